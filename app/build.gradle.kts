@@ -43,6 +43,11 @@ android {
     buildFeatures {
         viewBinding = true
     }
+    androidResources {
+        // KTX 纹理本身已压缩，不再打包压缩，运行时 AAsset_getBuffer 可以直接映射；.mesh 同样直接映射后上传
+        noCompress += "ktx"
+        noCompress += "mesh"
+    }
 }
 
 dependencies {
@@ -14,6 +14,10 @@
 #include <android/native_window.h>
 #include <android/native_window_jni.h>
 #include <android/log.h>
+#include "opengl_utils.h"
+#include "shader_compile_service.h"
+#include "gl_trace.h"
+#include "frame_timing.h"
 
 #define LOG_TAG "EGLDirect"
 #define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
@@ -27,6 +31,7 @@ static ANativeWindow* gWindow = nullptr;
 
 // OpenGL 渲染相关全局变量
 static GLuint gProgram = 0;
+static ProgramFuture gProgramFuture;  // 异步编译中的程序
 static GLuint gVAO = 0;
 static GLuint gVBO = 0;
 static bool gInitialized = false;
@@ -109,6 +114,8 @@ static bool createEGLContext(EGLConfig config) {
     
     // eglCreateContext(display, config, share_context, attribs)
     // 参数3share_context: 共享上下文（nullptr 表示不共享） 着色器 纹理贴图等可以共享
+    // 渲染上下文本身不需要共享；着色器编译工作线程会以它为 share_context
+    // 创建自己的上下文（见 shader_compile_service.cpp）
     // 参数4: 上下文属性数组
     gContext = eglCreateContext(gDisplay, config, nullptr, contextAttribs);
     if (gContext == EGL_NO_CONTEXT) {
@@ -212,9 +219,18 @@ Java_com_example_ndklearn2_EGLRenderer_nativeInitEGL(JNIEnv* env, jobject thiz,
     LOGI("OpenGL ES Version: %s", version);
     LOGI("OpenGL ES Renderer: %s", renderer);
     
-    // 8. 初始化 OpenGL 渲染资源（着色器、VAO/VBO）
+    // 有待处理的录制请求时从这里开始录制
+    glTraceContextCreated();
+    frameTimingContextCreated();
+    glCheckContextCreated();
+
+    // 8. 启动着色器编译工作线程（它的上下文与 gContext 共享对象）
+    startShaderCompileService();
+
+    // 9. 初始化 OpenGL 渲染资源（着色器、VAO/VBO）
     if (!initOpenGLResources()) {
         LOGE("Failed to initialize OpenGL resources");
+        stopShaderCompileService();
         eglDestroySurface(gDisplay, gSurface);
         eglDestroyContext(gDisplay, gContext);
         eglTerminate(gDisplay);
@@ -235,7 +251,12 @@ Java_com_example_ndklearn2_EGLRenderer_nativeSwapBuffers(JNIEnv* env, jobject th
     // eglSwapBuffers(display, surface)
     // 作用：将后台缓冲区的内容交换到前台，显示在屏幕上
     if (gDisplay != EGL_NO_DISPLAY && gSurface != EGL_NO_SURFACE) {
+        glTraceFrameEnd();
+        frameTimingBeginStage(FRAME_STAGE_SWAP);
         eglSwapBuffers(gDisplay, gSurface);
+        frameTimingEndStage(FRAME_STAGE_SWAP);
+        frameTimingEndFrame();
+        glCheckFrameEnd();
     }
 }
 
@@ -246,7 +267,8 @@ extern "C" JNIEXPORT void JNICALL
 Java_com_example_ndklearn2_EGLRenderer_nativeCleanupEGL(JNIEnv* env, jobject thiz) {
     LOGI("Cleaning up EGL resources");
     
-    // 1. 取消当前上下文
+    // 1. 停止着色器编译工作线程（销毁它的共享上下文），再取消当前上下文
+    stopShaderCompileService();
     if (gDisplay != EGL_NO_DISPLAY) {
         eglMakeCurrent(gDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
     }
@@ -278,6 +300,7 @@ Java_com_example_ndklearn2_EGLRenderer_nativeCleanupEGL(JNIEnv* env, jobject thi
         glDeleteProgram(gProgram);
         gProgram = 0;
     }
+    gProgramFuture = ProgramFuture();
     
     // 5. 终止 EGL
     if (gDisplay != EGL_NO_DISPLAY) {
@@ -332,99 +355,16 @@ precision mediump float;
     }
 )";
 
-// ============================================================
-// 编译着色器
-// ============================================================
-static GLuint compileShader(GLenum type, const char* source) {
-    GLuint shader = glCreateShader(type);
-    if (shader == 0) {
-        LOGE("Failed to create shader");
-        return 0;
-    }
-    
-    glShaderSource(shader, 1, &source, nullptr);
-    glCompileShader(shader);
-    
-    GLint compiled = 0;
-    glGetShaderiv(shader, GL_COMPILE_STATUS, &compiled);
-    if (!compiled) {
-        GLint infoLen = 0;
-        glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &infoLen);
-        if (infoLen > 0) {
-            char* infoLog = new char[infoLen];
-            glGetShaderInfoLog(shader, infoLen, nullptr, infoLog);
-            LOGE("Shader compilation error: %s", infoLog);
-            delete[] infoLog;
-        }
-        glDeleteShader(shader);
-        return 0;
-    }
-    
-    return shader;
-}
-
-// ============================================================
-// 创建着色器程序
-// ============================================================
-static GLuint createProgram() {
-    GLuint vertexShader = compileShader(GL_VERTEX_SHADER, vertexShaderSource);
-    if (vertexShader == 0) {
-        return 0;
-    }
-    
-    GLuint fragmentShader = compileShader(GL_FRAGMENT_SHADER, fragmentShaderSource);
-    if (fragmentShader == 0) {
-        glDeleteShader(vertexShader);
-        return 0;
-    }
-    
-    GLuint program = glCreateProgram();
-    if (program == 0) {
-        LOGE("Failed to create program");
-        glDeleteShader(vertexShader);
-        glDeleteShader(fragmentShader);
-        return 0;
-    }
-    
-    glAttachShader(program, vertexShader);
-    glAttachShader(program, fragmentShader);
-    glLinkProgram(program);
-    
-    GLint linked = 0;
-    glGetProgramiv(program, GL_LINK_STATUS, &linked);
-    if (!linked) {
-        GLint infoLen = 0;
-        glGetProgramiv(program, GL_INFO_LOG_LENGTH, &infoLen);
-        if (infoLen > 0) {
-            char* infoLog = new char[infoLen];
-            glGetProgramInfoLog(program, infoLen, nullptr, infoLog);
-            LOGE("Program linking error: %s", infoLog);
-            delete[] infoLog;
-        }
-        glDeleteProgram(program);
-        glDeleteShader(vertexShader);
-        glDeleteShader(fragmentShader);
-        return 0;
-    }
-    
-    glDeleteShader(vertexShader);
-    glDeleteShader(fragmentShader);
-    
-    return program;
-}
-
 // ============================================================
 // 初始化 OpenGL 渲染资源
 // ============================================================
 static bool initOpenGLResources() {
     LOGI("Initializing OpenGL resources");
     
-    // 1. 创建着色器程序
-    gProgram = createProgram();
-    if (gProgram == 0) {
-        LOGE("Failed to create shader program");
-        return false;
-    }
+    // 1. 提交着色器程序编译请求（在工作线程编译，经过程序二进制缓存）
+    gProgram = 0;
+    gProgramFuture = requestProgramAsync(vertexShaderSource, fragmentShaderSource,
+                                         nullptr, 0, GL_INTERLEAVED_ATTRIBS);
     
     // 2. 定义三角形的顶点数据（位置 + 颜色）
     float vertices[] = {
@@ -466,15 +406,33 @@ Java_com_example_ndklearn2_EGLRenderer_nativeRender(JNIEnv* env, jobject thiz) {
     if (!gInitialized) {
         return;
     }
+    // 这一帧在 nativeSwapBuffers 交换完成后结束，帧耗时包含交换
+    frameTimingBeginFrame();
     
     // 清除颜色缓冲区
-    glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
-    glClear(GL_COLOR_BUFFER_BIT);
+    {
+        FrameTimingStageScope timing(FRAME_STAGE_CLEAR);
+        glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT);
+    }
+
+    // 程序还在编译：只输出背景色作为占位帧
+    if (gProgram == 0) {
+        if (!pollProgram(&gProgramFuture, &gProgram)) {
+            return;
+        }
+        if (gProgram == 0) {
+            LOGE("Failed to create shader program");
+            gInitialized = false;
+            return;
+        }
+    }
     
     // 使用着色器程序
     glUseProgram(gProgram);
     
     // 绘制三角形
+    FrameTimingStageScope timing(FRAME_STAGE_DRAW);
     glBindVertexArray(gVAO);
     glDrawArrays(GL_TRIANGLES, 0, 3);
     glBindVertexArray(0);
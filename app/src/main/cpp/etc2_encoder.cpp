@@ -0,0 +1,711 @@
+//
+// Created by zhangx on 2026/10/16.
+// ETC2 块编码实现
+//
+// 块内像素下标：按行排列的 p = y * 4 + x；压缩数据中的像素索引按列排列（第 x * 4 + y 位）
+//
+
+#include "etc2_encoder.h"
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <stdint.h>
+#include <thread>
+#include <vector>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define ETC2_SIMD_NEON
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define ETC2_SIMD_SSE2
+#endif
+
+static const int MAX_AUTO_THREADS = 4;
+static const int MIN_PARALLEL_BLOCKS = 256;  // 更小的图像在调用线程直接编码，不唤醒线程池
+
+// 颜色修正表：选择值 0..3 对应 +a、+b、-a、-b
+static const int ETC_MODIFIERS[8][2] = {
+    {2, 8}, {5, 17}, {9, 29}, {13, 42}, {18, 60}, {24, 80}, {33, 106}, {47, 183}
+};
+
+// alpha 修正表，选择值 0..7
+static const int EAC_MODIFIERS[16][8] = {
+    {-3, -6, -9, -15, 2, 5, 8, 14},
+    {-3, -7, -10, -13, 2, 6, 9, 12},
+    {-2, -5, -8, -13, 1, 4, 7, 12},
+    {-2, -4, -6, -13, 1, 3, 5, 12},
+    {-3, -6, -8, -12, 2, 5, 7, 11},
+    {-3, -7, -9, -11, 2, 6, 8, 10},
+    {-4, -7, -8, -11, 3, 6, 7, 10},
+    {-3, -5, -8, -11, 2, 4, 7, 10},
+    {-2, -6, -8, -10, 1, 5, 7, 9},
+    {-2, -5, -8, -10, 1, 4, 7, 9},
+    {-2, -4, -8, -10, 1, 3, 7, 9},
+    {-2, -5, -7, -10, 1, 4, 6, 9},
+    {-3, -4, -7, -10, 2, 3, 6, 9},
+    {-1, -2, -3, -10, 0, 1, 2, 9},
+    {-4, -6, -8, -9, 3, 5, 7, 8},
+    {-3, -5, -7, -9, 2, 4, 6, 8}
+};
+
+static std::atomic<bool> gSimdEnabled(true);
+
+static inline int clamp255(int value) {
+    return value < 0 ? 0 : (value > 255 ? 255 : value);
+}
+
+// ==================== 误差计算 ====================
+
+// 子块的 8 个像素，按通道分开存放，方便按 8 个 16 位通道并行计算
+struct SubblockPixels {
+    int16_t r[8];
+    int16_t g[8];
+    int16_t b[8];
+    unsigned char index[8];  // 在块内的下标 y * 4 + x
+};
+
+// 每个像素在 4 个候选色中取误差最小的，写出选择值，返回误差和；相同误差取编号小的候选
+static int bestSelectorsScalar(const SubblockPixels& px, const int colors[4][3], unsigned char* selectors) {
+    int total = 0;
+    for (int i = 0; i < 8; i++) {
+        int best = INT_MAX;
+        for (int s = 0; s < 4; s++) {
+            int dr = colors[s][0] - px.r[i];
+            int dg = colors[s][1] - px.g[i];
+            int db = colors[s][2] - px.b[i];
+            int e = dr * dr + dg * dg + db * db;
+            if (e < best) {
+                best = e;
+                selectors[i] = (unsigned char)s;
+            }
+        }
+        total += best;
+    }
+    return total;
+}
+
+// alpha：16 个像素在 8 个候选值中取最近的，返回误差平方和
+static int eacErrorScalar(const int16_t* alpha, const int* values) {
+    int total = 0;
+    for (int p = 0; p < 16; p++) {
+        int best = INT_MAX;
+        for (int s = 0; s < 8; s++) {
+            int d = values[s] - alpha[p];
+            best = std::min(best, d * d);
+        }
+        total += best;
+    }
+    return total;
+}
+
+#if defined(ETC2_SIMD_NEON)
+
+static inline int horizontalSum(int32x4_t v) {
+#if defined(__aarch64__)
+    return vaddvq_s32(v);
+#else
+    int32x2_t pair = vadd_s32(vget_low_s32(v), vget_high_s32(v));
+    return vget_lane_s32(vpadd_s32(pair, pair), 0);
+#endif
+}
+
+static int bestSelectorsSimd(const SubblockPixels& px, const int colors[4][3], unsigned char* selectors) {
+    int16x8_t r = vld1q_s16(px.r);
+    int16x8_t g = vld1q_s16(px.g);
+    int16x8_t b = vld1q_s16(px.b);
+    int32x4_t bestLow = vdupq_n_s32(INT_MAX);
+    int32x4_t bestHigh = bestLow;
+    int32x4_t selectorLow = vdupq_n_s32(0);
+    int32x4_t selectorHigh = selectorLow;
+    for (int s = 0; s < 4; s++) {
+        int16x8_t dr = vsubq_s16(vdupq_n_s16((int16_t)colors[s][0]), r);
+        int16x8_t dg = vsubq_s16(vdupq_n_s16((int16_t)colors[s][1]), g);
+        int16x8_t db = vsubq_s16(vdupq_n_s16((int16_t)colors[s][2]), b);
+        int32x4_t low = vmull_s16(vget_low_s16(dr), vget_low_s16(dr));
+        low = vmlal_s16(low, vget_low_s16(dg), vget_low_s16(dg));
+        low = vmlal_s16(low, vget_low_s16(db), vget_low_s16(db));
+        int32x4_t high = vmull_s16(vget_high_s16(dr), vget_high_s16(dr));
+        high = vmlal_s16(high, vget_high_s16(dg), vget_high_s16(dg));
+        high = vmlal_s16(high, vget_high_s16(db), vget_high_s16(db));
+        uint32x4_t lessLow = vcltq_s32(low, bestLow);
+        uint32x4_t lessHigh = vcltq_s32(high, bestHigh);
+        bestLow = vbslq_s32(lessLow, low, bestLow);
+        bestHigh = vbslq_s32(lessHigh, high, bestHigh);
+        selectorLow = vbslq_s32(lessLow, vdupq_n_s32(s), selectorLow);
+        selectorHigh = vbslq_s32(lessHigh, vdupq_n_s32(s), selectorHigh);
+    }
+    int32_t lanes[8];
+    vst1q_s32(lanes, selectorLow);
+    vst1q_s32(lanes + 4, selectorHigh);
+    for (int i = 0; i < 8; i++) {
+        selectors[i] = (unsigned char)lanes[i];
+    }
+    return horizontalSum(vaddq_s32(bestLow, bestHigh));
+}
+
+static int eacErrorSimd(const int16_t* alpha, const int* values) {
+    int16x8_t a0 = vld1q_s16(alpha);
+    int16x8_t a1 = vld1q_s16(alpha + 8);
+    int16x8_t best0 = vdupq_n_s16(INT16_MAX);
+    int16x8_t best1 = best0;
+    for (int s = 0; s < 8; s++) {
+        int16x8_t value = vdupq_n_s16((int16_t)values[s]);
+        best0 = vminq_s16(best0, vabdq_s16(a0, value));
+        best1 = vminq_s16(best1, vabdq_s16(a1, value));
+    }
+    // 距离最小等价于误差平方最小，最后再平方求和
+    int32x4_t sum = vmull_s16(vget_low_s16(best0), vget_low_s16(best0));
+    sum = vmlal_s16(sum, vget_high_s16(best0), vget_high_s16(best0));
+    sum = vmlal_s16(sum, vget_low_s16(best1), vget_low_s16(best1));
+    sum = vmlal_s16(sum, vget_high_s16(best1), vget_high_s16(best1));
+    return horizontalSum(sum);
+}
+
+#elif defined(ETC2_SIMD_SSE2)
+
+static inline int horizontalSum(__m128i v) {
+    v = _mm_add_epi32(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2)));
+    v = _mm_add_epi32(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(v);
+}
+
+// mask 为真的通道取 a，否则取 b（SSE2 没有 blend）
+static inline __m128i select(__m128i mask, __m128i a, __m128i b) {
+    return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+static int bestSelectorsSimd(const SubblockPixels& px, const int colors[4][3], unsigned char* selectors) {
+    __m128i r = _mm_loadu_si128((const __m128i*)px.r);
+    __m128i g = _mm_loadu_si128((const __m128i*)px.g);
+    __m128i b = _mm_loadu_si128((const __m128i*)px.b);
+    __m128i zero = _mm_setzero_si128();
+    __m128i bestLow = _mm_set1_epi32(INT_MAX);
+    __m128i bestHigh = bestLow;
+    __m128i selectorLow = zero;
+    __m128i selectorHigh = zero;
+    for (int s = 0; s < 4; s++) {
+        __m128i dr = _mm_sub_epi16(_mm_set1_epi16((short)colors[s][0]), r);
+        __m128i dg = _mm_sub_epi16(_mm_set1_epi16((short)colors[s][1]), g);
+        __m128i db = _mm_sub_epi16(_mm_set1_epi16((short)colors[s][2]), b);
+        // (dr, dg) 交错后 madd 得到 dr² + dg²，(db, 0) 得到 db²，每个像素一个 32 位结果
+        __m128i rgLow = _mm_unpacklo_epi16(dr, dg);
+        __m128i rgHigh = _mm_unpackhi_epi16(dr, dg);
+        __m128i bLow = _mm_unpacklo_epi16(db, zero);
+        __m128i bHigh = _mm_unpackhi_epi16(db, zero);
+        __m128i low = _mm_add_epi32(_mm_madd_epi16(rgLow, rgLow), _mm_madd_epi16(bLow, bLow));
+        __m128i high = _mm_add_epi32(_mm_madd_epi16(rgHigh, rgHigh), _mm_madd_epi16(bHigh, bHigh));
+        __m128i lessLow = _mm_cmplt_epi32(low, bestLow);
+        __m128i lessHigh = _mm_cmplt_epi32(high, bestHigh);
+        bestLow = select(lessLow, low, bestLow);
+        bestHigh = select(lessHigh, high, bestHigh);
+        selectorLow = select(lessLow, _mm_set1_epi32(s), selectorLow);
+        selectorHigh = select(lessHigh, _mm_set1_epi32(s), selectorHigh);
+    }
+    int32_t lanes[8];
+    _mm_storeu_si128((__m128i*)lanes, selectorLow);
+    _mm_storeu_si128((__m128i*)(lanes + 4), selectorHigh);
+    for (int i = 0; i < 8; i++) {
+        selectors[i] = (unsigned char)lanes[i];
+    }
+    return horizontalSum(_mm_add_epi32(bestLow, bestHigh));
+}
+
+static inline __m128i absoluteDifference(__m128i a, __m128i b) {
+    __m128i d = _mm_sub_epi16(a, b);
+    return _mm_max_epi16(d, _mm_sub_epi16(_mm_setzero_si128(), d));
+}
+
+static int eacErrorSimd(const int16_t* alpha, const int* values) {
+    __m128i a0 = _mm_loadu_si128((const __m128i*)alpha);
+    __m128i a1 = _mm_loadu_si128((const __m128i*)(alpha + 8));
+    __m128i best0 = _mm_set1_epi16(INT16_MAX);
+    __m128i best1 = best0;
+    for (int s = 0; s < 8; s++) {
+        __m128i value = _mm_set1_epi16((short)values[s]);
+        best0 = _mm_min_epi16(best0, absoluteDifference(a0, value));
+        best1 = _mm_min_epi16(best1, absoluteDifference(a1, value));
+    }
+    // 距离最小等价于误差平方最小，最后再平方求和
+    __m128i sum = _mm_add_epi32(_mm_madd_epi16(best0, best0), _mm_madd_epi16(best1, best1));
+    return horizontalSum(sum);
+}
+
+#endif
+
+static inline int bestSelectors(const SubblockPixels& px, const int colors[4][3], unsigned char* selectors) {
+#if defined(ETC2_SIMD_NEON) || defined(ETC2_SIMD_SSE2)
+    if (gSimdEnabled.load(std::memory_order_relaxed)) {
+        return bestSelectorsSimd(px, colors, selectors);
+    }
+#endif
+    return bestSelectorsScalar(px, colors, selectors);
+}
+
+static inline int eacError(const int16_t* alpha, const int* values) {
+#if defined(ETC2_SIMD_NEON) || defined(ETC2_SIMD_SSE2)
+    if (gSimdEnabled.load(std::memory_order_relaxed)) {
+        return eacErrorSimd(alpha, values);
+    }
+#endif
+    return eacErrorScalar(alpha, values);
+}
+
+// ==================== 颜色块 ====================
+
+// 一个子块的拟合结果
+struct SubblockFit {
+    int table;
+    int error;
+    unsigned char selectors[8];
+};
+
+// 子块中的 8 个像素：flip 为 0 时左右两个 2x4，为 1 时上下两个 4x2
+static void gatherSubblock(const unsigned char* pixels, int flip, int subblock, SubblockPixels* px) {
+    int n = 0;
+    for (int y = 0; y < 4; y++) {
+        for (int x = 0; x < 4; x++) {
+            int half = flip ? y / 2 : x / 2;
+            if (half == subblock) {
+                const unsigned char* p = pixels + (y * 4 + x) * 4;
+                px->r[n] = p[0];
+                px->g[n] = p[1];
+                px->b[n] = p[2];
+                px->index[n] = (unsigned char)(y * 4 + x);
+                n++;
+            }
+        }
+    }
+}
+
+// 给定基色，尝试 8 张修正表，每个像素取误差最小的选择值
+static void fitSubblock(const SubblockPixels& px, const int* base, SubblockFit* fit) {
+    fit->error = INT_MAX;
+    for (int table = 0; table < 8; table++) {
+        int colors[4][3];
+        for (int s = 0; s < 4; s++) {
+            int magnitude = ETC_MODIFIERS[table][s & 1];
+            int modifier = s & 2 ? -magnitude : magnitude;
+            for (int c = 0; c < 3; c++) {
+                colors[s][c] = clamp255(base[c] + modifier);
+            }
+        }
+        unsigned char selectors[8];
+        int error = bestSelectors(px, colors, selectors);
+        if (error < fit->error) {
+            fit->error = error;
+            fit->table = table;
+            memcpy(fit->selectors, selectors, sizeof(selectors));
+        }
+    }
+}
+
+// 量化值展开为 8 位基色
+static void expandBase(const int* quantized, bool differential, int* base) {
+    for (int c = 0; c < 3; c++) {
+        base[c] = differential ? (quantized[c] << 3) | (quantized[c] >> 2) : quantized[c] * 17;
+    }
+}
+
+// differential 时第二个子块与第一个的差值必须在 [-4, 3]，两种模式都不能超出量化范围
+static bool validBases(const int quantized[2][3], bool differential) {
+    int limit = differential ? 31 : 15;
+    for (int c = 0; c < 3; c++) {
+        if (quantized[0][c] < 0 || quantized[0][c] > limit || quantized[1][c] < 0 || quantized[1][c] > limit) {
+            return false;
+        }
+        int delta = quantized[1][c] - quantized[0][c];
+        if (differential && (delta < -4 || delta > 3)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void packColorBlock(bool differential, int flip, const int quantized[2][3], const SubblockPixels* px,
+                           const SubblockFit* fits, unsigned char* out) {
+    uint32_t high = 0;
+    for (int c = 0; c < 3; c++) {
+        if (differential) {
+            int shift = 27 - c * 8;
+            high |= (uint32_t)quantized[0][c] << shift;
+            high |= (uint32_t)((quantized[1][c] - quantized[0][c]) & 7) << (shift - 3);
+        } else {
+            int shift = 28 - c * 8;
+            high |= (uint32_t)quantized[0][c] << shift;
+            high |= (uint32_t)quantized[1][c] << (shift - 4);
+        }
+    }
+    high |= (uint32_t)fits[0].table << 5 | (uint32_t)fits[1].table << 2;
+    high |= (uint32_t)differential << 1 | (uint32_t)flip;
+
+    uint32_t low = 0;
+    for (int s = 0; s < 2; s++) {
+        for (int i = 0; i < 8; i++) {
+            int p = px[s].index[i];
+            int bit = (p % 4) * 4 + p / 4;
+            int selector = fits[s].selectors[i];
+            low |= (uint32_t)(selector >> 1) << (16 + bit);
+            low |= (uint32_t)(selector & 1) << bit;
+        }
+    }
+    for (int i = 0; i < 4; i++) {
+        out[i] = (unsigned char)(high >> (24 - i * 8));
+        out[4 + i] = (unsigned char)(low >> (24 - i * 8));
+    }
+}
+
+void encodeETC2ColorBlock(const unsigned char* pixels, ETC2Quality quality, unsigned char* out) {
+    SubblockPixels px[2][2];
+    float average[2][2][3];
+    float variance[2] = {0.0f, 0.0f};
+    for (int flip = 0; flip < 2; flip++) {
+        for (int s = 0; s < 2; s++) {
+            SubblockPixels& sub = px[flip][s];
+            gatherSubblock(pixels, flip, s, &sub);
+            const int16_t* channels[3] = {sub.r, sub.g, sub.b};
+            for (int c = 0; c < 3; c++) {
+                int sum = 0;
+                int squares = 0;
+                for (int i = 0; i < 8; i++) {
+                    sum += channels[c][i];
+                    squares += channels[c][i] * channels[c][i];
+                }
+                average[flip][s][c] = sum / 8.0f;
+                variance[flip] += squares - sum * sum / 8.0f;
+            }
+        }
+    }
+
+    // FAST 只编码子块内方差小的翻转方向
+    int firstFlip = 0;
+    int lastFlip = 1;
+    if (quality == ETC2_QUALITY_FAST) {
+        firstFlip = lastFlip = variance[1] < variance[0] ? 1 : 0;
+    }
+
+    int bestError = INT_MAX;
+    for (int flip = firstFlip; flip <= lastFlip; flip++) {
+        // differential：5 位基色 + 3 位有符号差值，差值超出 [-4, 3] 时把第二个基色拉回范围内
+        // individual：两个子块各自 4 位基色
+        bool clamped = false;
+        for (int differential = 1; differential >= 0; differential--) {
+            if (!differential && quality == ETC2_QUALITY_FAST && !clamped) {
+                continue;
+            }
+            int quantized[2][3];
+            for (int c = 0; c < 3; c++) {
+                if (differential) {
+                    int q0 = (int)(average[flip][0][c] * 31.0f / 255.0f + 0.5f);
+                    int q1 = (int)(average[flip][1][c] * 31.0f / 255.0f + 0.5f);
+                    int delta = std::min(std::max(q1 - q0, -4), 3);
+                    clamped = clamped || delta != q1 - q0;
+                    quantized[0][c] = q0;
+                    quantized[1][c] = q0 + delta >= 0 && q0 + delta <= 31 ? q0 + delta : q0;
+                } else {
+                    quantized[0][c] = (int)(average[flip][0][c] * 15.0f / 255.0f + 0.5f);
+                    quantized[1][c] = (int)(average[flip][1][c] * 15.0f / 255.0f + 0.5f);
+                }
+            }
+
+            SubblockFit fits[2];
+            for (int s = 0; s < 2; s++) {
+                int base[3];
+                expandBase(quantized[s], differential != 0, base);
+                fitSubblock(px[flip][s], base, &fits[s]);
+            }
+
+            // HIGH：逐通道把量化值 ±1，子块误差变小就保留
+            if (quality == ETC2_QUALITY_HIGH) {
+                for (int s = 0; s < 2; s++) {
+                    for (int c = 0; c < 3; c++) {
+                        for (int step = -1; step <= 1; step += 2) {
+                            int trial[2][3];
+                            memcpy(trial, quantized, sizeof(trial));
+                            trial[s][c] += step;
+                            if (!validBases(trial, differential != 0)) {
+                                continue;
+                            }
+                            int base[3];
+                            SubblockFit fit;
+                            expandBase(trial[s], differential != 0, base);
+                            fitSubblock(px[flip][s], base, &fit);
+                            if (fit.error < fits[s].error) {
+                                fits[s] = fit;
+                                memcpy(quantized, trial, sizeof(trial));
+                            }
+                        }
+                    }
+                }
+            }
+
+            int error = fits[0].error + fits[1].error;
+            if (error < bestError) {
+                bestError = error;
+                packColorBlock(differential != 0, flip, quantized, px[flip], fits, out);
+            }
+        }
+    }
+}
+
+// ==================== alpha 块 ====================
+
+void encodeEACAlphaBlock(const unsigned char* pixels, ETC2Quality quality, unsigned char* out) {
+    int16_t alpha[16];
+    int minAlpha = 255;
+    int maxAlpha = 0;
+    for (int p = 0; p < 16; p++) {
+        alpha[p] = pixels[p * 4 + 3];
+        minAlpha = std::min(minAlpha, (int)alpha[p]);
+        maxAlpha = std::max(maxAlpha, (int)alpha[p]);
+    }
+
+    // 第 13 张表含 0，整块 alpha 相同时精确
+    int bestBase = minAlpha;
+    int bestMultiplier = 1;
+    int bestTable = 13;
+    int bestError = INT_MAX;
+    if (minAlpha != maxAlpha) {
+        // 每张表按范围估计倍数，再在估计值附近搜索基准值和倍数
+        int multiplierRadius = quality == ETC2_QUALITY_FAST ? 0 : (quality == ETC2_QUALITY_NORMAL ? 1 : 2);
+        int baseRadius = quality == ETC2_QUALITY_FAST ? 1 : (quality == ETC2_QUALITY_NORMAL ? 2 : 3);
+        for (int table = 0; table < 16 && bestError > 0; table++) {
+            int low = EAC_MODIFIERS[table][3];
+            int high = EAC_MODIFIERS[table][7];
+            int estimate = (maxAlpha - minAlpha + (high - low) / 2) / (high - low);
+            for (int multiplier = estimate - multiplierRadius; multiplier <= estimate + multiplierRadius; multiplier++) {
+                if (multiplier < 1 || multiplier > 15) {
+                    continue;
+                }
+                int center = (minAlpha + maxAlpha) / 2 - (low + high) * multiplier / 2;
+                for (int base = center - baseRadius; base <= center + baseRadius; base++) {
+                    if (base < 0 || base > 255) {
+                        continue;
+                    }
+                    int values[8];
+                    for (int s = 0; s < 8; s++) {
+                        values[s] = clamp255(base + EAC_MODIFIERS[table][s] * multiplier);
+                    }
+                    int error = eacError(alpha, values);
+                    if (error < bestError) {
+                        bestError = error;
+                        bestBase = base;
+                        bestMultiplier = multiplier;
+                        bestTable = table;
+                    }
+                }
+            }
+        }
+    }
+
+    uint64_t bits = (uint64_t)bestBase << 56 | (uint64_t)bestMultiplier << 52 | (uint64_t)bestTable << 48;
+    for (int p = 0; p < 16; p++) {
+        int best = INT_MAX;
+        int selector = 0;
+        for (int s = 0; s < 8; s++) {
+            int d = clamp255(bestBase + EAC_MODIFIERS[bestTable][s] * bestMultiplier) - alpha[p];
+            if (d * d < best) {
+                best = d * d;
+                selector = s;
+            }
+        }
+        int bit = (p % 4) * 4 + p / 4;
+        bits |= (uint64_t)selector << (45 - bit * 3);
+    }
+    for (int i = 0; i < 8; i++) {
+        out[i] = (unsigned char)(bits >> (56 - i * 8));
+    }
+}
+
+// ==================== 整张图像与线程池 ====================
+
+struct EncodeJob {
+    const unsigned char* rgba;
+    int width;
+    int height;
+    bool alpha;
+    ETC2Quality quality;
+    unsigned char* out;
+    int blockRows;
+    std::atomic<int> nextRow;
+};
+
+// 编码线程池：调用线程和工作线程从 nextRow 领取块行，直到全部编码完
+struct EncoderPool {
+    std::mutex callMutex;        // 一次只编码一张图像
+    std::mutex mutex;
+    std::condition_variable cond;
+    std::condition_variable doneCond;
+    std::vector<std::thread> workers;
+    int requestedThreads;        // 0 表示自动
+    EncodeJob* job;              // 当前图像，编码完后置空，晚醒的工作线程据此跳过
+    uint64_t generation;
+    int active;                  // 正在领取块行的工作线程数
+    bool stopping;
+
+    ~EncoderPool() { stopWorkers(); }
+
+    void stopWorkers() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        cond.notify_all();
+        for (size_t i = 0; i < workers.size(); i++) {
+            workers[i].join();
+        }
+        workers.clear();
+        stopping = false;
+    }
+};
+
+static EncoderPool gPool;
+
+static void encodeBlockRow(const EncodeJob& job, int by) {
+    int blocksX = (job.width + 3) / 4;
+    size_t blockBytes = job.alpha ? 16 : 8;
+    unsigned char* out = job.out + (size_t)by * blocksX * blockBytes;
+    unsigned char block[16 * 4];
+    for (int bx = 0; bx < blocksX; bx++) {
+        for (int y = 0; y < 4; y++) {
+            int sy = std::min(by * 4 + y, job.height - 1);
+            for (int x = 0; x < 4; x++) {
+                int sx = std::min(bx * 4 + x, job.width - 1);
+                memcpy(block + (y * 4 + x) * 4, job.rgba + ((size_t)sy * job.width + sx) * 4, 4);
+            }
+        }
+        if (job.alpha) {
+            encodeEACAlphaBlock(block, job.quality, out);
+            out += 8;
+        }
+        encodeETC2ColorBlock(block, job.quality, out);
+        out += 8;
+    }
+}
+
+static void encodeRows(EncodeJob* job) {
+    while (true) {
+        int row = job->nextRow.fetch_add(1);
+        if (row >= job->blockRows) {
+            break;
+        }
+        encodeBlockRow(*job, row);
+    }
+}
+
+static void workerLoop() {
+    uint64_t seen = 0;
+    std::unique_lock<std::mutex> lock(gPool.mutex);
+    while (true) {
+        gPool.cond.wait(lock, [&seen] { return gPool.stopping || gPool.generation != seen; });
+        if (gPool.stopping) {
+            break;
+        }
+        seen = gPool.generation;
+        EncodeJob* job = gPool.job;
+        if (job == nullptr) {
+            continue;
+        }
+        gPool.active++;
+        lock.unlock();
+        encodeRows(job);
+        lock.lock();
+        if (--gPool.active == 0) {
+            gPool.doneCond.notify_all();
+        }
+    }
+}
+
+static int poolThreadCount() {
+    if (gPool.requestedThreads > 0) {
+        return gPool.requestedThreads;
+    }
+    int cores = (int)std::thread::hardware_concurrency();
+    return std::max(1, std::min(cores, MAX_AUTO_THREADS));
+}
+
+void encodeETC2Image(const unsigned char* rgba, int width, int height, bool alpha, ETC2Quality quality,
+                     unsigned char* out) {
+    EncodeJob job;
+    job.rgba = rgba;
+    job.width = width;
+    job.height = height;
+    job.alpha = alpha;
+    job.quality = quality;
+    job.out = out;
+    job.blockRows = (height + 3) / 4;
+    job.nextRow = 0;
+
+    int blocks = job.blockRows * ((width + 3) / 4);
+    std::lock_guard<std::mutex> call(gPool.callMutex);
+    int threads = poolThreadCount();
+    if (threads == 1 || blocks < MIN_PARALLEL_BLOCKS) {
+        encodeRows(&job);
+        return;
+    }
+    // 第一次使用或线程数改变后（重新）创建工作线程
+    if ((int)gPool.workers.size() != threads - 1) {
+        gPool.stopWorkers();
+        for (int i = 0; i < threads - 1; i++) {
+            gPool.workers.push_back(std::thread(workerLoop));
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(gPool.mutex);
+        gPool.job = &job;
+        gPool.generation++;
+    }
+    gPool.cond.notify_all();
+    encodeRows(&job);
+    std::unique_lock<std::mutex> lock(gPool.mutex);
+    gPool.doneCond.wait(lock, [] { return gPool.active == 0; });
+    gPool.job = nullptr;
+}
+
+void encodeETC2Levels(const unsigned char* data, const KTXImage& source, bool alpha, ETC2Quality quality,
+                      std::vector<unsigned char>* out, KTXImage* image) {
+    *image = source;
+    image->internalFormat = alpha ? GL_COMPRESSED_RGBA8_ETC2_EAC : GL_COMPRESSED_RGB8_ETC2;
+    out->clear();
+    for (int i = 0; i < image->levelCount; i++) {
+        KTXLevel& info = image->levels[i];
+        info.offset = (uint32_t)out->size();
+        info.size = (uint32_t)compressedLevelSize(image->internalFormat, info.width, info.height);
+        out->resize(out->size() + info.size);
+        encodeETC2Image(data + source.levels[i].offset, info.width, info.height, alpha, quality,
+                        out->data() + info.offset);
+    }
+}
+
+bool etc2NeedsAlpha(const unsigned char* rgba, int width, int height) {
+    size_t count = (size_t)width * height;
+    for (size_t i = 0; i < count; i++) {
+        if (rgba[i * 4 + 3] != 255) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void setETC2EncoderThreads(int count) {
+    std::lock_guard<std::mutex> call(gPool.callMutex);
+    gPool.requestedThreads = std::max(count, 0);
+}
+
+void setETC2EncoderSimd(bool enabled) {
+    gSimdEnabled.store(enabled, std::memory_order_relaxed);
+}
+
+const char* etc2EncoderSimdName() {
+#if defined(ETC2_SIMD_NEON)
+    return "NEON";
+#elif defined(ETC2_SIMD_SSE2)
+    return "SSE2";
+#else
+    return "none";
+#endif
+}
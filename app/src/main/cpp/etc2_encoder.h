@@ -0,0 +1,48 @@
+//
+// Created by zhangx on 2026/10/16.
+// ETC2 块编码 - 把 RGBA8 图像编码为 GL_COMPRESSED_RGB8_ETC2 或 GL_COMPRESSED_RGBA8_ETC2_EAC
+//
+// 颜色块只使用与 ETC1 兼容的 individual / differential 模式，alpha 块按 EAC 的 16 张修正表搜索基准值和倍数。
+// 误差计算有 NEON / SSE2 实现（编译目标支持时自动使用），整张图像按块行分给编码线程池。
+// 离线工具（host/texture_encoder.cpp）和运行时的纹理加载（texture_loader.h）共用
+//
+
+#ifndef NDKLEARN2_ETC2_ENCODER_H
+#define NDKLEARN2_ETC2_ENCODER_H
+
+#include "ktx_container.h"
+#include <stddef.h>
+#include <vector>
+
+enum ETC2Quality {
+    ETC2_QUALITY_FAST = 0,  // 按子块方差选翻转方向，只在差值超出范围时尝试 individual，alpha 只试估计的倍数
+    ETC2_QUALITY_NORMAL,    // 两种翻转、两种模式全部比较
+    ETC2_QUALITY_HIGH       // 在 NORMAL 的基础上逐通道微调量化后的基色，离线工具默认使用
+};
+
+// 编码一个 4x4 块，pixels 为按行排列的 16 个 RGBA8 像素
+void encodeETC2ColorBlock(const unsigned char* pixels, ETC2Quality quality, unsigned char* out);  // 8 字节，忽略 alpha
+void encodeEACAlphaBlock(const unsigned char* pixels, ETC2Quality quality, unsigned char* out);   // 8 字节，只用 alpha
+
+// 编码整张图像（行紧密排列），宽高不是 4 的倍数时边缘块重复最后一行/列
+// alpha 为 false 输出 RGB8_ETC2（每块 8 字节），为 true 输出 RGBA8_ETC2_EAC（每块 16 字节，alpha 块在前）
+// out 的大小见 compressedLevelSize（ktx_container.h）。可在任意线程调用，多个调用方共用线程池时依次执行
+void encodeETC2Image(const unsigned char* rgba, int width, int height, bool alpha, ETC2Quality quality,
+                     unsigned char* out);
+
+// 逐级编码 mip 链：source 描述 data 中各级 RGBA8 数据（例如 generateMipChain 的结果），
+// 编码结果依次写进 out，image 写出压缩后的格式和各级偏移
+void encodeETC2Levels(const unsigned char* data, const KTXImage& source, bool alpha, ETC2Quality quality,
+                      std::vector<unsigned char>* out, KTXImage* image);
+
+// 图像中是否有 alpha 小于 255 的像素，决定用 RGBA8_ETC2_EAC 还是 RGB8_ETC2
+bool etc2NeedsAlpha(const unsigned char* rgba, int width, int height);
+
+// 编码线程数（包括调用线程），0 表示按 CPU 核数自动选择（最多 4 个），1 表示只在调用线程编码
+void setETC2EncoderThreads(int count);
+// 关闭后使用标量实现，基准测试对比用；两种实现的输出完全相同
+void setETC2EncoderSimd(bool enabled);
+// 编译进来的 SIMD 实现："NEON"、"SSE2" 或 "none"
+const char* etc2EncoderSimdName();
+
+#endif //NDKLEARN2_ETC2_ENCODER_H
@@ -0,0 +1,352 @@
+//
+// Created by zhangx on 2026/10/16.
+// 分阶段帧耗时统计实现
+//
+// 计时查询直接调用驱动，不经过 gl_trace.h 的录制包装：
+// 它们不影响渲染结果，也不应出现在录制文件和基准测试的调用计数里
+//
+
+#include "frame_timing.h"
+#include <GLES3/gl3.h>
+#include <GLES2/gl2ext.h>
+#include <EGL/egl.h>
+#ifdef __ANDROID__
+#include <jni.h>
+#endif
+#include <android/log.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <mutex>
+#include <vector>
+
+#define LOG_TAG "FrameTiming"
+#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
+#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
+
+typedef std::chrono::steady_clock Clock;
+
+static const int GPU_STAGE_COUNT = FRAME_STAGE_CULL;  // CULL 之前的阶段测 GPU
+static const int FRAME_LATENCY = 4;                   // GPU 结果最多等 3 帧，再晚只上报 CPU 耗时
+
+const char* frameStageName(int stage) {
+    switch (stage) {
+        case FRAME_STAGE_CLEAR: return "clear";
+        case FRAME_STAGE_UNIFORMS: return "uniforms";
+        case FRAME_STAGE_TFB_UPDATE: return "tfbUpdate";
+        case FRAME_STAGE_DRAW: return "draw";
+        case FRAME_STAGE_CULL: return "cull";
+        case FRAME_STAGE_SWAP: return "swap";
+        case FRAME_STAGE_FRAME: return "frame";
+        default: return "unknown";
+    }
+}
+
+// ==================== 样本环形缓冲区 ====================
+// 单生产者（渲染线程）无锁写入；取出方之间用互斥锁串行，不会阻塞渲染线程
+
+struct StageSample {
+    uint32_t stage;
+    float cpuMs;
+    float gpuMs;  // 没有 GPU 结果时为 -1
+};
+
+static const uint32_t RING_CAPACITY = 4096;  // 2 的幂，约 10 秒的 60 FPS 数据
+static StageSample gRing[RING_CAPACITY];
+static std::atomic<uint32_t> gRingHead(0);  // 只由渲染线程写
+static std::atomic<uint32_t> gRingTail(0);  // 只由取出方写
+static std::atomic<uint32_t> gDropped(0);
+static std::mutex gDrainMutex;
+
+static void pushSample(uint32_t stage, float cpuMs, float gpuMs) {
+    uint32_t head = gRingHead.load(std::memory_order_relaxed);
+    uint32_t tail = gRingTail.load(std::memory_order_acquire);
+    if (head - tail >= RING_CAPACITY) {
+        gDropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    StageSample& sample = gRing[head & (RING_CAPACITY - 1)];
+    sample.stage = stage;
+    sample.cpuMs = cpuMs;
+    sample.gpuMs = gpuMs;
+    gRingHead.store(head + 1, std::memory_order_release);
+}
+
+// ==================== 渲染线程状态 ====================
+
+struct FrameSlot {
+    bool pending;                       // 已结束，等待 GPU 结果
+    uint32_t stageMask;                 // 本帧出现过的阶段
+    uint32_t queryMask;                 // 已发出 GPU 查询的阶段
+    float cpuMs[FRAME_STAGE_COUNT];
+};
+
+static std::atomic<bool> gEnabled(true);
+static std::atomic<bool> gGpuSupported(false);
+
+// 以下状态只在渲染线程访问
+static struct {
+    PFNGLGETQUERYOBJECTUI64VEXTPROC getQueryObjectui64v;
+    GLuint queries[FRAME_LATENCY][GPU_STAGE_COUNT];
+    FrameSlot slots[FRAME_LATENCY];
+    uint32_t frame;                     // 当前帧序号，slots[frame % FRAME_LATENCY]
+    bool inFrame;
+    int activeQuery;                    // 正在计时的阶段，同一时刻只能有一个 TIME_ELAPSED 查询
+    Clock::time_point frameStart;
+    Clock::time_point stageStart[FRAME_STAGE_COUNT];
+} gTiming = {nullptr, {{0}}, {}, 0, false, -1};
+
+static float elapsedMs(Clock::time_point start, Clock::time_point end) {
+    return std::chrono::duration<float, std::milli>(end - start).count();
+}
+
+static void publishFrame(uint32_t frame, bool withGpu);
+
+void frameTimingContextCreated() {
+    // 旧上下文的查询对象随上下文销毁，未取回的帧只上报 CPU 耗时
+    for (uint32_t frame = gTiming.frame - FRAME_LATENCY; frame != gTiming.frame; frame++) {
+        if (gTiming.slots[frame % FRAME_LATENCY].pending) {
+            publishFrame(frame, false);
+        }
+    }
+    memset(gTiming.slots, 0, sizeof(gTiming.slots));
+    gTiming.inFrame = false;
+    gTiming.activeQuery = -1;
+
+    const char* extensions = (const char*)glGetString(GL_EXTENSIONS);
+    bool supported = extensions != nullptr && strstr(extensions, "GL_EXT_disjoint_timer_query") != nullptr;
+    if (supported) {
+        gTiming.getQueryObjectui64v =
+                (PFNGLGETQUERYOBJECTUI64VEXTPROC)eglGetProcAddress("glGetQueryObjectui64vEXT");
+        supported = gTiming.getQueryObjectui64v != nullptr;
+    }
+    if (supported) {
+        glGenQueries(FRAME_LATENCY * GPU_STAGE_COUNT, &gTiming.queries[0][0]);
+        // 读一次清掉上下文创建前可能残留的 disjoint 标志
+        GLint disjoint = 0;
+        glGetIntegerv(GL_GPU_DISJOINT_EXT, &disjoint);
+    }
+    gGpuSupported.store(supported, std::memory_order_relaxed);
+    LOGI("Frame timing: GPU timer queries %s", supported ? "available" : "not supported, CPU only");
+}
+
+bool frameTimingGpuSupported() {
+    return gGpuSupported.load(std::memory_order_relaxed);
+}
+
+void setFrameTimingEnabled(bool enabled) {
+    gEnabled.store(enabled, std::memory_order_relaxed);
+}
+
+void frameTimingBeginFrame() {
+    if (gTiming.inFrame || !gEnabled.load(std::memory_order_relaxed)) {
+        return;
+    }
+    FrameSlot& slot = gTiming.slots[gTiming.frame % FRAME_LATENCY];
+    slot.stageMask = 0;
+    slot.queryMask = 0;
+    memset(slot.cpuMs, 0, sizeof(slot.cpuMs));
+    gTiming.inFrame = true;
+    gTiming.frameStart = Clock::now();
+}
+
+void frameTimingBeginStage(FrameStage stage) {
+    if (!gTiming.inFrame) {
+        return;
+    }
+    FrameSlot& slot = gTiming.slots[gTiming.frame % FRAME_LATENCY];
+    uint32_t bit = 1u << stage;
+    if (stage < GPU_STAGE_COUNT && gTiming.activeQuery < 0 && (slot.queryMask & bit) == 0 &&
+        gGpuSupported.load(std::memory_order_relaxed)) {
+        glBeginQuery(GL_TIME_ELAPSED_EXT, gTiming.queries[gTiming.frame % FRAME_LATENCY][stage]);
+        gTiming.activeQuery = stage;
+        slot.queryMask |= bit;
+    }
+    gTiming.stageStart[stage] = Clock::now();
+}
+
+void frameTimingEndStage(FrameStage stage) {
+    if (!gTiming.inFrame) {
+        return;
+    }
+    FrameSlot& slot = gTiming.slots[gTiming.frame % FRAME_LATENCY];
+    slot.cpuMs[stage] += elapsedMs(gTiming.stageStart[stage], Clock::now());
+    slot.stageMask |= 1u << stage;
+    if (gTiming.activeQuery == stage) {
+        glEndQuery(GL_TIME_ELAPSED_EXT);
+        gTiming.activeQuery = -1;
+    }
+}
+
+// 上报一帧的样本；withGpu 为 false 时丢弃这一帧的 GPU 结果
+static void publishFrame(uint32_t frame, bool withGpu) {
+    FrameSlot& slot = gTiming.slots[frame % FRAME_LATENCY];
+    for (int stage = 0; stage < FRAME_STAGE_COUNT; stage++) {
+        if ((slot.stageMask & (1u << stage)) == 0) {
+            continue;
+        }
+        float gpuMs = -1.0f;
+        if (withGpu && (slot.queryMask & (1u << stage)) != 0) {
+            GLuint64 ns = 0;
+            gTiming.getQueryObjectui64v(gTiming.queries[frame % FRAME_LATENCY][stage], GL_QUERY_RESULT_EXT, &ns);
+            gpuMs = ns / 1000000.0f;
+        }
+        pushSample(stage, slot.cpuMs[stage], gpuMs);
+    }
+    slot.pending = false;
+}
+
+static bool gpuResultsAvailable(uint32_t frame) {
+    FrameSlot& slot = gTiming.slots[frame % FRAME_LATENCY];
+    for (int stage = 0; stage < GPU_STAGE_COUNT; stage++) {
+        if ((slot.queryMask & (1u << stage)) == 0) {
+            continue;
+        }
+        GLuint available = GL_FALSE;
+        glGetQueryObjectuiv(gTiming.queries[frame % FRAME_LATENCY][stage], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (available == GL_FALSE) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void frameTimingEndFrame() {
+    if (!gTiming.inFrame) {
+        return;
+    }
+    if (gTiming.activeQuery >= 0) {
+        // 阶段没有配对结束（提前返回等），查询在这里关闭，结果照常取回
+        glEndQuery(GL_TIME_ELAPSED_EXT);
+        gTiming.activeQuery = -1;
+    }
+    FrameSlot& current = gTiming.slots[gTiming.frame % FRAME_LATENCY];
+    current.cpuMs[FRAME_STAGE_FRAME] = elapsedMs(gTiming.frameStart, Clock::now());
+    current.stageMask |= 1u << FRAME_STAGE_FRAME;
+    current.pending = true;
+    gTiming.inFrame = false;
+
+    // 按帧顺序取回：最老的帧下一帧就要复用查询对象，结果还没出来就只上报 CPU 耗时
+    GLint disjoint = 0;
+    if (gGpuSupported.load(std::memory_order_relaxed)) {
+        glGetIntegerv(GL_GPU_DISJOINT_EXT, &disjoint);
+    }
+    for (int i = FRAME_LATENCY - 1; i >= 0; i--) {
+        uint32_t frame = gTiming.frame - i;
+        if (!gTiming.slots[frame % FRAME_LATENCY].pending) {
+            continue;
+        }
+        bool oldest = i == FRAME_LATENCY - 1;
+        if (disjoint || !gGpuSupported.load(std::memory_order_relaxed)) {
+            publishFrame(frame, false);
+        } else if (gpuResultsAvailable(frame)) {
+            publishFrame(frame, true);
+        } else if (oldest) {
+            publishFrame(frame, false);
+        } else {
+            break;
+        }
+    }
+    gTiming.frame++;
+}
+
+// ==================== 汇总 ====================
+
+static float percentile(const std::vector<float>& sorted, float p) {
+    size_t index = (size_t)(p * sorted.size() + 0.5f);
+    index = index > 0 ? index - 1 : 0;
+    return sorted[std::min(index, sorted.size() - 1)];
+}
+
+static void summarize(std::vector<float>& values, uint32_t* count, float* minMs, float* avgMs,
+                      float* p95Ms, float* p99Ms) {
+    *count = (uint32_t)values.size();
+    if (values.empty()) {
+        *minMs = *avgMs = *p95Ms = *p99Ms = -1.0f;
+        return;
+    }
+    std::sort(values.begin(), values.end());
+    double sum = 0.0;
+    for (size_t i = 0; i < values.size(); i++) {
+        sum += values[i];
+    }
+    *minMs = values.front();
+    *avgMs = (float)(sum / values.size());
+    *p95Ms = percentile(values, 0.95f);
+    *p99Ms = percentile(values, 0.99f);
+}
+
+uint32_t drainFrameTiming(FrameStageStats stats[FRAME_STAGE_COUNT]) {
+    std::vector<float> cpu[FRAME_STAGE_COUNT];
+    std::vector<float> gpu[FRAME_STAGE_COUNT];
+    uint32_t dropped;
+    {
+        std::lock_guard<std::mutex> lock(gDrainMutex);
+        uint32_t tail = gRingTail.load(std::memory_order_relaxed);
+        uint32_t head = gRingHead.load(std::memory_order_acquire);
+        for (; tail != head; tail++) {
+            const StageSample& sample = gRing[tail & (RING_CAPACITY - 1)];
+            cpu[sample.stage].push_back(sample.cpuMs);
+            if (sample.gpuMs >= 0.0f) {
+                gpu[sample.stage].push_back(sample.gpuMs);
+            }
+        }
+        gRingTail.store(head, std::memory_order_release);
+        dropped = gDropped.exchange(0, std::memory_order_relaxed);
+    }
+
+    for (int stage = 0; stage < FRAME_STAGE_COUNT; stage++) {
+        FrameStageStats& s = stats[stage];
+        summarize(cpu[stage], &s.samples, &s.cpuMin, &s.cpuAvg, &s.cpuP95, &s.cpuP99);
+        summarize(gpu[stage], &s.gpuSamples, &s.gpuMin, &s.gpuAvg, &s.gpuP95, &s.gpuP99);
+    }
+    return dropped;
+}
+
+#ifdef __ANDROID__
+
+// 每个阶段 10 个值：[样本数, CPU min/avg/p95/p99, GPU 样本数, GPU min/avg/p95/p99]，末尾追加丢弃数
+static const int STATS_FLOATS_PER_STAGE = 10;
+
+extern "C" JNIEXPORT jfloatArray JNICALL
+Java_com_example_ndklearn2_FrameTiming_nativeDrain(JNIEnv* env, jclass clazz) {
+    FrameStageStats stats[FRAME_STAGE_COUNT];
+    uint32_t dropped = drainFrameTiming(stats);
+
+    float values[FRAME_STAGE_COUNT * STATS_FLOATS_PER_STAGE + 1];
+    for (int stage = 0; stage < FRAME_STAGE_COUNT; stage++) {
+        const FrameStageStats& s = stats[stage];
+        float* v = &values[stage * STATS_FLOATS_PER_STAGE];
+        v[0] = (float)s.samples;
+        v[1] = s.cpuMin;
+        v[2] = s.cpuAvg;
+        v[3] = s.cpuP95;
+        v[4] = s.cpuP99;
+        v[5] = (float)s.gpuSamples;
+        v[6] = s.gpuMin;
+        v[7] = s.gpuAvg;
+        v[8] = s.gpuP95;
+        v[9] = s.gpuP99;
+    }
+    values[FRAME_STAGE_COUNT * STATS_FLOATS_PER_STAGE] = (float)dropped;
+
+    jsize length = FRAME_STAGE_COUNT * STATS_FLOATS_PER_STAGE + 1;
+    jfloatArray result = env->NewFloatArray(length);
+    if (result != nullptr) {
+        env->SetFloatArrayRegion(result, 0, length, values);
+    }
+    return result;
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_example_ndklearn2_FrameTiming_nativeSetEnabled(JNIEnv* env, jclass clazz, jboolean enabled) {
+    setFrameTimingEnabled(enabled == JNI_TRUE);
+}
+
+extern "C" JNIEXPORT jboolean JNICALL
+Java_com_example_ndklearn2_FrameTiming_nativeIsGpuSupported(JNIEnv* env, jclass clazz) {
+    return frameTimingGpuSupported() ? JNI_TRUE : JNI_FALSE;
+}
+
+#endif // __ANDROID__
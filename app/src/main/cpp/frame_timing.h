@@ -0,0 +1,65 @@
+//
+// Created by zhangx on 2026/10/16.
+// 分阶段帧耗时统计 - 每帧各阶段的 CPU 耗时和 GPU 耗时（GL_EXT_disjoint_timer_query）
+//
+
+#ifndef NDKLEARN2_FRAME_TIMING_H
+#define NDKLEARN2_FRAME_TIMING_H
+
+#include <stdint.h>
+
+// 帧内阶段，CULL 之前的阶段同时测 GPU 耗时
+enum FrameStage {
+    FRAME_STAGE_CLEAR = 0,
+    FRAME_STAGE_UNIFORMS,
+    FRAME_STAGE_TFB_UPDATE,
+    FRAME_STAGE_DRAW,
+    FRAME_STAGE_CULL,       // 只测 CPU：视锥剔除（见 frustum_culling.h）
+    FRAME_STAGE_SWAP,       // 只测 CPU：eglSwapBuffers 的阻塞时间
+    FRAME_STAGE_FRAME,      // 只测 CPU：从 frameTimingBeginFrame 到 frameTimingEndFrame
+    FRAME_STAGE_COUNT
+};
+
+const char* frameStageName(int stage);
+
+// 一个阶段的汇总，单位毫秒；没有 GPU 样本时 gpuSamples 为 0，gpu 各项为 -1
+struct FrameStageStats {
+    uint32_t samples;
+    float cpuMin, cpuAvg, cpuP95, cpuP99;
+    uint32_t gpuSamples;
+    float gpuMin, gpuAvg, gpuP95, gpuP99;
+};
+
+// 以下函数只在渲染线程调用
+// 新的 GL 上下文就绪后调用：检测计时扩展并创建查询对象，旧上下文未取回的 GPU 结果丢弃
+void frameTimingContextCreated();
+
+// 帧开始/结束；阶段只在帧内记录，同一帧内同一阶段多次出现时 CPU 耗时累加，GPU 只测第一次
+void frameTimingBeginFrame();
+void frameTimingEndFrame();
+void frameTimingBeginStage(FrameStage stage);
+void frameTimingEndStage(FrameStage stage);
+
+// 任意线程：开关统计（下一帧生效），默认开启
+void setFrameTimingEnabled(bool enabled);
+
+// 任意线程：当前上下文是否支持 GPU 计时
+bool frameTimingGpuSupported();
+
+// 任意线程：取出已完成帧的全部样本并按阶段汇总，返回上次取出以来因缓冲区满而丢弃的样本数
+// GPU 结果有几帧延迟，最近的几帧要到之后的帧结束时才进入缓冲区
+uint32_t drainFrameTiming(FrameStageStats stats[FRAME_STAGE_COUNT]);
+
+// 放在每帧入口函数开头，函数返回时（包括提前返回）结束这一帧
+struct FrameTimingFrameScope {
+    FrameTimingFrameScope() { frameTimingBeginFrame(); }
+    ~FrameTimingFrameScope() { frameTimingEndFrame(); }
+};
+
+struct FrameTimingStageScope {
+    explicit FrameTimingStageScope(FrameStage stage) : stage(stage) { frameTimingBeginStage(stage); }
+    ~FrameTimingStageScope() { frameTimingEndStage(stage); }
+    FrameStage stage;
+};
+
+#endif //NDKLEARN2_FRAME_TIMING_H
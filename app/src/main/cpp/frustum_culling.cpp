@@ -0,0 +1,757 @@
+//
+// Created by zhangx on 2026/10/16.
+// 视锥剔除实现
+//
+
+#include "frustum_culling.h"
+#include <algorithm>
+#include <cmath>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define CULL_SIMD_NEON
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define CULL_SIMD_SSE2
+#endif
+
+// 空位（补齐或还没设置）的半边长：对任何平面都在外侧
+static const float EMPTY_EXTENT = -1e30f;
+
+void extractFrustumPlanes(const float* m, FrustumPlanes* frustum) {
+    // Gribb-Hartmann：裁剪空间的 -w <= x <= w 等 6 个不等式换成矩阵的行组合，第 i 行为 (m[i], m[4+i], m[8+i], m[12+i])
+    for (int p = 0; p < 6; p++) {
+        int row = p / 2;
+        float sign = p % 2 == 0 ? 1.0f : -1.0f;
+        float* plane = frustum->planes[p];
+        for (int k = 0; k < 4; k++) {
+            plane[k] = m[k * 4 + 3] + sign * m[k * 4 + row];
+        }
+        float length = sqrtf(plane[0] * plane[0] + plane[1] * plane[1] + plane[2] * plane[2]);
+        if (length > 0.0f) {
+            for (int k = 0; k < 4; k++) {
+                plane[k] /= length;
+            }
+        }
+    }
+}
+
+static size_t paddedCount(size_t count) {
+    return (count + 3) & ~(size_t)3;
+}
+
+void resizeCullBounds(CullBounds* bounds, size_t count) {
+    size_t padded = paddedCount(count);
+    // 缩小时把不再使用的尾部标成空位，保证补齐的部分不可见
+    for (size_t i = count; i < std::min(bounds->count, padded); i++) {
+        bounds->centerX[i] = bounds->centerY[i] = bounds->centerZ[i] = 0.0f;
+        bounds->extentX[i] = bounds->extentY[i] = bounds->extentZ[i] = EMPTY_EXTENT;
+    }
+    bounds->centerX.resize(padded, 0.0f);
+    bounds->centerY.resize(padded, 0.0f);
+    bounds->centerZ.resize(padded, 0.0f);
+    bounds->extentX.resize(padded, EMPTY_EXTENT);
+    bounds->extentY.resize(padded, EMPTY_EXTENT);
+    bounds->extentZ.resize(padded, EMPTY_EXTENT);
+    bounds->count = count;
+}
+
+void setCullBounds(CullBounds* bounds, size_t index, const float* boundsMin, const float* boundsMax) {
+    bounds->centerX[index] = (boundsMin[0] + boundsMax[0]) * 0.5f;
+    bounds->centerY[index] = (boundsMin[1] + boundsMax[1]) * 0.5f;
+    bounds->centerZ[index] = (boundsMin[2] + boundsMax[2]) * 0.5f;
+    bounds->extentX[index] = (boundsMax[0] - boundsMin[0]) * 0.5f;
+    bounds->extentY[index] = (boundsMax[1] - boundsMin[1]) * 0.5f;
+    bounds->extentZ[index] = (boundsMax[2] - boundsMin[2]) * 0.5f;
+}
+
+void setCullBoundsTransformed(CullBounds* bounds, size_t index, const float* boundsMin, const float* boundsMax,
+                              const float* matrix) {
+    // Arvo：中心按矩阵变换，半边长乘以矩阵各元素的绝对值
+    float center[3];
+    float extent[3];
+    for (int i = 0; i < 3; i++) {
+        center[i] = (boundsMin[i] + boundsMax[i]) * 0.5f;
+        extent[i] = (boundsMax[i] - boundsMin[i]) * 0.5f;
+    }
+    float worldCenter[3];
+    float worldExtent[3];
+    for (int row = 0; row < 3; row++) {
+        worldCenter[row] = matrix[12 + row];
+        worldExtent[row] = 0.0f;
+        for (int column = 0; column < 3; column++) {
+            worldCenter[row] += matrix[column * 4 + row] * center[column];
+            worldExtent[row] += fabsf(matrix[column * 4 + row]) * extent[column];
+        }
+    }
+    bounds->centerX[index] = worldCenter[0];
+    bounds->centerY[index] = worldCenter[1];
+    bounds->centerZ[index] = worldCenter[2];
+    bounds->extentX[index] = worldExtent[0];
+    bounds->extentY[index] = worldExtent[1];
+    bounds->extentZ[index] = worldExtent[2];
+}
+
+void resizeCullSpheres(CullSpheres* spheres, size_t count) {
+    size_t padded = paddedCount(count);
+    for (size_t i = count; i < std::min(spheres->count, padded); i++) {
+        spheres->centerX[i] = spheres->centerY[i] = spheres->centerZ[i] = 0.0f;
+        spheres->radius[i] = EMPTY_EXTENT;
+    }
+    spheres->centerX.resize(padded, 0.0f);
+    spheres->centerY.resize(padded, 0.0f);
+    spheres->centerZ.resize(padded, 0.0f);
+    spheres->radius.resize(padded, EMPTY_EXTENT);
+    spheres->count = count;
+}
+
+void setCullSphere(CullSpheres* spheres, size_t index, const float* center, float radius) {
+    spheres->centerX[index] = center[0];
+    spheres->centerY[index] = center[1];
+    spheres->centerZ[index] = center[2];
+    spheres->radius[index] = radius;
+}
+
+// 4 个物体的可见位（第 k 位对应第 base + k 个）追加到 out，不分支：每个位置都写，只有可见时才前进
+static inline size_t appendVisible(uint32_t* out, size_t n, uint32_t base, uint32_t mask) {
+    for (uint32_t k = 0; k < 4; k++) {
+        out[n] = base + k;
+        n += (mask >> k) & 1;
+    }
+    return n;
+}
+
+size_t cullBoxesScalar(const FrustumPlanes& frustum, const CullBounds& bounds, std::vector<uint32_t>* visible) {
+    visible->clear();
+    for (size_t i = 0; i < bounds.count; i++) {
+        bool inside = true;
+        for (int p = 0; p < 6 && inside; p++) {
+            const float* plane = frustum.planes[p];
+            float distance = plane[0] * bounds.centerX[i] + plane[1] * bounds.centerY[i]
+                             + plane[2] * bounds.centerZ[i] + plane[3];
+            float radius = fabsf(plane[0]) * bounds.extentX[i] + fabsf(plane[1]) * bounds.extentY[i]
+                           + fabsf(plane[2]) * bounds.extentZ[i];
+            inside = distance + radius >= 0.0f;
+        }
+        if (inside) {
+            visible->push_back((uint32_t)i);
+        }
+    }
+    return visible->size();
+}
+
+#if defined(CULL_SIMD_NEON)
+
+static inline uint32_t laneMask(uint32x4_t outside) {
+    uint32_t lanes[4];
+    vst1q_u32(lanes, outside);
+    return (~lanes[0] & 1) | (~lanes[1] & 2) | (~lanes[2] & 4) | (~lanes[3] & 8);
+}
+
+size_t cullBoxes(const FrustumPlanes& frustum, const CullBounds& bounds, std::vector<uint32_t>* visible) {
+    size_t padded = bounds.centerX.size();
+    visible->resize(padded);
+    uint32_t* out = visible->data();
+    float32x4_t zero = vdupq_n_f32(0.0f);
+    size_t n = 0;
+    for (size_t i = 0; i < padded; i += 4) {
+        float32x4_t cx = vld1q_f32(&bounds.centerX[i]);
+        float32x4_t cy = vld1q_f32(&bounds.centerY[i]);
+        float32x4_t cz = vld1q_f32(&bounds.centerZ[i]);
+        float32x4_t ex = vld1q_f32(&bounds.extentX[i]);
+        float32x4_t ey = vld1q_f32(&bounds.extentY[i]);
+        float32x4_t ez = vld1q_f32(&bounds.extentZ[i]);
+        uint32x4_t outside = vdupq_n_u32(0);
+        for (int p = 0; p < 6; p++) {
+            const float* plane = frustum.planes[p];
+            // distance + radius = n.c + d + |n|.e
+            float32x4_t sum = vdupq_n_f32(plane[3]);
+            sum = vmlaq_n_f32(sum, cx, plane[0]);
+            sum = vmlaq_n_f32(sum, cy, plane[1]);
+            sum = vmlaq_n_f32(sum, cz, plane[2]);
+            sum = vmlaq_n_f32(sum, ex, fabsf(plane[0]));
+            sum = vmlaq_n_f32(sum, ey, fabsf(plane[1]));
+            sum = vmlaq_n_f32(sum, ez, fabsf(plane[2]));
+            outside = vorrq_u32(outside, vcltq_f32(sum, zero));
+        }
+        n = appendVisible(out, n, (uint32_t)i, laneMask(outside));
+    }
+    visible->resize(n);
+    return n;
+}
+
+size_t cullSpheres(const FrustumPlanes& frustum, const CullSpheres& spheres, std::vector<uint32_t>* visible) {
+    size_t padded = spheres.centerX.size();
+    visible->resize(padded);
+    uint32_t* out = visible->data();
+    size_t n = 0;
+    for (size_t i = 0; i < padded; i += 4) {
+        float32x4_t cx = vld1q_f32(&spheres.centerX[i]);
+        float32x4_t cy = vld1q_f32(&spheres.centerY[i]);
+        float32x4_t cz = vld1q_f32(&spheres.centerZ[i]);
+        float32x4_t negRadius = vnegq_f32(vld1q_f32(&spheres.radius[i]));
+        uint32x4_t outside = vdupq_n_u32(0);
+        for (int p = 0; p < 6; p++) {
+            const float* plane = frustum.planes[p];
+            float32x4_t distance = vdupq_n_f32(plane[3]);
+            distance = vmlaq_n_f32(distance, cx, plane[0]);
+            distance = vmlaq_n_f32(distance, cy, plane[1]);
+            distance = vmlaq_n_f32(distance, cz, plane[2]);
+            outside = vorrq_u32(outside, vcltq_f32(distance, negRadius));
+        }
+        n = appendVisible(out, n, (uint32_t)i, laneMask(outside));
+    }
+    visible->resize(n);
+    return n;
+}
+
+#elif defined(CULL_SIMD_SSE2)
+
+size_t cullBoxes(const FrustumPlanes& frustum, const CullBounds& bounds, std::vector<uint32_t>* visible) {
+    size_t padded = bounds.centerX.size();
+    visible->resize(padded);
+    uint32_t* out = visible->data();
+    // 平面系数在循环外展开成向量
+    __m128 a[6], b[6], c[6], d[6], absA[6], absB[6], absC[6];
+    for (int p = 0; p < 6; p++) {
+        const float* plane = frustum.planes[p];
+        a[p] = _mm_set1_ps(plane[0]);
+        b[p] = _mm_set1_ps(plane[1]);
+        c[p] = _mm_set1_ps(plane[2]);
+        d[p] = _mm_set1_ps(plane[3]);
+        absA[p] = _mm_set1_ps(fabsf(plane[0]));
+        absB[p] = _mm_set1_ps(fabsf(plane[1]));
+        absC[p] = _mm_set1_ps(fabsf(plane[2]));
+    }
+    __m128 zero = _mm_setzero_ps();
+    size_t n = 0;
+    for (size_t i = 0; i < padded; i += 4) {
+        __m128 cx = _mm_loadu_ps(&bounds.centerX[i]);
+        __m128 cy = _mm_loadu_ps(&bounds.centerY[i]);
+        __m128 cz = _mm_loadu_ps(&bounds.centerZ[i]);
+        __m128 ex = _mm_loadu_ps(&bounds.extentX[i]);
+        __m128 ey = _mm_loadu_ps(&bounds.extentY[i]);
+        __m128 ez = _mm_loadu_ps(&bounds.extentZ[i]);
+        __m128 outside = zero;
+        for (int p = 0; p < 6; p++) {
+            __m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(a[p], cx), _mm_mul_ps(b[p], cy)),
+                                         _mm_add_ps(_mm_mul_ps(c[p], cz), d[p]));
+            __m128 radius = _mm_add_ps(_mm_add_ps(_mm_mul_ps(absA[p], ex), _mm_mul_ps(absB[p], ey)),
+                                       _mm_mul_ps(absC[p], ez));
+            outside = _mm_or_ps(outside, _mm_cmplt_ps(_mm_add_ps(distance, radius), zero));
+        }
+        n = appendVisible(out, n, (uint32_t)i, (uint32_t)(~_mm_movemask_ps(outside) & 0xF));
+    }
+    visible->resize(n);
+    return n;
+}
+
+size_t cullSpheres(const FrustumPlanes& frustum, const CullSpheres& spheres, std::vector<uint32_t>* visible) {
+    size_t padded = spheres.centerX.size();
+    visible->resize(padded);
+    uint32_t* out = visible->data();
+    __m128 a[6], b[6], c[6], d[6];
+    for (int p = 0; p < 6; p++) {
+        const float* plane = frustum.planes[p];
+        a[p] = _mm_set1_ps(plane[0]);
+        b[p] = _mm_set1_ps(plane[1]);
+        c[p] = _mm_set1_ps(plane[2]);
+        d[p] = _mm_set1_ps(plane[3]);
+    }
+    __m128 zero = _mm_setzero_ps();
+    size_t n = 0;
+    for (size_t i = 0; i < padded; i += 4) {
+        __m128 cx = _mm_loadu_ps(&spheres.centerX[i]);
+        __m128 cy = _mm_loadu_ps(&spheres.centerY[i]);
+        __m128 cz = _mm_loadu_ps(&spheres.centerZ[i]);
+        __m128 negRadius = _mm_sub_ps(zero, _mm_loadu_ps(&spheres.radius[i]));
+        __m128 outside = zero;
+        for (int p = 0; p < 6; p++) {
+            __m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(a[p], cx), _mm_mul_ps(b[p], cy)),
+                                         _mm_add_ps(_mm_mul_ps(c[p], cz), d[p]));
+            outside = _mm_or_ps(outside, _mm_cmplt_ps(distance, negRadius));
+        }
+        n = appendVisible(out, n, (uint32_t)i, (uint32_t)(~_mm_movemask_ps(outside) & 0xF));
+    }
+    visible->resize(n);
+    return n;
+}
+
+#else
+
+size_t cullBoxes(const FrustumPlanes& frustum, const CullBounds& bounds, std::vector<uint32_t>* visible) {
+    return cullBoxesScalar(frustum, bounds, visible);
+}
+
+size_t cullSpheres(const FrustumPlanes& frustum, const CullSpheres& spheres, std::vector<uint32_t>* visible) {
+    visible->clear();
+    for (size_t i = 0; i < spheres.count; i++) {
+        bool inside = true;
+        for (int p = 0; p < 6 && inside; p++) {
+            const float* plane = frustum.planes[p];
+            float distance = plane[0] * spheres.centerX[i] + plane[1] * spheres.centerY[i]
+                             + plane[2] * spheres.centerZ[i] + plane[3];
+            inside = distance >= -spheres.radius[i];
+        }
+        if (inside) {
+            visible->push_back((uint32_t)i);
+        }
+    }
+    return visible->size();
+}
+
+#endif
+
+const char* frustumCullingSimdName() {
+#if defined(CULL_SIMD_NEON)
+    return "NEON";
+#elif defined(CULL_SIMD_SSE2)
+    return "SSE2";
+#else
+    return "none";
+#endif
+}
+
+// ==================== 动态 BVH ====================
+
+static const int32_t NULL_NODE = -1;
+
+struct CullTreeNode {
+    float boundsMin[3];
+    float boundsMax[3];
+    int32_t parent;      // 空闲节点中为空闲链表的下一个
+    int32_t child1;      // 叶子为 NULL_NODE
+    int32_t child2;
+    int32_t height;      // 叶子为 0，空闲节点为 -1
+    uint32_t userData;
+    CullProxy proxy;     // 叶子对应的句柄
+};
+
+struct CullTree {
+    std::vector<CullTreeNode> nodes;
+    int32_t root;
+    int32_t freeList;
+    float margin;
+    // 句柄经过一层映射到叶子节点，重建时节点下标改变，句柄不变
+    std::vector<int32_t> proxyNodes;   // 句柄 - 1 -> 叶子节点，空闲句柄为 NULL_NODE
+    std::vector<CullProxy> freeProxies;
+    uint32_t proxies;
+    uint32_t reinserts;
+    uint32_t rebuilds;
+    mutable std::vector<int32_t> stack;  // 查询用，避免每次分配
+};
+
+static bool isLeaf(const CullTreeNode& node) {
+    return node.child1 == NULL_NODE;
+}
+
+// 表面积的一半，插入代价只比较相对大小
+static float halfArea(const float* boundsMin, const float* boundsMax) {
+    float dx = boundsMax[0] - boundsMin[0];
+    float dy = boundsMax[1] - boundsMin[1];
+    float dz = boundsMax[2] - boundsMin[2];
+    return dx * dy + dy * dz + dz * dx;
+}
+
+static float unionArea(const CullTreeNode& a, const CullTreeNode& b) {
+    float boundsMin[3];
+    float boundsMax[3];
+    for (int i = 0; i < 3; i++) {
+        boundsMin[i] = std::min(a.boundsMin[i], b.boundsMin[i]);
+        boundsMax[i] = std::max(a.boundsMax[i], b.boundsMax[i]);
+    }
+    return halfArea(boundsMin, boundsMax);
+}
+
+// 节点的包围盒和高度按两个子节点重新计算
+static void refitNode(CullTree* tree, int32_t index) {
+    CullTreeNode& node = tree->nodes[index];
+    const CullTreeNode& child1 = tree->nodes[node.child1];
+    const CullTreeNode& child2 = tree->nodes[node.child2];
+    for (int i = 0; i < 3; i++) {
+        node.boundsMin[i] = std::min(child1.boundsMin[i], child2.boundsMin[i]);
+        node.boundsMax[i] = std::max(child1.boundsMax[i], child2.boundsMax[i]);
+    }
+    node.height = 1 + std::max(child1.height, child2.height);
+}
+
+static int32_t allocateNode(CullTree* tree) {
+    if (tree->freeList == NULL_NODE) {
+        CullTreeNode node;
+        node.height = -1;
+        node.parent = NULL_NODE;
+        tree->nodes.push_back(node);
+        tree->freeList = (int32_t)tree->nodes.size() - 1;
+    }
+    int32_t index = tree->freeList;
+    CullTreeNode& node = tree->nodes[index];
+    tree->freeList = node.parent;
+    node.parent = NULL_NODE;
+    node.child1 = NULL_NODE;
+    node.child2 = NULL_NODE;
+    node.height = 0;
+    node.userData = 0;
+    node.proxy = 0;
+    return index;
+}
+
+static void freeNode(CullTree* tree, int32_t index) {
+    CullTreeNode& node = tree->nodes[index];
+    node.parent = tree->freeList;
+    node.height = -1;
+    tree->freeList = index;
+}
+
+static void replaceChild(CullTree* tree, int32_t parent, int32_t oldChild, int32_t newChild) {
+    if (parent == NULL_NODE) {
+        tree->root = newChild;
+    } else if (tree->nodes[parent].child1 == oldChild) {
+        tree->nodes[parent].child1 = newChild;
+    } else {
+        tree->nodes[parent].child2 = newChild;
+    }
+}
+
+// 两个子树高度差超过 1 时把较高的子节点旋转上来，返回这个位置上新的节点
+static int32_t balance(CullTree* tree, int32_t iA) {
+    std::vector<CullTreeNode>& nodes = tree->nodes;
+    if (isLeaf(nodes[iA]) || nodes[iA].height < 2) {
+        return iA;
+    }
+    int32_t iB = nodes[iA].child1;
+    int32_t iC = nodes[iA].child2;
+    int32_t difference = nodes[iC].height - nodes[iB].height;
+    if (difference > 1) {
+        // C 上移，A 成为 C 的子节点，C 较矮的子节点交给 A
+        int32_t iF = nodes[iC].child1;
+        int32_t iG = nodes[iC].child2;
+        nodes[iC].child1 = iA;
+        nodes[iC].parent = nodes[iA].parent;
+        nodes[iA].parent = iC;
+        replaceChild(tree, nodes[iC].parent, iA, iC);
+        int32_t taller = nodes[iF].height > nodes[iG].height ? iF : iG;
+        int32_t shorter = taller == iF ? iG : iF;
+        nodes[iC].child2 = taller;
+        nodes[iA].child2 = shorter;
+        nodes[shorter].parent = iA;
+        refitNode(tree, iA);
+        refitNode(tree, iC);
+        return iC;
+    }
+    if (difference < -1) {
+        // B 上移，对称
+        int32_t iD = nodes[iB].child1;
+        int32_t iE = nodes[iB].child2;
+        nodes[iB].child1 = iA;
+        nodes[iB].parent = nodes[iA].parent;
+        nodes[iA].parent = iB;
+        replaceChild(tree, nodes[iB].parent, iA, iB);
+        int32_t taller = nodes[iD].height > nodes[iE].height ? iD : iE;
+        int32_t shorter = taller == iD ? iE : iD;
+        nodes[iB].child2 = taller;
+        nodes[iA].child1 = shorter;
+        nodes[shorter].parent = iA;
+        refitNode(tree, iA);
+        refitNode(tree, iB);
+        return iB;
+    }
+    return iA;
+}
+
+// 从 index 向上重新计算包围盒和高度，沿途做平衡
+static void refitAncestors(CullTree* tree, int32_t index) {
+    while (index != NULL_NODE) {
+        index = balance(tree, index);
+        refitNode(tree, index);
+        index = tree->nodes[index].parent;
+    }
+}
+
+static void insertLeaf(CullTree* tree, int32_t leaf) {
+    if (tree->root == NULL_NODE) {
+        tree->root = leaf;
+        tree->nodes[leaf].parent = NULL_NODE;
+        return;
+    }
+    // 沿代价较小的一侧下降：在 index 处新建父节点的代价为合并后的面积，
+    // 下降到子节点时，index 及其祖先都要扩大（inheritance）
+    const CullTreeNode leafNode = tree->nodes[leaf];
+    int32_t index = tree->root;
+    while (!isLeaf(tree->nodes[index])) {
+        const CullTreeNode& node = tree->nodes[index];
+        float area = halfArea(node.boundsMin, node.boundsMax);
+        float combined = unionArea(node, leafNode);
+        float cost = 2.0f * combined;
+        float inheritance = 2.0f * (combined - area);
+        float childCost[2];
+        int32_t children[2] = {node.child1, node.child2};
+        for (int k = 0; k < 2; k++) {
+            const CullTreeNode& child = tree->nodes[children[k]];
+            float childCombined = unionArea(child, leafNode);
+            childCost[k] = (isLeaf(child) ? childCombined
+                                          : childCombined - halfArea(child.boundsMin, child.boundsMax))
+                           + inheritance;
+        }
+        if (cost < childCost[0] && cost < childCost[1]) {
+            break;
+        }
+        index = childCost[0] < childCost[1] ? children[0] : children[1];
+    }
+
+    int32_t sibling = index;
+    int32_t oldParent = tree->nodes[sibling].parent;
+    int32_t newParent = allocateNode(tree);
+    tree->nodes[newParent].parent = oldParent;
+    tree->nodes[newParent].child1 = sibling;
+    tree->nodes[newParent].child2 = leaf;
+    tree->nodes[sibling].parent = newParent;
+    tree->nodes[leaf].parent = newParent;
+    replaceChild(tree, oldParent, sibling, newParent);
+    refitAncestors(tree, newParent);
+}
+
+static void removeLeaf(CullTree* tree, int32_t leaf) {
+    if (leaf == tree->root) {
+        tree->root = NULL_NODE;
+        return;
+    }
+    int32_t parent = tree->nodes[leaf].parent;
+    int32_t grandParent = tree->nodes[parent].parent;
+    int32_t sibling = tree->nodes[parent].child1 == leaf ? tree->nodes[parent].child2 : tree->nodes[parent].child1;
+    // 兄弟节点顶替父节点的位置
+    replaceChild(tree, grandParent, parent, sibling);
+    tree->nodes[sibling].parent = grandParent;
+    freeNode(tree, parent);
+    refitAncestors(tree, grandParent);
+}
+
+static void setFatBounds(CullTree* tree, int32_t leaf, const float* boundsMin, const float* boundsMax) {
+    CullTreeNode& node = tree->nodes[leaf];
+    for (int i = 0; i < 3; i++) {
+        node.boundsMin[i] = boundsMin[i] - tree->margin;
+        node.boundsMax[i] = boundsMax[i] + tree->margin;
+    }
+}
+
+CullTree* createCullTree(float margin) {
+    CullTree* tree = new CullTree();
+    tree->root = NULL_NODE;
+    tree->freeList = NULL_NODE;
+    tree->margin = margin;
+    tree->proxies = 0;
+    tree->reinserts = 0;
+    tree->rebuilds = 0;
+    return tree;
+}
+
+void destroyCullTree(CullTree* tree) {
+    delete tree;
+}
+
+// 无效或已经移除的句柄返回 NULL_NODE
+static int32_t proxyLeaf(const CullTree* tree, CullProxy proxy) {
+    if (proxy == 0 || proxy > tree->proxyNodes.size()) {
+        return NULL_NODE;
+    }
+    return tree->proxyNodes[proxy - 1];
+}
+
+CullProxy cullTreeInsert(CullTree* tree, const float* boundsMin, const float* boundsMax, uint32_t userData) {
+    CullProxy proxy;
+    if (!tree->freeProxies.empty()) {
+        proxy = tree->freeProxies.back();
+        tree->freeProxies.pop_back();
+    } else {
+        tree->proxyNodes.push_back(NULL_NODE);
+        proxy = (CullProxy)tree->proxyNodes.size();
+    }
+    int32_t leaf = allocateNode(tree);
+    setFatBounds(tree, leaf, boundsMin, boundsMax);
+    tree->nodes[leaf].userData = userData;
+    tree->nodes[leaf].proxy = proxy;
+    tree->proxyNodes[proxy - 1] = leaf;
+    insertLeaf(tree, leaf);
+    tree->proxies++;
+    return proxy;
+}
+
+void cullTreeRemove(CullTree* tree, CullProxy proxy) {
+    int32_t leaf = proxyLeaf(tree, proxy);
+    if (leaf == NULL_NODE) {
+        return;
+    }
+    removeLeaf(tree, leaf);
+    freeNode(tree, leaf);
+    tree->proxyNodes[proxy - 1] = NULL_NODE;
+    tree->freeProxies.push_back(proxy);
+    tree->proxies--;
+}
+
+bool cullTreeUpdate(CullTree* tree, CullProxy proxy, const float* boundsMin, const float* boundsMax) {
+    int32_t leaf = proxyLeaf(tree, proxy);
+    if (leaf == NULL_NODE) {
+        return false;
+    }
+    const CullTreeNode& node = tree->nodes[leaf];
+    bool contained = true;
+    for (int i = 0; i < 3; i++) {
+        contained = contained && node.boundsMin[i] <= boundsMin[i] && boundsMax[i] <= node.boundsMax[i];
+    }
+    if (contained) {
+        return false;
+    }
+    removeLeaf(tree, leaf);
+    setFatBounds(tree, leaf, boundsMin, boundsMax);
+    insertLeaf(tree, leaf);
+    tree->reinserts++;
+    return true;
+}
+
+// 自顶向下重建 [first, last) 的叶子：按包围盒中心分布最长的轴在中位数处分开。
+// 节点按深度优先的先序写出，child1 紧跟在父节点之后，查询时访问的节点在内存中大多相邻
+static int32_t buildSubtree(CullTree* tree, std::vector<CullTreeNode>* leaves, size_t first, size_t last,
+                            int32_t parent) {
+    int32_t index = (int32_t)tree->nodes.size();
+    if (last - first == 1) {
+        CullTreeNode leaf = (*leaves)[first];
+        leaf.parent = parent;
+        tree->nodes.push_back(leaf);
+        tree->proxyNodes[leaf.proxy - 1] = index;
+        return index;
+    }
+    float centerMin[3];
+    float centerMax[3];
+    for (int i = 0; i < 3; i++) {
+        centerMin[i] = centerMax[i] = (*leaves)[first].boundsMin[i] + (*leaves)[first].boundsMax[i];
+    }
+    for (size_t n = first + 1; n < last; n++) {
+        for (int i = 0; i < 3; i++) {
+            float center = (*leaves)[n].boundsMin[i] + (*leaves)[n].boundsMax[i];
+            centerMin[i] = std::min(centerMin[i], center);
+            centerMax[i] = std::max(centerMax[i], center);
+        }
+    }
+    int axis = 0;
+    for (int i = 1; i < 3; i++) {
+        if (centerMax[i] - centerMin[i] > centerMax[axis] - centerMin[axis]) {
+            axis = i;
+        }
+    }
+    size_t middle = first + (last - first) / 2;
+    std::nth_element(leaves->begin() + first, leaves->begin() + middle, leaves->begin() + last,
+                     [axis](const CullTreeNode& a, const CullTreeNode& b) {
+                         return a.boundsMin[axis] + a.boundsMax[axis] < b.boundsMin[axis] + b.boundsMax[axis];
+                     });
+    CullTreeNode node;
+    node.parent = parent;
+    node.userData = 0;
+    node.proxy = 0;
+    tree->nodes.push_back(node);
+    int32_t child1 = buildSubtree(tree, leaves, first, middle, index);
+    int32_t child2 = buildSubtree(tree, leaves, middle, last, index);
+    tree->nodes[index].child1 = child1;
+    tree->nodes[index].child2 = child2;
+    refitNode(tree, index);
+    return index;
+}
+
+void rebuildCullTree(CullTree* tree) {
+    std::vector<CullTreeNode> leaves;
+    leaves.reserve(tree->proxies);
+    for (size_t p = 0; p < tree->proxyNodes.size(); p++) {
+        if (tree->proxyNodes[p] != NULL_NODE) {
+            leaves.push_back(tree->nodes[tree->proxyNodes[p]]);
+        }
+    }
+    tree->nodes.clear();
+    tree->freeList = NULL_NODE;
+    tree->root = NULL_NODE;
+    if (!leaves.empty()) {
+        tree->nodes.reserve(leaves.size() * 2 - 1);
+        tree->root = buildSubtree(tree, &leaves, 0, leaves.size(), NULL_NODE);
+    }
+    tree->rebuilds++;
+}
+
+// 子树中所有叶子都可见，不再测试
+static size_t appendSubtree(const CullTree* tree, int32_t index, std::vector<int32_t>* stack,
+                            std::vector<uint32_t>* visible) {
+    size_t base = stack->size();
+    size_t added = 0;
+    stack->push_back(index);
+    while (stack->size() > base) {
+        const CullTreeNode& node = tree->nodes[stack->back()];
+        stack->pop_back();
+        if (isLeaf(node)) {
+            visible->push_back(node.userData);
+            added++;
+        } else {
+            // child1 后入栈先访问，重建过的树中它紧跟在父节点之后
+            stack->push_back(node.child2);
+            stack->push_back(node.child1);
+        }
+    }
+    return added;
+}
+
+size_t cullTreeQuery(const CullTree* tree, const FrustumPlanes& frustum, std::vector<uint32_t>* visible) {
+    if (tree->root == NULL_NODE) {
+        return 0;
+    }
+    // 栈中每一项为节点下标和还需要测试的平面（位掩码），父节点已经完全在某个平面内侧时子节点不再测这个平面
+    std::vector<int32_t>& stack = tree->stack;
+    stack.clear();
+    stack.push_back(tree->root);
+    stack.push_back(0x3F);
+    size_t added = 0;
+    while (!stack.empty()) {
+        uint32_t mask = (uint32_t)stack.back();
+        stack.pop_back();
+        int32_t index = stack.back();
+        stack.pop_back();
+        const CullTreeNode& node = tree->nodes[index];
+        bool outside = false;
+        for (int p = 0; p < 6 && !outside; p++) {
+            if ((mask & (1u << p)) == 0) {
+                continue;
+            }
+            const float* plane = frustum.planes[p];
+            float distance = plane[3];
+            float radius = 0.0f;
+            for (int i = 0; i < 3; i++) {
+                float center = (node.boundsMin[i] + node.boundsMax[i]) * 0.5f;
+                float extent = (node.boundsMax[i] - node.boundsMin[i]) * 0.5f;
+                distance += plane[i] * center;
+                radius += fabsf(plane[i]) * extent;
+            }
+            if (distance + radius < 0.0f) {
+                outside = true;
+            } else if (distance - radius >= 0.0f) {
+                mask &= ~(1u << p);
+            }
+        }
+        if (outside) {
+            continue;
+        }
+        if (mask == 0) {
+            added += appendSubtree(tree, index, &stack, visible);
+        } else if (isLeaf(node)) {
+            visible->push_back(node.userData);
+            added++;
+        } else {
+            stack.push_back(node.child2);
+            stack.push_back((int32_t)mask);
+            stack.push_back(node.child1);
+            stack.push_back((int32_t)mask);
+        }
+    }
+    return added;
+}
+
+void getCullTreeStats(const CullTree* tree, CullTreeStats* stats) {
+    stats->proxies = tree->proxies;
+    stats->nodes = tree->proxies > 0 ? tree->proxies * 2 - 1 : 0;
+    stats->height = tree->root != NULL_NODE ? tree->nodes[tree->root].height : 0;
+    stats->reinserts = tree->reinserts;
+    stats->rebuilds = tree->rebuilds;
+}
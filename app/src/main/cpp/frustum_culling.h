@@ -0,0 +1,93 @@
+//
+// Created by zhangx on 2026/10/16.
+// 视锥剔除 - 从视图投影矩阵提取 6 个平面，测试包围盒 / 包围球，输出紧凑的可见索引列表
+//
+// 两种组织方式：
+//   平铺列表：包围盒按分量分开存放（SoA），NEON / SSE2 一次测 4 个物体，适合每帧都在移动的物体；
+//   动态 BVH：插入时按表面积代价选兄弟节点并做 AVL 旋转保持平衡，叶子的包围盒放大一圈，
+//   小幅移动不改树。查询时记录已经完全在内侧的平面，整棵子树都在视锥内时不再逐个测试。
+//   逐个插入的树节点在内存中的顺序是随机的，大量物体插入完（例如加载场景后）调用一次重建，
+//   按深度优先顺序重新排列节点，查询快得多。
+// 两种方式的结果都是保守的：与视锥相交或在内侧的都算可见，视锥角落外的少量物体也会算可见。
+// 不依赖 GL，可以在任意线程使用（同一个对象不能同时在多个线程修改）
+//
+
+#ifndef NDKLEARN2_FRUSTUM_CULLING_H
+#define NDKLEARN2_FRUSTUM_CULLING_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+// 平面 (a, b, c, d)：a*x + b*y + c*z + d >= 0 为内侧，法线已归一化
+// 顺序为左、右、下、上、近、远
+struct FrustumPlanes {
+    float planes[6][4];
+};
+
+// 列主序的 4x4 矩阵（GL 约定，裁剪空间 -w <= x, y, z <= w）。传入 proj * view 得到世界空间的平面，
+// 传入 proj * view * model 得到模型空间的平面
+void extractFrustumPlanes(const float* viewProj, FrustumPlanes* frustum);
+
+// SoA 包围盒：中心和半边长，数组长度向上补到 4 的倍数，补齐的部分永远不可见
+struct CullBounds {
+    size_t count;
+    std::vector<float> centerX, centerY, centerZ;
+    std::vector<float> extentX, extentY, extentZ;
+};
+
+// SoA 包围球，补齐方式同上
+struct CullSpheres {
+    size_t count;
+    std::vector<float> centerX, centerY, centerZ;
+    std::vector<float> radius;
+};
+
+// 改变数量，保留前面已有的包围盒，新增的为空（不可见）
+void resizeCullBounds(CullBounds* bounds, size_t count);
+void setCullBounds(CullBounds* bounds, size_t index, const float* boundsMin, const float* boundsMax);
+// boundsMin / boundsMax 为局部包围盒，matrix 为列主序的仿射变换，写入变换后的轴对齐包围盒
+void setCullBoundsTransformed(CullBounds* bounds, size_t index, const float* boundsMin, const float* boundsMax,
+                              const float* matrix);
+
+void resizeCullSpheres(CullSpheres* spheres, size_t count);
+void setCullSphere(CullSpheres* spheres, size_t index, const float* center, float radius);
+
+// 可见物体的下标按升序写到 visible（先清空），返回可见数
+size_t cullBoxes(const FrustumPlanes& frustum, const CullBounds& bounds, std::vector<uint32_t>* visible);
+size_t cullSpheres(const FrustumPlanes& frustum, const CullSpheres& spheres, std::vector<uint32_t>* visible);
+// 逐个物体的标量实现，结果与上面相同，供基准测试对照
+size_t cullBoxesScalar(const FrustumPlanes& frustum, const CullBounds& bounds, std::vector<uint32_t>* visible);
+
+// 编译进来的 SIMD 实现："NEON"、"SSE2" 或 "none"
+const char* frustumCullingSimdName();
+
+// 动态 BVH
+struct CullTree;
+
+// 0 为无效句柄
+typedef uint32_t CullProxy;
+
+struct CullTreeStats {
+    uint32_t proxies;
+    uint32_t nodes;          // 含内部节点
+    int height;              // 只有根节点时为 0
+    uint32_t reinserts;      // 累计因移出放大的包围盒而重新插入的次数
+    uint32_t rebuilds;
+};
+
+// margin 为叶子包围盒每边放大的距离，与物体每帧的移动量同一量级
+CullTree* createCullTree(float margin);
+void destroyCullTree(CullTree* tree);
+// userData 在查询时输出
+CullProxy cullTreeInsert(CullTree* tree, const float* boundsMin, const float* boundsMax, uint32_t userData);
+void cullTreeRemove(CullTree* tree, CullProxy proxy);
+// 新包围盒仍在放大后的包围盒内时不改树，返回 false；否则重新插入，返回 true
+bool cullTreeUpdate(CullTree* tree, CullProxy proxy, const float* boundsMin, const float* boundsMax);
+// 按当前的叶子自顶向下重建整棵树（中位数划分，节点按深度优先顺序存放），句柄保持有效
+void rebuildCullTree(CullTree* tree);
+// 可见叶子的 userData 追加到 visible（不清空，顺序不定），返回追加的个数
+size_t cullTreeQuery(const CullTree* tree, const FrustumPlanes& frustum, std::vector<uint32_t>* visible);
+void getCullTreeStats(const CullTree* tree, CullTreeStats* stats);
+
+#endif //NDKLEARN2_FRUSTUM_CULLING_H
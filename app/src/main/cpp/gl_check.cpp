@@ -0,0 +1,192 @@
+//
+// Created by zhangx on 2026/10/16.
+// GL 错误检查策略实现
+//
+// 这里的 GL 调用直接发给驱动，不经过 gl_trace.h 的录制包装，也不出现在基准测试的调用计数里
+//
+
+#include "gl_check.h"
+
+#ifdef NDKLEARN2_GL_CHECKS
+
+#include <GLES3/gl3.h>
+#include <GLES2/gl2ext.h>
+#include <EGL/egl.h>
+#include <android/log.h>
+#include <atomic>
+#include <cstring>
+#include <string>
+
+#define LOG_TAG "GLCheck"
+#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
+#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
+
+static const int MAX_ERRORS_PER_CHECK = 8;  // glGetError 每次只返回一个错误标志
+
+static std::atomic<int> gRequestedMode(GL_CHECK_MODE_AUTO);
+static std::atomic<int> gActiveMode(GL_CHECK_MODE_SYNC);  // 第一个上下文创建前按同步检查
+static std::atomic<bool> gSampling(true);                 // SAMPLED 模式下本帧是否检查
+
+// 以下状态只在渲染线程访问
+static struct {
+    PFNGLDEBUGMESSAGECALLBACKKHRPROC debugMessageCallback;
+    PFNGLDEBUGMESSAGECONTROLKHRPROC debugMessageControl;
+    bool debugOutputSupported;
+    bool debugOutputEnabled;
+    int appliedRequest;
+    uint32_t frame;
+} gCheck = {nullptr, nullptr, false, false, -1, 0};
+
+// DEBUG_OUTPUT 模式：同步回调在出错的调用内部触发，先记下来，由下一个 GL_CHECK 归属到调用位置
+static thread_local std::string tPendingMessage;
+static thread_local int tPendingCount = 0;
+
+static const char* glErrorName(GLenum error) {
+    switch (error) {
+        case GL_INVALID_ENUM: return "GL_INVALID_ENUM";
+        case GL_INVALID_VALUE: return "GL_INVALID_VALUE";
+        case GL_INVALID_OPERATION: return "GL_INVALID_OPERATION";
+        case GL_INVALID_FRAMEBUFFER_OPERATION: return "GL_INVALID_FRAMEBUFFER_OPERATION";
+        case GL_OUT_OF_MEMORY: return "GL_OUT_OF_MEMORY";
+        default: return "unknown";
+    }
+}
+
+static const char* baseName(const char* file) {
+    const char* slash = strrchr(file, '/');
+    return slash != nullptr ? slash + 1 : file;
+}
+
+static void GL_APIENTRY debugMessageCallback(GLenum source, GLenum type, GLuint id, GLenum severity,
+                                             GLsizei length, const GLchar* message, const void* userParam) {
+    if (tPendingCount++ == 0) {
+        tPendingMessage = message;
+    }
+}
+
+static void reportPending(const char* where) {
+    LOGE("GL error %s: %s%s", where, tPendingMessage.c_str(),
+         tPendingCount > 1 ? " (and more errors)" : "");
+    tPendingCount = 0;
+    tPendingMessage.clear();
+}
+
+// 取出全部错误标志，返回是否有错误
+static bool drainErrors(const char* tag, const char* operation, const char* file, int line) {
+    bool found = false;
+    for (int i = 0; i < MAX_ERRORS_PER_CHECK; i++) {
+        GLenum error = glGetError();
+        if (error == GL_NO_ERROR) {
+            break;
+        }
+        found = true;
+        if (file != nullptr) {
+            LOGE("[%s] %s failed with %s (0x%x) at %s:%d", tag, operation, glErrorName(error), error,
+                 baseName(file), line);
+        } else {
+            LOGE("[%s] %s: %s (0x%x)", tag, operation, glErrorName(error), error);
+        }
+    }
+    return found;
+}
+
+static void setDebugOutput(bool enabled) {
+    if (enabled == gCheck.debugOutputEnabled) {
+        return;
+    }
+    if (enabled) {
+        // 只要错误类消息；同步输出让回调在出错的调用里触发，位置归属才准确
+        gCheck.debugMessageControl(GL_DONT_CARE, GL_DONT_CARE, GL_DONT_CARE, 0, nullptr, GL_FALSE);
+        gCheck.debugMessageControl(GL_DONT_CARE, GL_DEBUG_TYPE_ERROR_KHR, GL_DONT_CARE, 0, nullptr, GL_TRUE);
+        gCheck.debugMessageCallback(debugMessageCallback, nullptr);
+        glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS_KHR);
+        glEnable(GL_DEBUG_OUTPUT_KHR);
+    } else {
+        glDisable(GL_DEBUG_OUTPUT_KHR);
+        glDisable(GL_DEBUG_OUTPUT_SYNCHRONOUS_KHR);
+    }
+    gCheck.debugOutputEnabled = enabled;
+}
+
+static void applyRequestedMode() {
+    int requested = gRequestedMode.load(std::memory_order_relaxed);
+    int mode = requested;
+    if (mode == GL_CHECK_MODE_AUTO) {
+        mode = gCheck.debugOutputSupported ? GL_CHECK_MODE_DEBUG_OUTPUT : GL_CHECK_MODE_SAMPLED;
+    } else if (mode == GL_CHECK_MODE_DEBUG_OUTPUT && !gCheck.debugOutputSupported) {
+        LOGE("KHR_debug is not available, falling back to sampled glGetError");
+        mode = GL_CHECK_MODE_SAMPLED;
+    }
+    setDebugOutput(mode == GL_CHECK_MODE_DEBUG_OUTPUT);
+    gActiveMode.store(mode, std::memory_order_relaxed);
+    gCheck.appliedRequest = requested;
+}
+
+void setGLCheckMode(GLCheckMode mode) {
+    gRequestedMode.store(mode, std::memory_order_relaxed);
+}
+
+GLCheckMode glCheckActiveMode() {
+    return (GLCheckMode)gActiveMode.load(std::memory_order_relaxed);
+}
+
+void glCheckContextCreated() {
+    const char* extensions = (const char*)glGetString(GL_EXTENSIONS);
+    gCheck.debugOutputSupported = false;
+    gCheck.debugOutputEnabled = false;
+    if (extensions != nullptr && strstr(extensions, "GL_KHR_debug") != nullptr) {
+        gCheck.debugMessageCallback =
+                (PFNGLDEBUGMESSAGECALLBACKKHRPROC)eglGetProcAddress("glDebugMessageCallbackKHR");
+        gCheck.debugMessageControl =
+                (PFNGLDEBUGMESSAGECONTROLKHRPROC)eglGetProcAddress("glDebugMessageControlKHR");
+        gCheck.debugOutputSupported = gCheck.debugMessageCallback != nullptr && gCheck.debugMessageControl != nullptr;
+    }
+    tPendingCount = 0;
+    gCheck.frame = 0;
+    applyRequestedMode();
+    // 初始化阶段总是检查，第一帧结束后按模式抽样
+    gSampling.store(true, std::memory_order_relaxed);
+    LOGI("GL error checks: mode %d (KHR_debug %s)", gActiveMode.load(std::memory_order_relaxed),
+         gCheck.debugOutputSupported ? "available" : "not available");
+}
+
+void glCheckFrameEnd() {
+    if (tPendingCount > 0) {
+        reportPending("with no GL_CHECK after it in this frame");
+    }
+    gCheck.frame++;
+    if (gRequestedMode.load(std::memory_order_relaxed) != gCheck.appliedRequest) {
+        applyRequestedMode();
+    }
+    bool sampling = gActiveMode.load(std::memory_order_relaxed) == GL_CHECK_MODE_SAMPLED &&
+                    gCheck.frame % GL_CHECK_SAMPLE_INTERVAL == 0;
+    if (sampling) {
+        // 抽样帧开始前清掉未抽样帧留下的错误，避免记到本帧第一个检查点上
+        drainErrors(LOG_TAG, "unchecked calls in the previous frames", nullptr, 0);
+    }
+    gSampling.store(sampling, std::memory_order_relaxed);
+}
+
+void glCheckAt(const char* tag, const char* operation, const char* file, int line) {
+    switch (gActiveMode.load(std::memory_order_relaxed)) {
+        case GL_CHECK_MODE_DEBUG_OUTPUT:
+            if (tPendingCount > 0) {
+                std::string where = std::string("in [") + tag + "] " + operation + " at " + baseName(file) + ":" +
+                                    std::to_string(line);
+                reportPending(where.c_str());
+            }
+            break;
+        case GL_CHECK_MODE_SAMPLED:
+            if (gSampling.load(std::memory_order_relaxed)) {
+                drainErrors(tag, operation, file, line);
+            }
+            break;
+        case GL_CHECK_MODE_SYNC:
+            drainErrors(tag, operation, file, line);
+            break;
+        default:
+            break;
+    }
+}
+
+#endif // NDKLEARN2_GL_CHECKS
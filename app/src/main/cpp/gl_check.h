@@ -0,0 +1,59 @@
+//
+// Created by zhangx on 2026/10/16.
+// GL 错误检查策略 - 编译期可整体去掉，运行时按上下文能力选择 KHR_debug 回调或按帧抽样 glGetError
+//
+// glGetError 在分块渲染的 GPU 上可能让驱动刷新命令流，渲染路径里不要直接调用，改用 GL_CHECK：
+//   GL_CHECK(LOG_TAG, "glDrawArrays");
+// 没有定义 NDKLEARN2_GL_CHECKS 时（release 构建）GL_CHECK 和下面的函数全部为空。
+//
+
+#ifndef NDKLEARN2_GL_CHECK_H
+#define NDKLEARN2_GL_CHECK_H
+
+enum GLCheckMode {
+    GL_CHECK_MODE_AUTO = 0,       // 有 KHR_debug 用 DEBUG_OUTPUT，否则 SAMPLED
+    GL_CHECK_MODE_OFF,
+    GL_CHECK_MODE_DEBUG_OUTPUT,   // 驱动回调报告错误，GL_CHECK 只记录位置，不调用 glGetError
+    GL_CHECK_MODE_SAMPLED,        // 每 GL_CHECK_SAMPLE_INTERVAL 帧中的一帧在每个 GL_CHECK 调用 glGetError
+    GL_CHECK_MODE_SYNC            // 每个 GL_CHECK 都调用 glGetError，只用于定位问题
+};
+
+static const int GL_CHECK_SAMPLE_INTERVAL = 60;
+
+#ifdef NDKLEARN2_GL_CHECKS
+
+// 任意线程：请求切换模式，渲染线程在下一帧结束或下一个上下文创建时生效，默认 AUTO
+void setGLCheckMode(GLCheckMode mode);
+// 当前生效的模式（AUTO 已解析为具体模式）
+GLCheckMode glCheckActiveMode();
+
+// 渲染线程：新的 GL 上下文就绪后调用，初始化阶段（第一帧结束前）的检查总是生效
+void glCheckContextCreated();
+void glCheckFrameEnd();
+
+// 检查 operation 之后是否有错误，错误归属到 file:line
+void glCheckAt(const char* tag, const char* operation, const char* file, int line);
+
+#define GL_CHECK(tag, operation) glCheckAt(tag, operation, __FILE__, __LINE__)
+
+// 放在每帧入口函数开头，函数返回时（包括提前返回）结束这一帧
+struct GLCheckFrameScope {
+    ~GLCheckFrameScope() { glCheckFrameEnd(); }
+};
+
+#else
+
+inline void setGLCheckMode(GLCheckMode) {}
+inline GLCheckMode glCheckActiveMode() { return GL_CHECK_MODE_OFF; }
+inline void glCheckContextCreated() {}
+inline void glCheckFrameEnd() {}
+
+#define GL_CHECK(tag, operation) ((void)0)
+
+struct GLCheckFrameScope {
+    GLCheckFrameScope() {}
+};
+
+#endif // NDKLEARN2_GL_CHECKS
+
+#endif //NDKLEARN2_GL_CHECK_H
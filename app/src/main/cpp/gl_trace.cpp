@@ -0,0 +1,551 @@
+//
+// Created by zhangx on 2026/10/16.
+// GL 命令录制实现
+//
+
+#define NDKLEARN2_GL_TRACE_IMPL
+#include "gl_trace.h"
+#ifdef __ANDROID__
+#include <jni.h>
+#endif
+#include <android/log.h>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#define LOG_TAG "GLTrace"
+#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
+#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
+
+static std::mutex gRequestMutex;
+static std::string gPendingPath;
+static int gPendingFrames = 0;
+
+void glTraceRequest(const char* path, int frameCount) {
+#ifdef NDKLEARN2_GL_TRACE
+    if (path == nullptr || frameCount <= 0) {
+        LOGE("Invalid trace request");
+        return;
+    }
+    std::lock_guard<std::mutex> lock(gRequestMutex);
+    gPendingPath = path;
+    gPendingFrames = frameCount;
+    LOGI("GL trace requested: %d frames -> %s (starts with the next GL context)", frameCount, path);
+#else
+    (void)path;
+    (void)frameCount;
+    LOGE("GL trace support is not compiled in (NDKLEARN2_GL_TRACE is off)");
+#endif
+}
+
+#ifdef NDKLEARN2_GL_TRACE
+
+std::atomic<bool> gGLTraceActive(false);
+
+// 以下状态只在录制线程上访问
+static struct {
+    std::string path;
+    int targetFrames;
+    int frames;
+    uint32_t records;
+    std::vector<uint32_t> words;
+    bool counting;                        // 计数模式：只累加 counts，不保存记录
+    uint32_t counts[GL_TRACE_OP_COUNT];
+} gTrace;
+
+static const size_t INITIAL_TRACE_WORDS = 1u << 20;  // 4 MB，避免前几帧反复扩容
+
+// 只有录制线程会置位，其它线程读到的永远是 false
+static thread_local bool tRecordingThread = false;
+
+bool glTraceOnRecordingThread() {
+    return tRecordingThread;
+}
+
+void glTraceRecord(GLTraceOp op, const uint32_t* args, int argCount, const void* payload, size_t payloadSize) {
+    if (gTrace.counting) {
+        gTrace.counts[op]++;
+        return;
+    }
+    std::vector<uint32_t>& words = gTrace.words;
+    words.push_back((uint32_t)op | ((uint32_t)argCount << 16));
+    words.insert(words.end(), args, args + argCount);
+    if (glTraceOpHasPayload(op)) {
+        words.push_back((uint32_t)payloadSize);
+        size_t start = words.size();
+        words.resize(start + (payloadSize + 3) / 4, 0);
+        if (payloadSize > 0) {
+            memcpy(&words[start], payload, payloadSize);
+        }
+    }
+    gTrace.records++;
+}
+
+static void writeTrace() {
+    GLint viewport[4] = {0, 0, 0, 0};
+    glGetIntegerv(GL_VIEWPORT, viewport);
+
+    GLTraceFileHeader header;
+    header.magic = GL_TRACE_MAGIC;
+    header.version = GL_TRACE_VERSION;
+    header.width = (uint32_t)viewport[2];
+    header.height = (uint32_t)viewport[3];
+    header.frameCount = (uint32_t)gTrace.frames;
+    header.recordCount = gTrace.records;
+
+    FILE* file = fopen(gTrace.path.c_str(), "wb");
+    if (file == nullptr) {
+        LOGE("Failed to open trace file %s", gTrace.path.c_str());
+        return;
+    }
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1;
+    if (!gTrace.words.empty()) {
+        ok = ok && fwrite(gTrace.words.data(), sizeof(uint32_t), gTrace.words.size(), file) == gTrace.words.size();
+    }
+    fclose(file);
+    if (!ok) {
+        LOGE("Failed to write trace file %s", gTrace.path.c_str());
+        remove(gTrace.path.c_str());
+        return;
+    }
+    LOGI("GL trace written: %s (%d frames, %u records, %.1f KB, %dx%d)", gTrace.path.c_str(),
+         gTrace.frames, gTrace.records, gTrace.words.size() * 4 / 1024.0f, viewport[2], viewport[3]);
+}
+
+static void stopTrace() {
+    writeTrace();
+    gGLTraceActive.store(false, std::memory_order_relaxed);
+    tRecordingThread = false;
+    std::vector<uint32_t>().swap(gTrace.words);
+}
+
+bool glTraceCapturing() {
+    return glTraceRecording() && !gTrace.counting;
+}
+
+void glTraceContextCreated() {
+    // 上下文重建后旧对象全部失效，正在进行的录制到此为止
+    if (glTraceCapturing()) {
+        LOGI("GL context recreated while tracing, stopping early");
+        stopTrace();
+    }
+
+    std::lock_guard<std::mutex> lock(gRequestMutex);
+    if (gPendingPath.empty()) {
+        return;
+    }
+    gTrace.path = gPendingPath;
+    gTrace.targetFrames = gPendingFrames;
+    gTrace.frames = 0;
+    gTrace.records = 0;
+    gTrace.words.clear();
+    gTrace.words.reserve(INITIAL_TRACE_WORDS);
+    tRecordingThread = true;
+    gPendingPath.clear();
+    gGLTraceActive.store(true, std::memory_order_relaxed);
+    LOGI("GL trace started: %d frames -> %s", gTrace.targetFrames, gTrace.path.c_str());
+}
+
+void glTraceFrameEnd() {
+    if (!glTraceRecording()) {
+        return;
+    }
+    glTraceCall(GL_TRACE_FRAME_END);
+    if (gTrace.counting) {
+        return;
+    }
+    gTrace.frames++;
+    if (gTrace.frames >= gTrace.targetFrames) {
+        stopTrace();
+    }
+}
+
+bool glTraceBeginCounting() {
+    if (gGLTraceActive.load(std::memory_order_relaxed)) {
+        LOGE("GL trace is already active, counting not started");
+        return false;
+    }
+    memset(gTrace.counts, 0, sizeof(gTrace.counts));
+    gTrace.counting = true;
+    tRecordingThread = true;
+    gGLTraceActive.store(true, std::memory_order_relaxed);
+    return true;
+}
+
+void glTraceEndCounting(uint32_t* counts) {
+    if (glTraceRecording() && gTrace.counting) {
+        gGLTraceActive.store(false, std::memory_order_relaxed);
+        tRecordingThread = false;
+        gTrace.counting = false;
+        memcpy(counts, gTrace.counts, sizeof(gTrace.counts));
+    } else {
+        memset(counts, 0, sizeof(gTrace.counts));
+    }
+}
+
+// ==================== 需要额外数据的调用 ====================
+
+static void recordNames(GLTraceOp op, GLsizei n, const GLuint* names) {
+    const uint32_t args[] = {(uint32_t)n};
+    glTraceRecord(op, args, 1, names, n * sizeof(GLuint));
+}
+
+void traceGenBuffers(GLsizei n, GLuint* buffers) {
+    glGenBuffers(n, buffers);
+    if (glTraceRecording()) recordNames(GL_TRACE_GEN_BUFFERS, n, buffers);
+}
+
+void traceGenVertexArrays(GLsizei n, GLuint* arrays) {
+    glGenVertexArrays(n, arrays);
+    if (glTraceRecording()) recordNames(GL_TRACE_GEN_VERTEX_ARRAYS, n, arrays);
+}
+
+void traceGenTextures(GLsizei n, GLuint* textures) {
+    glGenTextures(n, textures);
+    if (glTraceRecording()) recordNames(GL_TRACE_GEN_TEXTURES, n, textures);
+}
+
+void traceGenFramebuffers(GLsizei n, GLuint* framebuffers) {
+    glGenFramebuffers(n, framebuffers);
+    if (glTraceRecording()) recordNames(GL_TRACE_GEN_FRAMEBUFFERS, n, framebuffers);
+}
+
+void traceGenRenderbuffers(GLsizei n, GLuint* renderbuffers) {
+    glGenRenderbuffers(n, renderbuffers);
+    if (glTraceRecording()) recordNames(GL_TRACE_GEN_RENDERBUFFERS, n, renderbuffers);
+}
+
+void traceDeleteBuffers(GLsizei n, const GLuint* buffers) {
+    glDeleteBuffers(n, buffers);
+    if (glTraceRecording()) recordNames(GL_TRACE_DELETE_BUFFERS, n, buffers);
+}
+
+void traceDeleteVertexArrays(GLsizei n, const GLuint* arrays) {
+    glDeleteVertexArrays(n, arrays);
+    if (glTraceRecording()) recordNames(GL_TRACE_DELETE_VERTEX_ARRAYS, n, arrays);
+}
+
+void traceDeleteTextures(GLsizei n, const GLuint* textures) {
+    glDeleteTextures(n, textures);
+    if (glTraceRecording()) recordNames(GL_TRACE_DELETE_TEXTURES, n, textures);
+}
+
+void traceDeleteFramebuffers(GLsizei n, const GLuint* framebuffers) {
+    glDeleteFramebuffers(n, framebuffers);
+    if (glTraceRecording()) recordNames(GL_TRACE_DELETE_FRAMEBUFFERS, n, framebuffers);
+}
+
+void traceDeleteRenderbuffers(GLsizei n, const GLuint* renderbuffers) {
+    glDeleteRenderbuffers(n, renderbuffers);
+    if (glTraceRecording()) recordNames(GL_TRACE_DELETE_RENDERBUFFERS, n, renderbuffers);
+}
+
+GLuint traceCreateShader(GLenum type) {
+    GLuint shader = glCreateShader(type);
+    if (glTraceRecording()) glTraceCall(GL_TRACE_CREATE_SHADER, type, shader);
+    return shader;
+}
+
+GLuint traceCreateProgram() {
+    GLuint program = glCreateProgram();
+    if (glTraceRecording()) glTraceCall(GL_TRACE_CREATE_PROGRAM, program);
+    return program;
+}
+
+// 多段源码拼接成一段录制
+void traceShaderSource(GLuint shader, GLsizei count, const GLchar* const* strings, const GLint* lengths) {
+    glShaderSource(shader, count, strings, lengths);
+    if (!glTraceRecording()) {
+        return;
+    }
+    std::string source;
+    for (GLsizei i = 0; i < count; i++) {
+        if (lengths != nullptr && lengths[i] >= 0) {
+            source.append(strings[i], lengths[i]);
+        } else {
+            source.append(strings[i]);
+        }
+    }
+    const uint32_t args[] = {shader};
+    glTraceRecord(GL_TRACE_SHADER_SOURCE, args, 1, source.c_str(), source.size() + 1);
+}
+
+void traceTransformFeedbackVaryings(GLuint program, GLsizei count, const GLchar* const* varyings, GLenum bufferMode) {
+    glTransformFeedbackVaryings(program, count, varyings, bufferMode);
+    if (!glTraceRecording()) {
+        return;
+    }
+    std::string names;
+    for (GLsizei i = 0; i < count; i++) {
+        names.append(varyings[i]);
+        names.push_back('\0');
+    }
+    const uint32_t args[] = {program, (uint32_t)count, bufferMode};
+    glTraceRecord(GL_TRACE_TRANSFORM_FEEDBACK_VARYINGS, args, 3, names.data(), names.size());
+}
+
+GLint traceGetUniformLocation(GLuint program, const GLchar* name) {
+    GLint location = glGetUniformLocation(program, name);
+    if (glTraceRecording()) {
+        const uint32_t args[] = {program, (uint32_t)location};
+        glTraceRecord(GL_TRACE_GET_UNIFORM_LOCATION, args, 2, name, strlen(name) + 1);
+    }
+    return location;
+}
+
+// 块索引因驱动而异，录制块名，回放时重新查询
+void traceUniformBlockBinding(GLuint program, GLuint blockIndex, GLuint binding) {
+    glUniformBlockBinding(program, blockIndex, binding);
+    if (!glTraceRecording()) {
+        return;
+    }
+    // 计数模式不需要块名，省掉两次查询
+    if (gTrace.counting) {
+        glTraceRecord(GL_TRACE_UNIFORM_BLOCK_BINDING, nullptr, 0, nullptr, 0);
+        return;
+    }
+    GLint length = 0;
+    glGetActiveUniformBlockiv(program, blockIndex, GL_UNIFORM_BLOCK_NAME_LENGTH, &length);
+    std::vector<char> name(length > 0 ? length : 1, '\0');
+    glGetActiveUniformBlockName(program, blockIndex, (GLsizei)name.size(), nullptr, name.data());
+    const uint32_t args[] = {program, binding};
+    glTraceRecord(GL_TRACE_UNIFORM_BLOCK_BINDING, args, 2, name.data(), strlen(name.data()) + 1);
+}
+
+void traceUniform3fv(GLint location, GLsizei count, const GLfloat* value) {
+    glUniform3fv(location, count, value);
+    if (glTraceRecording()) {
+        const uint32_t args[] = {(uint32_t)location, (uint32_t)count};
+        glTraceRecord(GL_TRACE_UNIFORM3FV, args, 2, value, count * 3 * sizeof(GLfloat));
+    }
+}
+
+void traceBufferData(GLenum target, GLsizeiptr size, const void* data, GLenum usage) {
+    glBufferData(target, size, data, usage);
+    if (glTraceRecording()) {
+        const uint32_t args[] = {target, (uint32_t)size, usage};
+        glTraceRecord(GL_TRACE_BUFFER_DATA, args, 3, data, data != nullptr ? (size_t)size : 0);
+    }
+}
+
+void traceBufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void* data) {
+    glBufferSubData(target, offset, size, data);
+    if (glTraceRecording()) {
+        const uint32_t args[] = {target, (uint32_t)offset, (uint32_t)size};
+        glTraceRecord(GL_TRACE_BUFFER_SUB_DATA, args, 3, data, (size_t)size);
+    }
+}
+
+// 录制线程上还没解除的映射，每个目标同时只能有一个
+struct TraceMapping {
+    GLenum target;
+    void* data;
+    GLsizeiptr length;
+    GLbitfield access;
+};
+static std::vector<TraceMapping> gTraceMappings;
+
+void* traceMapBufferRange(GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access) {
+    void* data = glMapBufferRange(target, offset, length, access);
+    if (glTraceRecording() && data != nullptr) {
+        const uint32_t args[] = {target, (uint32_t)offset, (uint32_t)length, access};
+        glTraceRecord(GL_TRACE_MAP_BUFFER_RANGE, args, 4, nullptr, 0);
+        TraceMapping mapping = {target, data, length, access};
+        gTraceMappings.push_back(mapping);
+    }
+    return data;
+}
+
+// 写映射的内容在这里作为数据录制，回放时写回同样映射的范围
+GLboolean traceUnmapBuffer(GLenum target) {
+    const void* payload = nullptr;
+    size_t payloadSize = 0;
+    bool mapped = false;
+    for (size_t i = 0; i < gTraceMappings.size(); i++) {
+        if (gTraceMappings[i].target == target) {
+            if ((gTraceMappings[i].access & GL_MAP_WRITE_BIT) != 0 && !gTrace.counting) {
+                payload = gTraceMappings[i].data;
+                payloadSize = (size_t)gTraceMappings[i].length;
+            }
+            mapped = true;
+            if (glTraceRecording()) {
+                const uint32_t args[] = {target};
+                glTraceRecord(GL_TRACE_UNMAP_BUFFER, args, 1, payload, payloadSize);
+            }
+            gTraceMappings.erase(gTraceMappings.begin() + i);
+            break;
+        }
+    }
+    if (!mapped && glTraceRecording()) {
+        const uint32_t args[] = {target};
+        glTraceRecord(GL_TRACE_UNMAP_BUFFER, args, 1, nullptr, 0);
+    }
+    return glUnmapBuffer(target);
+}
+
+// 每个像素的字节数，未知组合返回 0
+static size_t bytesPerPixel(GLenum format, GLenum type) {
+    switch (type) {
+        case GL_UNSIGNED_SHORT_5_6_5:
+        case GL_UNSIGNED_SHORT_4_4_4_4:
+        case GL_UNSIGNED_SHORT_5_5_5_1:
+            return 2;
+        case GL_UNSIGNED_INT_2_10_10_10_REV:
+        case GL_UNSIGNED_INT_10F_11F_11F_REV:
+        case GL_UNSIGNED_INT_5_9_9_9_REV:
+        case GL_UNSIGNED_INT_24_8:
+            return 4;
+        case GL_FLOAT_32_UNSIGNED_INT_24_8_REV:
+            return 8;
+        default:
+            break;
+    }
+
+    size_t components = 0;
+    switch (format) {
+        case GL_RED: case GL_RED_INTEGER: case GL_ALPHA: case GL_LUMINANCE: case GL_DEPTH_COMPONENT:
+            components = 1;
+            break;
+        case GL_RG: case GL_RG_INTEGER: case GL_LUMINANCE_ALPHA:
+            components = 2;
+            break;
+        case GL_RGB: case GL_RGB_INTEGER:
+            components = 3;
+            break;
+        case GL_RGBA: case GL_RGBA_INTEGER:
+            components = 4;
+            break;
+        default:
+            return 0;
+    }
+
+    switch (type) {
+        case GL_UNSIGNED_BYTE: case GL_BYTE:
+            return components;
+        case GL_UNSIGNED_SHORT: case GL_SHORT: case GL_HALF_FLOAT:
+            return components * 2;
+        case GL_UNSIGNED_INT: case GL_INT: case GL_FLOAT:
+            return components * 4;
+        default:
+            return 0;
+    }
+}
+
+// 按当前 UNPACK_ALIGNMENT 计算客户端像素数据大小（本项目不使用 UNPACK_ROW_LENGTH 等参数）
+static size_t pixelDataSize(GLsizei width, GLsizei height, GLenum format, GLenum type) {
+    size_t pixelBytes = bytesPerPixel(format, type);
+    if (pixelBytes == 0 || width <= 0 || height <= 0) {
+        return 0;
+    }
+    GLint alignment = 4;
+    glGetIntegerv(GL_UNPACK_ALIGNMENT, &alignment);
+    size_t rowBytes = width * pixelBytes;
+    size_t stride = (rowBytes + alignment - 1) / alignment * alignment;
+    return stride * (height - 1) + rowBytes;
+}
+
+// 像素来源：绑定了 PIXEL_UNPACK_BUFFER 时 pixels 是缓冲区偏移，数据已经在缓冲区的录制中
+static void recordPixels(GLTraceOp op, uint32_t* args, int argCount, GLsizei width, GLsizei height,
+                         GLenum format, GLenum type, const void* pixels) {
+    if (gTrace.counting) {
+        glTraceRecord(op, args, argCount, nullptr, 0);
+        return;
+    }
+    GLint unpackBuffer = 0;
+    glGetIntegerv(GL_PIXEL_UNPACK_BUFFER_BINDING, &unpackBuffer);
+    size_t size = 0;
+    if (unpackBuffer != 0) {
+        args[argCount - 2] = GL_TRACE_PIXELS_UNPACK_BUFFER;
+        args[argCount - 1] = (uint32_t)(uintptr_t)pixels;
+    } else if (pixels != nullptr) {
+        size = pixelDataSize(width, height, format, type);
+        args[argCount - 2] = size > 0 ? GL_TRACE_PIXELS_PAYLOAD : GL_TRACE_PIXELS_NONE;
+        args[argCount - 1] = 0;
+        if (size == 0) {
+            LOGE("Unsupported pixel format 0x%x/0x%x, upload recorded without data", format, type);
+        }
+    } else {
+        args[argCount - 2] = GL_TRACE_PIXELS_NONE;
+        args[argCount - 1] = 0;
+    }
+    glTraceRecord(op, args, argCount, size > 0 ? pixels : nullptr, size);
+}
+
+void traceTexImage2D(GLenum target, GLint level, GLint internalFormat, GLsizei width, GLsizei height,
+                     GLint border, GLenum format, GLenum type, const void* pixels) {
+    glTexImage2D(target, level, internalFormat, width, height, border, format, type, pixels);
+    if (glTraceRecording()) {
+        uint32_t args[] = {target, (uint32_t)level, (uint32_t)internalFormat, (uint32_t)width, (uint32_t)height,
+                           (uint32_t)border, format, type, 0, 0};
+        recordPixels(GL_TRACE_TEX_IMAGE_2D, args, 10, width, height, format, type, pixels);
+    }
+}
+
+void traceTexSubImage2D(GLenum target, GLint level, GLint x, GLint y, GLsizei width, GLsizei height,
+                        GLenum format, GLenum type, const void* pixels) {
+    glTexSubImage2D(target, level, x, y, width, height, format, type, pixels);
+    if (glTraceRecording()) {
+        uint32_t args[] = {target, (uint32_t)level, (uint32_t)x, (uint32_t)y, (uint32_t)width, (uint32_t)height,
+                           format, type, 0, 0};
+        recordPixels(GL_TRACE_TEX_SUB_IMAGE_2D, args, 10, width, height, format, type, pixels);
+    }
+}
+
+void traceTexSubImage3D(GLenum target, GLint level, GLint x, GLint y, GLint z, GLsizei width, GLsizei height,
+                        GLsizei depth, GLenum format, GLenum type, const void* pixels) {
+    glTexSubImage3D(target, level, x, y, z, width, height, depth, format, type, pixels);
+    if (glTraceRecording()) {
+        uint32_t args[] = {target, (uint32_t)level, (uint32_t)x, (uint32_t)y, (uint32_t)z, (uint32_t)width,
+                           (uint32_t)height, (uint32_t)depth, format, type, 0, 0};
+        // 各层紧密排列（GL_UNPACK_IMAGE_HEIGHT 为 0），数据量等于 width x (height * depth) 的二维图像
+        recordPixels(GL_TRACE_TEX_SUB_IMAGE_3D, args, 12, width, height * depth, format, type, pixels);
+    }
+}
+
+void traceCompressedTexSubImage2D(GLenum target, GLint level, GLint x, GLint y, GLsizei width, GLsizei height,
+                                  GLenum format, GLsizei imageSize, const void* data) {
+    glCompressedTexSubImage2D(target, level, x, y, width, height, format, imageSize, data);
+    if (!glTraceRecording()) {
+        return;
+    }
+    uint32_t args[] = {target, (uint32_t)level, (uint32_t)x, (uint32_t)y, (uint32_t)width, (uint32_t)height,
+                       format, (uint32_t)imageSize, GL_TRACE_PIXELS_NONE, 0};
+    if (gTrace.counting) {
+        glTraceRecord(GL_TRACE_COMPRESSED_TEX_SUB_IMAGE_2D, args, 10, nullptr, 0);
+        return;
+    }
+    // 压缩数据的大小由调用方给出，来源的处理与 recordPixels 相同
+    GLint unpackBuffer = 0;
+    glGetIntegerv(GL_PIXEL_UNPACK_BUFFER_BINDING, &unpackBuffer);
+    if (unpackBuffer != 0) {
+        args[8] = GL_TRACE_PIXELS_UNPACK_BUFFER;
+        args[9] = (uint32_t)(uintptr_t)data;
+        glTraceRecord(GL_TRACE_COMPRESSED_TEX_SUB_IMAGE_2D, args, 10, nullptr, 0);
+    } else {
+        args[8] = GL_TRACE_PIXELS_PAYLOAD;
+        glTraceRecord(GL_TRACE_COMPRESSED_TEX_SUB_IMAGE_2D, args, 10, data, (size_t)imageSize);
+    }
+}
+
+#endif // NDKLEARN2_GL_TRACE
+
+#ifdef __ANDROID__
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_example_ndklearn2_GLTrace_nativeRequest(JNIEnv* env, jclass clazz, jstring path, jint frameCount) {
+    const char* pathChars = env->GetStringUTFChars(path, nullptr);
+    glTraceRequest(pathChars, frameCount);
+    env->ReleaseStringUTFChars(path, pathChars);
+}
+
+extern "C" JNIEXPORT jboolean JNICALL
+Java_com_example_ndklearn2_GLTrace_nativeIsRecording(JNIEnv* env, jclass clazz) {
+#ifdef NDKLEARN2_GL_TRACE
+    return gGLTraceActive.load(std::memory_order_relaxed) ? JNI_TRUE : JNI_FALSE;
+#else
+    return JNI_FALSE;
+#endif
+}
+
+#endif // __ANDROID__
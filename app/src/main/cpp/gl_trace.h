@@ -0,0 +1,427 @@
+//
+// Created by zhangx on 2026/10/16.
+// GL 命令录制 - 把渲染线程的 GL 调用流（含缓冲区和纹理数据）录制成二进制文件，用 gl_trace_replay 离线回放
+//
+// 用法：在所有调用 GL 的源文件中，在其它头文件之后包含本文件。
+// 开启 NDKLEARN2_GL_TRACE 编译开关时，本文件把用到的 glXxx 重定向到同名的 traceXxx 包装：
+// 先调用真正的 GL 函数，只有在录制线程上录制时才追加记录，不录制时每次调用只多一次原子读和分支。
+// 新增 GL 调用时需要在这里补上包装，否则回放会缺少这个调用。
+//
+// 录制从上下文创建开始（渲染器 init 调用 glTraceContextCreated），保证回放时所有对象都有创建记录；
+// 录制期间程序二进制缓存和异步编译被绕过，着色器在渲染线程上同步编译，以便录下完整的编译链接过程。
+//
+// 计数模式（glTraceBeginCounting）复用同一套包装，但不保存记录，只按操作码统计调用次数，
+// 不影响程序缓存和异步编译，供主机基准测试（renderer_benchmark）统计每帧的 GL 调用数。
+//
+
+#ifndef NDKLEARN2_GL_TRACE_H
+#define NDKLEARN2_GL_TRACE_H
+
+#include <GLES3/gl3.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <atomic>
+#include "gl_trace_format.h"
+
+// 请求录制：下一次 glTraceContextCreated 时开始，录满 frameCount 帧后写入 path
+void glTraceRequest(const char* path, int frameCount);
+
+#ifdef NDKLEARN2_GL_TRACE
+
+extern std::atomic<bool> gGLTraceActive;
+
+// 当前线程是否正在录制
+bool glTraceOnRecordingThread();
+
+inline bool glTraceRecording() {
+    return gGLTraceActive.load(std::memory_order_relaxed) && glTraceOnRecordingThread();
+}
+
+// 渲染线程创建好上下文后调用：有待处理的请求时在当前线程开始录制
+void glTraceContextCreated();
+// 每帧结束时调用：录满请求的帧数后写文件并停止
+void glTraceFrameEnd();
+
+// 在当前线程开始计数，正在录制文件时返回 false
+bool glTraceBeginCounting();
+// 停止计数，counts 至少 GL_TRACE_OP_COUNT 个元素，按操作码下标写出调用次数
+void glTraceEndCounting(uint32_t* counts);
+// 正在录制到文件（计数模式不算）：程序缓存和异步编译据此绕过
+bool glTraceCapturing();
+
+// 追加一条记录（只在 glTraceRecording() 为真时调用）
+void glTraceRecord(GLTraceOp op, const uint32_t* args, int argCount, const void* payload, size_t payloadSize);
+
+// 参数编码
+inline uint32_t glTraceArg(int value) { return (uint32_t)value; }
+inline uint32_t glTraceArg(unsigned int value) { return value; }
+inline uint32_t glTraceArg(unsigned char value) { return value; }
+inline uint32_t glTraceArg(long value) { return (uint32_t)value; }
+inline uint32_t glTraceArg(long long value) { return (uint32_t)value; }
+inline uint32_t glTraceArg(const void* value) { return (uint32_t)(uintptr_t)value; }
+inline uint32_t glTraceArg(float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+inline void glTraceCall(GLTraceOp op) {
+    glTraceRecord(op, nullptr, 0, nullptr, 0);
+}
+
+template <typename... Args>
+inline void glTraceCall(GLTraceOp op, Args... args) {
+    const uint32_t words[] = {glTraceArg(args)...};
+    glTraceRecord(op, words, (int)sizeof...(Args), nullptr, 0);
+}
+
+// 需要额外数据的调用在 gl_trace.cpp 中实现
+void traceGenBuffers(GLsizei n, GLuint* buffers);
+void traceGenVertexArrays(GLsizei n, GLuint* arrays);
+void traceGenTextures(GLsizei n, GLuint* textures);
+void traceGenFramebuffers(GLsizei n, GLuint* framebuffers);
+void traceGenRenderbuffers(GLsizei n, GLuint* renderbuffers);
+void traceDeleteBuffers(GLsizei n, const GLuint* buffers);
+void traceDeleteVertexArrays(GLsizei n, const GLuint* arrays);
+void traceDeleteTextures(GLsizei n, const GLuint* textures);
+void traceDeleteFramebuffers(GLsizei n, const GLuint* framebuffers);
+void traceDeleteRenderbuffers(GLsizei n, const GLuint* renderbuffers);
+GLuint traceCreateShader(GLenum type);
+GLuint traceCreateProgram();
+void traceShaderSource(GLuint shader, GLsizei count, const GLchar* const* strings, const GLint* lengths);
+void traceTransformFeedbackVaryings(GLuint program, GLsizei count, const GLchar* const* varyings, GLenum bufferMode);
+GLint traceGetUniformLocation(GLuint program, const GLchar* name);
+void traceUniformBlockBinding(GLuint program, GLuint blockIndex, GLuint binding);
+void traceUniform3fv(GLint location, GLsizei count, const GLfloat* value);
+void traceBufferData(GLenum target, GLsizeiptr size, const void* data, GLenum usage);
+void traceBufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void* data);
+// 映射范围在解除映射时整体录制（写入的内容在 glUnmapBuffer 之前才确定）
+void* traceMapBufferRange(GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access);
+GLboolean traceUnmapBuffer(GLenum target);
+void traceTexImage2D(GLenum target, GLint level, GLint internalFormat, GLsizei width, GLsizei height,
+                     GLint border, GLenum format, GLenum type, const void* pixels);
+void traceTexSubImage2D(GLenum target, GLint level, GLint x, GLint y, GLsizei width, GLsizei height,
+                        GLenum format, GLenum type, const void* pixels);
+void traceCompressedTexSubImage2D(GLenum target, GLint level, GLint x, GLint y, GLsizei width, GLsizei height,
+                                  GLenum format, GLsizei imageSize, const void* data);
+void traceTexSubImage3D(GLenum target, GLint level, GLint x, GLint y, GLint z, GLsizei width, GLsizei height,
+                        GLsizei depth, GLenum format, GLenum type, const void* pixels);
+
+// 只有标量参数的调用
+inline void traceDeleteShader(GLuint shader) {
+    glDeleteShader(shader);
+    if (glTraceRecording()) glTraceCall(GL_TRACE_DELETE_SHADER, shader);
+}
+
+inline void traceDeleteProgram(GLuint program) {
+    glDeleteProgram(program);
+    if (glTraceRecording()) glTraceCall(GL_TRACE_DELETE_PROGRAM, program);
+}
+
+inline void traceCompileShader(GLuint shader) {
+    glCompileShader(shader);
+    if (glTraceRecording()) glTraceCall(GL_TRACE_COMPILE_SHADER, shader);
+}
+
+inline void traceAttachShader(GLuint program, GLuint shader) {
+    glAttachShader(program, shader);
+    if (glTraceRecording()) glTraceCall(GL_TRACE_ATTACH_SHADER, program, shader);
+}
+
+inline void traceProgramParameteri(GLuint program, GLenum pname, GLint value) {
+    glProgramParameteri(program, pname, value);
+    if (glTraceRecording()) glTraceCall(GL_TRACE_PROGRAM_PARAMETERI, program, pname, value);
+}
+
+inline void traceLinkProgram(GLuint program) {
+    glLinkProgram(program);
+    if (glTraceRecording()) glTraceCall(GL_TRACE_LINK_PROGRAM, program);
+}
+
+inline void traceUseProgram(GLuint program) {
+    glUseProgram(program);
+    if (glTraceRecording()) glTraceCall(GL_TRACE_USE_PROGRAM, program);
+}
+
+inline void traceUniform1i(GLint location, GLint v0) {
+    glUniform1i(location, v0);
+    if (glTraceRecording()) glTraceCall(GL_TRACE_UNIFORM1I, location, v0);
+}
+
+inline void traceUniform1f(GLint location, GLfloat v0) {
+    glUniform1f(location, v0);
+    if (glTraceRecording()) glTraceCall(GL_TRACE_UNIFORM1F, location, v0);
+}
+
+inline void traceBindBuffer(GLenum target, GLuint buffer) {
+    glBindBuffer(target, buffer);
+    if (glTraceRecording()) glTraceCall(GL_TRACE_BIND_BUFFER, target, buffer);
+}
+
+inline void traceBindBufferBase(GLenum target, GLuint index, GLuint buffer) {
+    glBindBufferBase(target, index, buffer);
+    if (glTraceRecording()) glTraceCall(GL_TRACE_BIND_BUFFER_BASE, target, index, buffer);
+}
+
+inline void traceBindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size) {
+    glBindBufferRange(target, index, buffer, offset, size);
+    if (glTraceRecording()) glTraceCall(GL_TRACE_BIND_BUFFER_RANGE, target, index, buffer, offset, size);
+}
+
+inline void traceCopyBufferSubData(GLenum readTarget, GLenum writeTarget, GLintptr readOffset, GLintptr writeOffset,
+                                   GLsizeiptr size) {
+    glCopyBufferSubData(readTarget, writeTarget, readOffset, writeOffset, size);
+    if (glTraceRecording()) {
+        glTraceCall(GL_TRACE_COPY_BUFFER_SUB_DATA, readTarget, writeTarget, readOffset, writeOffset, size);
+    }
+}
+
+inline void traceBindVertexArray(GLuint array) {
+    glBindVertexArray(array);
+    if (glTraceRecording()) glTraceCall(GL_TRACE_BIND_VERTEX_ARRAY, array);
+}
+
+// 本项目的顶点数据都在 VBO 中，pointer 按缓冲区偏移录制
+inline void traceVertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized,
+                                     GLsizei stride, const void* pointer) {
+    glVertexAttribPointer(index, size, type, normalized, stride, pointer);
+    if (glTraceRecording()) {
+        glTraceCall(GL_TRACE_VERTEX_ATTRIB_POINTER, index, size, type, normalized, stride, pointer);
+    }
+}
+
+inline void traceVertexAttribIPointer(GLuint index, GLint size, GLenum type, GLsizei stride, const void* pointer) {
+    glVertexAttribIPointer(index, size, type, stride, pointer);
+    if (glTraceRecording()) glTraceCall(GL_TRACE_VERTEX_ATTRIB_I_POINTER, index, size, type, stride, pointer);
+}
+
+inline void traceEnableVertexAttribArray(GLuint index) {
+    glEnableVertexAttribArray(index);
+    if (glTraceRecording()) glTraceCall(GL_TRACE_ENABLE_VERTEX_ATTRIB_ARRAY, index);
+}
+
+inline void traceVertexAttribDivisor(GLuint index, GLuint divisor) {
+    glVertexAttribDivisor(index, divisor);
+    if (glTraceRecording()) glTraceCall(GL_TRACE_VERTEX_ATTRIB_DIVISOR, index, divisor);
+}
+
+inline void traceActiveTexture(GLenum texture) {
+    glActiveTexture(texture);
+    if (glTraceRecording()) glTraceCall(GL_TRACE_ACTIVE_TEXTURE, texture);
+}
+
+inline void traceBindTexture(GLenum target, GLuint texture) {
+    glBindTexture(target, texture);
+    if (glTraceRecording()) glTraceCall(GL_TRACE_BIND_TEXTURE, target, texture);
+}
+
+inline void traceTexParameteri(GLenum target, GLenum pname, GLint param) {
+    glTexParameteri(target, pname, param);
+    if (glTraceRecording()) glTraceCall(GL_TRACE_TEX_PARAMETERI, target, pname, param);
+}
+
+inline void traceGenerateMipmap(GLenum target) {
+    glGenerateMipmap(target);
+    if (glTraceRecording()) glTraceCall(GL_TRACE_GENERATE_MIPMAP, target);
+}
+
+inline void traceTexStorage2D(GLenum target, GLsizei levels, GLenum internalFormat, GLsizei width, GLsizei height) {
+    glTexStorage2D(target, levels, internalFormat, width, height);
+    if (glTraceRecording()) glTraceCall(GL_TRACE_TEX_STORAGE_2D, target, levels, internalFormat, width, height);
+}
+
+inline void traceTexStorage3D(GLenum target, GLsizei levels, GLenum internalFormat, GLsizei width, GLsizei height,
+                              GLsizei depth) {
+    glTexStorage3D(target, levels, internalFormat, width, height, depth);
+    if (glTraceRecording()) {
+        glTraceCall(GL_TRACE_TEX_STORAGE_3D, target, levels, internalFormat, width, height, depth);
+    }
+}
+
+inline void tracePixelStorei(GLenum pname, GLint param) {
+    glPixelStorei(pname, param);
+    if (glTraceRecording()) glTraceCall(GL_TRACE_PIXEL_STOREI, pname, param);
+}
+
+inline void traceBindFramebuffer(GLenum target, GLuint framebuffer) {
+    glBindFramebuffer(target, framebuffer);
+    if (glTraceRecording()) glTraceCall(GL_TRACE_BIND_FRAMEBUFFER, target, framebuffer);
+}
+
+inline void traceBindRenderbuffer(GLenum target, GLuint renderbuffer) {
+    glBindRenderbuffer(target, renderbuffer);
+    if (glTraceRecording()) glTraceCall(GL_TRACE_BIND_RENDERBUFFER, target, renderbuffer);
+}
+
+inline void traceRenderbufferStorage(GLenum target, GLenum internalFormat, GLsizei width, GLsizei height) {
+    glRenderbufferStorage(target, internalFormat, width, height);
+    if (glTraceRecording()) glTraceCall(GL_TRACE_RENDERBUFFER_STORAGE, target, internalFormat, width, height);
+}
+
+inline void traceFramebufferRenderbuffer(GLenum target, GLenum attachment, GLenum renderbufferTarget,
+                                         GLuint renderbuffer) {
+    glFramebufferRenderbuffer(target, attachment, renderbufferTarget, renderbuffer);
+    if (glTraceRecording()) {
+        glTraceCall(GL_TRACE_FRAMEBUFFER_RENDERBUFFER, target, attachment, renderbufferTarget, renderbuffer);
+    }
+}
+
+inline void traceEnable(GLenum cap) {
+    glEnable(cap);
+    if (glTraceRecording()) glTraceCall(GL_TRACE_ENABLE, cap);
+}
+
+inline void traceDisable(GLenum cap) {
+    glDisable(cap);
+    if (glTraceRecording()) glTraceCall(GL_TRACE_DISABLE, cap);
+}
+
+inline void traceBlendFunc(GLenum sfactor, GLenum dfactor) {
+    glBlendFunc(sfactor, dfactor);
+    if (glTraceRecording()) glTraceCall(GL_TRACE_BLEND_FUNC, sfactor, dfactor);
+}
+
+inline void traceViewport(GLint x, GLint y, GLsizei width, GLsizei height) {
+    glViewport(x, y, width, height);
+    if (glTraceRecording()) glTraceCall(GL_TRACE_VIEWPORT, x, y, width, height);
+}
+
+inline void traceClearColor(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha) {
+    glClearColor(red, green, blue, alpha);
+    if (glTraceRecording()) glTraceCall(GL_TRACE_CLEAR_COLOR, red, green, blue, alpha);
+}
+
+inline void traceClear(GLbitfield mask) {
+    glClear(mask);
+    if (glTraceRecording()) glTraceCall(GL_TRACE_CLEAR, mask);
+}
+
+inline void traceDrawArrays(GLenum mode, GLint first, GLsizei count) {
+    glDrawArrays(mode, first, count);
+    if (glTraceRecording()) glTraceCall(GL_TRACE_DRAW_ARRAYS, mode, first, count);
+}
+
+// 索引来自 ELEMENT_ARRAY_BUFFER，indices 按缓冲区偏移录制
+inline void traceDrawElements(GLenum mode, GLsizei count, GLenum type, const void* indices) {
+    glDrawElements(mode, count, type, indices);
+    if (glTraceRecording()) glTraceCall(GL_TRACE_DRAW_ELEMENTS, mode, count, type, indices);
+}
+
+inline void traceDrawElementsInstanced(GLenum mode, GLsizei count, GLenum type, const void* indices,
+                                       GLsizei instanceCount) {
+    glDrawElementsInstanced(mode, count, type, indices, instanceCount);
+    if (glTraceRecording()) {
+        glTraceCall(GL_TRACE_DRAW_ELEMENTS_INSTANCED, mode, count, type, indices, instanceCount);
+    }
+}
+
+inline void traceBeginTransformFeedback(GLenum primitiveMode) {
+    glBeginTransformFeedback(primitiveMode);
+    if (glTraceRecording()) glTraceCall(GL_TRACE_BEGIN_TRANSFORM_FEEDBACK, primitiveMode);
+}
+
+inline void traceEndTransformFeedback() {
+    glEndTransformFeedback();
+    if (glTraceRecording()) glTraceCall(GL_TRACE_END_TRANSFORM_FEEDBACK);
+}
+
+inline void traceFlush() {
+    glFlush();
+    if (glTraceRecording()) glTraceCall(GL_TRACE_FLUSH);
+}
+
+inline void traceFinish() {
+    glFinish();
+    if (glTraceRecording()) glTraceCall(GL_TRACE_FINISH);
+}
+
+// gl_trace.cpp 自己需要调用真正的 GL 函数，不做重定向
+#ifndef NDKLEARN2_GL_TRACE_IMPL
+#define glGenBuffers traceGenBuffers
+#define glGenVertexArrays traceGenVertexArrays
+#define glGenTextures traceGenTextures
+#define glGenFramebuffers traceGenFramebuffers
+#define glGenRenderbuffers traceGenRenderbuffers
+#define glDeleteBuffers traceDeleteBuffers
+#define glDeleteVertexArrays traceDeleteVertexArrays
+#define glDeleteTextures traceDeleteTextures
+#define glDeleteFramebuffers traceDeleteFramebuffers
+#define glDeleteRenderbuffers traceDeleteRenderbuffers
+#define glCreateShader traceCreateShader
+#define glCreateProgram traceCreateProgram
+#define glDeleteShader traceDeleteShader
+#define glDeleteProgram traceDeleteProgram
+#define glShaderSource traceShaderSource
+#define glCompileShader traceCompileShader
+#define glAttachShader traceAttachShader
+#define glTransformFeedbackVaryings traceTransformFeedbackVaryings
+#define glProgramParameteri traceProgramParameteri
+#define glLinkProgram traceLinkProgram
+#define glUseProgram traceUseProgram
+#define glGetUniformLocation traceGetUniformLocation
+#define glUniformBlockBinding traceUniformBlockBinding
+#define glUniform1i traceUniform1i
+#define glUniform1f traceUniform1f
+#define glUniform3fv traceUniform3fv
+#define glBindBuffer traceBindBuffer
+#define glBindBufferBase traceBindBufferBase
+#define glBufferData traceBufferData
+#define glBufferSubData traceBufferSubData
+#define glBindBufferRange traceBindBufferRange
+#define glMapBufferRange traceMapBufferRange
+#define glUnmapBuffer traceUnmapBuffer
+#define glCopyBufferSubData traceCopyBufferSubData
+#define glBindVertexArray traceBindVertexArray
+#define glVertexAttribPointer traceVertexAttribPointer
+#define glVertexAttribIPointer traceVertexAttribIPointer
+#define glEnableVertexAttribArray traceEnableVertexAttribArray
+#define glVertexAttribDivisor traceVertexAttribDivisor
+#define glActiveTexture traceActiveTexture
+#define glBindTexture traceBindTexture
+#define glTexImage2D traceTexImage2D
+#define glTexSubImage2D traceTexSubImage2D
+#define glTexParameteri traceTexParameteri
+#define glGenerateMipmap traceGenerateMipmap
+#define glPixelStorei tracePixelStorei
+#define glTexStorage2D traceTexStorage2D
+#define glCompressedTexSubImage2D traceCompressedTexSubImage2D
+#define glTexStorage3D traceTexStorage3D
+#define glTexSubImage3D traceTexSubImage3D
+#define glBindFramebuffer traceBindFramebuffer
+#define glBindRenderbuffer traceBindRenderbuffer
+#define glRenderbufferStorage traceRenderbufferStorage
+#define glFramebufferRenderbuffer traceFramebufferRenderbuffer
+#define glEnable traceEnable
+#define glDisable traceDisable
+#define glBlendFunc traceBlendFunc
+#define glViewport traceViewport
+#define glClearColor traceClearColor
+#define glClear traceClear
+#define glDrawArrays traceDrawArrays
+#define glDrawElements traceDrawElements
+#define glDrawElementsInstanced traceDrawElementsInstanced
+#define glBeginTransformFeedback traceBeginTransformFeedback
+#define glEndTransformFeedback traceEndTransformFeedback
+#define glFlush traceFlush
+#define glFinish traceFinish
+#endif
+
+#else
+
+// 编译开关关闭时录制接口为空操作，GL 调用不做任何重定向
+inline bool glTraceRecording() { return false; }
+inline void glTraceContextCreated() {}
+inline void glTraceFrameEnd() {}
+inline bool glTraceBeginCounting() { return false; }
+inline void glTraceEndCounting(uint32_t* counts) { memset(counts, 0, GL_TRACE_OP_COUNT * sizeof(uint32_t)); }
+inline bool glTraceCapturing() { return false; }
+
+#endif // NDKLEARN2_GL_TRACE
+
+// 放在每帧入口函数（渲染器的 render）开头，函数返回时（包括提前返回）结束这一帧
+struct GLTraceFrameScope {
+    ~GLTraceFrameScope() { glTraceFrameEnd(); }
+};
+
+#endif //NDKLEARN2_GL_TRACE_H
@@ -0,0 +1,243 @@
+//
+// Created by zhangx on 2026/10/16.
+// GL 命令录制文件格式 - 录制端（gl_trace.cpp）和离线回放工具（gl_trace_replay.cpp）共用
+//
+// 文件布局（小端，全部按 4 字节对齐）：
+//   GLTraceFileHeader
+//   记录 * recordCount，每条记录：
+//     uint32_t  op | (argCount << 16)
+//     uint32_t  args[argCount]           整数原样保存，浮点数保存位模式，缓冲区偏移保存为整数
+//     （仅 GL_TRACE_HAS_PAYLOAD 的操作）uint32_t payloadSize + payload，末尾补齐到 4 字节
+//
+// 对象名字（缓冲区、纹理、程序等）和 uniform 位置保存的是录制时驱动返回的值，回放时重新映射
+//
+
+#ifndef NDKLEARN2_GL_TRACE_FORMAT_H
+#define NDKLEARN2_GL_TRACE_FORMAT_H
+
+#include <stdint.h>
+
+static const uint32_t GL_TRACE_MAGIC = 0x52544C47u;  // "GLTR"
+static const uint32_t GL_TRACE_VERSION = 8;  // 2：新增 glTexStorage2D；3：新增 glCompressedTexSubImage2D；
+                                             // 4：新增 glTexStorage3D / glTexSubImage3D；5：新增 glVertexAttribIPointer；
+                                             // 6：新增 glCopyBufferSubData；
+                                             // 7：新增 glVertexAttribDivisor / glDrawElementsInstanced；
+                                             // 8：新增 glBindBufferRange / glMapBufferRange / glUnmapBuffer
+
+struct GLTraceFileHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t width;         // 停止录制时的视口大小，回放用同样大小的 pbuffer
+    uint32_t height;
+    uint32_t frameCount;
+    uint32_t recordCount;
+};
+
+// 操作码，注释为参数列表；[payload] 表示带数据
+enum GLTraceOp {
+    GL_TRACE_FRAME_END = 1,                 // 一帧结束（eglSwapBuffers / onDrawFrame 返回）
+
+    // 对象创建与删除，[payload] 为名字数组
+    GL_TRACE_GEN_BUFFERS,                   // n [names]
+    GL_TRACE_GEN_VERTEX_ARRAYS,             // n [names]
+    GL_TRACE_GEN_TEXTURES,                  // n [names]
+    GL_TRACE_GEN_FRAMEBUFFERS,              // n [names]
+    GL_TRACE_GEN_RENDERBUFFERS,             // n [names]
+    GL_TRACE_DELETE_BUFFERS,                // n [names]
+    GL_TRACE_DELETE_VERTEX_ARRAYS,          // n [names]
+    GL_TRACE_DELETE_TEXTURES,               // n [names]
+    GL_TRACE_DELETE_FRAMEBUFFERS,           // n [names]
+    GL_TRACE_DELETE_RENDERBUFFERS,          // n [names]
+    GL_TRACE_CREATE_SHADER,                 // type, result
+    GL_TRACE_CREATE_PROGRAM,                // result
+    GL_TRACE_DELETE_SHADER,                 // shader
+    GL_TRACE_DELETE_PROGRAM,                // program
+
+    // 着色器与程序
+    GL_TRACE_SHADER_SOURCE,                 // shader [source]
+    GL_TRACE_COMPILE_SHADER,                // shader
+    GL_TRACE_ATTACH_SHADER,                 // program, shader
+    GL_TRACE_TRANSFORM_FEEDBACK_VARYINGS,   // program, count, bufferMode [names, '\0' 分隔]
+    GL_TRACE_PROGRAM_PARAMETERI,            // program, pname, value
+    GL_TRACE_LINK_PROGRAM,                  // program
+    GL_TRACE_USE_PROGRAM,                   // program
+    GL_TRACE_GET_UNIFORM_LOCATION,          // program, result [name]
+    GL_TRACE_UNIFORM_BLOCK_BINDING,         // program, binding [block name]
+    GL_TRACE_UNIFORM1I,                     // location, v0
+    GL_TRACE_UNIFORM1F,                     // location, v0
+    GL_TRACE_UNIFORM3FV,                    // location, count [values]
+
+    // 缓冲区
+    GL_TRACE_BIND_BUFFER,                   // target, buffer
+    GL_TRACE_BIND_BUFFER_BASE,              // target, index, buffer
+    GL_TRACE_BUFFER_DATA,                   // target, size, usage [data，data 为空时无数据]
+    GL_TRACE_BUFFER_SUB_DATA,               // target, offset, size [data]
+    GL_TRACE_COPY_BUFFER_SUB_DATA,          // readTarget, writeTarget, readOffset, writeOffset, size
+    GL_TRACE_BIND_BUFFER_RANGE,             // target, index, buffer, offset, size
+    GL_TRACE_MAP_BUFFER_RANGE,              // target, offset, length, access
+    GL_TRACE_UNMAP_BUFFER,                  // target [写入映射范围的数据，只读映射时无数据]
+
+    // 顶点数组
+    GL_TRACE_BIND_VERTEX_ARRAY,             // vao
+    GL_TRACE_VERTEX_ATTRIB_POINTER,         // index, size, type, normalized, stride, offset
+    GL_TRACE_ENABLE_VERTEX_ATTRIB_ARRAY,    // index
+    GL_TRACE_VERTEX_ATTRIB_I_POINTER,       // index, size, type, stride, offset
+    GL_TRACE_VERTEX_ATTRIB_DIVISOR,         // index, divisor
+
+    // 纹理
+    GL_TRACE_ACTIVE_TEXTURE,                // unit
+    GL_TRACE_BIND_TEXTURE,                  // target, texture
+    GL_TRACE_TEX_IMAGE_2D,                  // target, level, internalFormat, width, height, border, format, type,
+                                            // source, offset [pixels]（source 见 GLTracePixelSource）
+    GL_TRACE_TEX_SUB_IMAGE_2D,              // target, level, x, y, width, height, format, type,
+                                            // source, offset [pixels]
+    GL_TRACE_TEX_PARAMETERI,                // target, pname, value
+    GL_TRACE_GENERATE_MIPMAP,               // target
+    GL_TRACE_PIXEL_STOREI,                  // pname, value
+    GL_TRACE_TEX_STORAGE_2D,                // target, levels, internalFormat, width, height
+    GL_TRACE_COMPRESSED_TEX_SUB_IMAGE_2D,   // target, level, x, y, width, height, format, imageSize,
+                                            // source, offset [data]
+    GL_TRACE_TEX_STORAGE_3D,                // target, levels, internalFormat, width, height, depth
+    GL_TRACE_TEX_SUB_IMAGE_3D,              // target, level, x, y, z, width, height, depth, format, type,
+                                            // source, offset [pixels]
+
+    // 帧缓冲
+    GL_TRACE_BIND_FRAMEBUFFER,              // target, framebuffer
+    GL_TRACE_BIND_RENDERBUFFER,             // target, renderbuffer
+    GL_TRACE_RENDERBUFFER_STORAGE,          // target, internalFormat, width, height
+    GL_TRACE_FRAMEBUFFER_RENDERBUFFER,      // target, attachment, renderbufferTarget, renderbuffer
+
+    // 固定功能状态
+    GL_TRACE_ENABLE,                        // cap
+    GL_TRACE_DISABLE,                       // cap
+    GL_TRACE_BLEND_FUNC,                    // sfactor, dfactor
+    GL_TRACE_VIEWPORT,                      // x, y, width, height
+    GL_TRACE_CLEAR_COLOR,                   // r, g, b, a
+    GL_TRACE_CLEAR,                         // mask
+
+    // 绘制
+    GL_TRACE_DRAW_ARRAYS,                   // mode, first, count
+    GL_TRACE_DRAW_ELEMENTS,                 // mode, count, type, offset（索引来自 ELEMENT_ARRAY_BUFFER）
+    GL_TRACE_DRAW_ELEMENTS_INSTANCED,       // mode, count, type, offset, instanceCount
+    GL_TRACE_BEGIN_TRANSFORM_FEEDBACK,      // primitiveMode
+    GL_TRACE_END_TRANSFORM_FEEDBACK,        //
+    GL_TRACE_FLUSH,                         //
+    GL_TRACE_FINISH,                        //
+
+    GL_TRACE_OP_COUNT
+};
+
+// 纹理像素来源
+enum GLTracePixelSource {
+    GL_TRACE_PIXELS_NONE = 0,               // pixels 为空（只分配存储）
+    GL_TRACE_PIXELS_PAYLOAD = 1,            // 像素数据跟在记录后面
+    GL_TRACE_PIXELS_UNPACK_BUFFER = 2       // 来自 PIXEL_UNPACK_BUFFER，offset 为缓冲区内偏移
+};
+
+// 带数据的操作
+inline bool glTraceOpHasPayload(uint32_t op) {
+    switch (op) {
+        case GL_TRACE_GEN_BUFFERS:
+        case GL_TRACE_GEN_VERTEX_ARRAYS:
+        case GL_TRACE_GEN_TEXTURES:
+        case GL_TRACE_GEN_FRAMEBUFFERS:
+        case GL_TRACE_GEN_RENDERBUFFERS:
+        case GL_TRACE_DELETE_BUFFERS:
+        case GL_TRACE_DELETE_VERTEX_ARRAYS:
+        case GL_TRACE_DELETE_TEXTURES:
+        case GL_TRACE_DELETE_FRAMEBUFFERS:
+        case GL_TRACE_DELETE_RENDERBUFFERS:
+        case GL_TRACE_SHADER_SOURCE:
+        case GL_TRACE_TRANSFORM_FEEDBACK_VARYINGS:
+        case GL_TRACE_GET_UNIFORM_LOCATION:
+        case GL_TRACE_UNIFORM_BLOCK_BINDING:
+        case GL_TRACE_UNIFORM3FV:
+        case GL_TRACE_BUFFER_DATA:
+        case GL_TRACE_BUFFER_SUB_DATA:
+        case GL_TRACE_UNMAP_BUFFER:
+        case GL_TRACE_TEX_IMAGE_2D:
+        case GL_TRACE_TEX_SUB_IMAGE_2D:
+        case GL_TRACE_COMPRESSED_TEX_SUB_IMAGE_2D:
+        case GL_TRACE_TEX_SUB_IMAGE_3D:
+            return true;
+        default:
+            return false;
+    }
+}
+
+// 操作码对应的 GL 函数名，用于统计输出
+inline const char* glTraceOpName(uint32_t op) {
+    switch (op) {
+        case GL_TRACE_FRAME_END: return "frameEnd";
+        case GL_TRACE_GEN_BUFFERS: return "glGenBuffers";
+        case GL_TRACE_GEN_VERTEX_ARRAYS: return "glGenVertexArrays";
+        case GL_TRACE_GEN_TEXTURES: return "glGenTextures";
+        case GL_TRACE_GEN_FRAMEBUFFERS: return "glGenFramebuffers";
+        case GL_TRACE_GEN_RENDERBUFFERS: return "glGenRenderbuffers";
+        case GL_TRACE_DELETE_BUFFERS: return "glDeleteBuffers";
+        case GL_TRACE_DELETE_VERTEX_ARRAYS: return "glDeleteVertexArrays";
+        case GL_TRACE_DELETE_TEXTURES: return "glDeleteTextures";
+        case GL_TRACE_DELETE_FRAMEBUFFERS: return "glDeleteFramebuffers";
+        case GL_TRACE_DELETE_RENDERBUFFERS: return "glDeleteRenderbuffers";
+        case GL_TRACE_CREATE_SHADER: return "glCreateShader";
+        case GL_TRACE_CREATE_PROGRAM: return "glCreateProgram";
+        case GL_TRACE_DELETE_SHADER: return "glDeleteShader";
+        case GL_TRACE_DELETE_PROGRAM: return "glDeleteProgram";
+        case GL_TRACE_SHADER_SOURCE: return "glShaderSource";
+        case GL_TRACE_COMPILE_SHADER: return "glCompileShader";
+        case GL_TRACE_ATTACH_SHADER: return "glAttachShader";
+        case GL_TRACE_TRANSFORM_FEEDBACK_VARYINGS: return "glTransformFeedbackVaryings";
+        case GL_TRACE_PROGRAM_PARAMETERI: return "glProgramParameteri";
+        case GL_TRACE_LINK_PROGRAM: return "glLinkProgram";
+        case GL_TRACE_USE_PROGRAM: return "glUseProgram";
+        case GL_TRACE_GET_UNIFORM_LOCATION: return "glGetUniformLocation";
+        case GL_TRACE_UNIFORM_BLOCK_BINDING: return "glUniformBlockBinding";
+        case GL_TRACE_UNIFORM1I: return "glUniform1i";
+        case GL_TRACE_UNIFORM1F: return "glUniform1f";
+        case GL_TRACE_UNIFORM3FV: return "glUniform3fv";
+        case GL_TRACE_BIND_BUFFER: return "glBindBuffer";
+        case GL_TRACE_BIND_BUFFER_BASE: return "glBindBufferBase";
+        case GL_TRACE_BUFFER_DATA: return "glBufferData";
+        case GL_TRACE_BUFFER_SUB_DATA: return "glBufferSubData";
+        case GL_TRACE_COPY_BUFFER_SUB_DATA: return "glCopyBufferSubData";
+        case GL_TRACE_BIND_BUFFER_RANGE: return "glBindBufferRange";
+        case GL_TRACE_MAP_BUFFER_RANGE: return "glMapBufferRange";
+        case GL_TRACE_UNMAP_BUFFER: return "glUnmapBuffer";
+        case GL_TRACE_BIND_VERTEX_ARRAY: return "glBindVertexArray";
+        case GL_TRACE_VERTEX_ATTRIB_POINTER: return "glVertexAttribPointer";
+        case GL_TRACE_VERTEX_ATTRIB_I_POINTER: return "glVertexAttribIPointer";
+        case GL_TRACE_ENABLE_VERTEX_ATTRIB_ARRAY: return "glEnableVertexAttribArray";
+        case GL_TRACE_VERTEX_ATTRIB_DIVISOR: return "glVertexAttribDivisor";
+        case GL_TRACE_ACTIVE_TEXTURE: return "glActiveTexture";
+        case GL_TRACE_BIND_TEXTURE: return "glBindTexture";
+        case GL_TRACE_TEX_IMAGE_2D: return "glTexImage2D";
+        case GL_TRACE_TEX_SUB_IMAGE_2D: return "glTexSubImage2D";
+        case GL_TRACE_TEX_PARAMETERI: return "glTexParameteri";
+        case GL_TRACE_GENERATE_MIPMAP: return "glGenerateMipmap";
+        case GL_TRACE_PIXEL_STOREI: return "glPixelStorei";
+        case GL_TRACE_TEX_STORAGE_2D: return "glTexStorage2D";
+        case GL_TRACE_COMPRESSED_TEX_SUB_IMAGE_2D: return "glCompressedTexSubImage2D";
+        case GL_TRACE_TEX_STORAGE_3D: return "glTexStorage3D";
+        case GL_TRACE_TEX_SUB_IMAGE_3D: return "glTexSubImage3D";
+        case GL_TRACE_BIND_FRAMEBUFFER: return "glBindFramebuffer";
+        case GL_TRACE_BIND_RENDERBUFFER: return "glBindRenderbuffer";
+        case GL_TRACE_RENDERBUFFER_STORAGE: return "glRenderbufferStorage";
+        case GL_TRACE_FRAMEBUFFER_RENDERBUFFER: return "glFramebufferRenderbuffer";
+        case GL_TRACE_ENABLE: return "glEnable";
+        case GL_TRACE_DISABLE: return "glDisable";
+        case GL_TRACE_BLEND_FUNC: return "glBlendFunc";
+        case GL_TRACE_VIEWPORT: return "glViewport";
+        case GL_TRACE_CLEAR_COLOR: return "glClearColor";
+        case GL_TRACE_CLEAR: return "glClear";
+        case GL_TRACE_DRAW_ARRAYS: return "glDrawArrays";
+        case GL_TRACE_DRAW_ELEMENTS: return "glDrawElements";
+        case GL_TRACE_DRAW_ELEMENTS_INSTANCED: return "glDrawElementsInstanced";
+        case GL_TRACE_BEGIN_TRANSFORM_FEEDBACK: return "glBeginTransformFeedback";
+        case GL_TRACE_END_TRANSFORM_FEEDBACK: return "glEndTransformFeedback";
+        case GL_TRACE_FLUSH: return "glFlush";
+        case GL_TRACE_FINISH: return "glFinish";
+        default: return "unknown";
+    }
+}
+
+#endif //NDKLEARN2_GL_TRACE_FORMAT_H
@@ -0,0 +1,404 @@
+//
+// Created by zhangx on 2026/10/16.
+// GL 命令录制回放工具（Linux 主机）- 在无窗口的 EGL 上下文（例如 Mesa llvmpipe）中回放 .gltrace 文件，
+// 统计每帧的 CPU 提交耗时
+//
+// 用法：gl_trace_replay <trace 文件> [--no-finish]
+//   默认每帧结束后 glFinish（不计入提交耗时），避免 GPU 积压影响下一帧的测量；--no-finish 则连续提交
+//
+
+#include <GLES3/gl3.h>
+#include "gl_trace_format.h"
+#include "host/headless_egl.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+typedef std::unordered_map<GLuint, GLuint> NameMap;
+
+// 录制时的名字 -> 回放时的名字
+struct NameMaps {
+    NameMap buffers;
+    NameMap vertexArrays;
+    NameMap textures;
+    NameMap framebuffers;
+    NameMap renderbuffers;
+    NameMap shaders;
+    NameMap programs;
+    std::unordered_map<uint64_t, GLint> uniformLocations;   // (录制程序 << 32 | 录制位置) -> 回放位置
+};
+
+static GLuint mapName(const NameMap& map, uint32_t name) {
+    if (name == 0) {
+        return 0;
+    }
+    NameMap::const_iterator it = map.find(name);
+    return it == map.end() ? name : it->second;
+}
+
+static float asFloat(uint32_t bits) {
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+static const void* asOffset(uint32_t offset) {
+    return (const void*)(uintptr_t)offset;
+}
+
+struct Replayer {
+    NameMaps names;
+    GLuint currentProgram;      // 录制时的名字，用于查 uniform 位置
+    uint64_t uploadBytes;
+    std::unordered_map<GLenum, void*> mappings;   // 目标 -> 映射的写指针
+
+    Replayer() : currentProgram(0), uploadBytes(0) {}
+
+    GLint mapLocation(uint32_t location) const {
+        if ((GLint)location == -1) {
+            return -1;
+        }
+        std::unordered_map<uint64_t, GLint>::const_iterator it =
+            names.uniformLocations.find(((uint64_t)currentProgram << 32) | location);
+        return it == names.uniformLocations.end() ? (GLint)location : it->second;
+    }
+
+    void genNames(NameMap* map, const uint32_t* recorded, GLsizei n,
+                  void (*gen)(GLsizei, GLuint*)) {
+        std::vector<GLuint> created(n);
+        gen(n, created.data());
+        for (GLsizei i = 0; i < n; i++) {
+            (*map)[recorded[i]] = created[i];
+        }
+    }
+
+    void deleteNames(NameMap* map, const uint32_t* recorded, GLsizei n,
+                     void (*del)(GLsizei, const GLuint*)) {
+        std::vector<GLuint> actual(n);
+        for (GLsizei i = 0; i < n; i++) {
+            actual[i] = mapName(*map, recorded[i]);
+            map->erase(recorded[i]);
+        }
+        del(n, actual.data());
+    }
+
+    const void* pixels(uint32_t source, uint32_t offset, const void* payload) {
+        if (source == GL_TRACE_PIXELS_PAYLOAD) {
+            return payload;
+        }
+        if (source == GL_TRACE_PIXELS_UNPACK_BUFFER) {
+            return asOffset(offset);
+        }
+        return nullptr;
+    }
+
+    // 执行一条记录
+    void execute(uint32_t op, const uint32_t* a, const void* payload, uint32_t payloadSize) {
+        const uint32_t* names32 = (const uint32_t*)payload;
+        switch (op) {
+            case GL_TRACE_GEN_BUFFERS: genNames(&names.buffers, names32, a[0], glGenBuffers); break;
+            case GL_TRACE_GEN_VERTEX_ARRAYS: genNames(&names.vertexArrays, names32, a[0], glGenVertexArrays); break;
+            case GL_TRACE_GEN_TEXTURES: genNames(&names.textures, names32, a[0], glGenTextures); break;
+            case GL_TRACE_GEN_FRAMEBUFFERS: genNames(&names.framebuffers, names32, a[0], glGenFramebuffers); break;
+            case GL_TRACE_GEN_RENDERBUFFERS: genNames(&names.renderbuffers, names32, a[0], glGenRenderbuffers); break;
+            case GL_TRACE_DELETE_BUFFERS: deleteNames(&names.buffers, names32, a[0], glDeleteBuffers); break;
+            case GL_TRACE_DELETE_VERTEX_ARRAYS:
+                deleteNames(&names.vertexArrays, names32, a[0], glDeleteVertexArrays);
+                break;
+            case GL_TRACE_DELETE_TEXTURES: deleteNames(&names.textures, names32, a[0], glDeleteTextures); break;
+            case GL_TRACE_DELETE_FRAMEBUFFERS:
+                deleteNames(&names.framebuffers, names32, a[0], glDeleteFramebuffers);
+                break;
+            case GL_TRACE_DELETE_RENDERBUFFERS:
+                deleteNames(&names.renderbuffers, names32, a[0], glDeleteRenderbuffers);
+                break;
+            case GL_TRACE_CREATE_SHADER: names.shaders[a[1]] = glCreateShader(a[0]); break;
+            case GL_TRACE_CREATE_PROGRAM: names.programs[a[0]] = glCreateProgram(); break;
+            case GL_TRACE_DELETE_SHADER: glDeleteShader(mapName(names.shaders, a[0])); break;
+            case GL_TRACE_DELETE_PROGRAM: glDeleteProgram(mapName(names.programs, a[0])); break;
+
+            case GL_TRACE_SHADER_SOURCE: {
+                const GLchar* source = (const GLchar*)payload;
+                glShaderSource(mapName(names.shaders, a[0]), 1, &source, nullptr);
+                break;
+            }
+            case GL_TRACE_COMPILE_SHADER: glCompileShader(mapName(names.shaders, a[0])); break;
+            case GL_TRACE_ATTACH_SHADER:
+                glAttachShader(mapName(names.programs, a[0]), mapName(names.shaders, a[1]));
+                break;
+            case GL_TRACE_TRANSFORM_FEEDBACK_VARYINGS: {
+                std::vector<const GLchar*> varyings;
+                const char* name = (const char*)payload;
+                for (uint32_t i = 0; i < a[1]; i++) {
+                    varyings.push_back(name);
+                    name += strlen(name) + 1;
+                }
+                glTransformFeedbackVaryings(mapName(names.programs, a[0]), (GLsizei)a[1], varyings.data(), a[2]);
+                break;
+            }
+            case GL_TRACE_PROGRAM_PARAMETERI:
+                glProgramParameteri(mapName(names.programs, a[0]), a[1], (GLint)a[2]);
+                break;
+            case GL_TRACE_LINK_PROGRAM: {
+                GLuint program = mapName(names.programs, a[0]);
+                glLinkProgram(program);
+                GLint linked = 0;
+                glGetProgramiv(program, GL_LINK_STATUS, &linked);
+                if (!linked) {
+                    fprintf(stderr, "warning: program %u failed to link on this driver\n", a[0]);
+                }
+                break;
+            }
+            case GL_TRACE_USE_PROGRAM:
+                currentProgram = a[0];
+                glUseProgram(mapName(names.programs, a[0]));
+                break;
+            case GL_TRACE_GET_UNIFORM_LOCATION: {
+                GLint location = glGetUniformLocation(mapName(names.programs, a[0]), (const GLchar*)payload);
+                names.uniformLocations[((uint64_t)a[0] << 32) | a[1]] = location;
+                break;
+            }
+            case GL_TRACE_UNIFORM_BLOCK_BINDING: {
+                GLuint program = mapName(names.programs, a[0]);
+                GLuint blockIndex = glGetUniformBlockIndex(program, (const GLchar*)payload);
+                if (blockIndex != GL_INVALID_INDEX) {
+                    glUniformBlockBinding(program, blockIndex, a[1]);
+                }
+                break;
+            }
+            case GL_TRACE_UNIFORM1I: glUniform1i(mapLocation(a[0]), (GLint)a[1]); break;
+            case GL_TRACE_UNIFORM1F: glUniform1f(mapLocation(a[0]), asFloat(a[1])); break;
+            case GL_TRACE_UNIFORM3FV: glUniform3fv(mapLocation(a[0]), (GLsizei)a[1], (const GLfloat*)payload); break;
+
+            case GL_TRACE_BIND_BUFFER: glBindBuffer(a[0], mapName(names.buffers, a[1])); break;
+            case GL_TRACE_BIND_BUFFER_BASE: glBindBufferBase(a[0], a[1], mapName(names.buffers, a[2])); break;
+            case GL_TRACE_BUFFER_DATA:
+                glBufferData(a[0], a[1], payloadSize > 0 ? payload : nullptr, a[2]);
+                uploadBytes += payloadSize;
+                break;
+            case GL_TRACE_BUFFER_SUB_DATA:
+                glBufferSubData(a[0], a[1], a[2], payload);
+                uploadBytes += payloadSize;
+                break;
+            case GL_TRACE_COPY_BUFFER_SUB_DATA: glCopyBufferSubData(a[0], a[1], a[2], a[3], a[4]); break;
+            case GL_TRACE_BIND_BUFFER_RANGE:
+                glBindBufferRange(a[0], a[1], mapName(names.buffers, a[2]), a[3], a[4]);
+                break;
+            case GL_TRACE_MAP_BUFFER_RANGE:
+                // 录制时由 fence 保证不覆盖 GPU 还在读的范围，回放没有 fence，去掉 UNSYNCHRONIZED 让驱动同步
+                mappings[a[0]] = glMapBufferRange(a[0], a[1], a[2], a[3] & ~GL_MAP_UNSYNCHRONIZED_BIT);
+                break;
+            case GL_TRACE_UNMAP_BUFFER: {
+                void* mapped = mappings[a[0]];
+                if (mapped != nullptr && payloadSize > 0) {
+                    memcpy(mapped, payload, payloadSize);
+                    uploadBytes += payloadSize;
+                }
+                mappings.erase(a[0]);
+                glUnmapBuffer(a[0]);
+                break;
+            }
+
+            case GL_TRACE_BIND_VERTEX_ARRAY: glBindVertexArray(mapName(names.vertexArrays, a[0])); break;
+            case GL_TRACE_VERTEX_ATTRIB_POINTER:
+                glVertexAttribPointer(a[0], (GLint)a[1], a[2], (GLboolean)a[3], (GLsizei)a[4], asOffset(a[5]));
+                break;
+            case GL_TRACE_ENABLE_VERTEX_ATTRIB_ARRAY: glEnableVertexAttribArray(a[0]); break;
+            case GL_TRACE_VERTEX_ATTRIB_DIVISOR: glVertexAttribDivisor(a[0], a[1]); break;
+            case GL_TRACE_VERTEX_ATTRIB_I_POINTER:
+                glVertexAttribIPointer(a[0], (GLint)a[1], a[2], (GLsizei)a[3], asOffset(a[4]));
+                break;
+
+            case GL_TRACE_ACTIVE_TEXTURE: glActiveTexture(a[0]); break;
+            case GL_TRACE_BIND_TEXTURE: glBindTexture(a[0], mapName(names.textures, a[1])); break;
+            case GL_TRACE_TEX_IMAGE_2D:
+                glTexImage2D(a[0], (GLint)a[1], (GLint)a[2], (GLsizei)a[3], (GLsizei)a[4], (GLint)a[5], a[6], a[7],
+                             pixels(a[8], a[9], payload));
+                uploadBytes += payloadSize;
+                break;
+            case GL_TRACE_TEX_SUB_IMAGE_2D:
+                glTexSubImage2D(a[0], (GLint)a[1], (GLint)a[2], (GLint)a[3], (GLsizei)a[4], (GLsizei)a[5], a[6], a[7],
+                                pixels(a[8], a[9], payload));
+                uploadBytes += payloadSize;
+                break;
+            case GL_TRACE_TEX_PARAMETERI: glTexParameteri(a[0], a[1], (GLint)a[2]); break;
+            case GL_TRACE_GENERATE_MIPMAP: glGenerateMipmap(a[0]); break;
+            case GL_TRACE_PIXEL_STOREI: glPixelStorei(a[0], (GLint)a[1]); break;
+            case GL_TRACE_TEX_STORAGE_2D:
+                glTexStorage2D(a[0], (GLsizei)a[1], a[2], (GLsizei)a[3], (GLsizei)a[4]);
+                break;
+            case GL_TRACE_COMPRESSED_TEX_SUB_IMAGE_2D:
+                glCompressedTexSubImage2D(a[0], (GLint)a[1], (GLint)a[2], (GLint)a[3], (GLsizei)a[4], (GLsizei)a[5],
+                                          a[6], (GLsizei)a[7], pixels(a[8], a[9], payload));
+                uploadBytes += payloadSize;
+                break;
+            case GL_TRACE_TEX_STORAGE_3D:
+                glTexStorage3D(a[0], (GLsizei)a[1], a[2], (GLsizei)a[3], (GLsizei)a[4], (GLsizei)a[5]);
+                break;
+            case GL_TRACE_TEX_SUB_IMAGE_3D:
+                glTexSubImage3D(a[0], (GLint)a[1], (GLint)a[2], (GLint)a[3], (GLint)a[4], (GLsizei)a[5],
+                                (GLsizei)a[6], (GLsizei)a[7], a[8], a[9], pixels(a[10], a[11], payload));
+                uploadBytes += payloadSize;
+                break;
+
+            case GL_TRACE_BIND_FRAMEBUFFER: glBindFramebuffer(a[0], mapName(names.framebuffers, a[1])); break;
+            case GL_TRACE_BIND_RENDERBUFFER: glBindRenderbuffer(a[0], mapName(names.renderbuffers, a[1])); break;
+            case GL_TRACE_RENDERBUFFER_STORAGE:
+                glRenderbufferStorage(a[0], a[1], (GLsizei)a[2], (GLsizei)a[3]);
+                break;
+            case GL_TRACE_FRAMEBUFFER_RENDERBUFFER:
+                glFramebufferRenderbuffer(a[0], a[1], a[2], mapName(names.renderbuffers, a[3]));
+                break;
+
+            case GL_TRACE_ENABLE: glEnable(a[0]); break;
+            case GL_TRACE_DISABLE: glDisable(a[0]); break;
+            case GL_TRACE_BLEND_FUNC: glBlendFunc(a[0], a[1]); break;
+            case GL_TRACE_VIEWPORT: glViewport((GLint)a[0], (GLint)a[1], (GLsizei)a[2], (GLsizei)a[3]); break;
+            case GL_TRACE_CLEAR_COLOR:
+                glClearColor(asFloat(a[0]), asFloat(a[1]), asFloat(a[2]), asFloat(a[3]));
+                break;
+            case GL_TRACE_CLEAR: glClear(a[0]); break;
+
+            case GL_TRACE_DRAW_ARRAYS: glDrawArrays(a[0], (GLint)a[1], (GLsizei)a[2]); break;
+            case GL_TRACE_DRAW_ELEMENTS: glDrawElements(a[0], (GLsizei)a[1], a[2], asOffset(a[3])); break;
+            case GL_TRACE_DRAW_ELEMENTS_INSTANCED:
+                glDrawElementsInstanced(a[0], (GLsizei)a[1], a[2], asOffset(a[3]), (GLsizei)a[4]);
+                break;
+            case GL_TRACE_BEGIN_TRANSFORM_FEEDBACK: glBeginTransformFeedback(a[0]); break;
+            case GL_TRACE_END_TRANSFORM_FEEDBACK: glEndTransformFeedback(); break;
+            case GL_TRACE_FLUSH: glFlush(); break;
+            case GL_TRACE_FINISH: glFinish(); break;
+
+            default:
+                fprintf(stderr, "warning: unknown trace op %u skipped\n", op);
+                break;
+        }
+    }
+};
+
+static bool readTrace(const char* path, GLTraceFileHeader* header, std::vector<uint32_t>* words) {
+    FILE* file = fopen(path, "rb");
+    if (file == nullptr) {
+        fprintf(stderr, "cannot open %s\n", path);
+        return false;
+    }
+    bool ok = fread(header, sizeof(*header), 1, file) == 1
+              && header->magic == GL_TRACE_MAGIC && header->version == GL_TRACE_VERSION;
+    if (ok) {
+        fseek(file, 0, SEEK_END);
+        long size = ftell(file) - (long)sizeof(*header);
+        fseek(file, sizeof(*header), SEEK_SET);
+        words->resize(size / sizeof(uint32_t));
+        ok = words->empty() || fread(words->data(), sizeof(uint32_t), words->size(), file) == words->size();
+    }
+    fclose(file);
+    if (!ok) {
+        fprintf(stderr, "%s is not a valid GL trace (version %u expected)\n", path, GL_TRACE_VERSION);
+    }
+    return ok;
+}
+
+static double percentile(std::vector<double> values, double p) {
+    if (values.empty()) {
+        return 0.0;
+    }
+    std::sort(values.begin(), values.end());
+    size_t index = (size_t)(p * (values.size() - 1) + 0.5);
+    return values[index];
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s <trace.gltrace> [--no-finish]\n", argv[0]);
+        return 2;
+    }
+    bool finishFrames = !(argc > 2 && strcmp(argv[2], "--no-finish") == 0);
+
+    GLTraceFileHeader header;
+    std::vector<uint32_t> words;
+    if (!readTrace(argv[1], &header, &words)) {
+        return 1;
+    }
+    HeadlessEGL egl;
+    if (!createHeadlessEGL((int)header.width, (int)header.height, &egl)) {
+        return 1;
+    }
+    printf("Replaying %s: %u frames, %u records, %ux%u on %s\n", argv[1], header.frameCount,
+           header.recordCount, header.width, header.height, (const char*)glGetString(GL_RENDERER));
+
+    Replayer replayer;
+    std::vector<double> frameMs;
+    std::vector<uint32_t> frameCalls;
+    uint32_t calls = 0;
+    uint32_t glErrors = 0;
+    std::chrono::steady_clock::time_point frameStart = std::chrono::steady_clock::now();
+
+    size_t pos = 0;
+    while (pos < words.size()) {
+        uint32_t op = words[pos] & 0xFFFFu;
+        uint32_t argCount = words[pos] >> 16;
+        const uint32_t* args = &words[pos + 1];
+        pos += 1 + argCount;
+        const void* payload = nullptr;
+        uint32_t payloadSize = 0;
+        if (glTraceOpHasPayload(op) && pos < words.size()) {
+            payloadSize = words[pos];
+            payload = &words[pos + 1];
+            pos += 1 + (payloadSize + 3) / 4;
+        }
+        if (pos > words.size()) {
+            fprintf(stderr, "trace truncated after %zu frames\n", frameMs.size());
+            break;
+        }
+
+        if (op != GL_TRACE_FRAME_END) {
+            replayer.execute(op, args, payload, payloadSize);
+            calls++;
+            continue;
+        }
+
+        // 帧结束：只统计提交耗时，glFinish 和错误检查不计入
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frameStart).count();
+        frameMs.push_back(ms);
+        frameCalls.push_back(calls);
+        calls = 0;
+        if (finishFrames) {
+            glFinish();
+        }
+        for (GLenum error = glGetError(); error != GL_NO_ERROR; error = glGetError()) {
+            if (glErrors++ < 10) {
+                fprintf(stderr, "GL error 0x%x in frame %zu\n", error, frameMs.size() - 1);
+            }
+        }
+        frameStart = std::chrono::steady_clock::now();
+    }
+
+    if (frameMs.empty()) {
+        fprintf(stderr, "trace contains no complete frame\n");
+        destroyHeadlessEGL(&egl);
+        return 1;
+    }
+
+    // 第 0 帧包含上下文初始化（着色器编译、资源上传），单独报告
+    printf("Frame 0 (setup): %.3f ms, %u calls\n", frameMs[0], frameCalls[0]);
+    if (frameMs.size() > 1) {
+        std::vector<double> steady(frameMs.begin() + 1, frameMs.end());
+        double total = 0.0;
+        uint64_t totalCalls = 0;
+        for (size_t i = 0; i < steady.size(); i++) {
+            total += steady[i];
+            totalCalls += frameCalls[i + 1];
+        }
+        printf("Frames 1-%zu submit: avg %.3f ms, p50 %.3f ms, p95 %.3f ms, max %.3f ms, %.1f calls/frame\n",
+               steady.size(), total / steady.size(), percentile(steady, 0.5), percentile(steady, 0.95),
+               *std::max_element(steady.begin(), steady.end()), (double)totalCalls / steady.size());
+    }
+    printf("Uploaded %.1f KB, %u GL errors\n", replayer.uploadBytes / 1024.0, glErrors);
+
+    destroyHeadlessEGL(&egl);
+    return glErrors == 0 ? 0 : 1;
+}
@@ -0,0 +1,53 @@
+//
+// Created by zhangx on 2026/10/16.
+// 半精度浮点转换 - RGBA16F 纹理的 mip 生成和半精度顶点属性共用
+//
+
+#ifndef NDKLEARN2_HALF_FLOAT_H
+#define NDKLEARN2_HALF_FLOAT_H
+
+#include <cmath>
+#include <cstring>
+#include <stdint.h>
+
+inline float halfToFloat(uint16_t half) {
+    uint32_t sign = (uint32_t)(half & 0x8000u) << 16;
+    uint32_t exponent = (half >> 10) & 31;
+    uint32_t mantissa = half & 0x3ffu;
+    uint32_t bits;
+    if (exponent == 0) {
+        // 零和非规格化数：mantissa * 2^-24
+        float value = (float)mantissa * (1.0f / 16777216.0f);
+        return sign != 0 ? -value : value;
+    } else if (exponent == 31) {
+        bits = sign | 0x7f800000u | (mantissa << 13);
+    } else {
+        bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+    }
+    float value;
+    memcpy(&value, &bits, 4);
+    return value;
+}
+
+// 就近舍入到偶数，超出范围为无穷大
+inline uint16_t floatToHalf(float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, 4);
+    uint16_t sign = (uint16_t)((bits >> 16) & 0x8000u);
+    uint32_t magnitude = bits & 0x7fffffffu;
+    if (magnitude >= 0x7f800000u) {
+        return (uint16_t)(sign | 0x7c00u | (magnitude > 0x7f800000u ? 0x200u : 0));
+    }
+    if (magnitude >= 0x477ff000u) {
+        return (uint16_t)(sign | 0x7c00u);
+    }
+    if (magnitude < 0x38800000u) {
+        float absolute;
+        memcpy(&absolute, &magnitude, 4);
+        return (uint16_t)(sign | (uint16_t)lrintf(absolute * 16777216.0f));
+    }
+    uint32_t rounded = magnitude + 0xfffu + ((magnitude >> 13) & 1);
+    return (uint16_t)(sign | ((rounded - 0x38000000u) >> 13));
+}
+
+#endif //NDKLEARN2_HALF_FLOAT_H
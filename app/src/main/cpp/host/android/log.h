@@ -0,0 +1,46 @@
+//
+// Created by zhangx on 2026/10/16.
+// 主机构建用的 <android/log.h> 替身：渲染核心的 LOGI/LOGE 输出到 stderr
+// 只在非 Android 构建的 include 路径中（见 CMakeLists.txt），Android 构建仍使用 NDK 的头文件
+//
+
+#ifndef NDKLEARN2_HOST_ANDROID_LOG_H
+#define NDKLEARN2_HOST_ANDROID_LOG_H
+
+#include <stdarg.h>
+#include <stdio.h>
+
+typedef enum android_LogPriority {
+    ANDROID_LOG_UNKNOWN = 0,
+    ANDROID_LOG_DEFAULT,
+    ANDROID_LOG_VERBOSE,
+    ANDROID_LOG_DEBUG,
+    ANDROID_LOG_INFO,
+    ANDROID_LOG_WARN,
+    ANDROID_LOG_ERROR,
+    ANDROID_LOG_FATAL,
+    ANDROID_LOG_SILENT
+} android_LogPriority;
+
+// 低于该优先级的日志被丢弃，默认只输出警告和错误，基准测试的 --verbose 会调低
+inline int& hostLogMinPriority() {
+    static int priority = ANDROID_LOG_WARN;
+    return priority;
+}
+
+__attribute__((format(printf, 3, 4)))
+inline int __android_log_print(int prio, const char* tag, const char* fmt, ...) {
+    if (prio < hostLogMinPriority()) {
+        return 0;
+    }
+    static const char LEVELS[] = "??VDIWEFS";
+    fprintf(stderr, "%c/%s: ", LEVELS[prio >= 0 && prio <= ANDROID_LOG_SILENT ? prio : 0], tag);
+    va_list args;
+    va_start(args, fmt);
+    int written = vfprintf(stderr, fmt, args);
+    va_end(args);
+    fputc('\n', stderr);
+    return written;
+}
+
+#endif //NDKLEARN2_HOST_ANDROID_LOG_H
@@ -0,0 +1,350 @@
+//
+// Created by zhangx on 2026/10/16.
+// 纹理数组图集基准测试（Linux 主机）- 比较每个物体一个 GL_TEXTURE_2D、逐个绑定绘制
+// 与所有物体共用一个图集（texture_atlas.h）、只绑定一次的每帧 CPU 耗时和状态调用数，
+// 并在工作集大于显存预算时统计每帧的重新上传和淘汰
+//
+// 用法：atlas_benchmark [--count N] [--visible N] [--image WxH] [--layer-size N] [--levels N]
+//                       [--budget MB] [--frames N]
+//   count 张纯色图像，每帧绘制从第 frame 张开始（循环）的 visible 张；图集查询失败的图像当帧重新加入。
+//   开始前先校验每张图像在各级 mip 的 UV 矩形四角采样到的都是自己的颜色（边框没有混色），失败时返回非 0
+//
+
+#include <GLES3/gl3.h>
+#include "headless_egl.h"
+#include "../texture_atlas.h"
+#include "../opengl_utils.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+struct BenchmarkOptions {
+    int count;
+    int visible;
+    int imageWidth;
+    int imageHeight;
+    int layerSize;
+    int levels;
+    int budgetMB;
+    int frames;
+};
+
+static const int VIEWPORT_SIZE = 512;
+
+// 每个物体是一个小方块，位置和纹理坐标矩形由 uniform 给出
+static const char* QUAD_VERTEX_SHADER =
+        "#version 300 es\n"
+        "uniform vec4 uQuad;\n"
+        "out vec2 vUV;\n"
+        "void main() {\n"
+        "    vec2 corner = vec2(float(gl_VertexID & 1), float((gl_VertexID >> 1) & 1));\n"
+        "    vUV = corner;\n"
+        "    gl_Position = vec4(mix(uQuad.xy, uQuad.zw, corner), 0.0, 1.0);\n"
+        "}\n";
+
+static const char* TEXTURE_FRAGMENT_SHADER =
+        "#version 300 es\n"
+        "precision mediump float;\n"
+        "uniform sampler2D uTexture;\n"
+        "in vec2 vUV;\n"
+        "out vec4 fragColor;\n"
+        "void main() {\n"
+        "    fragColor = texture(uTexture, vUV);\n"
+        "}\n";
+
+static const char* ATLAS_FRAGMENT_SHADER =
+        "#version 300 es\n"
+        "precision mediump float;\n"
+        "uniform highp sampler2DArray uAtlas;\n"
+        "uniform vec4 uRect;\n"
+        "uniform float uLayer;\n"
+        "in vec2 vUV;\n"
+        "out vec4 fragColor;\n"
+        "void main() {\n"
+        "    fragColor = texture(uAtlas, vec3(mix(uRect.xy, uRect.zw, vUV), uLayer));\n"
+        "}\n";
+
+// 校验：2x2 视口的四个像素分别采样矩形的四个角
+static const char* VERIFY_FRAGMENT_SHADER =
+        "#version 300 es\n"
+        "precision highp float;\n"
+        "uniform highp sampler2DArray uAtlas;\n"
+        "uniform vec4 uRect;\n"
+        "uniform float uLayer;\n"
+        "uniform float uLod;\n"
+        "out vec4 fragColor;\n"
+        "void main() {\n"
+        "    vec2 corner = floor(gl_FragCoord.xy);\n"
+        "    fragColor = textureLod(uAtlas, vec3(mix(uRect.xy, uRect.zw, corner), uLayer), uLod);\n"
+        "}\n";
+
+static void imageColor(int index, unsigned char* rgba) {
+    unsigned int hash = (unsigned int)index * 2654435761u;
+    rgba[0] = (unsigned char)(hash >> 24);
+    rgba[1] = (unsigned char)(hash >> 16);
+    rgba[2] = (unsigned char)(hash >> 8);
+    rgba[3] = 255;
+}
+
+static void generateImage(int index, int width, int height, std::vector<unsigned char>* rgba) {
+    rgba->resize((size_t)width * height * 4);
+    unsigned char color[4];
+    imageColor(index, color);
+    for (size_t i = 0; i < rgba->size(); i += 4) {
+        memcpy(&(*rgba)[i], color, 4);
+    }
+}
+
+static void quadRect(int slot, int visible, float* quad) {
+    int columns = 1;
+    while (columns * columns < visible) {
+        columns++;
+    }
+    float size = 2.0f / columns;
+    quad[0] = -1.0f + (slot % columns) * size;
+    quad[1] = -1.0f + (slot / columns) * size;
+    quad[2] = quad[0] + size * 0.9f;
+    quad[3] = quad[1] + size * 0.9f;
+}
+
+// 每张图像在各级 mip 的四角颜色都应该是自己的颜色
+static bool verifyAtlas(TextureAtlas* atlas, const std::vector<AtlasHandle>& handles, int levels) {
+    GLuint program = createProgram(QUAD_VERTEX_SHADER, VERIFY_FRAGMENT_SHADER);
+    GLuint vao = 0;
+    glGenVertexArrays(1, &vao);
+    cachedBindVertexArray(vao);
+    cachedUseProgram(program);
+    cachedViewport(0, 0, 2, 2);
+    glUniform4f(glGetUniformLocation(program, "uQuad"), -1.0f, -1.0f, 1.0f, 1.0f);
+    glUniform1i(glGetUniformLocation(program, "uAtlas"), 0);
+    int failures = 0;
+    int checked = 0;
+    for (size_t i = 0; i < handles.size(); i++) {
+        AtlasRegion region;
+        if (!atlasLookup(atlas, handles[i], &region)) {
+            continue;
+        }
+        checked++;
+        cachedActiveTexture(GL_TEXTURE0);
+        cachedBindTexture(GL_TEXTURE_2D_ARRAY, region.texture);
+        glUniform4fv(glGetUniformLocation(program, "uRect"), 1, region.uvRect);
+        glUniform1f(glGetUniformLocation(program, "uLayer"), (float)region.layer);
+        unsigned char expected[4];
+        imageColor((int)i, expected);
+        for (int level = 0; level < levels; level++) {
+            glUniform1f(glGetUniformLocation(program, "uLod"), (float)level);
+            glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+            unsigned char pixels[16];
+            glReadPixels(0, 0, 2, 2, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+            for (int p = 0; p < 16; p++) {
+                if (abs((int)pixels[p] - expected[p & 3]) > 1) {
+                    if (failures++ < 8) {
+                        fprintf(stderr, "image %zu level %d corner %d: %d,%d,%d,%d expected %d,%d,%d\n", i, level,
+                                p / 4, pixels[p & ~3], pixels[(p & ~3) + 1], pixels[(p & ~3) + 2],
+                                pixels[(p & ~3) + 3], expected[0], expected[1], expected[2]);
+                    }
+                    break;
+                }
+            }
+        }
+    }
+    cachedBindVertexArray(0);
+    glDeleteVertexArrays(1, &vao);
+    cachedDeleteProgram(program);
+    printf("verify: %d resident images x %d levels, %d failures\n", checked, levels, failures);
+    return failures == 0;
+}
+
+struct FrameResult {
+    double milliseconds;
+    uint32_t stateCalls;
+};
+
+static FrameResult finishFrame(std::chrono::steady_clock::time_point start, int frames) {
+    glFinish();
+    FrameResult result;
+    result.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count()
+                          / frames;
+    result.stateCalls = getGLStateCacheStats().issued / frames;
+    return result;
+}
+
+// 每个物体一个纹理：逐个绑定后绘制
+static FrameResult drawTextures(const BenchmarkOptions& options, const std::vector<GLuint>& textures) {
+    GLuint program = createProgram(QUAD_VERTEX_SHADER, TEXTURE_FRAGMENT_SHADER);
+    cachedUseProgram(program);
+    glUniform1i(glGetUniformLocation(program, "uTexture"), 0);
+    GLint quadLocation = glGetUniformLocation(program, "uQuad");
+    glFinish();
+    resetGLStateCacheStats();
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (int frame = 0; frame < options.frames; frame++) {
+        glClear(GL_COLOR_BUFFER_BIT);
+        for (int slot = 0; slot < options.visible; slot++) {
+            float quad[4];
+            quadRect(slot, options.visible, quad);
+            cachedActiveTexture(GL_TEXTURE0);
+            cachedBindTexture(GL_TEXTURE_2D, textures[(frame + slot) % options.count]);
+            glUniform4fv(quadLocation, 1, quad);
+            glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+        }
+    }
+    FrameResult result = finishFrame(start, options.frames);
+    cachedDeleteProgram(program);
+    return result;
+}
+
+// 共用图集：只绑定一次，每个物体只改 uniform；查询失败（被淘汰）的图像当帧重新加入
+static FrameResult drawAtlas(const BenchmarkOptions& options, TextureAtlas* atlas, std::vector<AtlasHandle>* handles,
+                             uint32_t* reuploads) {
+    GLuint program = createProgram(QUAD_VERTEX_SHADER, ATLAS_FRAGMENT_SHADER);
+    cachedUseProgram(program);
+    glUniform1i(glGetUniformLocation(program, "uAtlas"), 0);
+    GLint quadLocation = glGetUniformLocation(program, "uQuad");
+    GLint rectLocation = glGetUniformLocation(program, "uRect");
+    GLint layerLocation = glGetUniformLocation(program, "uLayer");
+    std::vector<unsigned char> pixels;
+    *reuploads = 0;
+    glFinish();
+    resetGLStateCacheStats();
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (int frame = 0; frame < options.frames; frame++) {
+        atlasBeginFrame(atlas);
+        glClear(GL_COLOR_BUFFER_BIT);
+        for (int slot = 0; slot < options.visible; slot++) {
+            int index = (frame + slot) % options.count;
+            AtlasRegion region;
+            if (!atlasLookup(atlas, (*handles)[index], &region)) {
+                generateImage(index, options.imageWidth, options.imageHeight, &pixels);
+                (*handles)[index] = atlasAdd(atlas, pixels.data(), options.imageWidth, options.imageHeight);
+                (*reuploads)++;
+                if (!atlasLookup(atlas, (*handles)[index], &region)) {
+                    continue;
+                }
+            }
+            float quad[4];
+            quadRect(slot, options.visible, quad);
+            cachedActiveTexture(GL_TEXTURE0);
+            cachedBindTexture(GL_TEXTURE_2D_ARRAY, region.texture);
+            glUniform4fv(quadLocation, 1, quad);
+            glUniform4fv(rectLocation, 1, region.uvRect);
+            glUniform1f(layerLocation, (float)region.layer);
+            glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+        }
+    }
+    FrameResult result = finishFrame(start, options.frames);
+    cachedDeleteProgram(program);
+    return result;
+}
+
+static void usage(const char* program) {
+    fprintf(stderr, "usage: %s [--count N] [--visible N] [--image WxH] [--layer-size N] [--levels N]"
+                    " [--budget MB] [--frames N]\n", program);
+}
+
+int main(int argc, char** argv) {
+    BenchmarkOptions options = {256, 64, 64, 64, 1024, 4, 16, 200};
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        if (strcmp(arg, "--count") == 0 && i + 1 < argc) {
+            options.count = std::max(1, atoi(argv[++i]));
+        } else if (strcmp(arg, "--visible") == 0 && i + 1 < argc) {
+            options.visible = std::max(1, atoi(argv[++i]));
+        } else if (strcmp(arg, "--image") == 0 && i + 1 < argc) {
+            if (sscanf(argv[++i], "%dx%d", &options.imageWidth, &options.imageHeight) != 2 ||
+                options.imageWidth <= 0 || options.imageHeight <= 0) {
+                usage(argv[0]);
+                return 1;
+            }
+        } else if (strcmp(arg, "--layer-size") == 0 && i + 1 < argc) {
+            options.layerSize = atoi(argv[++i]);
+        } else if (strcmp(arg, "--levels") == 0 && i + 1 < argc) {
+            options.levels = atoi(argv[++i]);
+        } else if (strcmp(arg, "--budget") == 0 && i + 1 < argc) {
+            options.budgetMB = std::max(1, atoi(argv[++i]));
+        } else if (strcmp(arg, "--frames") == 0 && i + 1 < argc) {
+            options.frames = std::max(1, atoi(argv[++i]));
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    options.visible = std::min(options.visible, options.count);
+
+    HeadlessEGL egl;
+    if (!createHeadlessEGL(VIEWPORT_SIZE, VIEWPORT_SIZE, &egl)) {
+        fprintf(stderr, "No EGL context\n");
+        return 1;
+    }
+    invalidateGLStateCache();
+
+    TextureAtlasConfig config = {options.layerSize, options.levels, (size_t)options.budgetMB << 20};
+    TextureAtlas* atlas = createTextureAtlas(config);
+    if (atlas == nullptr) {
+        destroyHeadlessEGL(&egl);
+        return 1;
+    }
+
+    // 全部加入一遍：预算放不下时后加入的图像淘汰先加入的层
+    std::vector<unsigned char> pixels;
+    std::vector<AtlasHandle> handles(options.count);
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (int i = 0; i < options.count; i++) {
+        atlasBeginFrame(atlas);
+        generateImage(i, options.imageWidth, options.imageHeight, &pixels);
+        handles[i] = atlasAdd(atlas, pixels.data(), options.imageWidth, options.imageHeight);
+    }
+    glFinish();
+    double addMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    TextureAtlasStats stats;
+    getTextureAtlasStats(atlas, &stats);
+    printf("atlas: %d layers of %dx%d (%d levels), %.1f MB; added %d images of %dx%d in %.2f ms (%.3f ms each)\n",
+           stats.layers, options.layerSize, options.layerSize, options.levels, stats.textureBytes / 1048576.0,
+           options.count, options.imageWidth, options.imageHeight, addMs, addMs / options.count);
+    printf("resident: %d images in %d layers, evicted %u layers / %u images\n", stats.entries, stats.usedLayers,
+           stats.evictedLayers, stats.evictedEntries);
+    bool verified = verifyAtlas(atlas, handles, options.levels);
+
+    // 对照组：每张图像一个 GL_TEXTURE_2D
+    std::vector<GLuint> textures(options.count);
+    glGenTextures(options.count, textures.data());
+    for (int i = 0; i < options.count; i++) {
+        generateImage(i, options.imageWidth, options.imageHeight, &pixels);
+        cachedBindTexture(GL_TEXTURE_2D, textures[i]);
+        glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA8, options.imageWidth, options.imageHeight);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, options.imageWidth, options.imageHeight, GL_RGBA, GL_UNSIGNED_BYTE,
+                        pixels.data());
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    }
+
+    GLuint vao = 0;
+    glGenVertexArrays(1, &vao);
+    cachedBindVertexArray(vao);
+    cachedViewport(0, 0, VIEWPORT_SIZE, VIEWPORT_SIZE);
+    FrameResult separate = drawTextures(options, textures);
+    uint32_t reuploads = 0;
+    uint32_t evictedBefore = stats.evictedLayers;
+    FrameResult atlased = drawAtlas(options, atlas, &handles, &reuploads);
+    getTextureAtlasStats(atlas, &stats);
+
+    printf("\n%d of %d images per frame, %d frames\n", options.visible, options.count, options.frames);
+    printf("%-10s %10s %12s\n", "mode", "ms/frame", "state calls");
+    printf("%-10s %10.3f %12u\n", "textures", separate.milliseconds, separate.stateCalls);
+    printf("%-10s %10.3f %12u\n", "atlas", atlased.milliseconds, atlased.stateCalls);
+    printf("atlas re-uploads %.2f images/frame, evicted %u layers during the run\n",
+           (double)reuploads / options.frames, stats.evictedLayers - evictedBefore);
+
+    cachedBindVertexArray(0);
+    glDeleteVertexArrays(1, &vao);
+    cachedDeleteTextures(options.count, textures.data());
+    destroyTextureAtlas(atlas);
+    destroyHeadlessEGL(&egl);
+    if (!verified) {
+        fprintf(stderr, "Atlas verification failed\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,286 @@
+//
+// Created by zhangx on 2026/10/16.
+// 视锥剔除基准测试（Linux 主机）- 随机分布的物体在相机绕场景旋转时每帧的剔除耗时：
+// 标量逐个测试、SoA + SIMD 的包围盒和包围球、动态 BVH 查询，以及部分物体移动时两种组织方式的更新耗时
+//
+// 用法：culling_benchmark [--count N]... [--frames N] [--moving PERCENT]
+//   不给 --count 时依次测 10000、100000、1000000 个物体；物体密度固定，场景边长随数量增长，
+//   视距为场景边长的一半，可见比例大致不随数量变化。每帧有 moving% 的物体移动一小段距离。
+//   标量和 SIMD 的可见列表逐项比较，包围球和 BVH（叶子包围盒放大过）的结果必须包含包围盒的全部可见物体，
+//   不满足时返回非 0
+//
+
+#include "../frustum_culling.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+struct BenchmarkOptions {
+    std::vector<int> counts;
+    int frames;
+    int movingPercent;
+};
+
+static const float OBJECT_SPACING = 4.0f;  // 平均每个物体占据的立方体边长
+static const float MOVE_STEP = 0.05f;      // 移动物体每帧的位移
+static const float TREE_MARGIN = 0.2f;     // BVH 叶子包围盒的放大量，约 4 帧的位移
+
+struct Scene {
+    std::vector<float> position;  // 每个物体 3 个 float（中心）
+    std::vector<float> halfSize;  // 每个物体 3 个 float
+    std::vector<float> velocity;  // 每个物体 3 个 float
+    float size;                   // 场景边长，物体在 [-size/2, size/2]^3
+};
+
+struct CountResult {
+    size_t visible;
+    double scalarMs;
+    double boxesMs;
+    double spheresMs;
+    double treeBuildMs;
+    double treeRebuildMs;
+    double treeQueryMs;
+    double flatUpdateMs;
+    double treeUpdateMs;
+    CullTreeStats treeStats;
+};
+
+typedef std::chrono::steady_clock Clock;
+
+static double elapsedMs(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+static float random01(unsigned int* state) {
+    *state = *state * 1664525u + 1013904223u;
+    return (float)(*state >> 8) / 16777216.0f;
+}
+
+static void generateScene(int count, Scene* scene) {
+    unsigned int state = 12345u;
+    scene->size = cbrtf((float)count) * OBJECT_SPACING;
+    scene->position.resize((size_t)count * 3);
+    scene->halfSize.resize((size_t)count * 3);
+    scene->velocity.resize((size_t)count * 3);
+    for (int i = 0; i < count * 3; i++) {
+        scene->position[i] = (random01(&state) - 0.5f) * scene->size;
+        scene->halfSize[i] = 0.25f + random01(&state) * 0.75f;
+        scene->velocity[i] = (random01(&state) * 2.0f - 1.0f) * MOVE_STEP;
+    }
+}
+
+static void objectBounds(const Scene& scene, int index, float* boundsMin, float* boundsMax) {
+    for (int k = 0; k < 3; k++) {
+        boundsMin[k] = scene.position[index * 3 + k] - scene.halfSize[index * 3 + k];
+        boundsMax[k] = scene.position[index * 3 + k] + scene.halfSize[index * 3 + k];
+    }
+}
+
+// 列主序 a * b
+static void multiplyMatrix(const float* a, const float* b, float* result) {
+    for (int column = 0; column < 4; column++) {
+        for (int row = 0; row < 4; row++) {
+            result[column * 4 + row] = a[row] * b[column * 4] + a[4 + row] * b[column * 4 + 1]
+                                       + a[8 + row] * b[column * 4 + 2] + a[12 + row] * b[column * 4 + 3];
+        }
+    }
+}
+
+// 相机在场景中心，第 frame 帧朝向绕 y 轴转过 frame * 6 度并略微俯视，60 度垂直视角，16:9
+static void cameraViewProj(const Scene& scene, int frame, float* viewProj) {
+    float yaw = frame * 6.0f * (float)M_PI / 180.0f;
+    float pitch = -0.2f;
+    float forward[3] = {sinf(yaw) * cosf(pitch), sinf(pitch), -cosf(yaw) * cosf(pitch)};
+    float right[3] = {cosf(yaw), 0.0f, sinf(yaw)};
+    float up[3] = {right[1] * forward[2] - right[2] * forward[1], right[2] * forward[0] - right[0] * forward[2],
+                   right[0] * forward[1] - right[1] * forward[0]};
+    // 相机在原点，视图矩阵只有旋转
+    float view[16] = {right[0], up[0], -forward[0], 0.0f,
+                      right[1], up[1], -forward[1], 0.0f,
+                      right[2], up[2], -forward[2], 0.0f,
+                      0.0f, 0.0f, 0.0f, 1.0f};
+    float nearPlane = 0.1f;
+    float farPlane = scene.size * 0.5f;
+    float f = 1.0f / tanf(30.0f * (float)M_PI / 180.0f);
+    float aspect = 16.0f / 9.0f;
+    float proj[16] = {f / aspect, 0.0f, 0.0f, 0.0f,
+                      0.0f, f, 0.0f, 0.0f,
+                      0.0f, 0.0f, (farPlane + nearPlane) / (nearPlane - farPlane), -1.0f,
+                      0.0f, 0.0f, 2.0f * farPlane * nearPlane / (nearPlane - farPlane), 0.0f};
+    multiplyMatrix(proj, view, viewProj);
+}
+
+// sorted 为升序，other 顺序不定：other 中是否包含 sorted 的全部元素
+static bool containsAll(const std::vector<uint32_t>& sorted, std::vector<uint32_t> other) {
+    std::sort(other.begin(), other.end());
+    return std::includes(other.begin(), other.end(), sorted.begin(), sorted.end());
+}
+
+static bool runCount(int count, const BenchmarkOptions& options, CountResult* result) {
+    Scene scene;
+    generateScene(count, &scene);
+    CullBounds bounds;
+    bounds.count = 0;
+    resizeCullBounds(&bounds, (size_t)count);
+    CullSpheres spheres;
+    spheres.count = 0;
+    resizeCullSpheres(&spheres, (size_t)count);
+    for (int i = 0; i < count; i++) {
+        float boundsMin[3];
+        float boundsMax[3];
+        objectBounds(scene, i, boundsMin, boundsMax);
+        setCullBounds(&bounds, (size_t)i, boundsMin, boundsMax);
+        const float* half = &scene.halfSize[i * 3];
+        setCullSphere(&spheres, (size_t)i, &scene.position[i * 3],
+                      sqrtf(half[0] * half[0] + half[1] * half[1] + half[2] * half[2]));
+    }
+
+    Clock::time_point start = Clock::now();
+    CullTree* tree = createCullTree(TREE_MARGIN);
+    std::vector<CullProxy> proxies((size_t)count);
+    for (int i = 0; i < count; i++) {
+        float boundsMin[3];
+        float boundsMax[3];
+        objectBounds(scene, i, boundsMin, boundsMax);
+        proxies[i] = cullTreeInsert(tree, boundsMin, boundsMax, (uint32_t)i);
+    }
+    result->treeBuildMs = elapsedMs(start);
+    // 逐个插入后重建一次，之后的移动仍然走增量更新
+    start = Clock::now();
+    rebuildCullTree(tree);
+    result->treeRebuildMs = elapsedMs(start);
+
+    result->scalarMs = result->boxesMs = result->spheresMs = result->treeQueryMs = 0.0;
+    result->flatUpdateMs = result->treeUpdateMs = 0.0;
+    std::vector<uint32_t> scalarVisible;
+    std::vector<uint32_t> boxVisible;
+    std::vector<uint32_t> sphereVisible;
+    std::vector<uint32_t> treeVisible;
+    int moving = (int)((long long)count * options.movingPercent / 100);
+    bool verified = true;
+    size_t visibleTotal = 0;
+    for (int frame = 0; frame < options.frames; frame++) {
+        // 移动的物体每帧换一批，两种组织方式各自更新
+        int firstMoving = (int)(((long long)frame * moving) % count);
+        for (int n = 0; n < moving; n++) {
+            int i = (firstMoving + n) % count;
+            for (int k = 0; k < 3; k++) {
+                scene.position[i * 3 + k] += scene.velocity[i * 3 + k];
+            }
+        }
+        start = Clock::now();
+        for (int n = 0; n < moving; n++) {
+            int i = (firstMoving + n) % count;
+            float boundsMin[3];
+            float boundsMax[3];
+            objectBounds(scene, i, boundsMin, boundsMax);
+            setCullBounds(&bounds, (size_t)i, boundsMin, boundsMax);
+            setCullSphere(&spheres, (size_t)i, &scene.position[i * 3], spheres.radius[i]);
+        }
+        result->flatUpdateMs += elapsedMs(start);
+        start = Clock::now();
+        for (int n = 0; n < moving; n++) {
+            int i = (firstMoving + n) % count;
+            float boundsMin[3];
+            float boundsMax[3];
+            objectBounds(scene, i, boundsMin, boundsMax);
+            cullTreeUpdate(tree, proxies[i], boundsMin, boundsMax);
+        }
+        result->treeUpdateMs += elapsedMs(start);
+
+        float viewProj[16];
+        cameraViewProj(scene, frame, viewProj);
+        FrustumPlanes frustum;
+        extractFrustumPlanes(viewProj, &frustum);
+
+        start = Clock::now();
+        cullBoxesScalar(frustum, bounds, &scalarVisible);
+        result->scalarMs += elapsedMs(start);
+        start = Clock::now();
+        cullBoxes(frustum, bounds, &boxVisible);
+        result->boxesMs += elapsedMs(start);
+        start = Clock::now();
+        cullSpheres(frustum, spheres, &sphereVisible);
+        result->spheresMs += elapsedMs(start);
+        start = Clock::now();
+        treeVisible.clear();
+        cullTreeQuery(tree, frustum, &treeVisible);
+        result->treeQueryMs += elapsedMs(start);
+
+        visibleTotal += boxVisible.size();
+        if (boxVisible != scalarVisible) {
+            fprintf(stderr, "%d objects, frame %d: SIMD boxes %zu visible, scalar %zu\n", count, frame,
+                    boxVisible.size(), scalarVisible.size());
+            verified = false;
+        }
+        if (!containsAll(boxVisible, sphereVisible)) {
+            fprintf(stderr, "%d objects, frame %d: spheres miss visible boxes\n", count, frame);
+            verified = false;
+        }
+        if (!containsAll(boxVisible, treeVisible)) {
+            fprintf(stderr, "%d objects, frame %d: BVH misses visible boxes\n", count, frame);
+            verified = false;
+        }
+    }
+    result->visible = visibleTotal / options.frames;
+    result->scalarMs /= options.frames;
+    result->boxesMs /= options.frames;
+    result->spheresMs /= options.frames;
+    result->treeQueryMs /= options.frames;
+    result->flatUpdateMs /= options.frames;
+    result->treeUpdateMs /= options.frames;
+    getCullTreeStats(tree, &result->treeStats);
+    destroyCullTree(tree);
+    return verified;
+}
+
+static void usage(const char* program) {
+    fprintf(stderr, "usage: %s [--count N]... [--frames N] [--moving PERCENT]\n", program);
+}
+
+int main(int argc, char** argv) {
+    BenchmarkOptions options;
+    options.frames = 60;
+    options.movingPercent = 10;
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        if (strcmp(arg, "--count") == 0 && i + 1 < argc) {
+            options.counts.push_back(std::max(1, atoi(argv[++i])));
+        } else if (strcmp(arg, "--frames") == 0 && i + 1 < argc) {
+            options.frames = std::max(1, atoi(argv[++i]));
+        } else if (strcmp(arg, "--moving") == 0 && i + 1 < argc) {
+            options.movingPercent = std::min(100, std::max(0, atoi(argv[++i])));
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (options.counts.empty()) {
+        options.counts.push_back(10000);
+        options.counts.push_back(100000);
+        options.counts.push_back(1000000);
+    }
+
+    printf("SIMD: %s, %d frames, %d%% of objects moving per frame, times in ms/frame\n",
+           frustumCullingSimdName(), options.frames, options.movingPercent);
+    printf("%9s %8s %8s %8s %8s | %9s %9s %6s %8s | %8s %8s %9s\n", "objects", "visible", "scalar", "boxes",
+           "spheres", "bvh build", "rebuild", "height", "bvh", "update", "bvh upd", "reinserts");
+    bool verified = true;
+    for (size_t c = 0; c < options.counts.size(); c++) {
+        CountResult result;
+        verified = runCount(options.counts[c], options, &result) && verified;
+        printf("%9d %8zu %8.3f %8.3f %8.3f | %9.1f %9.1f %6d %8.3f | %8.3f %8.3f %9u\n", options.counts[c],
+               result.visible, result.scalarMs, result.boxesMs, result.spheresMs, result.treeBuildMs,
+               result.treeRebuildMs, result.treeStats.height, result.treeQueryMs, result.flatUpdateMs, result.treeUpdateMs,
+               result.treeStats.reinserts);
+    }
+    if (!verified) {
+        fprintf(stderr, "Culling verification failed\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,231 @@
+//
+// Created by zhangx on 2026/10/16.
+// ETC2 编码基准测试（Linux 主机）- 统计运行时编码器各档位在标量/SIMD、单线程/线程池下的吞吐量（Mpixels/s），
+// 并在无窗口 EGL 上下文中让驱动解码，计算各档位的 PSNR
+//
+// 用法：etc2_benchmark [--size WxH] [--repeat N] [--threads N] [--no-psnr]
+//   输入是固定种子生成的合成图像（渐变 + 色块 + 噪声），RGB 和 RGBA（带渐变 alpha）各测一遍。
+//   每个组合编码 repeat 次取最快的一次；标量和 SIMD 的输出必须逐字节相同，否则返回非 0。
+//   --threads 为线程池的线程数，默认 0（自动）
+//
+
+#include <GLES3/gl3.h>
+#include "headless_egl.h"
+#include "../etc2_encoder.h"
+#include "../ktx_container.h"
+#include "../opengl_utils.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+// 与 ETC2Quality 的顺序一致
+static const char* const QUALITY_NAMES[] = {"fast", "normal", "high"};
+static const int QUALITY_COUNT = sizeof(QUALITY_NAMES) / sizeof(QUALITY_NAMES[0]);
+
+struct BenchmarkOptions {
+    int width;
+    int height;
+    int repeat;
+    int threads;
+    bool psnr;
+};
+
+// 解码用：把压缩纹理逐像素画到 RGBA8 渲染缓冲（压缩纹理本身不能作为颜色附件）
+static const char* DECODE_VERTEX_SHADER =
+        "#version 300 es\n"
+        "void main() {\n"
+        "    vec2 position = vec2(float((gl_VertexID << 1) & 2), float(gl_VertexID & 2));\n"
+        "    gl_Position = vec4(position * 2.0 - 1.0, 0.0, 1.0);\n"
+        "}\n";
+
+static const char* DECODE_FRAGMENT_SHADER =
+        "#version 300 es\n"
+        "precision highp float;\n"
+        "uniform sampler2D uTexture;\n"
+        "out vec4 fragColor;\n"
+        "void main() {\n"
+        "    fragColor = texelFetch(uTexture, ivec2(gl_FragCoord.xy), 0);\n"
+        "}\n";
+
+static void generateImage(int width, int height, bool alpha, std::vector<unsigned char>* rgba) {
+    rgba->resize((size_t)width * height * 4);
+    unsigned int seed = 12345;
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            unsigned char* p = &(*rgba)[((size_t)y * width + x) * 4];
+            seed = seed * 1103515245 + 12345;
+            int noise = (int)((seed >> 16) & 15) - 8;
+            // 每 64 像素一个色块，块内叠加横纵渐变
+            int cell = ((x / 64) * 7 + (y / 64) * 13) % 8;
+            p[0] = (unsigned char)std::min(255, std::max(0, (cell & 1) * 128 + x * 127 / width + noise));
+            p[1] = (unsigned char)std::min(255, std::max(0, (cell & 2) * 64 + y * 127 / height + noise));
+            p[2] = (unsigned char)std::min(255, std::max(0, (cell & 4) * 32 + (x + y) * 127 / (width + height)));
+            p[3] = alpha ? (unsigned char)((x * 255 / width + ((y / 8) & 1) * 48) & 255) : 255;
+        }
+    }
+}
+
+static double encodeMilliseconds(const std::vector<unsigned char>& rgba, const BenchmarkOptions& options, bool alpha,
+                                 ETC2Quality quality, std::vector<unsigned char>* out) {
+    double best = 0.0;
+    for (int i = 0; i < options.repeat; i++) {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        encodeETC2Image(rgba.data(), options.width, options.height, alpha, quality, out->data());
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        best = i == 0 ? ms : std::min(best, ms);
+    }
+    return best;
+}
+
+// 上传压缩数据后读回解码结果，返回 PSNR（dB）；rgb 只比较颜色通道，否则只比较 alpha
+static double decodePSNR(GLuint program, const std::vector<unsigned char>& source,
+                         const std::vector<unsigned char>& encoded, int width, int height, bool alpha, bool rgb) {
+    GLenum format = alpha ? GL_COMPRESSED_RGBA8_ETC2_EAC : GL_COMPRESSED_RGB8_ETC2;
+    GLuint texture = 0;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glCompressedTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, (GLsizei)encoded.size(), encoded.data());
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+
+    GLuint renderbuffer = 0;
+    glGenRenderbuffers(1, &renderbuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, renderbuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+    GLuint framebuffer = 0;
+    glGenFramebuffers(1, &framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, renderbuffer);
+
+    GLuint vao = 0;
+    glGenVertexArrays(1, &vao);
+    glBindVertexArray(vao);
+    glUseProgram(program);
+    glViewport(0, 0, width, height);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+
+    std::vector<unsigned char> decoded((size_t)width * height * 4);
+    glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, decoded.data());
+
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glDeleteFramebuffers(1, &framebuffer);
+    glDeleteRenderbuffers(1, &renderbuffer);
+    glDeleteVertexArrays(1, &vao);
+    glDeleteTextures(1, &texture);
+
+    double squared = 0.0;
+    size_t samples = 0;
+    for (size_t i = 0; i < decoded.size(); i += 4) {
+        for (int c = rgb ? 0 : 3; c < (rgb ? 3 : 4); c++) {
+            double d = (double)decoded[i + c] - source[i + c];
+            squared += d * d;
+            samples++;
+        }
+    }
+    if (squared == 0.0) {
+        return INFINITY;
+    }
+    return 10.0 * log10(255.0 * 255.0 / (squared / samples));
+}
+
+// 一种输入（RGB 或 RGBA）的全部组合，标量与 SIMD 输出不一致时返回 false
+static bool runBenchmark(const BenchmarkOptions& options, bool alpha, GLuint program) {
+    GLenum format = alpha ? GL_COMPRESSED_RGBA8_ETC2_EAC : GL_COMPRESSED_RGB8_ETC2;
+    std::vector<unsigned char> rgba;
+    generateImage(options.width, options.height, alpha, &rgba);
+    std::vector<unsigned char> reference(compressedLevelSize(format, options.width, options.height));
+    std::vector<unsigned char> encoded(reference.size());
+    double megapixels = (double)options.width * options.height / 1e6;
+    bool simdAvailable = strcmp(etc2EncoderSimdName(), "none") != 0;
+    bool matched = true;
+
+    printf("\n%s %dx%d\n", textureFormatName(format), options.width, options.height);
+    printf("%-8s %-6s %8s %10s %10s", "quality", "simd", "threads", "ms", "Mpix/s");
+    printf(program != 0 ? (alpha ? " %9s %9s\n" : " %9s\n") : "\n", "RGB dB", "A dB");
+    for (int q = 0; q < QUALITY_COUNT; q++) {
+        ETC2Quality quality = (ETC2Quality)q;
+        for (int simd = 0; simd <= (simdAvailable ? 1 : 0); simd++) {
+            for (int pooled = 0; pooled <= 1; pooled++) {
+                setETC2EncoderSimd(simd != 0);
+                setETC2EncoderThreads(pooled ? options.threads : 1);
+                // 第一个组合（标量单线程）作为参照
+                std::vector<unsigned char>& out = simd == 0 && pooled == 0 ? reference : encoded;
+                double ms = encodeMilliseconds(rgba, options, alpha, quality, &out);
+                bool same = &out == &reference || out == reference;
+                matched = matched && same;
+                printf("%-8s %-6s %8s %10.2f %10.2f", QUALITY_NAMES[q], simd ? etc2EncoderSimdName() : "scalar",
+                       pooled ? (options.threads == 0 ? "auto" : "pool") : "1", ms, megapixels / (ms / 1000.0));
+                if (!same) {
+                    printf("  OUTPUT MISMATCH");
+                }
+                printf("\n");
+            }
+        }
+        if (program != 0) {
+            printf("%-8s psnr %29s %9.2f", QUALITY_NAMES[q], "",
+                   decodePSNR(program, rgba, reference, options.width, options.height, alpha, true));
+            if (alpha) {
+                printf(" %9.2f", decodePSNR(program, rgba, reference, options.width, options.height, alpha, false));
+            }
+            printf("\n");
+        }
+    }
+    setETC2EncoderSimd(true);
+    setETC2EncoderThreads(0);
+    return matched;
+}
+
+static void usage(const char* program) {
+    fprintf(stderr, "usage: %s [--size WxH] [--repeat N] [--threads N] [--no-psnr]\n", program);
+}
+
+int main(int argc, char** argv) {
+    BenchmarkOptions options = {1024, 1024, 3, 0, true};
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        if (strcmp(arg, "--size") == 0 && i + 1 < argc) {
+            if (sscanf(argv[++i], "%dx%d", &options.width, &options.height) != 2 ||
+                options.width <= 0 || options.height <= 0) {
+                usage(argv[0]);
+                return 1;
+            }
+        } else if (strcmp(arg, "--repeat") == 0 && i + 1 < argc) {
+            options.repeat = std::max(1, atoi(argv[++i]));
+        } else if (strcmp(arg, "--threads") == 0 && i + 1 < argc) {
+            options.threads = std::max(0, atoi(argv[++i]));
+        } else if (strcmp(arg, "--no-psnr") == 0) {
+            options.psnr = false;
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    HeadlessEGL egl;
+    GLuint program = 0;
+    if (options.psnr) {
+        if (!createHeadlessEGL(16, 16, &egl)) {
+            fprintf(stderr, "No EGL context, PSNR is skipped\n");
+            options.psnr = false;
+        } else {
+            program = createProgram(DECODE_VERTEX_SHADER, DECODE_FRAGMENT_SHADER);
+        }
+    }
+
+    printf("ETC2 encoder: SIMD %s, repeat %d\n", etc2EncoderSimdName(), options.repeat);
+    bool matched = runBenchmark(options, false, program);
+    matched = runBenchmark(options, true, program) && matched;
+
+    if (options.psnr) {
+        glDeleteProgram(program);
+        destroyHeadlessEGL(&egl);
+    }
+    if (!matched) {
+        fprintf(stderr, "Scalar and SIMD outputs differ\n");
+        return 1;
+    }
+    return 0;
+}
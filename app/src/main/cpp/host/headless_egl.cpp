@@ -0,0 +1,76 @@
+//
+// Created by zhangx on 2026/10/16.
+// 主机无窗口 EGL 上下文实现
+//
+
+#include "headless_egl.h"
+#include <EGL/eglext.h>
+#include <cstdio>
+
+#ifndef EGL_PLATFORM_SURFACELESS_MESA
+#define EGL_PLATFORM_SURFACELESS_MESA 0x31DD
+#endif
+
+// Mesa 支持 surfaceless 平台时不需要任何窗口系统
+static EGLDisplay openDisplay() {
+    PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay =
+        (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+    if (getPlatformDisplay != nullptr) {
+        EGLDisplay display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+        if (display != EGL_NO_DISPLAY && eglInitialize(display, nullptr, nullptr)) {
+            return display;
+        }
+    }
+    EGLDisplay display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    if (display != EGL_NO_DISPLAY && eglInitialize(display, nullptr, nullptr)) {
+        return display;
+    }
+    return EGL_NO_DISPLAY;
+}
+
+bool createHeadlessEGL(int width, int height, HeadlessEGL* egl) {
+    egl->display = openDisplay();
+    egl->context = EGL_NO_CONTEXT;
+    egl->surface = EGL_NO_SURFACE;
+    if (egl->display == EGL_NO_DISPLAY) {
+        fprintf(stderr, "eglInitialize failed\n");
+        return false;
+    }
+    const EGLint configAttribs[] = {
+        EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_ES3_BIT_KHR,
+        EGL_RED_SIZE, 8, EGL_GREEN_SIZE, 8, EGL_BLUE_SIZE, 8, EGL_ALPHA_SIZE, 8,
+        EGL_DEPTH_SIZE, 16,
+        EGL_NONE
+    };
+    EGLConfig config;
+    EGLint numConfigs = 0;
+    if (!eglChooseConfig(egl->display, configAttribs, &config, 1, &numConfigs) || numConfigs == 0) {
+        fprintf(stderr, "no GLES3 pbuffer config\n");
+        return false;
+    }
+    eglBindAPI(EGL_OPENGL_ES_API);
+    const EGLint contextAttribs[] = {EGL_CONTEXT_CLIENT_VERSION, 3, EGL_NONE};
+    egl->context = eglCreateContext(egl->display, config, EGL_NO_CONTEXT, contextAttribs);
+    const EGLint surfaceAttribs[] = {
+        EGL_WIDTH, width > 0 ? width : 1, EGL_HEIGHT, height > 0 ? height : 1, EGL_NONE
+    };
+    egl->surface = eglCreatePbufferSurface(egl->display, config, surfaceAttribs);
+    if (egl->context == EGL_NO_CONTEXT || egl->surface == EGL_NO_SURFACE
+        || !eglMakeCurrent(egl->display, egl->surface, egl->surface, egl->context)) {
+        fprintf(stderr, "failed to create EGL context: 0x%x\n", eglGetError());
+        return false;
+    }
+    return true;
+}
+
+void destroyHeadlessEGL(HeadlessEGL* egl) {
+    eglMakeCurrent(egl->display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    if (egl->surface != EGL_NO_SURFACE) {
+        eglDestroySurface(egl->display, egl->surface);
+    }
+    if (egl->context != EGL_NO_CONTEXT) {
+        eglDestroyContext(egl->display, egl->context);
+    }
+    eglTerminate(egl->display);
+}
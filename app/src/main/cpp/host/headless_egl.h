@@ -0,0 +1,21 @@
+//
+// Created by zhangx on 2026/10/16.
+// 主机上的无窗口 EGL 上下文（Mesa surfaceless 平台 + pbuffer），供回放工具和基准测试使用
+//
+
+#ifndef NDKLEARN2_HEADLESS_EGL_H
+#define NDKLEARN2_HEADLESS_EGL_H
+
+#include <EGL/egl.h>
+
+struct HeadlessEGL {
+    EGLDisplay display;
+    EGLContext context;
+    EGLSurface surface;
+};
+
+// 创建 GLES3 上下文和 width x height 的 pbuffer（带 16 位深度），并设为当前上下文
+bool createHeadlessEGL(int width, int height, HeadlessEGL* egl);
+void destroyHeadlessEGL(HeadlessEGL* egl);
+
+#endif //NDKLEARN2_HEADLESS_EGL_H
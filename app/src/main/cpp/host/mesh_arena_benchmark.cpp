@@ -0,0 +1,327 @@
+//
+// Created by zhangx on 2026/10/16.
+// 网格池基准测试（Linux 主机）- 比较每个网格一个 VAO/VBO/EBO、逐个绑定绘制
+// 与所有网格共用一个网格池（opengl_utils.h 的 MeshArena）、只绑定一次 VAO 的每帧 CPU 耗时和状态调用数，
+// 再随机删除一半网格、加入新网格，统计整理前后的碎片率
+//
+// 用法：mesh_arena_benchmark [--count N] [--capacity N] [--frames N]
+//   count 个细分程度不同的小球体，网格池的初始顶点容量为 capacity（索引容量为 3 倍），放不下时自动扩容。
+//   两种方式的绘制结果逐像素比较，整理后再比较一次，不一致时返回非 0
+//
+
+#include <GLES3/gl3.h>
+#include "headless_egl.h"
+#include "../opengl_utils.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+struct BenchmarkOptions {
+    int count;
+    int capacity;
+    int frames;
+};
+
+static const int VIEWPORT_SIZE = 512;
+
+static const char* MESH_VERTEX_SHADER =
+        "#version 300 es\n"
+        "layout(location = 0) in vec3 aPosition;\n"
+        "layout(location = 1) in vec3 aNormal;\n"
+        "uniform vec3 uPlace;\n"
+        "out vec3 vNormal;\n"
+        "void main() {\n"
+        "    vNormal = aNormal;\n"
+        "    gl_Position = vec4(uPlace.xy + aPosition.xy * uPlace.z, aPosition.z * 0.5, 1.0);\n"
+        "}\n";
+
+static const char* MESH_FRAGMENT_SHADER =
+        "#version 300 es\n"
+        "precision mediump float;\n"
+        "in vec3 vNormal;\n"
+        "out vec4 fragColor;\n"
+        "void main() {\n"
+        "    fragColor = vec4(normalize(vNormal) * 0.5 + 0.5, 1.0);\n"
+        "}\n";
+
+static const MeshAttribute MESH_ATTRIBUTES[] = {
+    {0, 3, GL_FLOAT, 0, 0},
+    {1, 3, GL_FLOAT, 0, 12},
+};
+static const GLsizei MESH_STRIDE = 24;
+
+struct SourceMesh {
+    std::vector<float> vertices;
+    std::vector<uint32_t> indices;
+};
+
+// 第 index 个网格：经纬球，环数和段数随 index 变化，顶点数从几十到一百多
+static void generateMesh(int index, SourceMesh* mesh) {
+    unsigned int hash = (unsigned int)index * 2654435761u;
+    int rings = 3 + (int)((hash >> 8) % 8);
+    int segments = 4 + (int)((hash >> 16) % 13);
+    mesh->vertices.clear();
+    mesh->indices.clear();
+    for (int r = 0; r <= rings; r++) {
+        float theta = (float)M_PI * r / rings;
+        for (int s = 0; s <= segments; s++) {
+            float phi = 2.0f * (float)M_PI * s / segments;
+            float normal[3] = {sinf(theta) * cosf(phi), cosf(theta), sinf(theta) * sinf(phi)};
+            mesh->vertices.insert(mesh->vertices.end(), normal, normal + 3);
+            mesh->vertices.insert(mesh->vertices.end(), normal, normal + 3);
+        }
+    }
+    for (int r = 0; r < rings; r++) {
+        for (int s = 0; s < segments; s++) {
+            uint32_t a = (uint32_t)(r * (segments + 1) + s);
+            uint32_t b = a + (uint32_t)segments + 1;
+            uint32_t quad[6] = {a, b, a + 1, a + 1, b, b + 1};
+            mesh->indices.insert(mesh->indices.end(), quad, quad + 6);
+        }
+    }
+}
+
+// 网格按网格线排列，返回中心和缩放
+static void meshPlace(int slot, int count, float* place) {
+    int columns = 1;
+    while (columns * columns < count) {
+        columns++;
+    }
+    float size = 2.0f / columns;
+    place[0] = -1.0f + (slot % columns + 0.5f) * size;
+    place[1] = -1.0f + (slot / columns + 0.5f) * size;
+    place[2] = size * 0.45f;
+}
+
+struct FrameResult {
+    double milliseconds;
+    uint32_t stateCalls;
+};
+
+static FrameResult finishFrame(std::chrono::steady_clock::time_point start, int frames) {
+    glFinish();
+    FrameResult result;
+    result.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count()
+                          / frames;
+    result.stateCalls = getGLStateCacheStats().issued / frames;
+    return result;
+}
+
+static void readFrame(std::vector<unsigned char>* pixels) {
+    pixels->resize((size_t)VIEWPORT_SIZE * VIEWPORT_SIZE * 4);
+    glReadPixels(0, 0, VIEWPORT_SIZE, VIEWPORT_SIZE, GL_RGBA, GL_UNSIGNED_BYTE, pixels->data());
+}
+
+// 每个网格一个 VAO：逐个绑定后绘制；slots 中为 -1 的网格不画
+static FrameResult drawSeparate(const std::vector<MeshData>& meshes, const std::vector<int>& slots,
+                                GLint placeLocation, int frames, std::vector<unsigned char>* pixels) {
+    glFinish();
+    resetGLStateCacheStats();
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (int frame = 0; frame < frames; frame++) {
+        glClear(GL_COLOR_BUFFER_BIT);
+        for (size_t i = 0; i < meshes.size(); i++) {
+            if (slots[i] < 0) {
+                continue;
+            }
+            float place[3];
+            meshPlace(slots[i], (int)meshes.size(), place);
+            glUniform3fv(placeLocation, 1, place);
+            cachedBindVertexArray(meshes[i].vao);
+            glDrawElements(GL_TRIANGLES, meshes[i].indexCount, meshes[i].indexType, nullptr);
+        }
+    }
+    FrameResult result = finishFrame(start, frames);
+    readFrame(pixels);
+    return result;
+}
+
+// 共用网格池：只绑定一次 VAO，每个网格只改 uniform 和索引偏移
+static FrameResult drawArena(const MeshArena* arena, const std::vector<ArenaMeshHandle>& handles,
+                             const std::vector<int>& slots, GLint placeLocation, int frames,
+                             std::vector<unsigned char>* pixels) {
+    glFinish();
+    resetGLStateCacheStats();
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (int frame = 0; frame < frames; frame++) {
+        glClear(GL_COLOR_BUFFER_BIT);
+        bindMeshArena(arena);
+        for (size_t i = 0; i < handles.size(); i++) {
+            if (slots[i] < 0) {
+                continue;
+            }
+            float place[3];
+            meshPlace(slots[i], (int)handles.size(), place);
+            glUniform3fv(placeLocation, 1, place);
+            drawArenaMesh(arena, handles[i]);
+        }
+    }
+    FrameResult result = finishFrame(start, frames);
+    readFrame(pixels);
+    return result;
+}
+
+static void printArenaStats(const char* label, const MeshArena* arena) {
+    MeshArenaStats stats;
+    getMeshArenaStats(arena, &stats);
+    printf("%-16s %6u meshes, vertices %7u/%-7u (%3u free blocks, fragmentation %.2f), "
+           "indices %7u/%-7u (%3u free blocks, fragmentation %.2f)\n", label, stats.meshes, stats.vertexUsed,
+           stats.vertexCapacity, stats.freeVertexBlocks, stats.vertexFragmentation, stats.indexUsed,
+           stats.indexCapacity, stats.freeIndexBlocks, stats.indexFragmentation);
+}
+
+static bool compareFrames(const char* label, const std::vector<unsigned char>& expected,
+                          const std::vector<unsigned char>& actual) {
+    size_t mismatches = 0;
+    for (size_t i = 0; i < expected.size(); i += 4) {
+        if (memcmp(&expected[i], &actual[i], 4) != 0) {
+            mismatches++;
+        }
+    }
+    printf("verify %s: %zu mismatched pixels\n", label, mismatches);
+    return mismatches == 0;
+}
+
+static void usage(const char* program) {
+    fprintf(stderr, "usage: %s [--count N] [--capacity N] [--frames N]\n", program);
+}
+
+int main(int argc, char** argv) {
+    BenchmarkOptions options = {2000, 16384, 200};
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        if (strcmp(arg, "--count") == 0 && i + 1 < argc) {
+            options.count = std::max(1, atoi(argv[++i]));
+        } else if (strcmp(arg, "--capacity") == 0 && i + 1 < argc) {
+            options.capacity = std::max(1, atoi(argv[++i]));
+        } else if (strcmp(arg, "--frames") == 0 && i + 1 < argc) {
+            options.frames = std::max(1, atoi(argv[++i]));
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    HeadlessEGL egl;
+    if (!createHeadlessEGL(VIEWPORT_SIZE, VIEWPORT_SIZE, &egl)) {
+        fprintf(stderr, "No EGL context\n");
+        return 1;
+    }
+    invalidateGLStateCache();
+
+    std::vector<SourceMesh> sources(options.count);
+    size_t totalVertices = 0;
+    size_t totalIndices = 0;
+    for (int i = 0; i < options.count; i++) {
+        generateMesh(i, &sources[i]);
+        totalVertices += sources[i].vertices.size() / 6;
+        totalIndices += sources[i].indices.size();
+    }
+
+    // 对照组：每个网格一个 VAO/VBO/EBO
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::vector<MeshData> meshes(options.count);
+    for (int i = 0; i < options.count; i++) {
+        const SourceMesh& source = sources[i];
+        meshes[i] = createMeshBuffers(source.vertices.data(), source.vertices.size() * sizeof(float),
+                                      source.indices.data(), GL_UNSIGNED_INT, source.indices.size());
+        setVertexAttributes(MESH_ATTRIBUTES, 2, MESH_STRIDE);
+        finishMeshBuffers();
+    }
+    glFinish();
+    double separateMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    MeshArena* arena = createMeshArena(MESH_ATTRIBUTES, 2, MESH_STRIDE, (uint32_t)options.capacity,
+                                       (uint32_t)options.capacity * 3);
+    if (arena == nullptr) {
+        destroyHeadlessEGL(&egl);
+        return 1;
+    }
+    std::vector<ArenaMeshHandle> handles(options.count);
+    for (int i = 0; i < options.count; i++) {
+        const SourceMesh& source = sources[i];
+        handles[i] = arenaAddMesh(arena, source.vertices.data(), (uint32_t)(source.vertices.size() / 6),
+                                  source.indices.data(), (uint32_t)source.indices.size());
+    }
+    glFinish();
+    double arenaMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    MeshArenaStats stats;
+    getMeshArenaStats(arena, &stats);
+    printf("%d meshes, %zu vertices, %zu indices\n", options.count, totalVertices, totalIndices);
+    printf("upload: separate %.2f ms, arena %.2f ms (%u grows)\n", separateMs, arenaMs, stats.grows);
+    printArenaStats("arena", arena);
+
+    GLuint program = createProgram(MESH_VERTEX_SHADER, MESH_FRAGMENT_SHADER);
+    cachedUseProgram(program);
+    GLint placeLocation = glGetUniformLocation(program, "uPlace");
+    cachedViewport(0, 0, VIEWPORT_SIZE, VIEWPORT_SIZE);
+
+    std::vector<int> slots(options.count);
+    for (int i = 0; i < options.count; i++) {
+        slots[i] = i;
+    }
+    std::vector<unsigned char> expected;
+    std::vector<unsigned char> actual;
+    FrameResult separate = drawSeparate(meshes, slots, placeLocation, options.frames, &expected);
+    FrameResult arenaDraw = drawArena(arena, handles, slots, placeLocation, options.frames, &actual);
+    bool verified = compareFrames("all meshes", expected, actual);
+
+    printf("\n%d draws per frame, %d frames\n", options.count, options.frames);
+    printf("%-10s %10s %12s\n", "mode", "ms/frame", "state calls");
+    printf("%-10s %10.3f %12u\n", "separate", separate.milliseconds, separate.stateCalls);
+    printf("%-10s %10.3f %12u\n", "arena", arenaDraw.milliseconds, arenaDraw.stateCalls);
+
+    // 随机删除约一半，留下分散的空洞；再在每 4 个位置中的第一个（已被删除时）加入细分程度不同的新网格
+    printf("\n");
+    unsigned int seed = 12345;
+    for (int i = 0; i < options.count; i++) {
+        seed = seed * 1103515245 + 12345;
+        if ((seed >> 16) & 1) {
+            arenaRemoveMesh(arena, handles[i]);
+            releaseMesh(&meshes[i]);
+            slots[i] = -1;
+        }
+    }
+    printArenaStats("after removal", arena);
+    for (int i = 0; i < options.count; i += 4) {
+        if (slots[i] >= 0) {
+            continue;
+        }
+        const SourceMesh& source = sources[(i * 7 + 3) % options.count];
+        handles[i] = arenaAddMesh(arena, source.vertices.data(), (uint32_t)(source.vertices.size() / 6),
+                                  source.indices.data(), (uint32_t)source.indices.size());
+        meshes[i] = createMeshBuffers(source.vertices.data(), source.vertices.size() * sizeof(float),
+                                      source.indices.data(), GL_UNSIGNED_INT, source.indices.size());
+        setVertexAttributes(MESH_ATTRIBUTES, 2, MESH_STRIDE);
+        finishMeshBuffers();
+        slots[i] = i;
+    }
+    printArenaStats("after re-adding", arena);
+    start = std::chrono::steady_clock::now();
+    compactMeshArena(arena);
+    glFinish();
+    double compactMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    printArenaStats("after compaction", arena);
+    printf("compaction %.2f ms\n", compactMs);
+
+    drawSeparate(meshes, slots, placeLocation, 1, &expected);
+    drawArena(arena, handles, slots, placeLocation, 1, &actual);
+    verified = compareFrames("after compaction", expected, actual) && verified;
+
+    for (int i = 0; i < options.count; i++) {
+        releaseMesh(&meshes[i]);
+    }
+    destroyMeshArena(arena);
+    cachedDeleteProgram(program);
+    destroyHeadlessEGL(&egl);
+    if (!verified) {
+        fprintf(stderr, "Mesh arena verification failed\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,436 @@
+//
+// Created by zhangx on 2026/10/16.
+// 网格转换工具（Linux 主机）- 把 OBJ 模型转换为 .mesh 文件（mesh_container.h），构建时由 mesh_assets 目标调用
+//
+// 用法：mesh_converter [--float] [--flip-v] [--no-optimize] [--lods N] <输入.obj> <输出.mesh>
+//   默认布局：location 0 半精度位置、1 GL_INT_2_10_10_10_REV 法线、2 半精度 UV，每个顶点 16 字节（vertex_layout.h）；
+//   --float 全部用 float（32 字节），用于坐标超出半精度范围或需要更高精度的模型。
+//   --flip-v 把 v 换成 1 - v：OBJ 的 v 从图像底部算起，Bitmap 上传的纹理第一行在顶部。
+//   f 中相同的 位置/UV/法线 组合合并为一个顶点，多边形按扇形拆成三角形；没有法线的面用面积加权的平滑法线。
+//   o / g / usemtl 开始新的子网格（同名的面合并到同一个子网格），顶点不超过 65536 个时索引用 16 位。
+//   默认按 mesh_optimizer.h 重排三角形（变换后缓存、过度绘制）和顶点（读取顺序），输出前后的 ACMR / ATVR；
+//   --no-optimize 保持 OBJ 中的顺序，用来对比。
+//   --lods 为每个子网格生成的 LOD 级数（含完整网格，默认 MESH_MAX_LODS，1 表示不简化）：第 i 级的目标是
+//   完整网格三角形数的 1/2^i（mesh_simplifier.h），简化不到上一级的 3/4 时停止；运行时按投影到屏幕的误差选择。
+//   glTF 模型先用 Blender 等工具导出为 OBJ 再转换。
+//
+
+#include "../mesh_container.h"
+#include "../mesh_optimizer.h"
+#include "../mesh_simplifier.h"
+#include "../vertex_layout.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include <tuple>
+#include <vector>
+
+// 位置、法线、UV：packVertices 的源数据，两种布局的属性顺序相同
+typedef VertexLayout<VertexHalf<3>, VertexPackedNormal, VertexHalf<2>> PackedMeshLayout;
+typedef VertexLayout<VertexFloat<3>, VertexFloat<3>, VertexFloat<2>> FloatMeshLayout;
+static const int SOURCE_FLOATS = 8;
+
+struct ConverterOptions {
+    bool floatLayout;
+    bool flipV;
+    bool optimize;
+    int lods;
+    const char* input;
+    const char* output;
+};
+
+// 面的一个角：OBJ 中从 0 开始的位置 / UV / 法线下标，-1 表示没有
+typedef std::tuple<int, int, int> Corner;
+
+struct Submesh {
+    std::string name;
+    std::vector<uint32_t> indices;
+};
+
+struct ObjModel {
+    std::vector<float> positions;
+    std::vector<float> texCoords;
+    std::vector<float> normals;
+    std::vector<Corner> vertices;     // 合并后的顶点
+    std::vector<Submesh> submeshes;
+};
+
+// OBJ 下标从 1 开始，负数从末尾倒数
+static bool resolveIndex(const char* text, size_t count, int* index) {
+    char* end = nullptr;
+    long value = strtol(text, &end, 10);
+    if (end == text) {
+        *index = -1;
+        return true;
+    }
+    long resolved = value > 0 ? value - 1 : (long)count + value;
+    if (value == 0 || resolved < 0 || resolved >= (long)count) {
+        return false;
+    }
+    *index = (int)resolved;
+    return true;
+}
+
+static bool parseCorner(const char* token, const ObjModel& model, Corner* corner) {
+    int position = -1;
+    int texCoord = -1;
+    int normal = -1;
+    const char* uv = strchr(token, '/');
+    const char* n = uv != nullptr ? strchr(uv + 1, '/') : nullptr;
+    if (!resolveIndex(token, model.positions.size() / 3, &position) || position < 0
+        || (uv != nullptr && !resolveIndex(uv + 1, model.texCoords.size() / 2, &texCoord))
+        || (n != nullptr && !resolveIndex(n + 1, model.normals.size() / 3, &normal))) {
+        return false;
+    }
+    *corner = Corner(position, texCoord, normal);
+    return true;
+}
+
+static Submesh* findSubmesh(ObjModel* model, const std::string& name) {
+    for (size_t i = 0; i < model->submeshes.size(); i++) {
+        if (model->submeshes[i].name == name) {
+            return &model->submeshes[i];
+        }
+    }
+    Submesh submesh;
+    submesh.name = name;
+    model->submeshes.push_back(submesh);
+    return &model->submeshes.back();
+}
+
+static bool readOBJ(const char* path, ObjModel* model) {
+    FILE* file = fopen(path, "r");
+    if (file == nullptr) {
+        perror(path);
+        return false;
+    }
+    std::map<Corner, uint32_t> vertexIndices;
+    Submesh* current = nullptr;
+    char line[4096];
+    int lineNumber = 0;
+    bool ok = true;
+    while (ok && fgets(line, sizeof(line), file) != nullptr) {
+        lineNumber++;
+        char* save = nullptr;
+        const char* keyword = strtok_r(line, " \t\r\n", &save);
+        if (keyword == nullptr || keyword[0] == '#') {
+            continue;
+        }
+        if (strcmp(keyword, "v") == 0 || strcmp(keyword, "vn") == 0 || strcmp(keyword, "vt") == 0) {
+            std::vector<float>* target = keyword[1] == 0 ? &model->positions
+                                                         : (keyword[1] == 'n' ? &model->normals : &model->texCoords);
+            int components = keyword[1] == 't' ? 2 : 3;
+            for (int i = 0; i < components; i++) {
+                const char* value = strtok_r(nullptr, " \t\r\n", &save);
+                target->push_back(value != nullptr ? strtof(value, nullptr) : 0.0f);
+            }
+        } else if (strcmp(keyword, "o") == 0 || strcmp(keyword, "g") == 0 || strcmp(keyword, "usemtl") == 0) {
+            const char* name = strtok_r(nullptr, "\r\n", &save);
+            current = findSubmesh(model, name != nullptr ? name : "");
+        } else if (strcmp(keyword, "f") == 0) {
+            if (current == nullptr) {
+                current = findSubmesh(model, "default");
+            }
+            std::vector<uint32_t> polygon;
+            const char* token;
+            while ((token = strtok_r(nullptr, " \t\r\n", &save)) != nullptr) {
+                Corner corner;
+                if (!parseCorner(token, *model, &corner)) {
+                    fprintf(stderr, "%s:%d: invalid face vertex %s\n", path, lineNumber, token);
+                    ok = false;
+                    break;
+                }
+                std::map<Corner, uint32_t>::iterator found = vertexIndices.find(corner);
+                if (found == vertexIndices.end()) {
+                    found = vertexIndices.insert(std::make_pair(corner, (uint32_t)model->vertices.size())).first;
+                    model->vertices.push_back(corner);
+                }
+                polygon.push_back(found->second);
+            }
+            for (size_t i = 2; ok && i < polygon.size(); i++) {
+                current->indices.push_back(polygon[0]);
+                current->indices.push_back(polygon[i - 1]);
+                current->indices.push_back(polygon[i]);
+            }
+        }
+        // mtllib、s 等其余语句忽略
+    }
+    fclose(file);
+    return ok;
+}
+
+// 没有法线的角用所在位置上各三角形面积加权的平均法线
+static std::vector<float> smoothNormals(const ObjModel& model) {
+    std::vector<float> normals(model.positions.size(), 0.0f);
+    for (size_t s = 0; s < model.submeshes.size(); s++) {
+        const std::vector<uint32_t>& indices = model.submeshes[s].indices;
+        for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+            int p[3];
+            for (int k = 0; k < 3; k++) {
+                p[k] = std::get<0>(model.vertices[indices[i + k]]);
+            }
+            const float* a = &model.positions[p[0] * 3];
+            const float* b = &model.positions[p[1] * 3];
+            const float* c = &model.positions[p[2] * 3];
+            float e1[3] = {b[0] - a[0], b[1] - a[1], b[2] - a[2]};
+            float e2[3] = {c[0] - a[0], c[1] - a[1], c[2] - a[2]};
+            // 叉积的长度是面积的两倍，不归一化即按面积加权
+            float n[3] = {e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0]};
+            for (int k = 0; k < 3; k++) {
+                for (int j = 0; j < 3; j++) {
+                    normals[p[k] * 3 + j] += n[j];
+                }
+            }
+        }
+    }
+    return normals;
+}
+
+static void normalize(float* v) {
+    float length = sqrtf(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+    if (length > 0.0f) {
+        v[0] /= length;
+        v[1] /= length;
+        v[2] /= length;
+    }
+}
+
+static void growBounds(const float* position, float* boundsMin, float* boundsMax) {
+    for (int i = 0; i < 3; i++) {
+        boundsMin[i] = position[i] < boundsMin[i] ? position[i] : boundsMin[i];
+        boundsMax[i] = position[i] > boundsMax[i] ? position[i] : boundsMax[i];
+    }
+}
+
+static bool writeFile(const char* path, const std::vector<unsigned char>& data) {
+    FILE* file = fopen(path, "wb");
+    if (file == nullptr) {
+        perror(path);
+        return false;
+    }
+    bool written = fwrite(data.data(), 1, data.size(), file) == data.size();
+    written = fclose(file) == 0 && written;
+    if (!written) {
+        fprintf(stderr, "%s: write failed\n", path);
+    }
+    return written;
+}
+
+// 为每个子网格追加 LOD 1 以后的索引：每一级都从完整网格简化（误差不累积），按级依次排在全部 LOD 0 之后
+static void generateLods(const ConverterOptions& options, const std::vector<float>& source, size_t vertexCount,
+                         MeshFile* mesh, std::vector<uint32_t>* indices) {
+    std::vector<std::vector<uint32_t>> levels[MESH_MAX_LODS];
+    std::vector<uint32_t> clusters;
+    for (int s = 0; s < mesh->submeshCount; s++) {
+        MeshSubmesh& submesh = mesh->submeshes[s];
+        std::vector<uint32_t> full(indices->begin() + submesh.lods[0].firstIndex,
+                                   indices->begin() + submesh.lods[0].firstIndex + submesh.lods[0].indexCount);
+        size_t previous = full.size();
+        for (int l = 1; l < options.lods; l++) {
+            size_t target = full.size() / 3 >> l;
+            std::vector<uint32_t> simplified;
+            float error = 0.0f;
+            simplifyMesh(full.data(), full.size(), source.data(), SOURCE_FLOATS * sizeof(float), vertexCount,
+                         target * 3, &simplified, &error);
+            if (simplified.empty() || simplified.size() > previous * 3 / 4) {
+                break;
+            }
+            if (options.optimize) {
+                optimizeVertexCache(simplified.data(), simplified.size(), vertexCount, MESH_VERTEX_CACHE_SIZE,
+                                    &clusters);
+                optimizeOverdraw(simplified.data(), simplified.size(), source.data(), SOURCE_FLOATS * sizeof(float),
+                                 vertexCount, clusters, MESH_VERTEX_CACHE_SIZE, MESH_OVERDRAW_THRESHOLD);
+            }
+            // 误差保持递增，运行时从粗到细找第一个满足阈值的级别
+            MeshLod lod = {0, (uint32_t)simplified.size(), std::max(error, submesh.lods[l - 1].error)};
+            submesh.lods[l] = lod;
+            submesh.lodCount = l + 1;
+            previous = simplified.size();
+            levels[l].resize(mesh->submeshCount);
+            levels[l][s].swap(simplified);
+        }
+    }
+    for (int l = 1; l < MESH_MAX_LODS; l++) {
+        for (int s = 0; s < mesh->submeshCount && !levels[l].empty(); s++) {
+            if (l < mesh->submeshes[s].lodCount) {
+                mesh->submeshes[s].lods[l].firstIndex = (uint32_t)indices->size();
+                indices->insert(indices->end(), levels[l][s].begin(), levels[l][s].end());
+            }
+        }
+    }
+}
+
+static void usage(const char* program) {
+    fprintf(stderr, "usage: %s [--float] [--flip-v] [--no-optimize] [--lods N] <input.obj> <output.mesh>\n", program);
+}
+
+int main(int argc, char** argv) {
+    ConverterOptions options = {false, false, true, MESH_MAX_LODS, nullptr, nullptr};
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        if (strcmp(arg, "--float") == 0) {
+            options.floatLayout = true;
+        } else if (strcmp(arg, "--flip-v") == 0) {
+            options.flipV = true;
+        } else if (strcmp(arg, "--no-optimize") == 0) {
+            options.optimize = false;
+        } else if (strcmp(arg, "--lods") == 0 && i + 1 < argc) {
+            options.lods = atoi(argv[++i]);
+            if (options.lods < 1 || options.lods > MESH_MAX_LODS) {
+                usage(argv[0]);
+                return 1;
+            }
+        } else if (arg[0] != '-' && options.input == nullptr) {
+            options.input = arg;
+        } else if (arg[0] != '-' && options.output == nullptr) {
+            options.output = arg;
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (options.input == nullptr || options.output == nullptr) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    ObjModel model;
+    if (!readOBJ(options.input, &model)) {
+        return 1;
+    }
+    // 去掉没有面的子网格（例如只有 usemtl 的组）
+    std::vector<Submesh> submeshes;
+    for (size_t i = 0; i < model.submeshes.size(); i++) {
+        if (!model.submeshes[i].indices.empty()) {
+            submeshes.push_back(model.submeshes[i]);
+        }
+    }
+    model.submeshes.swap(submeshes);
+    if (model.vertices.empty() || model.submeshes.empty()) {
+        fprintf(stderr, "%s: no faces\n", options.input);
+        return 1;
+    }
+    if (model.submeshes.size() > (size_t)MESH_MAX_SUBMESHES) {
+        fprintf(stderr, "%s: %zu submeshes, at most %d are supported\n", options.input, model.submeshes.size(),
+                MESH_MAX_SUBMESHES);
+        return 1;
+    }
+
+    // 展开成 float 源顶点：位置、法线、UV
+    std::vector<float> smooth = smoothNormals(model);
+    std::vector<float> source(model.vertices.size() * SOURCE_FLOATS);
+    for (size_t i = 0; i < model.vertices.size(); i++) {
+        int position = std::get<0>(model.vertices[i]);
+        int texCoord = std::get<1>(model.vertices[i]);
+        int normal = std::get<2>(model.vertices[i]);
+        float* vertex = &source[i * SOURCE_FLOATS];
+        memcpy(vertex, &model.positions[position * 3], 3 * sizeof(float));
+        memcpy(vertex + 3, normal >= 0 ? &model.normals[normal * 3] : &smooth[position * 3], 3 * sizeof(float));
+        normalize(vertex + 3);
+        vertex[6] = texCoord >= 0 ? model.texCoords[texCoord * 2] : 0.0f;
+        vertex[7] = texCoord >= 0 ? model.texCoords[texCoord * 2 + 1] : 0.0f;
+        if (options.flipV) {
+            vertex[7] = 1.0f - vertex[7];
+        }
+    }
+
+    MeshFile mesh;
+    memset(&mesh, 0, sizeof(mesh));
+    // 子网格的索引依次排列
+    std::vector<uint32_t> indices;
+    for (int i = 0; i < 3; i++) {
+        mesh.boundsMin[i] = INFINITY;
+        mesh.boundsMax[i] = -INFINITY;
+    }
+    mesh.submeshCount = (int)model.submeshes.size();
+    for (size_t s = 0; s < model.submeshes.size(); s++) {
+        const Submesh& submesh = model.submeshes[s];
+        MeshSubmesh& info = mesh.submeshes[s];
+        MeshLod full = {(uint32_t)indices.size(), (uint32_t)submesh.indices.size(), 0.0f};
+        info.lodCount = 1;
+        info.lods[0] = full;
+        strncpy(info.name, submesh.name.c_str(), MESH_NAME_LENGTH - 1);
+        for (int i = 0; i < 3; i++) {
+            info.boundsMin[i] = INFINITY;
+            info.boundsMax[i] = -INFINITY;
+        }
+        for (size_t i = 0; i < submesh.indices.size(); i++) {
+            const float* position = &source[submesh.indices[i] * SOURCE_FLOATS];
+            growBounds(position, info.boundsMin, info.boundsMax);
+            growBounds(position, mesh.boundsMin, mesh.boundsMax);
+        }
+        indices.insert(indices.end(), submesh.indices.begin(), submesh.indices.end());
+    }
+
+    // 每个子网格内重排三角形（子网格的索引范围不变），生成 LOD，再按新的三角形顺序重排全部顶点
+    size_t vertexCount = model.vertices.size();
+    VertexCacheStats before = analyzeVertexCache(indices.data(), indices.size(), vertexCount, MESH_VERTEX_CACHE_SIZE);
+    if (options.optimize) {
+        std::vector<uint32_t> clusters;
+        for (int s = 0; s < mesh.submeshCount; s++) {
+            uint32_t* range = indices.data() + mesh.submeshes[s].lods[0].firstIndex;
+            size_t count = mesh.submeshes[s].lods[0].indexCount;
+            optimizeVertexCache(range, count, vertexCount, MESH_VERTEX_CACHE_SIZE, &clusters);
+            optimizeOverdraw(range, count, source.data(), SOURCE_FLOATS * sizeof(float), vertexCount, clusters,
+                             MESH_VERTEX_CACHE_SIZE, MESH_OVERDRAW_THRESHOLD);
+        }
+    }
+    size_t fullIndexCount = indices.size();
+    generateLods(options, source, vertexCount, &mesh, &indices);
+    if (options.optimize) {
+        vertexCount = optimizeVertexFetch(source.data(), vertexCount, SOURCE_FLOATS * sizeof(float), indices.data(),
+                                          indices.size());
+    }
+    VertexCacheStats after = analyzeVertexCache(indices.data(), fullIndexCount, vertexCount, MESH_VERTEX_CACHE_SIZE);
+
+    std::vector<unsigned char> vertices;
+    if (options.floatLayout) {
+        packVertices<FloatMeshLayout>(source.data(), vertexCount, &vertices);
+        FloatMeshLayout::describeAttributes(mesh.attributes);
+        mesh.attributeCount = FloatMeshLayout::COUNT;
+        mesh.vertexStride = FloatMeshLayout::SIZE;
+    } else {
+        packVertices<PackedMeshLayout>(source.data(), vertexCount, &vertices);
+        PackedMeshLayout::describeAttributes(mesh.attributes);
+        mesh.attributeCount = PackedMeshLayout::COUNT;
+        mesh.vertexStride = PackedMeshLayout::SIZE;
+    }
+    mesh.vertexCount = (uint32_t)vertexCount;
+    mesh.vertices = vertices.data();
+
+    mesh.indexCount = (uint32_t)indices.size();
+    std::vector<uint16_t> shortIndices;
+    if (mesh.vertexCount <= 65536) {
+        shortIndices.assign(indices.begin(), indices.end());
+        mesh.indexType = GL_UNSIGNED_SHORT;
+        mesh.indices = shortIndices.data();
+    } else {
+        mesh.indexType = GL_UNSIGNED_INT;
+        mesh.indices = indices.data();
+    }
+
+    std::vector<unsigned char> file;
+    if (!writeMeshFile(mesh, &file) || !writeFile(options.output, file)) {
+        return 1;
+    }
+    size_t floatBytes = model.vertices.size() * FloatMeshLayout::SIZE + fullIndexCount * sizeof(uint32_t);
+    printf("%s: %u vertices, %zu triangles, %d submeshes, %u bytes per vertex, %d-bit indices, %zu bytes "
+           "(float vertices with 32-bit indices: %zu bytes)\n", options.output, mesh.vertexCount, fullIndexCount / 3,
+           mesh.submeshCount, mesh.vertexStride, mesh.indexType == GL_UNSIGNED_SHORT ? 16 : 32, file.size(),
+           floatBytes);
+    for (int s = 0; s < mesh.submeshCount; s++) {
+        const MeshSubmesh& submesh = mesh.submeshes[s];
+        for (int l = 1; l < submesh.lodCount; l++) {
+            printf("%s: %s LOD %d: %u triangles (%.0f%%), error %g\n", options.output, submesh.name, l,
+                   submesh.lods[l].indexCount / 3, submesh.lods[l].indexCount * 100.0 / submesh.lods[0].indexCount,
+                   submesh.lods[l].error);
+        }
+    }
+    printf("%s: ACMR %.3f -> %.3f, ATVR %.3f -> %.3f (FIFO cache of %d vertices)\n", options.output, before.acmr,
+           after.acmr, before.atvr, after.atvr, MESH_VERTEX_CACHE_SIZE);
+    return 0;
+}
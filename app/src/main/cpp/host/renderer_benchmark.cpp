@@ -0,0 +1,593 @@
+//
+// Created by zhangx on 2026/10/16.
+// 渲染器基准测试（Linux 主机）- 在无窗口的 EGL 上下文（例如 Mesa llvmpipe）中直接运行三个渲染器的核心逻辑，
+// 统计每帧 CPU 耗时的分位数、各阶段 CPU/GPU 耗时和 GL 调用数
+//
+// 用法：renderer_benchmark [--renderer triangle|lighting|particles|all] [--frames N] [--warmup N]
+//                          [--size WxH] [--no-finish] [--verbose]
+//                          [--gl-checks auto|off|debug-output|sampled|sync] [--texture <文件.ktx>]
+//                          [--runtime-etc2 fast|normal|high] [--checker-size N] [--stream-budget KB]
+//                          [--mesh <文件.mesh>] [--mesh-arena] [--camera-distance D] [--lod-threshold PX]
+//                          [--instances N] [--draw-loop] [--no-cull] [--instances-at-fps FPS]
+//   每个渲染器使用独立的上下文，按 Java 层的顺序初始化（init -> 资源加载 -> resize），
+//   等异步编译全部完成、再预热若干帧后开始计时。
+//   submit 为 render 调用本身的 CPU 耗时；默认每帧之后 glFinish，frame 为包含等待 GPU 完成的耗时。
+//   --texture 让 lighting 使用 KTX 压缩纹理（例如 texture_encoder 的输出），默认是 RGBA8 棋盘格。
+//   --runtime-etc2 打开纹理加载器的运行时压缩，棋盘格在上传前编码为 ETC2。
+//   --checker-size 设置棋盘格边长（默认 256），--stream-budget 设置纹理流式上传的每帧预算（0 为一次上传），
+//   大纹理的 mip 级别在计时的帧里逐步补上，用来比较分帧上传和一次上传的帧耗时峰值。
+//   --mesh 让 lighting 绘制 mesh_converter 生成的模型（映射文件后直接上传），代替内置立方体；
+//   加上 --mesh-arena 时模型放进同一布局的网格池（lightingRendererSetMeshArenaEnabled），按网格中的偏移绘制。
+//   --camera-distance 把相机沿 (1, 1, 1) 方向移到离原点 D 处（默认约 4.33），--lod-threshold 设置 LOD 选择的
+//   屏幕误差（像素，0 为总是完整网格），用来比较远处模型选用简化 LOD 后的顶点开销。
+//   --instances 让 lighting 把 N 个小正方体排成立方网格（占据原来正方体附近的空间），用一次实例化绘制画出；
+//   加上 --draw-loop 改为每个实例更新一次 TransformBlock 再单独绘制。--instances-at-fps 不跑常规测试，
+//   对实例化和逐个绘制两种方式分别找出每帧耗时（含 glFinish）不超过 1000/FPS ms 的最大实例数。
+//   实例默认按视锥剔除（阶段耗时中的 cull），--no-cull 关闭剔除，全部上传和绘制。
+//   --gl-checks 只在 Debug 构建（定义了 NDKLEARN2_GL_CHECKS）中有效，用来比较各错误检查模式的开销。
+//
+
+#include <GLES3/gl3.h>
+#include <android/log.h>
+#include "headless_egl.h"
+#include "../opengl_renderer.h"
+#include "../opengl_renderer2.h"
+#include "../opengl_renderer3.h"
+#include "../opengl_utils.h"
+#include "../shader_compile_service.h"
+#include "../texture_loader.h"
+#include "../gl_trace.h"
+#include "../frame_timing.h"
+#include "../gl_check.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+// 与 GLCheckMode 的顺序一致
+static const char* const GL_CHECK_MODE_NAMES[] = {"auto", "off", "debug-output", "sampled", "sync"};
+static const int GL_CHECK_MODE_NAME_COUNT = sizeof(GL_CHECK_MODE_NAMES) / sizeof(GL_CHECK_MODE_NAMES[0]);
+// 与 ETC2Quality 的顺序一致
+static const char* const ETC2_QUALITY_NAMES[] = {"fast", "normal", "high"};
+static const int ETC2_QUALITY_NAME_COUNT = sizeof(ETC2_QUALITY_NAMES) / sizeof(ETC2_QUALITY_NAMES[0]);
+
+struct BenchmarkOptions {
+    const char* renderer;
+    int frames;
+    int warmup;
+    int width;
+    int height;
+    bool finish;
+};
+
+// 一个渲染器的入口：setup 对应 onSurfaceCreated + onSurfaceChanged，frame 对应 onDrawFrame
+struct RendererEntry {
+    const char* name;
+    bool (*setup)(int width, int height);
+    void (*frame)();
+    void (*cleanup)();
+};
+
+// ==================== Renderer1：三角形 ====================
+
+static bool setupTriangle(int width, int height) {
+    if (!triangleRendererInit()) {
+        return false;
+    }
+    triangleRendererResize(width, height);
+    return true;
+}
+
+// ==================== Renderer2：光照正方体 ====================
+
+// 列主序 4x4 矩阵，与 android.opengl.Matrix 相同
+static void perspective(float* m, float fovyDegrees, float aspect, float zNear, float zFar) {
+    float f = 1.0f / tanf(fovyDegrees * (float)M_PI / 360.0f);
+    memset(m, 0, 16 * sizeof(float));
+    m[0] = f / aspect;
+    m[5] = f;
+    m[10] = (zFar + zNear) / (zNear - zFar);
+    m[11] = -1.0f;
+    m[14] = 2.0f * zFar * zNear / (zNear - zFar);
+}
+
+static void lookAt(float* m, const float* eye, const float* center, const float* up) {
+    float f[3] = {center[0] - eye[0], center[1] - eye[1], center[2] - eye[2]};
+    float fl = sqrtf(f[0] * f[0] + f[1] * f[1] + f[2] * f[2]);
+    f[0] /= fl;
+    f[1] /= fl;
+    f[2] /= fl;
+    float s[3] = {f[1] * up[2] - f[2] * up[1], f[2] * up[0] - f[0] * up[2], f[0] * up[1] - f[1] * up[0]};
+    float sl = sqrtf(s[0] * s[0] + s[1] * s[1] + s[2] * s[2]);
+    s[0] /= sl;
+    s[1] /= sl;
+    s[2] /= sl;
+    float u[3] = {s[1] * f[2] - s[2] * f[1], s[2] * f[0] - s[0] * f[2], s[0] * f[1] - s[1] * f[0]};
+    const float values[16] = {
+        s[0], u[0], -f[0], 0.0f,
+        s[1], u[1], -f[1], 0.0f,
+        s[2], u[2], -f[2], 0.0f,
+        -(s[0] * eye[0] + s[1] * eye[1] + s[2] * eye[2]),
+        -(u[0] * eye[0] + u[1] * eye[1] + u[2] * eye[2]),
+        f[0] * eye[0] + f[1] * eye[1] + f[2] * eye[2], 1.0f
+    };
+    memcpy(m, values, sizeof(values));
+}
+
+// --texture 读入的 KTX 文件内容，为空时 lighting 用棋盘格
+static std::vector<unsigned char> gTextureFile;
+static int gCheckerSize = 256;
+// --mesh 指定的 .mesh 文件，为空时 lighting 用内置立方体
+static const char* gMeshPath = nullptr;
+static float gCameraDistance = 4.330127f;
+// --instances 的实例数，0 为只画一个正方体
+static int gInstanceCount = 0;
+static bool gDrawLoop = false;
+static bool gCulling = true;
+
+// count 个实例排成边长为 side 的立方网格，整体约占 [-1.5, 1.5]^3，每个正方体缩小到间距的 30%（控制片段开销）
+static void setLightingInstances(int count) {
+    int side = 1;
+    while (side * side * side < count) {
+        side++;
+    }
+    float spacing = 3.0f / side;
+    float scale = spacing * 0.3f;
+    std::vector<float> models((size_t)count * 16, 0.0f);
+    for (int i = 0; i < count; i++) {
+        float* m = &models[(size_t)i * 16];
+        m[0] = scale;
+        m[5] = scale;
+        m[10] = scale;
+        m[12] = -1.5f + (i % side + 0.5f) * spacing;
+        m[13] = -1.5f + (i / side % side + 0.5f) * spacing;
+        m[14] = -1.5f + (i / (side * side) + 0.5f) * spacing;
+        m[15] = 1.0f;
+    }
+    lightingRendererSetInstanceCount(count);
+    lightingRendererUpdateInstances(0, count, models.data(), nullptr);
+}
+
+// 棋盘格代替 Java 层从资源解码的 Bitmap
+static void uploadCheckerTexture() {
+    const int size = gCheckerSize;
+    std::vector<unsigned char> pixels((size_t)size * size * 4);
+    for (int y = 0; y < size; y++) {
+        for (int x = 0; x < size; x++) {
+            unsigned char value = ((x / 32) ^ (y / 32)) & 1 ? 230 : 40;
+            unsigned char* p = &pixels[((size_t)y * size + x) * 4];
+            p[0] = value;
+            p[1] = value;
+            p[2] = value;
+            p[3] = 255;
+        }
+    }
+    lightingRendererUploadTexture(pixels.data(), size, size);
+}
+
+// 参数与 OpenGLRenderer2.java 的默认值一致：相机在 (2.5, 2.5, 2.5)，带衰减的点光源
+static bool setupLighting(int width, int height) {
+    if (!lightingRendererInit()) {
+        return false;
+    }
+    if (gTextureFile.empty() ||
+        !lightingRendererSetTexture(loadKTXTextureAsync(gTextureFile.data(), gTextureFile.size()))) {
+        uploadCheckerTexture();
+    }
+    lightingRendererCreateUniformBuffers();
+    if (gMeshPath != nullptr) {
+        MeshAsset asset;
+        if (!loadMeshFile(gMeshPath, &asset)) {
+            return false;
+        }
+        lightingRendererSetMesh(asset);
+    } else {
+        lightingRendererLoadMesh();
+    }
+
+    const float axis = gCameraDistance / sqrtf(3.0f);
+    const float cameraPos[3] = {axis, axis, axis};
+    const float center[3] = {0.0f, 0.0f, 0.0f};
+    const float up[3] = {0.0f, 1.0f, 0.0f};
+    float model[16] = {1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1};
+    float view[16];
+    float proj[16];
+    float normal[12] = {1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0};
+    lookAt(view, cameraPos, center, up);
+    perspective(proj, 45.0f, (float)width / (float)height, 1.0f, fmaxf(100.0f, gCameraDistance * 2.0f));
+
+    LightParams light = {
+        {0.2f, 0.2f, 0.2f}, {1.0f, 1.0f, 1.0f}, {1.0f, 1.0f, 1.0f},
+        {0.0f, 0.0f, 0.0f}, {2.0f, 2.0f, 2.0f}, {1.0f, 0.09f, 0.032f},
+        0.0f, 0.0f, {0.0f, 0.0f, 0.0f}, 1
+    };
+    const float materialAmbient[3] = {0.2f, 0.2f, 0.2f};
+    const float materialDiffuse[3] = {0.8f, 0.8f, 0.8f};
+    const float materialSpecular[3] = {1.0f, 1.0f, 1.0f};
+
+    lightingRendererUpdateTransform(model, view, proj, normal);
+    lightingRendererUpdateLight(light);
+    lightingRendererUpdateMaterial(materialAmbient, materialDiffuse, materialSpecular, 32.0f);
+    lightingRendererUpdateCameraPos(cameraPos);
+    lightingRendererResize(width, height);
+    if (gInstanceCount > 0) {
+        setLightingInstances(gInstanceCount);
+        lightingRendererSetInstancing(!gDrawLoop);
+        lightingRendererSetCulling(gCulling);
+    }
+    return true;
+}
+
+// ==================== Renderer3：TFB 粒子 ====================
+
+static bool setupParticles(int width, int height) {
+    if (!particleRendererInit()) {
+        return false;
+    }
+    particleRendererInitTFBBuffer();
+    particleRendererInitVAO();
+    particleRendererInitUBO();
+    particleRendererResize(width, height);
+    return true;
+}
+
+static const RendererEntry RENDERERS[] = {
+    {"triangle", setupTriangle, triangleRendererRender, triangleRendererCleanup},
+    {"lighting", setupLighting, lightingRendererRender, lightingRendererCleanup},
+    {"particles", setupParticles, particleRendererRender, particleRendererCleanup},
+};
+static const int RENDERER_COUNT = sizeof(RENDERERS) / sizeof(RENDERERS[0]);
+
+// ==================== 测量 ====================
+
+static double percentile(const std::vector<double>& sorted, double p) {
+    if (sorted.empty()) {
+        return 0.0;
+    }
+    size_t index = (size_t)(p * (sorted.size() - 1) + 0.5);
+    return sorted[index];
+}
+
+static void printTimes(const char* label, std::vector<double> ms) {
+    std::sort(ms.begin(), ms.end());
+    double total = 0.0;
+    for (size_t i = 0; i < ms.size(); i++) {
+        total += ms[i];
+    }
+    printf("  %-7s avg %7.3f  p50 %7.3f  p90 %7.3f  p99 %7.3f  max %7.3f ms\n", label,
+           total / ms.size(), percentile(ms, 0.5), percentile(ms, 0.9), percentile(ms, 0.99), ms.back());
+}
+
+// 渲染器内部各阶段的耗时（frame_timing），GPU 列只在驱动支持 GL_EXT_disjoint_timer_query 时出现
+static void printStageTimes(const FrameStageStats* stats, uint32_t dropped) {
+    for (int stage = 0; stage < FRAME_STAGE_COUNT; stage++) {
+        const FrameStageStats& s = stats[stage];
+        if (s.samples == 0) {
+            continue;
+        }
+        printf("  stage %-9s cpu min %6.3f avg %6.3f p95 %6.3f p99 %6.3f ms", frameStageName(stage),
+               s.cpuMin, s.cpuAvg, s.cpuP95, s.cpuP99);
+        if (s.gpuSamples > 0) {
+            printf(" | gpu min %6.3f avg %6.3f p95 %6.3f p99 %6.3f ms", s.gpuMin, s.gpuAvg, s.gpuP95, s.gpuP99);
+        }
+        printf("\n");
+    }
+    if (dropped > 0) {
+        printf("  stage timing: %u samples dropped, ring buffer full\n", dropped);
+    }
+}
+
+static bool runRenderer(const RendererEntry& renderer, const BenchmarkOptions& options) {
+    HeadlessEGL egl;
+    if (!createHeadlessEGL(options.width, options.height, &egl)) {
+        return false;
+    }
+    // 每个渲染器都是新的上下文，状态缓存里的绑定全部失效
+    invalidateGLStateCache();
+    printf("%s: %d frames at %dx%d on %s\n", renderer.name, options.frames, options.width, options.height,
+           (const char*)glGetString(GL_RENDERER));
+
+    typedef std::chrono::steady_clock Clock;
+    Clock::time_point setupStart = Clock::now();
+    if (!renderer.setup(options.width, options.height)) {
+        fprintf(stderr, "%s: setup failed\n", renderer.name);
+        stopShaderCompileService();
+        stopTextureLoader();
+        destroyHeadlessEGL(&egl);
+        return false;
+    }
+    // 第一帧会提交按需编译的请求（例如光照变体），等它们和纹理上传全部完成后再预热
+    renderer.frame();
+    glFinish();
+    waitShaderCompileServiceIdle();
+    waitTextureLoaderIdle();
+    double setupMs = std::chrono::duration<double, std::milli>(Clock::now() - setupStart).count();
+    for (int i = 0; i < options.warmup; i++) {
+        renderer.frame();
+        glFinish();
+    }
+    printf("  setup   %.1f ms (init, resource upload, shader compile and first frame)\n", setupMs);
+#ifdef NDKLEARN2_GL_CHECKS
+    printf("  GL checks: %s\n", GL_CHECK_MODE_NAMES[glCheckActiveMode()]);
+#endif
+
+    resetGLStateCacheStats();
+    FrameStageStats stageStats[FRAME_STAGE_COUNT];
+    drainFrameTiming(stageStats);  // 丢掉预热帧的样本
+    bool counting = glTraceBeginCounting();
+    std::vector<double> submitMs;
+    std::vector<double> frameMs;
+    submitMs.reserve(options.frames);
+    frameMs.reserve(options.frames);
+    for (int i = 0; i < options.frames; i++) {
+        Clock::time_point start = Clock::now();
+        renderer.frame();
+        Clock::time_point submitted = Clock::now();
+        if (options.finish) {
+            glFinish();
+        }
+        submitMs.push_back(std::chrono::duration<double, std::milli>(submitted - start).count());
+        frameMs.push_back(std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+    }
+    uint32_t counts[GL_TRACE_OP_COUNT];
+    glTraceEndCounting(counts);
+    GLStateCacheStats cacheStats = getGLStateCacheStats();
+    uint32_t droppedSamples = drainFrameTiming(stageStats);
+
+    printTimes("submit", submitMs);
+    if (options.finish) {
+        printTimes("frame", frameMs);
+    }
+
+    printStageTimes(stageStats, droppedSamples);
+
+    if (counting) {
+        // glFinish 由基准测试自己调用，不算渲染器的调用
+        counts[GL_TRACE_FRAME_END] = 0;
+        if (options.finish) {
+            counts[GL_TRACE_FINISH] -= std::min(counts[GL_TRACE_FINISH], (uint32_t)options.frames);
+        }
+        uint64_t total = 0;
+        uint64_t draws = counts[GL_TRACE_DRAW_ARRAYS] + counts[GL_TRACE_DRAW_ELEMENTS]
+                         + counts[GL_TRACE_DRAW_ELEMENTS_INSTANCED];
+        std::vector<uint32_t> ops;
+        for (uint32_t op = 0; op < GL_TRACE_OP_COUNT; op++) {
+            if (counts[op] > 0) {
+                total += counts[op];
+                ops.push_back(op);
+            }
+        }
+        std::sort(ops.begin(), ops.end(), [&counts](uint32_t a, uint32_t b) { return counts[a] > counts[b]; });
+        printf("  GL calls %.1f/frame, %.1f draws/frame:", (double)total / options.frames,
+               (double)draws / options.frames);
+        for (size_t i = 0; i < ops.size(); i++) {
+            printf(" %s %.1f", glTraceOpName(ops[i]), (double)counts[ops[i]] / options.frames);
+        }
+        printf("\n");
+    } else {
+        printf("  GL calls: not available (built without NDKLEARN2_GL_TRACE)\n");
+    }
+    printf("  state cache %.1f issued, %.1f elided per frame\n", (double)cacheStats.issued / options.frames,
+           (double)cacheStats.elided / options.frames);
+
+    GLenum error = glGetError();
+    if (error != GL_NO_ERROR) {
+        printf("  GL error 0x%x pending after the run\n", error);
+    }
+
+    renderer.cleanup();
+    stopShaderCompileService();
+    stopTextureLoader();
+    destroyHeadlessEGL(&egl);
+    return true;
+}
+
+// 画 count 个实例时每帧的平均耗时（含 glFinish）
+static double lightingFrameMs(int count) {
+    setLightingInstances(count);
+    for (int i = 0; i < 5; i++) {
+        lightingRendererRender();
+        glFinish();
+    }
+    const int frames = 20;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (int i = 0; i < frames; i++) {
+        lightingRendererRender();
+        glFinish();
+    }
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / frames;
+}
+
+// 实例化和逐个绘制各自在帧预算内能画的最大实例数：先翻倍找到超出预算的数量，再二分到 5% 以内
+static bool findInstancesAtFps(const BenchmarkOptions& options, double fps) {
+    HeadlessEGL egl;
+    if (!createHeadlessEGL(options.width, options.height, &egl)) {
+        return false;
+    }
+    invalidateGLStateCache();
+    double budgetMs = 1000.0 / fps;
+    printf("lighting instances within %.2f ms/frame (%.0f fps) at %dx%d on %s\n", budgetMs, fps, options.width,
+           options.height, (const char*)glGetString(GL_RENDERER));
+    bool ok = setupLighting(options.width, options.height);
+    for (int mode = 0; ok && mode < 2; mode++) {
+        bool instancing = mode == 0;
+        lightingRendererSetInstancing(instancing);
+        lightingRendererSetCulling(gCulling);
+        // 第一帧提交实例化变体的编译，等编译和纹理上传完成后再测
+        setLightingInstances(1);
+        lightingRendererRender();
+        glFinish();
+        waitShaderCompileServiceIdle();
+        waitTextureLoaderIdle();
+
+        int passed = 0;
+        double passedMs = 0.0;
+        int failed = 256;
+        double ms;
+        while ((ms = lightingFrameMs(failed)) <= budgetMs && failed < (1 << 22)) {
+            passed = failed;
+            passedMs = ms;
+            failed *= 2;
+        }
+        while (failed - passed > std::max(1, passed / 20)) {
+            int middle = passed + (failed - passed) / 2;
+            ms = lightingFrameMs(middle);
+            if (ms <= budgetMs) {
+                passed = middle;
+                passedMs = ms;
+            } else {
+                failed = middle;
+            }
+        }
+        printf("  %-10s %8d instances (%.3f ms/frame)\n", instancing ? "instanced" : "draw loop", passed, passedMs);
+    }
+    if (!ok) {
+        fprintf(stderr, "lighting: setup failed\n");
+    }
+    lightingRendererSetInstanceCount(0);
+    lightingRendererCleanup();
+    stopShaderCompileService();
+    stopTextureLoader();
+    destroyHeadlessEGL(&egl);
+    return ok;
+}
+
+static void usage(const char* program) {
+    fprintf(stderr, "usage: %s [--renderer triangle|lighting|particles|all] [--frames N] [--warmup N]"
+                    " [--size WxH] [--no-finish] [--verbose]"
+                    " [--gl-checks auto|off|debug-output|sampled|sync] [--texture file.ktx]"
+                    " [--runtime-etc2 fast|normal|high] [--checker-size N] [--stream-budget KB]"
+                    " [--mesh file.mesh] [--mesh-arena] [--camera-distance D] [--lod-threshold PX]"
+                    " [--instances N] [--draw-loop] [--no-cull] [--instances-at-fps FPS]\n", program);
+}
+
+static bool readFile(const char* path, std::vector<unsigned char>* data) {
+    FILE* file = fopen(path, "rb");
+    if (file == nullptr) {
+        perror(path);
+        return false;
+    }
+    unsigned char buffer[65536];
+    size_t n;
+    while ((n = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        data->insert(data->end(), buffer, buffer + n);
+    }
+    fclose(file);
+    return true;
+}
+
+int main(int argc, char** argv) {
+    BenchmarkOptions options = {"all", 600, 60, 1280, 720, true};
+    double instancesAtFps = 0.0;
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (strcmp(arg, "--renderer") == 0 && hasValue) {
+            options.renderer = argv[++i];
+        } else if (strcmp(arg, "--frames") == 0 && hasValue) {
+            options.frames = atoi(argv[++i]);
+        } else if (strcmp(arg, "--warmup") == 0 && hasValue) {
+            options.warmup = atoi(argv[++i]);
+        } else if (strcmp(arg, "--size") == 0 && hasValue) {
+            if (sscanf(argv[++i], "%dx%d", &options.width, &options.height) != 2) {
+                usage(argv[0]);
+                return 2;
+            }
+        } else if (strcmp(arg, "--no-finish") == 0) {
+            options.finish = false;
+        } else if (strcmp(arg, "--gl-checks") == 0 && hasValue) {
+            const char* mode = argv[++i];
+            int index = 0;
+            while (index < GL_CHECK_MODE_NAME_COUNT && strcmp(mode, GL_CHECK_MODE_NAMES[index]) != 0) {
+                index++;
+            }
+            if (index == GL_CHECK_MODE_NAME_COUNT) {
+                usage(argv[0]);
+                return 2;
+            }
+            setGLCheckMode((GLCheckMode)index);
+        } else if (strcmp(arg, "--texture") == 0 && hasValue) {
+            if (!readFile(argv[++i], &gTextureFile)) {
+                return 2;
+            }
+        } else if (strcmp(arg, "--runtime-etc2") == 0 && hasValue) {
+            const char* quality = argv[++i];
+            int index = 0;
+            while (index < ETC2_QUALITY_NAME_COUNT && strcmp(quality, ETC2_QUALITY_NAMES[index]) != 0) {
+                index++;
+            }
+            if (index == ETC2_QUALITY_NAME_COUNT) {
+                usage(argv[0]);
+                return 2;
+            }
+            setTextureLoaderCompression(true, (ETC2Quality)index);
+        } else if (strcmp(arg, "--checker-size") == 0 && hasValue) {
+            gCheckerSize = atoi(argv[++i]);
+            if (gCheckerSize <= 0) {
+                usage(argv[0]);
+                return 2;
+            }
+        } else if (strcmp(arg, "--stream-budget") == 0 && hasValue) {
+            setTextureStreamingBudget((size_t)atoi(argv[++i]) * 1024);
+        } else if (strcmp(arg, "--mesh") == 0 && hasValue) {
+            gMeshPath = argv[++i];
+        } else if (strcmp(arg, "--mesh-arena") == 0) {
+            lightingRendererSetMeshArenaEnabled(true);
+        } else if (strcmp(arg, "--camera-distance") == 0 && hasValue) {
+            gCameraDistance = (float)atof(argv[++i]);
+            if (gCameraDistance <= 0.0f) {
+                usage(argv[0]);
+                return 2;
+            }
+        } else if (strcmp(arg, "--lod-threshold") == 0 && hasValue) {
+            lightingRendererSetLodThreshold((float)atof(argv[++i]));
+        } else if (strcmp(arg, "--instances") == 0 && hasValue) {
+            gInstanceCount = atoi(argv[++i]);
+            if (gInstanceCount < 0) {
+                usage(argv[0]);
+                return 2;
+            }
+        } else if (strcmp(arg, "--draw-loop") == 0) {
+            gDrawLoop = true;
+        } else if (strcmp(arg, "--no-cull") == 0) {
+            gCulling = false;
+        } else if (strcmp(arg, "--instances-at-fps") == 0 && hasValue) {
+            instancesAtFps = atof(argv[++i]);
+            if (instancesAtFps <= 0.0) {
+                usage(argv[0]);
+                return 2;
+            }
+        } else if (strcmp(arg, "--verbose") == 0) {
+            hostLogMinPriority() = ANDROID_LOG_INFO;
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+    if (options.frames <= 0 || options.warmup < 0 || options.width <= 0 || options.height <= 0) {
+        usage(argv[0]);
+        return 2;
+    }
+    if (instancesAtFps > 0.0) {
+        return findInstancesAtFps(options, instancesAtFps) ? 0 : 1;
+    }
+
+    bool ran = false;
+    bool ok = true;
+    for (int i = 0; i < RENDERER_COUNT; i++) {
+        if (strcmp(options.renderer, "all") != 0 && strcmp(options.renderer, RENDERERS[i].name) != 0) {
+            continue;
+        }
+        ran = true;
+        ok = runRenderer(RENDERERS[i], options) && ok;
+    }
+    if (!ran) {
+        fprintf(stderr, "unknown renderer '%s'\n", options.renderer);
+        usage(argv[0]);
+        return 2;
+    }
+    return ok ? 0 : 1;
+}
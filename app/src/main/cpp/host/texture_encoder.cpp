@@ -0,0 +1,150 @@
+//
+// Created by zhangx on 2026/10/16.
+// 离线纹理编码工具（Linux 主机）- 把 PNG 编码为带完整 mip 链的 ETC2 KTX，构建时由 texture_assets 目标调用
+//
+// 用法：texture_encoder [--format auto|rgb|rgba] [--quality fast|normal|high] [--linear] [--no-mipmaps]
+//                       <输入.png> <输出.ktx>
+//   auto（默认）：图像中有不透明度小于 255 的像素时输出 RGBA8_ETC2_EAC（每像素 1 字节），
+//   否则输出 RGB8_ETC2（每像素 0.5 字节），分别是 RGBA8 的 1/4 和 1/8。
+//   --quality 默认 high（离线编码不在乎耗时），fast/normal 与运行时压缩的档位相同。
+//   mip 链在 CPU 上逐级生成（mip_generator.h），默认按 sRGB 颜色在线性空间平均，
+//   法线、遮罩等数据纹理用 --linear 直接平均编码值；运行时不再调用 glGenerateMipmap。
+//   ASTC 用 ARM 的 astcenc 等工具生成 KTX，运行时加载路径相同。
+//
+
+#include <png.h>
+#include "../ktx_container.h"
+#include "../etc2_encoder.h"
+#include "../mip_generator.h"
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+// 与 ETC2Quality 的顺序一致
+static const char* const QUALITY_NAMES[] = {"fast", "normal", "high"};
+static const int QUALITY_NAME_COUNT = sizeof(QUALITY_NAMES) / sizeof(QUALITY_NAMES[0]);
+
+struct EncoderOptions {
+    const char* format;
+    ETC2Quality quality;
+    MipColorSpace colorSpace;
+    bool mipmaps;
+    const char* input;
+    const char* output;
+};
+
+static bool readPNG(const char* path, std::vector<unsigned char>* rgba, int* width, int* height) {
+    png_image image;
+    memset(&image, 0, sizeof(image));
+    image.version = PNG_IMAGE_VERSION;
+    if (!png_image_begin_read_from_file(&image, path)) {
+        fprintf(stderr, "%s: %s\n", path, image.message);
+        return false;
+    }
+    image.format = PNG_FORMAT_RGBA;
+    rgba->resize(PNG_IMAGE_SIZE(image));
+    if (!png_image_finish_read(&image, nullptr, rgba->data(), 0, nullptr)) {
+        fprintf(stderr, "%s: %s\n", path, image.message);
+        png_image_free(&image);
+        return false;
+    }
+    *width = (int)image.width;
+    *height = (int)image.height;
+    return true;
+}
+
+static bool writeFile(const char* path, const std::vector<unsigned char>& data) {
+    FILE* file = fopen(path, "wb");
+    if (file == nullptr) {
+        perror(path);
+        return false;
+    }
+    bool written = fwrite(data.data(), 1, data.size(), file) == data.size();
+    written = fclose(file) == 0 && written;
+    if (!written) {
+        fprintf(stderr, "%s: write failed\n", path);
+    }
+    return written;
+}
+
+static void usage(const char* program) {
+    fprintf(stderr, "usage: %s [--format auto|rgb|rgba] [--quality fast|normal|high] [--linear] [--no-mipmaps]"
+                    " <input.png> <output.ktx>\n", program);
+}
+
+int main(int argc, char** argv) {
+    EncoderOptions options = {"auto", ETC2_QUALITY_HIGH, MIP_COLOR_SRGB, true, nullptr, nullptr};
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        if (strcmp(arg, "--format") == 0 && i + 1 < argc) {
+            options.format = argv[++i];
+        } else if (strcmp(arg, "--quality") == 0 && i + 1 < argc) {
+            const char* quality = argv[++i];
+            int index = 0;
+            while (index < QUALITY_NAME_COUNT && strcmp(quality, QUALITY_NAMES[index]) != 0) {
+                index++;
+            }
+            if (index == QUALITY_NAME_COUNT) {
+                usage(argv[0]);
+                return 1;
+            }
+            options.quality = (ETC2Quality)index;
+        } else if (strcmp(arg, "--linear") == 0) {
+            options.colorSpace = MIP_COLOR_LINEAR;
+        } else if (strcmp(arg, "--no-mipmaps") == 0) {
+            options.mipmaps = false;
+        } else if (arg[0] != '-' && options.input == nullptr) {
+            options.input = arg;
+        } else if (arg[0] != '-' && options.output == nullptr) {
+            options.output = arg;
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (options.input == nullptr || options.output == nullptr) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    std::vector<unsigned char> pixels;
+    int width = 0;
+    int height = 0;
+    if (!readPNG(options.input, &pixels, &width, &height)) {
+        return 1;
+    }
+
+    bool alpha;
+    if (strcmp(options.format, "auto") == 0) {
+        alpha = etc2NeedsAlpha(pixels.data(), width, height);
+    } else if (strcmp(options.format, "rgb") == 0 || strcmp(options.format, "rgba") == 0) {
+        alpha = strcmp(options.format, "rgba") == 0;
+    } else {
+        usage(argv[0]);
+        return 1;
+    }
+    KTXImage source;
+    if (options.mipmaps) {
+        generateMipChain(&pixels, GL_RGBA8, width, height, options.colorSpace, &source);
+    } else {
+        memset(&source, 0, sizeof(source));
+        source.internalFormat = GL_RGBA8;
+        source.width = width;
+        source.height = height;
+        source.levelCount = 1;
+        KTXLevel level = {0, (uint32_t)pixels.size(), width, height};
+        source.levels[0] = level;
+    }
+    std::vector<unsigned char> encoded;
+    KTXImage image;
+    encodeETC2Levels(pixels.data(), source, alpha, options.quality, &encoded, &image);
+
+    std::vector<unsigned char> file;
+    if (!writeKTX(image, encoded.data(), &file) || !writeFile(options.output, file)) {
+        return 1;
+    }
+    printf("%s: %dx%d %s, %d levels, %zu bytes (RGBA8 with the same levels: %zu bytes, %.1fx smaller)\n",
+           options.output, width, height, textureFormatName(image.internalFormat), image.levelCount, file.size(),
+           pixels.size(), (double)pixels.size() / file.size());
+    return 0;
+}
@@ -0,0 +1,409 @@
+//
+// Created by zhangx on 2026/10/16.
+// KTX / KTX2 纹理容器实现
+//
+
+#include "ktx_container.h"
+#include <GLES2/gl2ext.h>
+#include <android/log.h>
+#include <cstring>
+
+#define LOG_TAG "KTXContainer"
+#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
+
+static const unsigned char KTX1_IDENTIFIER[12] = {0xAB, 'K', 'T', 'X', ' ', '1', '1', 0xBB, '\r', '\n', 0x1A, '\n'};
+static const unsigned char KTX2_IDENTIFIER[12] = {0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n'};
+static const uint32_t KTX1_ENDIANNESS = 0x04030201u;
+static const size_t KTX1_HEADER_SIZE = 64;
+static const size_t KTX2_HEADER_SIZE = 80;        // 标识 + 9 个字段 + 索引（dfd/kvd/sgd）
+static const size_t KTX2_LEVEL_INDEX_ENTRY = 24;  // byteOffset, byteLength, uncompressedByteLength（uint64）
+
+// ASTC 的 14 种块尺寸，GL 格式（0x93B0 起 / sRGB 0x93D0 起）和 VkFormat（157 起两两一组）都按这个顺序
+static const unsigned char ASTC_BLOCK_SIZES[14][2] = {
+    {4, 4}, {5, 4}, {5, 5}, {6, 5}, {6, 6}, {8, 5}, {8, 6}, {8, 8},
+    {10, 5}, {10, 6}, {10, 8}, {10, 10}, {12, 10}, {12, 12}
+};
+static const int ASTC_BLOCK_SIZE_COUNT = sizeof(ASTC_BLOCK_SIZES) / sizeof(ASTC_BLOCK_SIZES[0]);
+
+// VkFormat 147..156 对应的 ETC2/EAC 格式
+static const GLenum VK_ETC2_FORMATS[] = {
+    GL_COMPRESSED_RGB8_ETC2, GL_COMPRESSED_SRGB8_ETC2,
+    GL_COMPRESSED_RGB8_PUNCHTHROUGH_ALPHA1_ETC2, GL_COMPRESSED_SRGB8_PUNCHTHROUGH_ALPHA1_ETC2,
+    GL_COMPRESSED_RGBA8_ETC2_EAC, GL_COMPRESSED_SRGB8_ALPHA8_ETC2_EAC,
+    GL_COMPRESSED_R11_EAC, GL_COMPRESSED_SIGNED_R11_EAC,
+    GL_COMPRESSED_RG11_EAC, GL_COMPRESSED_SIGNED_RG11_EAC
+};
+static const uint32_t VK_FORMAT_R8G8B8A8_UNORM = 37;
+static const uint32_t VK_FORMAT_R8G8B8A8_SRGB = 43;
+static const uint32_t VK_FORMAT_ETC2_FIRST = 147;
+static const uint32_t VK_FORMAT_ASTC_FIRST = 157;
+
+static uint32_t readU32(const unsigned char* p) {
+    uint32_t value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+static uint64_t readU64(const unsigned char* p) {
+    uint64_t value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+static void appendU32(std::vector<unsigned char>* out, uint32_t value) {
+    const unsigned char* bytes = (const unsigned char*)&value;
+    out->insert(out->end(), bytes, bytes + sizeof(value));
+}
+
+static GLenum glFormatFromVk(uint32_t vkFormat) {
+    if (vkFormat == VK_FORMAT_R8G8B8A8_UNORM || vkFormat == VK_FORMAT_R8G8B8A8_SRGB) {
+        return vkFormat == VK_FORMAT_R8G8B8A8_SRGB ? GL_SRGB8_ALPHA8 : GL_RGBA8;
+    }
+    if (vkFormat >= VK_FORMAT_ETC2_FIRST && vkFormat < VK_FORMAT_ASTC_FIRST) {
+        return VK_ETC2_FORMATS[vkFormat - VK_FORMAT_ETC2_FIRST];
+    }
+    if (vkFormat >= VK_FORMAT_ASTC_FIRST && vkFormat < VK_FORMAT_ASTC_FIRST + ASTC_BLOCK_SIZE_COUNT * 2) {
+        uint32_t index = vkFormat - VK_FORMAT_ASTC_FIRST;
+        GLenum first = index % 2 == 0 ? GL_COMPRESSED_RGBA_ASTC_4x4_KHR : GL_COMPRESSED_SRGB8_ALPHA8_ASTC_4x4_KHR;
+        return first + index / 2;
+    }
+    return 0;
+}
+
+bool compressedBlockInfo(GLenum internalFormat, int* blockWidth, int* blockHeight, int* blockBytes) {
+    switch (internalFormat) {
+        case GL_COMPRESSED_RGB8_ETC2:
+        case GL_COMPRESSED_SRGB8_ETC2:
+        case GL_COMPRESSED_RGB8_PUNCHTHROUGH_ALPHA1_ETC2:
+        case GL_COMPRESSED_SRGB8_PUNCHTHROUGH_ALPHA1_ETC2:
+        case GL_COMPRESSED_R11_EAC:
+        case GL_COMPRESSED_SIGNED_R11_EAC:
+            *blockWidth = 4;
+            *blockHeight = 4;
+            *blockBytes = 8;
+            return true;
+        case GL_COMPRESSED_RGBA8_ETC2_EAC:
+        case GL_COMPRESSED_SRGB8_ALPHA8_ETC2_EAC:
+        case GL_COMPRESSED_RG11_EAC:
+        case GL_COMPRESSED_SIGNED_RG11_EAC:
+            *blockWidth = 4;
+            *blockHeight = 4;
+            *blockBytes = 16;
+            return true;
+        default:
+            break;
+    }
+    // ASTC 每块都是 16 字节
+    for (int base = 0; base < 2; base++) {
+        GLenum first = base == 0 ? GL_COMPRESSED_RGBA_ASTC_4x4_KHR : GL_COMPRESSED_SRGB8_ALPHA8_ASTC_4x4_KHR;
+        if (internalFormat >= first && internalFormat < first + ASTC_BLOCK_SIZE_COUNT) {
+            *blockWidth = ASTC_BLOCK_SIZES[internalFormat - first][0];
+            *blockHeight = ASTC_BLOCK_SIZES[internalFormat - first][1];
+            *blockBytes = 16;
+            return true;
+        }
+    }
+    return false;
+}
+
+size_t compressedLevelSize(GLenum internalFormat, int width, int height) {
+    int blockWidth, blockHeight, blockBytes;
+    if (!compressedBlockInfo(internalFormat, &blockWidth, &blockHeight, &blockBytes)) {
+        return 0;
+    }
+    size_t blocksX = (size_t)(width + blockWidth - 1) / blockWidth;
+    size_t blocksY = (size_t)(height + blockHeight - 1) / blockHeight;
+    return blocksX * blocksY * blockBytes;
+}
+
+// 未压缩格式：KTX1 的 glFormat / glType / glTypeSize 与上传时的 format / type 相同
+struct UncompressedFormat {
+    GLenum internalFormat;
+    GLenum format;
+    GLenum type;
+    int typeSize;
+    int bytesPerPixel;
+};
+
+static const UncompressedFormat UNCOMPRESSED_FORMATS[] = {
+    {GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE, 1, 4},
+    {GL_SRGB8_ALPHA8, GL_RGBA, GL_UNSIGNED_BYTE, 1, 4},
+    {GL_RGB565, GL_RGB, GL_UNSIGNED_SHORT_5_6_5, 2, 2},
+    {GL_R8, GL_RED, GL_UNSIGNED_BYTE, 1, 1},
+    {GL_RGBA16F, GL_RGBA, GL_HALF_FLOAT, 2, 8},
+};
+static const int UNCOMPRESSED_FORMAT_COUNT = sizeof(UNCOMPRESSED_FORMATS) / sizeof(UNCOMPRESSED_FORMATS[0]);
+
+static const UncompressedFormat* findUncompressedFormat(GLenum internalFormat) {
+    for (int i = 0; i < UNCOMPRESSED_FORMAT_COUNT; i++) {
+        if (UNCOMPRESSED_FORMATS[i].internalFormat == internalFormat) {
+            return &UNCOMPRESSED_FORMATS[i];
+        }
+    }
+    return nullptr;
+}
+
+bool uncompressedFormatInfo(GLenum internalFormat, GLenum* format, GLenum* type, int* bytesPerPixel) {
+    const UncompressedFormat* info = findUncompressedFormat(internalFormat);
+    if (info == nullptr) {
+        return false;
+    }
+    *format = info->format;
+    *type = info->type;
+    *bytesPerPixel = info->bytesPerPixel;
+    return true;
+}
+
+size_t textureRowSize(GLenum internalFormat, int width) {
+    const UncompressedFormat* info = findUncompressedFormat(internalFormat);
+    if (info == nullptr) {
+        return 0;
+    }
+    return ((size_t)width * info->bytesPerPixel + 3) & ~(size_t)3;
+}
+
+size_t textureLevelSize(GLenum internalFormat, int width, int height) {
+    if (findUncompressedFormat(internalFormat) != nullptr) {
+        return textureRowSize(internalFormat, width) * height;
+    }
+    return compressedLevelSize(internalFormat, width, height);
+}
+
+const char* textureFormatName(GLenum internalFormat) {
+    switch (internalFormat) {
+        case GL_RGBA8: return "RGBA8";
+        case GL_SRGB8_ALPHA8: return "sRGB8 A8";
+        case GL_RGB565: return "RGB565";
+        case GL_R8: return "R8";
+        case GL_RGBA16F: return "RGBA16F";
+        case GL_COMPRESSED_RGB8_ETC2: return "ETC2 RGB8";
+        case GL_COMPRESSED_SRGB8_ETC2: return "ETC2 sRGB8";
+        case GL_COMPRESSED_RGB8_PUNCHTHROUGH_ALPHA1_ETC2: return "ETC2 RGB8A1";
+        case GL_COMPRESSED_SRGB8_PUNCHTHROUGH_ALPHA1_ETC2: return "ETC2 sRGB8A1";
+        case GL_COMPRESSED_RGBA8_ETC2_EAC: return "ETC2 RGBA8 EAC";
+        case GL_COMPRESSED_SRGB8_ALPHA8_ETC2_EAC: return "ETC2 sRGB8 A8 EAC";
+        case GL_COMPRESSED_R11_EAC: return "EAC R11";
+        case GL_COMPRESSED_SIGNED_R11_EAC: return "EAC signed R11";
+        case GL_COMPRESSED_RG11_EAC: return "EAC RG11";
+        case GL_COMPRESSED_SIGNED_RG11_EAC: return "EAC signed RG11";
+        default: break;
+    }
+    int blockWidth, blockHeight, blockBytes;
+    if (compressedBlockInfo(internalFormat, &blockWidth, &blockHeight, &blockBytes)) {
+        return internalFormat >= GL_COMPRESSED_SRGB8_ALPHA8_ASTC_4x4_KHR ? "ASTC sRGB" : "ASTC";
+    }
+    return "unknown";
+}
+
+// 按第 0 级尺寸填好各级的宽高，检查级数
+static bool initLevels(KTXImage* image, uint32_t levelCount) {
+    if (image->width <= 0 || image->height <= 0 || levelCount == 0 || levelCount > KTX_MAX_LEVELS) {
+        LOGE("Unsupported texture size %dx%d with %u levels", image->width, image->height, levelCount);
+        return false;
+    }
+    image->levelCount = (int)levelCount;
+    for (int level = 0; level < image->levelCount; level++) {
+        int width = image->width >> level;
+        int height = image->height >> level;
+        if (width == 0 && height == 0) {
+            LOGE("%u levels is more than a full mip chain for %dx%d", levelCount, image->width, image->height);
+            return false;
+        }
+        image->levels[level].width = width > 0 ? width : 1;
+        image->levels[level].height = height > 0 ? height : 1;
+    }
+    return true;
+}
+
+static bool checkLevel(const KTXImage& image, int level, uint64_t offset, uint64_t size, size_t fileSize) {
+    const KTXLevel& info = image.levels[level];
+    size_t expected = textureLevelSize(image.internalFormat, info.width, info.height);
+    if (size != expected) {
+        LOGE("Level %d is %llu bytes, expected %zu for %dx%d", level, (unsigned long long)size, expected,
+             info.width, info.height);
+        return false;
+    }
+    if (offset > fileSize || size > fileSize - offset) {
+        LOGE("Level %d extends past the end of the file", level);
+        return false;
+    }
+    return true;
+}
+
+static bool parseKTX1(const unsigned char* bytes, size_t size, KTXImage* image) {
+    if (size < KTX1_HEADER_SIZE) {
+        LOGE("KTX header truncated");
+        return false;
+    }
+    if (readU32(bytes + 12) != KTX1_ENDIANNESS) {
+        LOGE("Big-endian KTX files are not supported");
+        return false;
+    }
+    uint32_t glType = readU32(bytes + 16);
+    uint32_t glFormat = readU32(bytes + 24);
+    uint32_t glInternalFormat = readU32(bytes + 28);
+    uint32_t pixelDepth = readU32(bytes + 44);
+    uint32_t arrayElements = readU32(bytes + 48);
+    uint32_t faces = readU32(bytes + 52);
+    uint32_t levelCount = readU32(bytes + 56);
+    uint32_t keyValueBytes = readU32(bytes + 60);
+    // 压缩格式的 glType 为 0；未压缩的 glFormat / glType 必须与表中的格式一致
+    const UncompressedFormat* uncompressed = findUncompressedFormat(glInternalFormat);
+    bool matched = uncompressed != nullptr && glType == uncompressed->type && glFormat == uncompressed->format;
+    if ((glType != 0 && !matched) || pixelDepth != 0 || arrayElements != 0 || faces != 1) {
+        LOGE("Only single compressed or uncompressed 2D textures are supported "
+             "(type 0x%x, depth %u, layers %u, faces %u)",
+             glType, pixelDepth, arrayElements, faces);
+        return false;
+    }
+    image->internalFormat = glInternalFormat;
+    image->width = (int)readU32(bytes + 36);
+    image->height = (int)readU32(bytes + 40);
+    // 0 表示由加载方生成 mip，这里按只有一级处理
+    if (!initLevels(image, levelCount > 0 ? levelCount : 1)) {
+        return false;
+    }
+
+    // 每级：uint32_t imageSize + 数据，补齐到 4 字节
+    size_t offset = KTX1_HEADER_SIZE + keyValueBytes;
+    for (int level = 0; level < image->levelCount; level++) {
+        if (offset > size || size - offset < 4) {
+            LOGE("Level %d size field past the end of the file", level);
+            return false;
+        }
+        uint32_t levelSize = readU32(bytes + offset);
+        offset += 4;
+        if (!checkLevel(*image, level, offset, levelSize, size)) {
+            return false;
+        }
+        image->levels[level].offset = (uint32_t)offset;
+        image->levels[level].size = levelSize;
+        offset += (levelSize + 3u) & ~3u;
+    }
+    return true;
+}
+
+static bool parseKTX2(const unsigned char* bytes, size_t size, KTXImage* image) {
+    if (size < KTX2_HEADER_SIZE) {
+        LOGE("KTX2 header truncated");
+        return false;
+    }
+    uint32_t vkFormat = readU32(bytes + 12);
+    uint32_t pixelDepth = readU32(bytes + 28);
+    uint32_t layerCount = readU32(bytes + 32);
+    uint32_t faceCount = readU32(bytes + 36);
+    uint32_t levelCount = readU32(bytes + 40);
+    uint32_t supercompression = readU32(bytes + 44);
+    if (pixelDepth != 0 || layerCount != 0 || faceCount != 1) {
+        LOGE("Only single 2D textures are supported (depth %u, layers %u, faces %u)", pixelDepth, layerCount,
+             faceCount);
+        return false;
+    }
+    if (supercompression != 0) {
+        LOGE("Supercompressed KTX2 (scheme %u) is not supported, encode without Basis/zstd", supercompression);
+        return false;
+    }
+    image->internalFormat = glFormatFromVk(vkFormat);
+    if (image->internalFormat == 0) {
+        LOGE("Unsupported VkFormat %u, expected ETC2/EAC, ASTC or RGBA8", vkFormat);
+        return false;
+    }
+    image->width = (int)readU32(bytes + 20);
+    image->height = (int)readU32(bytes + 24);
+    if (!initLevels(image, levelCount > 0 ? levelCount : 1)) {
+        return false;
+    }
+    if (size - KTX2_HEADER_SIZE < (size_t)image->levelCount * KTX2_LEVEL_INDEX_ENTRY) {
+        LOGE("KTX2 level index truncated");
+        return false;
+    }
+    for (int level = 0; level < image->levelCount; level++) {
+        const unsigned char* entry = bytes + KTX2_HEADER_SIZE + level * KTX2_LEVEL_INDEX_ENTRY;
+        uint64_t offset = readU64(entry);
+        uint64_t length = readU64(entry + 8);
+        if (!checkLevel(*image, level, offset, length, size)) {
+            return false;
+        }
+        image->levels[level].offset = (uint32_t)offset;
+        image->levels[level].size = (uint32_t)length;
+    }
+    return true;
+}
+
+bool parseKTX(const void* data, size_t size, KTXImage* image) {
+    const unsigned char* bytes = (const unsigned char*)data;
+    memset(image, 0, sizeof(*image));
+    bool parsed = false;
+    if (size >= sizeof(KTX1_IDENTIFIER) && memcmp(bytes, KTX1_IDENTIFIER, sizeof(KTX1_IDENTIFIER)) == 0) {
+        parsed = parseKTX1(bytes, size, image);
+    } else if (size >= sizeof(KTX2_IDENTIFIER) && memcmp(bytes, KTX2_IDENTIFIER, sizeof(KTX2_IDENTIFIER)) == 0) {
+        parsed = parseKTX2(bytes, size, image);
+    } else {
+        LOGE("Not a KTX or KTX2 file");
+        return false;
+    }
+    if (!parsed) {
+        return false;
+    }
+    if (textureLevelSize(image->internalFormat, 1, 1) == 0) {
+        LOGE("Unsupported internal format 0x%x, expected ETC2/EAC, ASTC, RGBA8, RGB565, R8 or RGBA16F",
+             image->internalFormat);
+        return false;
+    }
+    return true;
+}
+
+bool writeKTX(const KTXImage& image, const void* data, std::vector<unsigned char>* out) {
+    GLenum internalFormat = image.internalFormat;
+    if (image.levelCount <= 0 || image.levelCount > KTX_MAX_LEVELS) {
+        LOGE("Cannot write %d levels", image.levelCount);
+        return false;
+    }
+    for (int level = 0; level < image.levelCount; level++) {
+        int levelWidth = image.width >> level > 0 ? image.width >> level : 1;
+        int levelHeight = image.height >> level > 0 ? image.height >> level : 1;
+        const KTXLevel& info = image.levels[level];
+        size_t expected = textureLevelSize(internalFormat, levelWidth, levelHeight);
+        if (info.width != levelWidth || info.height != levelHeight || info.size != expected) {
+            LOGE("Level %d is %dx%d with %u bytes, expected %dx%d with %zu", level, info.width, info.height,
+                 info.size, levelWidth, levelHeight, expected);
+            return false;
+        }
+    }
+
+    const UncompressedFormat* uncompressed = findUncompressedFormat(internalFormat);
+    GLenum baseFormat = GL_RGBA;
+    if (uncompressed != nullptr) {
+        baseFormat = uncompressed->format;
+    } else if (internalFormat == GL_COMPRESSED_RGB8_ETC2 || internalFormat == GL_COMPRESSED_SRGB8_ETC2) {
+        baseFormat = GL_RGB;
+    } else if (internalFormat == GL_COMPRESSED_R11_EAC || internalFormat == GL_COMPRESSED_SIGNED_R11_EAC) {
+        baseFormat = GL_RED;
+    } else if (internalFormat == GL_COMPRESSED_RG11_EAC || internalFormat == GL_COMPRESSED_SIGNED_RG11_EAC) {
+        baseFormat = GL_RG;
+    }
+
+    out->clear();
+    out->insert(out->end(), KTX1_IDENTIFIER, KTX1_IDENTIFIER + sizeof(KTX1_IDENTIFIER));
+    appendU32(out, KTX1_ENDIANNESS);
+    appendU32(out, uncompressed != nullptr ? uncompressed->type : 0);       // glType：压缩格式为 0
+    appendU32(out, uncompressed != nullptr ? uncompressed->typeSize : 1);   // glTypeSize
+    appendU32(out, uncompressed != nullptr ? uncompressed->format : 0);     // glFormat：压缩格式为 0
+    appendU32(out, internalFormat);
+    appendU32(out, baseFormat);
+    appendU32(out, (uint32_t)image.width);
+    appendU32(out, (uint32_t)image.height);
+    appendU32(out, 0);               // pixelDepth
+    appendU32(out, 0);               // numberOfArrayElements
+    appendU32(out, 1);               // numberOfFaces
+    appendU32(out, (uint32_t)image.levelCount);
+    appendU32(out, 0);               // bytesOfKeyValueData
+    for (int level = 0; level < image.levelCount; level++) {
+        const KTXLevel& info = image.levels[level];
+        const unsigned char* bytes = (const unsigned char*)data + info.offset;
+        appendU32(out, info.size);
+        out->insert(out->end(), bytes, bytes + info.size);
+        out->resize((out->size() + 3) & ~(size_t)3, 0);
+    }
+    return true;
+}
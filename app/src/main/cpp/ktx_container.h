@@ -0,0 +1,56 @@
+//
+// Created by zhangx on 2026/10/16.
+// KTX / KTX2 纹理容器 - 解析预先压缩（ETC2/EAC、ASTC）并带 mip 链的 2D 纹理，离线编码工具用它写出 KTX；
+// 也接受未压缩的 RGBA8 / RGB565 / R8 / RGBA16F mip 链（纹理加载器把 CPU 生成的 mip 链缓存成这种文件，
+// KTX2 只接受其中的 RGBA8）
+//
+// 只处理字节布局，不调用 GL：上传见 texture_loader.h 的 requestKTXTextureAsync
+//
+
+#ifndef NDKLEARN2_KTX_CONTAINER_H
+#define NDKLEARN2_KTX_CONTAINER_H
+
+#include <GLES3/gl3.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+static const int KTX_MAX_LEVELS = 16;
+
+struct KTXLevel {
+    uint32_t offset;  // 压缩数据相对文件开头的偏移
+    uint32_t size;
+    int width;
+    int height;
+};
+
+struct KTXImage {
+    GLenum internalFormat;  // GL 压缩格式（例如 GL_COMPRESSED_RGB8_ETC2），或 uncompressedFormatInfo 认识的未压缩格式
+    int width;
+    int height;
+    int levelCount;
+    KTXLevel levels[KTX_MAX_LEVELS];  // 第 0 级最大
+};
+
+// 解析 KTX 1.1 或 KTX2 文件；只接受单张 2D 纹理（无数组层、非立方体、KTX2 无超压缩），
+// 每一级的大小必须与格式和尺寸一致。失败时输出原因并返回 false
+bool parseKTX(const void* data, size_t size, KTXImage* image);
+
+// 压缩格式的块尺寸和每块字节数，不认识的格式（包括 RGBA8）返回 false
+bool compressedBlockInfo(GLenum internalFormat, int* blockWidth, int* blockHeight, int* blockBytes);
+// 一级压缩数据的字节数，不认识的格式返回 0
+size_t compressedLevelSize(GLenum internalFormat, int width, int height);
+// 未压缩格式（GL_RGBA8、GL_SRGB8_ALPHA8、GL_RGB565、GL_R8、GL_RGBA16F）上传用的 format / type 和每像素字节数，
+// 其余格式返回 false
+bool uncompressedFormatInfo(GLenum internalFormat, GLenum* format, GLenum* type, int* bytesPerPixel);
+// 一级数据的字节数：压缩格式同上；未压缩格式的每行补齐到 4 字节（KTX1 的行填充，也是 GL_UNPACK_ALIGNMENT
+// 的默认值），其余格式返回 0
+size_t textureLevelSize(GLenum internalFormat, int width, int height);
+// 未压缩格式一行的字节数（补齐到 4 字节），其余格式返回 0
+size_t textureRowSize(GLenum internalFormat, int width);
+const char* textureFormatName(GLenum internalFormat);
+
+// 写出 KTX 1.1 文件，image 描述各级在 data 中的偏移（每级大小必须与格式和尺寸一致）
+bool writeKTX(const KTXImage& image, const void* data, std::vector<unsigned char>* out);
+
+#endif //NDKLEARN2_KTX_CONTAINER_H
@@ -0,0 +1,271 @@
+//
+// Created by zhangx on 2026/10/16.
+// 二进制网格容器实现
+//
+
+#include "mesh_container.h"
+#include <android/log.h>
+#include <cstring>
+
+#define LOG_TAG "MeshContainer"
+#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
+
+static const size_t MESH_HEADER_SIZE = 64;
+static const size_t MESH_ATTRIBUTE_ENTRY = 20;
+static const size_t MESH_LOD_ENTRY = 12;
+static const size_t MESH_SUBMESH_ENTRY = 4 + MESH_MAX_LODS * MESH_LOD_ENTRY + 24 + MESH_NAME_LENGTH;
+static const size_t MESH_SUBMESH_ENTRY_SINGLE_LOD = 8 + 24 + MESH_NAME_LENGTH;
+static const size_t MESH_VERTEX_ALIGNMENT = 16;
+
+static uint32_t readU32(const unsigned char* p) {
+    uint32_t value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+static float readF32(const unsigned char* p) {
+    float value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+static void appendU32(std::vector<unsigned char>* out, uint32_t value) {
+    const unsigned char* bytes = (const unsigned char*)&value;
+    out->insert(out->end(), bytes, bytes + sizeof(value));
+}
+
+static void appendF32(std::vector<unsigned char>* out, float value) {
+    const unsigned char* bytes = (const unsigned char*)&value;
+    out->insert(out->end(), bytes, bytes + sizeof(value));
+}
+
+static void appendPadding(std::vector<unsigned char>* out, size_t alignment) {
+    out->resize((out->size() + alignment - 1) / alignment * alignment, 0);
+}
+
+static bool isIntegerType(GLenum type) {
+    return type == GL_BYTE || type == GL_UNSIGNED_BYTE || type == GL_SHORT || type == GL_UNSIGNED_SHORT
+           || type == GL_INT || type == GL_UNSIGNED_INT;
+}
+
+static size_t indexSize(GLenum indexType) {
+    return indexType == GL_UNSIGNED_SHORT ? 2 : (indexType == GL_UNSIGNED_INT ? 4 : 0);
+}
+
+size_t meshAttributeSize(GLenum type, int components) {
+    if (components < 1 || components > 4) {
+        return 0;
+    }
+    switch (type) {
+        case GL_BYTE:
+        case GL_UNSIGNED_BYTE:
+            return (size_t)components;
+        case GL_SHORT:
+        case GL_UNSIGNED_SHORT:
+        case GL_HALF_FLOAT:
+            return (size_t)components * 2;
+        case GL_INT:
+        case GL_UNSIGNED_INT:
+        case GL_FLOAT:
+            return (size_t)components * 4;
+        case GL_INT_2_10_10_10_REV:
+        case GL_UNSIGNED_INT_2_10_10_10_REV:
+            return components == 4 ? 4 : 0;
+        default:
+            return 0;
+    }
+}
+
+static bool checkAttribute(const MeshAttribute& attribute, uint32_t stride) {
+    size_t size = meshAttributeSize(attribute.type, attribute.components);
+    if (size == 0 || attribute.location >= (uint32_t)MESH_MAX_ATTRIBUTES) {
+        LOGE("Unsupported attribute at location %u (type 0x%x, %d components)", attribute.location, attribute.type,
+             attribute.components);
+        return false;
+    }
+    if ((uint64_t)attribute.offset + size > stride) {
+        LOGE("Attribute at location %u extends past the %u byte vertex", attribute.location, stride);
+        return false;
+    }
+    if ((attribute.flags & MESH_ATTRIBUTE_INTEGER) != 0
+        && (!isIntegerType(attribute.type) || (attribute.flags & MESH_ATTRIBUTE_NORMALIZED) != 0)) {
+        LOGE("Integer attribute at location %u must be an unnormalized integer type", attribute.location);
+        return false;
+    }
+    return true;
+}
+
+bool parseMeshFile(const void* data, size_t size, MeshFile* mesh) {
+    const unsigned char* bytes = (const unsigned char*)data;
+    if (size < MESH_HEADER_SIZE || readU32(bytes) != MESH_FILE_MAGIC) {
+        LOGE("Not a mesh file");
+        return false;
+    }
+    uint32_t version = readU32(bytes + 4);
+    if (version != MESH_FILE_VERSION && version != MESH_FILE_VERSION_SINGLE_LOD) {
+        LOGE("Mesh file version %u, expected %u", version, MESH_FILE_VERSION);
+        return false;
+    }
+    bool singleLod = version == MESH_FILE_VERSION_SINGLE_LOD;
+    size_t submeshEntry = singleLod ? MESH_SUBMESH_ENTRY_SINGLE_LOD : MESH_SUBMESH_ENTRY;
+    memset(mesh, 0, sizeof(*mesh));
+    mesh->vertexCount = readU32(bytes + 8);
+    mesh->vertexStride = readU32(bytes + 12);
+    uint32_t attributeCount = readU32(bytes + 16);
+    mesh->indexType = readU32(bytes + 20);
+    mesh->indexCount = readU32(bytes + 24);
+    uint32_t submeshCount = readU32(bytes + 28);
+    uint32_t vertexOffset = readU32(bytes + 32);
+    uint32_t indexOffset = readU32(bytes + 36);
+    for (int i = 0; i < 3; i++) {
+        mesh->boundsMin[i] = readF32(bytes + 40 + i * 4);
+        mesh->boundsMax[i] = readF32(bytes + 52 + i * 4);
+    }
+
+    if (attributeCount == 0 || attributeCount > (uint32_t)MESH_MAX_ATTRIBUTES
+        || submeshCount > (uint32_t)MESH_MAX_SUBMESHES || mesh->vertexStride == 0
+        || indexSize(mesh->indexType) == 0) {
+        LOGE("Unsupported mesh: %u attributes, %u submeshes, stride %u, index type 0x%x", attributeCount,
+             submeshCount, mesh->vertexStride, mesh->indexType);
+        return false;
+    }
+    size_t tables = MESH_HEADER_SIZE + attributeCount * MESH_ATTRIBUTE_ENTRY + submeshCount * submeshEntry;
+    if (tables > size) {
+        LOGE("Mesh tables truncated");
+        return false;
+    }
+    mesh->attributeCount = (int)attributeCount;
+    const unsigned char* entry = bytes + MESH_HEADER_SIZE;
+    for (uint32_t i = 0; i < attributeCount; i++, entry += MESH_ATTRIBUTE_ENTRY) {
+        MeshAttribute& attribute = mesh->attributes[i];
+        attribute.location = readU32(entry);
+        attribute.components = (int)readU32(entry + 4);
+        attribute.type = readU32(entry + 8);
+        attribute.flags = readU32(entry + 12);
+        attribute.offset = readU32(entry + 16);
+        if (!checkAttribute(attribute, mesh->vertexStride)) {
+            return false;
+        }
+    }
+    mesh->submeshCount = (int)submeshCount;
+    for (uint32_t i = 0; i < submeshCount; i++, entry += submeshEntry) {
+        MeshSubmesh& submesh = mesh->submeshes[i];
+        const unsigned char* bounds;
+        if (singleLod) {
+            // 版本 1：{ firstIndex, indexCount } 作为 LOD 0，其余 LOD 保持为 0（memset）
+            submesh.lodCount = 1;
+            submesh.lods[0].firstIndex = readU32(entry);
+            submesh.lods[0].indexCount = readU32(entry + 4);
+            bounds = entry + 8;
+        } else {
+            submesh.lodCount = (int)readU32(entry);
+            const unsigned char* lodEntry = entry + 4;
+            for (int j = 0; j < MESH_MAX_LODS; j++, lodEntry += MESH_LOD_ENTRY) {
+                submesh.lods[j].firstIndex = readU32(lodEntry);
+                submesh.lods[j].indexCount = readU32(lodEntry + 4);
+                submesh.lods[j].error = readF32(lodEntry + 8);
+            }
+            bounds = entry + 4 + MESH_MAX_LODS * MESH_LOD_ENTRY;
+        }
+        for (int j = 0; j < 3; j++) {
+            submesh.boundsMin[j] = readF32(bounds + j * 4);
+            submesh.boundsMax[j] = readF32(bounds + 12 + j * 4);
+        }
+        memcpy(submesh.name, bounds + 24, MESH_NAME_LENGTH);
+        submesh.name[MESH_NAME_LENGTH - 1] = 0;
+        if (submesh.lodCount < 1 || submesh.lodCount > MESH_MAX_LODS) {
+            LOGE("Submesh %u (%s) has %d LODs", i, submesh.name, submesh.lodCount);
+            return false;
+        }
+        for (int j = 0; j < submesh.lodCount; j++) {
+            if ((uint64_t)submesh.lods[j].firstIndex + submesh.lods[j].indexCount > mesh->indexCount) {
+                LOGE("LOD %d of submesh %u (%s) extends past the %u indices", j, i, submesh.name,
+                     mesh->indexCount);
+                return false;
+            }
+        }
+    }
+
+    uint64_t vertexBytes = (uint64_t)mesh->vertexCount * mesh->vertexStride;
+    uint64_t indexBytes = (uint64_t)mesh->indexCount * indexSize(mesh->indexType);
+    if (vertexOffset < tables || vertexOffset + vertexBytes > size || indexOffset < tables
+        || indexOffset + indexBytes > size || indexOffset % 4 != 0) {
+        LOGE("Mesh data extends past the end of the file");
+        return false;
+    }
+    mesh->vertices = bytes + vertexOffset;
+    mesh->indices = bytes + indexOffset;
+    return true;
+}
+
+bool writeMeshFile(const MeshFile& mesh, std::vector<unsigned char>* out) {
+    if (mesh.attributeCount <= 0 || mesh.attributeCount > MESH_MAX_ATTRIBUTES || mesh.submeshCount < 0
+        || mesh.submeshCount > MESH_MAX_SUBMESHES || mesh.vertexStride == 0 || indexSize(mesh.indexType) == 0) {
+        LOGE("Cannot write mesh with %d attributes and %d submeshes", mesh.attributeCount, mesh.submeshCount);
+        return false;
+    }
+    for (int i = 0; i < mesh.attributeCount; i++) {
+        if (!checkAttribute(mesh.attributes[i], mesh.vertexStride)) {
+            return false;
+        }
+    }
+    size_t tables = MESH_HEADER_SIZE + mesh.attributeCount * MESH_ATTRIBUTE_ENTRY
+                    + mesh.submeshCount * MESH_SUBMESH_ENTRY;
+    size_t vertexOffset = (tables + MESH_VERTEX_ALIGNMENT - 1) / MESH_VERTEX_ALIGNMENT * MESH_VERTEX_ALIGNMENT;
+    size_t vertexBytes = (size_t)mesh.vertexCount * mesh.vertexStride;
+    size_t indexOffset = (vertexOffset + vertexBytes + 3) / 4 * 4;
+    size_t indexBytes = (size_t)mesh.indexCount * indexSize(mesh.indexType);
+
+    out->clear();
+    out->reserve(indexOffset + indexBytes);
+    appendU32(out, MESH_FILE_MAGIC);
+    appendU32(out, MESH_FILE_VERSION);
+    appendU32(out, mesh.vertexCount);
+    appendU32(out, mesh.vertexStride);
+    appendU32(out, (uint32_t)mesh.attributeCount);
+    appendU32(out, mesh.indexType);
+    appendU32(out, mesh.indexCount);
+    appendU32(out, (uint32_t)mesh.submeshCount);
+    appendU32(out, (uint32_t)vertexOffset);
+    appendU32(out, (uint32_t)indexOffset);
+    for (int i = 0; i < 3; i++) {
+        appendF32(out, mesh.boundsMin[i]);
+    }
+    for (int i = 0; i < 3; i++) {
+        appendF32(out, mesh.boundsMax[i]);
+    }
+    for (int i = 0; i < mesh.attributeCount; i++) {
+        const MeshAttribute& attribute = mesh.attributes[i];
+        appendU32(out, attribute.location);
+        appendU32(out, (uint32_t)attribute.components);
+        appendU32(out, attribute.type);
+        appendU32(out, attribute.flags);
+        appendU32(out, attribute.offset);
+    }
+    for (int i = 0; i < mesh.submeshCount; i++) {
+        const MeshSubmesh& submesh = mesh.submeshes[i];
+        appendU32(out, (uint32_t)submesh.lodCount);
+        for (int j = 0; j < MESH_MAX_LODS; j++) {
+            const MeshLod lod = j < submesh.lodCount ? submesh.lods[j] : MeshLod{0, 0, 0.0f};
+            appendU32(out, lod.firstIndex);
+            appendU32(out, lod.indexCount);
+            appendF32(out, lod.error);
+        }
+        for (int j = 0; j < 3; j++) {
+            appendF32(out, submesh.boundsMin[j]);
+        }
+        for (int j = 0; j < 3; j++) {
+            appendF32(out, submesh.boundsMax[j]);
+        }
+        char name[MESH_NAME_LENGTH] = {};
+        strncpy(name, submesh.name, MESH_NAME_LENGTH - 1);
+        out->insert(out->end(), name, name + MESH_NAME_LENGTH);
+    }
+    appendPadding(out, MESH_VERTEX_ALIGNMENT);
+    const unsigned char* vertices = (const unsigned char*)mesh.vertices;
+    out->insert(out->end(), vertices, vertices + vertexBytes);
+    appendPadding(out, 4);
+    const unsigned char* indices = (const unsigned char*)mesh.indices;
+    out->insert(out->end(), indices, indices + indexBytes);
+    return true;
+}
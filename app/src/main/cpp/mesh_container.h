@@ -0,0 +1,88 @@
+//
+// Created by zhangx on 2026/10/16.
+// 二进制网格容器（.mesh）- 文件头、顶点布局、索引类型、子网格和包围盒，顶点和索引数据按 GPU 上的格式原样存放，
+// 加载时映射文件后直接交给 glBufferData（opengl_utils.h 的 loadMeshFile），不经过中间复制。
+// 由主机工具 mesh_converter 从 OBJ 生成，构建时 mesh_assets 目标把 app/src/main/meshes 下的模型转换到 assets/meshes
+//
+// 布局（小端，所有字段 4 字节）：
+//   MeshFileHeader（64 字节）
+//   属性表：attributeCount 个 { location, components, type, flags, offset }，flags 见 MESH_ATTRIBUTE_*
+//   子网格表：submeshCount 个 { lodCount, lods[MESH_MAX_LODS] { firstIndex, indexCount, error },
+//             boundsMin[3], boundsMax[3], name[32] }
+//             版本 1 的子网格表为 { firstIndex, indexCount, boundsMin[3], boundsMax[3], name[32] }，
+//             读取时作为只有 LOD 0 的子网格；写出总是当前版本
+//   顶点数据：vertexOffset 开始（16 字节对齐），vertexCount * vertexStride 字节
+//   索引数据：indexOffset 开始（4 字节对齐），indexCount 个 GL_UNSIGNED_SHORT 或 GL_UNSIGNED_INT，
+//             先是全部子网格的 LOD 0，然后依次是各级简化结果，所有 LOD 引用同一份顶点
+//
+// 只处理字节布局，不调用 GL
+//
+
+#ifndef NDKLEARN2_MESH_CONTAINER_H
+#define NDKLEARN2_MESH_CONTAINER_H
+
+#include <GLES3/gl3.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+static const uint32_t MESH_FILE_MAGIC = 0x48534D4Eu;  // "NMSH"
+static const uint32_t MESH_FILE_VERSION = 2;
+static const uint32_t MESH_FILE_VERSION_SINGLE_LOD = 1;  // 子网格没有 LOD 表的旧版本，仍可读取
+static const int MESH_MAX_ATTRIBUTES = 16;
+static const int MESH_MAX_SUBMESHES = 64;
+static const int MESH_NAME_LENGTH = 32;
+static const int MESH_MAX_LODS = 4;
+
+static const uint32_t MESH_ATTRIBUTE_NORMALIZED = 1;  // 整数类型归一化到 [0, 1] / [-1, 1]
+static const uint32_t MESH_ATTRIBUTE_INTEGER = 2;     // 用 glVertexAttribIPointer，着色器中为 int / uint
+
+struct MeshAttribute {
+    uint32_t location;
+    int components;     // 1 到 4
+    GLenum type;        // GL_FLOAT、GL_HALF_FLOAT、GL_INT_2_10_10_10_REV 或 8/16/32 位整数
+    uint32_t flags;
+    uint32_t offset;    // 在顶点内的字节偏移
+};
+
+// 一级 LOD 的索引范围；error 为简化造成的最大几何误差（模型空间距离），LOD 0 为 0
+struct MeshLod {
+    uint32_t firstIndex;
+    uint32_t indexCount;
+    float error;
+};
+
+struct MeshSubmesh {
+    int lodCount;                 // 1 到 MESH_MAX_LODS，lods[0] 为完整网格，之后的误差递增
+    MeshLod lods[MESH_MAX_LODS];
+    float boundsMin[3];
+    float boundsMax[3];
+    char name[MESH_NAME_LENGTH];  // OBJ 中的 o / g / usemtl 名字，以 0 结尾
+};
+
+struct MeshFile {
+    uint32_t vertexCount;
+    uint32_t vertexStride;
+    int attributeCount;
+    MeshAttribute attributes[MESH_MAX_ATTRIBUTES];
+    GLenum indexType;           // GL_UNSIGNED_SHORT 或 GL_UNSIGNED_INT
+    uint32_t indexCount;
+    int submeshCount;
+    MeshSubmesh submeshes[MESH_MAX_SUBMESHES];
+    float boundsMin[3];
+    float boundsMax[3];
+    const void* vertices;       // parseMeshFile 的结果指向文件数据内部
+    const void* indices;
+};
+
+// 属性在顶点中占的字节数，不认识的类型或分量数返回 0
+size_t meshAttributeSize(GLenum type, int components);
+
+// 校验并解析 .mesh 文件，vertices / indices 指向 data 内部（data 必须在使用期间有效）。
+// 属性越出顶点、数据越出文件、LOD 越出索引范围时输出原因并返回 false；不检查索引值本身
+bool parseMeshFile(const void* data, size_t size, MeshFile* mesh);
+
+// 写出 .mesh 文件，数据来自 mesh.vertices / mesh.indices
+bool writeMeshFile(const MeshFile& mesh, std::vector<unsigned char>* out);
+
+#endif //NDKLEARN2_MESH_CONTAINER_H
@@ -0,0 +1,306 @@
+//
+// Created by zhangx on 2026/10/16.
+// 索引缓冲优化实现
+//
+
+#include "mesh_optimizer.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+// FIFO 缓存：每次未命中时间加 1，顶点在进入缓存后的 cacheSize 次未命中之内仍在缓存中
+struct FIFOCache {
+    std::vector<uint32_t> stamps;
+    uint32_t time;
+    int size;
+};
+
+static void resetCache(FIFOCache* cache, size_t vertexCount, int cacheSize) {
+    cache->stamps.assign(vertexCount, 0);
+    cache->time = (uint32_t)cacheSize + 1;
+    cache->size = cacheSize;
+}
+
+// 清空缓存中的全部顶点：时间前进 cacheSize 即可，不用改写 stamps
+static void flushCache(FIFOCache* cache) {
+    cache->time += (uint32_t)cache->size + 1;
+}
+
+// 返回未命中数（0 或 1）
+static unsigned int touchVertex(FIFOCache* cache, uint32_t vertex) {
+    if (cache->time - cache->stamps[vertex] > (uint32_t)cache->size) {
+        cache->stamps[vertex] = cache->time++;
+        return 1;
+    }
+    return 0;
+}
+
+static unsigned int touchTriangle(FIFOCache* cache, const uint32_t* triangle) {
+    return touchVertex(cache, triangle[0]) + touchVertex(cache, triangle[1]) + touchVertex(cache, triangle[2]);
+}
+
+VertexCacheStats analyzeVertexCache(const uint32_t* indices, size_t indexCount, size_t vertexCount, int cacheSize) {
+    VertexCacheStats stats = {0.0f, 0.0f};
+    if (indexCount < 3) {
+        return stats;
+    }
+    FIFOCache cache;
+    resetCache(&cache, vertexCount, cacheSize);
+    std::vector<bool> used(vertexCount, false);
+    size_t usedCount = 0;
+    size_t misses = 0;
+    for (size_t i = 0; i + 2 < indexCount; i += 3) {
+        misses += touchTriangle(&cache, indices + i);
+        for (int k = 0; k < 3; k++) {
+            if (!used[indices[i + k]]) {
+                used[indices[i + k]] = true;
+                usedCount++;
+            }
+        }
+    }
+    stats.acmr = (float)misses / (float)(indexCount / 3);
+    stats.atvr = (float)misses / (float)usedCount;
+    return stats;
+}
+
+// 死路：最近输出过、还有未输出三角形的顶点优先（可能仍在缓存中），其次按编号顺序找下一个
+static int skipDeadEnd(const std::vector<uint32_t>& live, std::vector<uint32_t>* deadEnds, size_t* cursor) {
+    while (!deadEnds->empty()) {
+        uint32_t vertex = deadEnds->back();
+        deadEnds->pop_back();
+        if (live[vertex] > 0) {
+            return (int)vertex;
+        }
+    }
+    while (*cursor < live.size()) {
+        if (live[*cursor] > 0) {
+            return (int)*cursor;
+        }
+        (*cursor)++;
+    }
+    return -1;
+}
+
+void optimizeVertexCache(uint32_t* indices, size_t indexCount, size_t vertexCount, int cacheSize,
+                         std::vector<uint32_t>* clusters) {
+    size_t triangleCount = indexCount / 3;
+    clusters->clear();
+    if (triangleCount == 0) {
+        return;
+    }
+
+    // 顶点 -> 相邻三角形（CSR）；live 为每个顶点还没输出的三角形数
+    std::vector<uint32_t> live(vertexCount, 0);
+    for (size_t i = 0; i < triangleCount * 3; i++) {
+        live[indices[i]]++;
+    }
+    std::vector<uint32_t> offsets(vertexCount + 1, 0);
+    for (size_t v = 0; v < vertexCount; v++) {
+        offsets[v + 1] = offsets[v] + live[v];
+    }
+    std::vector<uint32_t> adjacency(triangleCount * 3);
+    std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+    for (size_t i = 0; i < triangleCount * 3; i++) {
+        adjacency[fill[indices[i]]++] = (uint32_t)(i / 3);
+    }
+
+    FIFOCache cache;
+    resetCache(&cache, vertexCount, cacheSize);
+    std::vector<bool> emitted(triangleCount, false);
+    std::vector<uint32_t> deadEnds;
+    std::vector<uint32_t> candidates;
+    std::vector<uint32_t> output;
+    output.reserve(triangleCount * 3);
+    size_t cursor = 0;
+
+    int fan = skipDeadEnd(live, &deadEnds, &cursor);
+    clusters->push_back(0);
+    while (fan >= 0) {
+        // 输出以 fan 为中心的全部剩余三角形
+        candidates.clear();
+        for (uint32_t a = offsets[fan]; a < offsets[fan + 1]; a++) {
+            uint32_t triangle = adjacency[a];
+            if (emitted[triangle]) {
+                continue;
+            }
+            emitted[triangle] = true;
+            for (int k = 0; k < 3; k++) {
+                uint32_t vertex = indices[triangle * 3 + k];
+                output.push_back(vertex);
+                deadEnds.push_back(vertex);
+                candidates.push_back(vertex);
+                live[vertex]--;
+                touchVertex(&cache, vertex);
+            }
+        }
+
+        // 下一个中心：扇形输出完之后仍在缓存中的顶点里，进入缓存最早的一个（再晚就会被挤出）
+        int next = -1;
+        int bestPriority = -1;
+        for (size_t c = 0; c < candidates.size(); c++) {
+            uint32_t vertex = candidates[c];
+            if (live[vertex] == 0) {
+                continue;
+            }
+            int age = (int)(cache.time - cache.stamps[vertex]);
+            // 每个剩余三角形最多再引入 2 个新顶点
+            int priority = age + 2 * (int)live[vertex] <= cacheSize ? age : 0;
+            if (priority > bestPriority) {
+                bestPriority = priority;
+                next = (int)vertex;
+            }
+        }
+        if (next < 0) {
+            next = skipDeadEnd(live, &deadEnds, &cursor);
+            if (next >= 0) {
+                clusters->push_back((uint32_t)(output.size() / 3));
+            }
+        }
+        fan = next;
+    }
+    memcpy(indices, output.data(), output.size() * sizeof(uint32_t));
+}
+
+static const float* vertexPosition(const float* positions, size_t positionStride, uint32_t vertex) {
+    return (const float*)((const unsigned char*)positions + vertex * positionStride);
+}
+
+// 三角形的法线（长度为面积的两倍）和重心
+static void triangleNormal(const float* positions, size_t positionStride, const uint32_t* triangle, float* normal,
+                           float* centroid) {
+    const float* a = vertexPosition(positions, positionStride, triangle[0]);
+    const float* b = vertexPosition(positions, positionStride, triangle[1]);
+    const float* c = vertexPosition(positions, positionStride, triangle[2]);
+    float e1[3] = {b[0] - a[0], b[1] - a[1], b[2] - a[2]};
+    float e2[3] = {c[0] - a[0], c[1] - a[1], c[2] - a[2]};
+    normal[0] = e1[1] * e2[2] - e1[2] * e2[1];
+    normal[1] = e1[2] * e2[0] - e1[0] * e2[2];
+    normal[2] = e1[0] * e2[1] - e1[1] * e2[0];
+    for (int k = 0; k < 3; k++) {
+        centroid[k] = (a[k] + b[k] + c[k]) / 3.0f;
+    }
+}
+
+// 在每个 Tipsify 簇内找软边界：从簇开头（缓存为空）累计的 ACMR 降到整簇的 threshold 倍以内时就切开，
+// 切开后的每一段都假设从空缓存开始画，排序后 ACMR 最多变差 threshold 倍
+static void splitClusters(const uint32_t* indices, size_t triangleCount, size_t vertexCount,
+                          const std::vector<uint32_t>& clusters, int cacheSize, float threshold,
+                          std::vector<uint32_t>* split) {
+    FIFOCache cache;
+    resetCache(&cache, vertexCount, cacheSize);
+    for (size_t c = 0; c < clusters.size(); c++) {
+        size_t begin = clusters[c];
+        size_t end = c + 1 < clusters.size() ? clusters[c + 1] : triangleCount;
+        flushCache(&cache);
+        unsigned int clusterMisses = 0;
+        for (size_t t = begin; t < end; t++) {
+            clusterMisses += touchTriangle(&cache, indices + t * 3);
+        }
+        float clusterACMR = (float)clusterMisses / (float)(end - begin);
+
+        split->push_back((uint32_t)begin);
+        flushCache(&cache);
+        unsigned int misses = 0;
+        size_t start = begin;
+        for (size_t t = begin; t < end; t++) {
+            misses += touchTriangle(&cache, indices + t * 3);
+            if (t + 1 < end && (float)misses / (float)(t + 1 - start) <= threshold * clusterACMR) {
+                split->push_back((uint32_t)(t + 1));
+                flushCache(&cache);
+                misses = 0;
+                start = t + 1;
+            }
+        }
+    }
+}
+
+void optimizeOverdraw(uint32_t* indices, size_t indexCount, const float* positions, size_t positionStride,
+                      size_t vertexCount, const std::vector<uint32_t>& clusters, int cacheSize, float threshold) {
+    size_t triangleCount = indexCount / 3;
+    if (triangleCount == 0 || clusters.empty()) {
+        return;
+    }
+    std::vector<uint32_t> split;
+    if (threshold > 1.0f) {
+        splitClusters(indices, triangleCount, vertexCount, clusters, cacheSize, threshold, &split);
+    } else {
+        split = clusters;
+    }
+    size_t clusterCount = split.size();
+
+    // 整个网格按面积加权的重心
+    float meshCentroid[3] = {0.0f, 0.0f, 0.0f};
+    float meshArea = 0.0f;
+    std::vector<float> clusterNormals(clusterCount * 3, 0.0f);
+    std::vector<float> clusterCentroids(clusterCount * 3, 0.0f);
+    std::vector<float> clusterAreas(clusterCount, 0.0f);
+    for (size_t c = 0; c < clusterCount; c++) {
+        size_t end = c + 1 < clusterCount ? split[c + 1] : triangleCount;
+        for (size_t t = split[c]; t < end; t++) {
+            float normal[3];
+            float centroid[3];
+            triangleNormal(positions, positionStride, indices + t * 3, normal, centroid);
+            float area = sqrtf(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+            for (int k = 0; k < 3; k++) {
+                clusterNormals[c * 3 + k] += normal[k];
+                clusterCentroids[c * 3 + k] += centroid[k] * area;
+                meshCentroid[k] += centroid[k] * area;
+            }
+            clusterAreas[c] += area;
+            meshArea += area;
+        }
+    }
+    for (int k = 0; k < 3; k++) {
+        meshCentroid[k] = meshArea > 0.0f ? meshCentroid[k] / meshArea : 0.0f;
+    }
+
+    // 排序键：簇的平均法线与（簇重心 - 网格重心）的点积，越朝外越大，先画
+    std::vector<float> keys(clusterCount);
+    std::vector<uint32_t> order(clusterCount);
+    for (size_t c = 0; c < clusterCount; c++) {
+        float* normal = &clusterNormals[c * 3];
+        float length = sqrtf(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+        float key = 0.0f;
+        for (int k = 0; k < 3; k++) {
+            float centroid = clusterAreas[c] > 0.0f ? clusterCentroids[c * 3 + k] / clusterAreas[c] : 0.0f;
+            key += (centroid - meshCentroid[k]) * (length > 0.0f ? normal[k] / length : 0.0f);
+        }
+        keys[c] = key;
+        order[c] = (uint32_t)c;
+    }
+    std::stable_sort(order.begin(), order.end(), [&keys](uint32_t a, uint32_t b) {
+        return keys[a] > keys[b];
+    });
+
+    std::vector<uint32_t> sorted;
+    sorted.reserve(triangleCount * 3);
+    for (size_t i = 0; i < clusterCount; i++) {
+        uint32_t c = order[i];
+        size_t end = c + 1 < clusterCount ? split[c + 1] : triangleCount;
+        sorted.insert(sorted.end(), indices + split[c] * 3, indices + end * 3);
+    }
+    memcpy(indices, sorted.data(), sorted.size() * sizeof(uint32_t));
+}
+
+size_t optimizeVertexFetch(void* vertices, size_t vertexCount, size_t vertexSize, uint32_t* indices,
+                           size_t indexCount) {
+    const uint32_t unused = 0xffffffffu;
+    std::vector<uint32_t> remap(vertexCount, unused);
+    uint32_t next = 0;
+    for (size_t i = 0; i < indexCount; i++) {
+        uint32_t& target = remap[indices[i]];
+        if (target == unused) {
+            target = next++;
+        }
+        indices[i] = target;
+    }
+    std::vector<unsigned char> original((const unsigned char*)vertices,
+                                        (const unsigned char*)vertices + vertexCount * vertexSize);
+    unsigned char* destination = (unsigned char*)vertices;
+    for (size_t v = 0; v < vertexCount; v++) {
+        if (remap[v] != unused) {
+            memcpy(destination + remap[v] * vertexSize, &original[v * vertexSize], vertexSize);
+        }
+    }
+    return next;
+}
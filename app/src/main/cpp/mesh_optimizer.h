@@ -0,0 +1,48 @@
+//
+// Created by zhangx on 2026/10/16.
+// 索引缓冲优化 - 在 mesh_converter 中转换时调整三角形和顶点的顺序，不改变网格的形状
+//
+// 依次执行（Sander 等，"Fast Triangle Reordering for Vertex Locality and Reduced Overdraw"）：
+//   optimizeVertexCache：Tipsify，按顶点扇形输出三角形，让顶点着色的结果尽量在变换后缓存中命中，
+//     同时在死路处（需要跳到远处继续）记下簇的边界
+//   optimizeOverdraw：在 ACMR 不超过阈值的前提下把簇切得更细，再按朝外程度排序，
+//     朝外、靠外的簇先画，被挡住的像素在深度测试中提前丢弃
+//   optimizeVertexFetch：按索引中第一次出现的顺序重排顶点，顶点读取顺序接近线性，去掉没用到的顶点
+// 缓存按 FIFO 模拟，大小用 MESH_VERTEX_CACHE_SIZE（移动 GPU 的变换后缓存通常为 16 到 32 个顶点，取保守值）。
+// ACMR（每个三角形的平均缓存未命中数）最好为 0.5 左右，最差为 3；ATVR（未命中数 / 顶点数）最好为 1
+//
+
+#ifndef NDKLEARN2_MESH_OPTIMIZER_H
+#define NDKLEARN2_MESH_OPTIMIZER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+static const int MESH_VERTEX_CACHE_SIZE = 16;
+// 切分簇时允许 ACMR 变差的比例
+static const float MESH_OVERDRAW_THRESHOLD = 1.05f;
+
+struct VertexCacheStats {
+    float acmr;   // 未命中数 / 三角形数
+    float atvr;   // 未命中数 / 被引用的顶点数
+};
+
+// 按 cacheSize 个顶点的 FIFO 缓存模拟 indices 的绘制
+VertexCacheStats analyzeVertexCache(const uint32_t* indices, size_t indexCount, size_t vertexCount, int cacheSize);
+
+// 原地重排三角形（indexCount 为 3 的倍数，索引小于 vertexCount），
+// clusters 写出各簇第一个三角形的下标（从 0 开始，升序），供 optimizeOverdraw 使用
+void optimizeVertexCache(uint32_t* indices, size_t indexCount, size_t vertexCount, int cacheSize,
+                         std::vector<uint32_t>* clusters);
+
+// 原地重排 optimizeVertexCache 输出的簇，簇内顺序不变；positions 为每个顶点开头的 3 个 float，
+// 相邻顶点相距 positionStride 字节。threshold 为切分后允许的 ACMR 比例（1 表示只用 Tipsify 的簇）
+void optimizeOverdraw(uint32_t* indices, size_t indexCount, const float* positions, size_t positionStride,
+                      size_t vertexCount, const std::vector<uint32_t>& clusters, int cacheSize, float threshold);
+
+// 原地重排 vertices（vertexCount 个，每个 vertexSize 字节）并改写 indices，返回保留的顶点数
+size_t optimizeVertexFetch(void* vertices, size_t vertexCount, size_t vertexSize, uint32_t* indices,
+                           size_t indexCount);
+
+#endif //NDKLEARN2_MESH_OPTIMIZER_H
@@ -0,0 +1,302 @@
+//
+// Created by zhangx on 2026/10/16.
+// 网格简化实现
+//
+
+#include "mesh_simplifier.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <map>
+#include <tuple>
+
+// 对称 4x4 矩阵的上三角部分，加上累计的面积权重：
+// Q(p) = p^T A p + 2 b.p + c，Q(p) / weight 为到各平面的面积加权均方距离
+struct Quadric {
+    double a00, a11, a22, a01, a02, a12;
+    double b0, b1, b2;
+    double c;
+    double weight;
+};
+
+struct Collapse {
+    uint32_t source;
+    uint32_t target;
+    float cost;
+};
+
+static const float* vertexPosition(const float* positions, size_t positionStride, uint32_t vertex) {
+    return (const float*)((const unsigned char*)positions + vertex * positionStride);
+}
+
+static void cross(const float* a, const float* b, const float* c, double* normal) {
+    double e1[3] = {(double)b[0] - a[0], (double)b[1] - a[1], (double)b[2] - a[2]};
+    double e2[3] = {(double)c[0] - a[0], (double)c[1] - a[1], (double)c[2] - a[2]};
+    normal[0] = e1[1] * e2[2] - e1[2] * e2[1];
+    normal[1] = e1[2] * e2[0] - e1[0] * e2[2];
+    normal[2] = e1[0] * e2[1] - e1[1] * e2[0];
+}
+
+static void addQuadric(Quadric* q, const Quadric& other) {
+    q->a00 += other.a00;
+    q->a11 += other.a11;
+    q->a22 += other.a22;
+    q->a01 += other.a01;
+    q->a02 += other.a02;
+    q->a12 += other.a12;
+    q->b0 += other.b0;
+    q->b1 += other.b1;
+    q->b2 += other.b2;
+    q->c += other.c;
+    q->weight += other.weight;
+}
+
+// 三角形所在平面的二次误差，按面积加权
+static Quadric planeQuadric(const float* a, const float* b, const float* c) {
+    Quadric q;
+    memset(&q, 0, sizeof(q));
+    double n[3];
+    cross(a, b, c, n);
+    double length = sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+    if (length == 0.0) {
+        return q;
+    }
+    double area = length * 0.5;
+    n[0] /= length;
+    n[1] /= length;
+    n[2] /= length;
+    double d = -(n[0] * a[0] + n[1] * a[1] + n[2] * a[2]);
+    q.a00 = area * n[0] * n[0];
+    q.a11 = area * n[1] * n[1];
+    q.a22 = area * n[2] * n[2];
+    q.a01 = area * n[0] * n[1];
+    q.a02 = area * n[0] * n[2];
+    q.a12 = area * n[1] * n[2];
+    q.b0 = area * n[0] * d;
+    q.b1 = area * n[1] * d;
+    q.b2 = area * n[2] * d;
+    q.c = area * d * d;
+    q.weight = area;
+    return q;
+}
+
+// 折叠到 p 的几何误差（距离）
+static float quadricError(const Quadric& q, const float* p) {
+    double x = p[0];
+    double y = p[1];
+    double z = p[2];
+    double value = q.a00 * x * x + q.a11 * y * y + q.a22 * z * z
+                   + 2.0 * (q.a01 * x * y + q.a02 * x * z + q.a12 * y * z)
+                   + 2.0 * (q.b0 * x + q.b1 * y + q.b2 * z) + q.c;
+    if (q.weight <= 0.0 || value <= 0.0) {
+        return 0.0f;
+    }
+    return (float)sqrt(value / q.weight);
+}
+
+// 不能移动的顶点：同一位置有多个顶点（接缝），或者在开放边界上
+static std::vector<bool> findLockedVertices(const uint32_t* indices, size_t indexCount, const float* positions,
+                                            size_t positionStride, size_t vertexCount) {
+    typedef std::tuple<float, float, float> Position;
+    std::map<Position, uint32_t> firstVertex;
+    std::vector<uint32_t> welded(vertexCount);
+    std::vector<uint32_t> weldedCount(vertexCount, 0);
+    for (size_t v = 0; v < vertexCount; v++) {
+        const float* p = vertexPosition(positions, positionStride, (uint32_t)v);
+        uint32_t id = firstVertex.insert(std::make_pair(Position(p[0], p[1], p[2]), (uint32_t)v)).first->second;
+        welded[v] = id;
+        weldedCount[id]++;
+    }
+    std::vector<bool> locked(vertexCount, false);
+    for (size_t v = 0; v < vertexCount; v++) {
+        locked[v] = weldedCount[welded[v]] > 1;
+    }
+
+    // 按位置统计有向边：没有反向边的边在边界上
+    std::map<std::pair<uint32_t, uint32_t>, int> edges;
+    for (size_t i = 0; i + 2 < indexCount; i += 3) {
+        for (int k = 0; k < 3; k++) {
+            uint32_t a = welded[indices[i + k]];
+            uint32_t b = welded[indices[i + (k + 1) % 3]];
+            edges[std::make_pair(a, b)]++;
+        }
+    }
+    for (size_t i = 0; i + 2 < indexCount; i += 3) {
+        for (int k = 0; k < 3; k++) {
+            uint32_t a = indices[i + k];
+            uint32_t b = indices[i + (k + 1) % 3];
+            if (edges.find(std::make_pair(welded[b], welded[a])) == edges.end()) {
+                locked[a] = true;
+                locked[b] = true;
+            }
+        }
+    }
+    return locked;
+}
+
+static uint32_t resolve(std::vector<uint32_t>* remap, uint32_t vertex) {
+    while ((*remap)[vertex] != vertex) {
+        (*remap)[vertex] = (*remap)[(*remap)[vertex]];
+        vertex = (*remap)[vertex];
+    }
+    return vertex;
+}
+
+// source 移到 target 后，source 周围（不含 target 的）三角形的法线不能翻转
+static bool flipsTriangles(const std::vector<uint32_t>& triangles, const std::vector<uint32_t>& current,
+                           const std::vector<bool>& dead, std::vector<uint32_t>* remap, const float* positions,
+                           size_t positionStride, uint32_t source, uint32_t target) {
+    const float* moved = vertexPosition(positions, positionStride, target);
+    for (size_t i = 0; i < triangles.size(); i++) {
+        uint32_t t = triangles[i];
+        if (dead[t]) {
+            continue;
+        }
+        uint32_t v[3];
+        for (int k = 0; k < 3; k++) {
+            v[k] = resolve(remap, current[t * 3 + k]);
+        }
+        if (v[0] == target || v[1] == target || v[2] == target) {
+            continue;
+        }
+        const float* p[3];
+        const float* q[3];
+        for (int k = 0; k < 3; k++) {
+            p[k] = vertexPosition(positions, positionStride, v[k]);
+            q[k] = v[k] == source ? moved : p[k];
+        }
+        double before[3];
+        double after[3];
+        cross(p[0], p[1], p[2], before);
+        cross(q[0], q[1], q[2], after);
+        if (before[0] * after[0] + before[1] * after[1] + before[2] * after[2] <= 0.0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+size_t simplifyMesh(const uint32_t* indices, size_t indexCount, const float* positions, size_t positionStride,
+                    size_t vertexCount, size_t targetIndexCount, std::vector<uint32_t>* destination, float* error) {
+    std::vector<uint32_t> current(indices, indices + indexCount / 3 * 3);
+    *error = 0.0f;
+    std::vector<bool> locked = findLockedVertices(current.data(), current.size(), positions, positionStride,
+                                                  vertexCount);
+    std::vector<Quadric> quadrics(vertexCount);
+    memset(quadrics.data(), 0, quadrics.size() * sizeof(Quadric));
+    for (size_t i = 0; i < current.size(); i += 3) {
+        Quadric q = planeQuadric(vertexPosition(positions, positionStride, current[i]),
+                                 vertexPosition(positions, positionStride, current[i + 1]),
+                                 vertexPosition(positions, positionStride, current[i + 2]));
+        for (int k = 0; k < 3; k++) {
+            addQuadric(&quadrics[current[i + k]], q);
+        }
+    }
+
+    std::vector<uint32_t> remap(vertexCount);
+    std::vector<Collapse> collapses;
+    std::vector<uint32_t> offsets;
+    std::vector<uint32_t> adjacency;
+    std::vector<uint8_t> touched;
+    while (current.size() > targetIndexCount) {
+        size_t triangleCount = current.size() / 3;
+
+        // 顶点 -> 三角形（CSR）
+        offsets.assign(vertexCount + 1, 0);
+        for (size_t i = 0; i < current.size(); i++) {
+            offsets[current[i] + 1]++;
+        }
+        for (size_t v = 0; v < vertexCount; v++) {
+            offsets[v + 1] += offsets[v];
+        }
+        adjacency.resize(current.size());
+        std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+        for (size_t i = 0; i < current.size(); i++) {
+            adjacency[fill[current[i]]++] = (uint32_t)(i / 3);
+        }
+
+        // 每条边两个方向的折叠，代价为合并后的二次误差在目标位置的值
+        collapses.clear();
+        for (size_t i = 0; i < current.size(); i += 3) {
+            for (int k = 0; k < 3; k++) {
+                uint32_t a = current[i + k];
+                uint32_t b = current[i + (k + 1) % 3];
+                for (int direction = 0; direction < 2; direction++) {
+                    uint32_t source = direction == 0 ? a : b;
+                    uint32_t target = direction == 0 ? b : a;
+                    if (locked[source]) {
+                        continue;
+                    }
+                    Quadric q = quadrics[source];
+                    addQuadric(&q, quadrics[target]);
+                    Collapse collapse = {source, target,
+                                         quadricError(q, vertexPosition(positions, positionStride, target))};
+                    collapses.push_back(collapse);
+                }
+            }
+        }
+        if (collapses.empty()) {
+            break;
+        }
+        std::sort(collapses.begin(), collapses.end(), [](const Collapse& x, const Collapse& y) {
+            return x.cost < y.cost;
+        });
+
+        // 每轮最多去掉还需要去掉的一半，剩下的在重新计算代价后再折叠
+        size_t remaining = triangleCount;
+        size_t passTarget = targetIndexCount / 3 + (triangleCount - targetIndexCount / 3) / 2;
+        for (size_t v = 0; v < vertexCount; v++) {
+            remap[v] = (uint32_t)v;
+        }
+        touched.assign(vertexCount, 0);
+        std::vector<bool> dead(triangleCount, false);
+        size_t performed = 0;
+        for (size_t c = 0; c < collapses.size() && remaining > passTarget; c++) {
+            const Collapse& collapse = collapses[c];
+            // 本轮已经移动过或接收过折叠的顶点不再参与，周围三角形的判断都基于本轮开始时的邻接
+            if (touched[collapse.source] || touched[collapse.target]) {
+                continue;
+            }
+            std::vector<uint32_t> triangles(adjacency.begin() + offsets[collapse.source],
+                                            adjacency.begin() + offsets[collapse.source + 1]);
+            if (flipsTriangles(triangles, current, dead, &remap, positions, positionStride, collapse.source,
+                               collapse.target)) {
+                continue;
+            }
+            remap[collapse.source] = collapse.target;
+            touched[collapse.source] = 1;
+            touched[collapse.target] = 1;
+            addQuadric(&quadrics[collapse.target], quadrics[collapse.source]);
+            *error = std::max(*error, collapse.cost);
+            performed++;
+            for (size_t i = 0; i < triangles.size(); i++) {
+                uint32_t t = triangles[i];
+                uint32_t v0 = resolve(&remap, current[t * 3]);
+                uint32_t v1 = resolve(&remap, current[t * 3 + 1]);
+                uint32_t v2 = resolve(&remap, current[t * 3 + 2]);
+                if (!dead[t] && (v0 == v1 || v1 == v2 || v0 == v2)) {
+                    dead[t] = true;
+                    remaining--;
+                }
+            }
+        }
+        if (performed == 0) {
+            break;
+        }
+
+        // 应用折叠，去掉退化的三角形
+        std::vector<uint32_t> next;
+        next.reserve(remaining * 3);
+        for (size_t t = 0; t < triangleCount; t++) {
+            if (dead[t]) {
+                continue;
+            }
+            for (int k = 0; k < 3; k++) {
+                next.push_back(resolve(&remap, current[t * 3 + k]));
+            }
+        }
+        current.swap(next);
+    }
+    destination->swap(current);
+    return destination->size();
+}
@@ -0,0 +1,24 @@
+//
+// Created by zhangx on 2026/10/16.
+// 网格简化 - 二次误差度量（Garland-Heckbert）的边折叠，mesh_converter 用它生成每个子网格的 LOD 链
+//
+// 只把顶点折叠到相邻顶点上（不产生新位置），简化结果仍然引用原来的顶点，
+// 所有 LOD 共用一个 VBO，只是 EBO 中的索引范围不同（mesh_container.h 的 MeshLod）。
+// 开放边界上的顶点和 UV / 法线接缝上的顶点（同一位置有多个顶点）保持不动，轮廓和贴图不会被拉开；
+// 代价是接缝很多的网格（例如每个面独立 UV 的立方体）简化不了多少
+//
+
+#ifndef NDKLEARN2_MESH_SIMPLIFIER_H
+#define NDKLEARN2_MESH_SIMPLIFIER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+// 把 indices（indexCount 为 3 的倍数）简化到不超过 targetIndexCount 个索引，结果写到 destination，
+// 返回结果的索引数（所有可折叠的边都用完时可能多于目标）。positions 为每个顶点开头的 3 个 float，
+// 相邻顶点相距 positionStride 字节。error 写出折叠造成的最大几何误差，与位置同单位（到原表面的距离）
+size_t simplifyMesh(const uint32_t* indices, size_t indexCount, const float* positions, size_t positionStride,
+                    size_t vertexCount, size_t targetIndexCount, std::vector<uint32_t>* destination, float* error);
+
+#endif //NDKLEARN2_MESH_SIMPLIFIER_H
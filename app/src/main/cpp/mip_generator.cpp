@@ -0,0 +1,418 @@
+//
+// Created by zhangx on 2026/10/16.
+// CPU mip 生成实现
+//
+
+#include "mip_generator.h"
+#include "half_float.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdint.h>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define MIP_SIMD_NEON
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define MIP_SIMD_SSE2
+#endif
+
+static const int LINEAR_MAX = 16383;  // sRGB 解码后的线性值用 14 位整数表示，4 个相加不超过 16 位
+
+struct SrgbTables {
+    uint16_t toLinear[256];
+    unsigned char fromLinear[LINEAR_MAX + 1];
+};
+
+static SrgbTables buildSrgbTables() {
+    SrgbTables tables;
+    for (int i = 0; i < 256; i++) {
+        double c = i / 255.0;
+        double linear = c <= 0.04045 ? c / 12.92 : pow((c + 0.055) / 1.055, 2.4);
+        tables.toLinear[i] = (uint16_t)(linear * LINEAR_MAX + 0.5);
+    }
+    for (int i = 0; i <= LINEAR_MAX; i++) {
+        double linear = (double)i / LINEAR_MAX;
+        double c = linear <= 0.0031308 ? linear * 12.92 : 1.055 * pow(linear, 1.0 / 2.4) - 0.055;
+        tables.fromLinear[i] = (unsigned char)(c * 255.0 + 0.5);
+    }
+    return tables;
+}
+
+// 第一次使用时构建，C++11 保证局部静态变量的初始化是线程安全的
+static const SrgbTables& srgbTables() {
+    static const SrgbTables tables = buildSrgbTables();
+    return tables;
+}
+
+int mipLevelCount(int width, int height) {
+    int levels = 1;
+    int size = width > height ? width : height;
+    while (size > 1 && levels < KTX_MAX_LEVELS) {
+        size >>= 1;
+        levels++;
+    }
+    return levels;
+}
+
+// ==================== 偶数尺寸：2x2 盒式滤波 ====================
+
+// 源图相邻两行 -> 一行输出，count 为输出像素数；结果与 (a + b + c + d + 2) / 4 逐字节相同
+static void boxRowRGBA8(const unsigned char* row0, const unsigned char* row1, int count, unsigned char* out) {
+    int x = 0;
+#if defined(MIP_SIMD_NEON)
+    for (; x + 4 <= count; x += 4) {
+        // 按 32 位解交错：val[0] 为偶数列的 4 个像素，val[1] 为奇数列，同一位置的字节就是 2x2 中的同一通道
+        uint32x4x2_t top = vld2q_u32((const uint32_t*)(row0 + x * 8));
+        uint32x4x2_t bottom = vld2q_u32((const uint32_t*)(row1 + x * 8));
+        uint8x16_t a = vreinterpretq_u8_u32(top.val[0]);
+        uint8x16_t b = vreinterpretq_u8_u32(top.val[1]);
+        uint8x16_t c = vreinterpretq_u8_u32(bottom.val[0]);
+        uint8x16_t d = vreinterpretq_u8_u32(bottom.val[1]);
+        uint16x8_t low = vaddl_u8(vget_low_u8(a), vget_low_u8(b));
+        low = vaddw_u8(low, vget_low_u8(c));
+        low = vaddw_u8(low, vget_low_u8(d));
+        uint16x8_t high = vaddl_u8(vget_high_u8(a), vget_high_u8(b));
+        high = vaddw_u8(high, vget_high_u8(c));
+        high = vaddw_u8(high, vget_high_u8(d));
+        vst1q_u8(out + x * 4, vcombine_u8(vrshrn_n_u16(low, 2), vrshrn_n_u16(high, 2)));
+    }
+#elif defined(MIP_SIMD_SSE2)
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i two = _mm_set1_epi16(2);
+    for (; x + 4 <= count; x += 4) {
+        __m128i top0 = _mm_loadu_si128((const __m128i*)(row0 + x * 8));
+        __m128i top1 = _mm_loadu_si128((const __m128i*)(row0 + x * 8 + 16));
+        __m128i bottom0 = _mm_loadu_si128((const __m128i*)(row1 + x * 8));
+        __m128i bottom1 = _mm_loadu_si128((const __m128i*)(row1 + x * 8 + 16));
+        // 扩展到 16 位后上下两行相加，每个寄存器是相邻两列的和
+        __m128i s01 = _mm_add_epi16(_mm_unpacklo_epi8(top0, zero), _mm_unpacklo_epi8(bottom0, zero));
+        __m128i s23 = _mm_add_epi16(_mm_unpackhi_epi8(top0, zero), _mm_unpackhi_epi8(bottom0, zero));
+        __m128i s45 = _mm_add_epi16(_mm_unpacklo_epi8(top1, zero), _mm_unpacklo_epi8(bottom1, zero));
+        __m128i s67 = _mm_add_epi16(_mm_unpackhi_epi8(top1, zero), _mm_unpackhi_epi8(bottom1, zero));
+        // [0,1] 和 [2,3] 按 64 位重排成 [0,2] + [1,3]，得到第 0、1 个输出像素
+        __m128i p01 = _mm_add_epi16(_mm_unpacklo_epi64(s01, s23), _mm_unpackhi_epi64(s01, s23));
+        __m128i p23 = _mm_add_epi16(_mm_unpacklo_epi64(s45, s67), _mm_unpackhi_epi64(s45, s67));
+        p01 = _mm_srli_epi16(_mm_add_epi16(p01, two), 2);
+        p23 = _mm_srli_epi16(_mm_add_epi16(p23, two), 2);
+        _mm_storeu_si128((__m128i*)(out + x * 4), _mm_packus_epi16(p01, p23));
+    }
+#endif
+    for (; x < count; x++) {
+        for (int c = 0; c < 4; c++) {
+            int sum = row0[x * 8 + c] + row0[x * 8 + 4 + c] + row1[x * 8 + c] + row1[x * 8 + 4 + c];
+            out[x * 4 + c] = (unsigned char)((sum + 2) >> 2);
+        }
+    }
+}
+
+// 同上，输入输出为 16 位（sRGB 解码后的线性值）
+static void boxRowU16(const uint16_t* row0, const uint16_t* row1, int count, uint16_t* out) {
+    int x = 0;
+#if defined(MIP_SIMD_NEON)
+    for (; x + 2 <= count; x += 2) {
+        uint16x8_t s01 = vaddq_u16(vld1q_u16(row0 + x * 8), vld1q_u16(row1 + x * 8));
+        uint16x8_t s23 = vaddq_u16(vld1q_u16(row0 + x * 8 + 8), vld1q_u16(row1 + x * 8 + 8));
+        uint16x4_t p0 = vadd_u16(vget_low_u16(s01), vget_high_u16(s01));
+        uint16x4_t p1 = vadd_u16(vget_low_u16(s23), vget_high_u16(s23));
+        vst1q_u16(out + x * 4, vrshrq_n_u16(vcombine_u16(p0, p1), 2));
+    }
+#elif defined(MIP_SIMD_SSE2)
+    const __m128i two = _mm_set1_epi16(2);
+    for (; x + 2 <= count; x += 2) {
+        __m128i s01 = _mm_add_epi16(_mm_loadu_si128((const __m128i*)(row0 + x * 8)),
+                                    _mm_loadu_si128((const __m128i*)(row1 + x * 8)));
+        __m128i s23 = _mm_add_epi16(_mm_loadu_si128((const __m128i*)(row0 + x * 8 + 8)),
+                                    _mm_loadu_si128((const __m128i*)(row1 + x * 8 + 8)));
+        __m128i sum = _mm_add_epi16(_mm_unpacklo_epi64(s01, s23), _mm_unpackhi_epi64(s01, s23));
+        _mm_storeu_si128((__m128i*)(out + x * 4), _mm_srli_epi16(_mm_add_epi16(sum, two), 2));
+    }
+#endif
+    for (; x < count; x++) {
+        for (int c = 0; c < 4; c++) {
+            int sum = row0[x * 8 + c] + row0[x * 8 + 4 + c] + row1[x * 8 + c] + row1[x * 8 + 4 + c];
+            out[x * 4 + c] = (uint16_t)((sum + 2) >> 2);
+        }
+    }
+}
+
+// sRGB 颜色解码为 14 位线性值，alpha 原样保留
+static void decodeSrgbRow(const unsigned char* src, int count, uint16_t* out) {
+    const uint16_t* toLinear = srgbTables().toLinear;
+    for (int i = 0; i < count * 4; i += 4) {
+        out[i] = toLinear[src[i]];
+        out[i + 1] = toLinear[src[i + 1]];
+        out[i + 2] = toLinear[src[i + 2]];
+        out[i + 3] = src[i + 3];
+    }
+}
+
+static void encodeSrgbRow(const uint16_t* src, int count, unsigned char* out) {
+    const unsigned char* fromLinear = srgbTables().fromLinear;
+    for (int i = 0; i < count * 4; i += 4) {
+        out[i] = fromLinear[src[i]];
+        out[i + 1] = fromLinear[src[i + 1]];
+        out[i + 2] = fromLinear[src[i + 2]];
+        out[i + 3] = (unsigned char)src[i + 3];
+    }
+}
+
+static void downsampleEven(const unsigned char* src, int width, int height, MipColorSpace colorSpace,
+                           unsigned char* dst) {
+    int w = width / 2;
+    int h = height / 2;
+    size_t srcStride = (size_t)width * 4;
+    if (colorSpace == MIP_COLOR_LINEAR) {
+        for (int y = 0; y < h; y++) {
+            const unsigned char* row0 = src + (size_t)y * 2 * srcStride;
+            boxRowRGBA8(row0, row0 + srcStride, w, dst + (size_t)y * w * 4);
+        }
+        return;
+    }
+    std::vector<uint16_t> rows((size_t)width * 4 * 2 + (size_t)w * 4);
+    uint16_t* row0 = rows.data();
+    uint16_t* row1 = row0 + (size_t)width * 4;
+    uint16_t* averaged = row1 + (size_t)width * 4;
+    for (int y = 0; y < h; y++) {
+        decodeSrgbRow(src + (size_t)y * 2 * srcStride, width, row0);
+        decodeSrgbRow(src + ((size_t)y * 2 + 1) * srcStride, width, row1);
+        boxRowU16(row0, row1, w, averaged);
+        encodeSrgbRow(averaged, w, dst + (size_t)y * w * 4);
+    }
+}
+
+// ==================== 奇数尺寸：多相盒式滤波 ====================
+
+// 一个方向上一个输出位置的抽头：源下标 first 起的 count 个像素及其权重
+struct FilterTaps {
+    int first;
+    int count;
+    float weights[3];
+};
+
+// 偶数尺寸两个抽头各 1/2；奇数尺寸 2m+1 缩小到 m 时，第 i 个输出覆盖 2i..2i+2，
+// 权重 (m-i, m, i+1) / (2m+1)，每个源像素的总权重相同
+static FilterTaps filterTaps(int size, int i) {
+    FilterTaps taps;
+    taps.first = i * 2;
+    if (size == 1) {
+        taps.count = 1;
+        taps.weights[0] = 1.0f;
+    } else if (size % 2 == 0) {
+        taps.count = 2;
+        taps.weights[0] = 0.5f;
+        taps.weights[1] = 0.5f;
+    } else {
+        int m = size / 2;
+        float total = (float)size;
+        taps.count = 3;
+        taps.weights[0] = (float)(m - i) / total;
+        taps.weights[1] = (float)m / total;
+        taps.weights[2] = (float)(i + 1) / total;
+    }
+    return taps;
+}
+
+// 宽或高为奇数（或为 1）时逐像素计算，只在 NPOT 纹理的部分级别用到
+static void downsampleGeneral(const unsigned char* src, int width, int height, MipColorSpace colorSpace,
+                              unsigned char* dst) {
+    int w = mipLevelDimension(width);
+    int h = mipLevelDimension(height);
+    const SrgbTables* tables = colorSpace == MIP_COLOR_SRGB ? &srgbTables() : nullptr;
+
+    // 每个通道的解码值：sRGB 颜色为 14 位线性值，其余为原值
+    float decode[4][256];
+    for (int v = 0; v < 256; v++) {
+        for (int c = 0; c < 4; c++) {
+            decode[c][v] = tables != nullptr && c < 3 ? (float)tables->toLinear[v] : (float)v;
+        }
+    }
+
+    std::vector<FilterTaps> columns(w);
+    for (int x = 0; x < w; x++) {
+        columns[x] = filterTaps(width, x);
+    }
+    std::vector<float> filtered((size_t)w * 4);
+    for (int y = 0; y < h; y++) {
+        FilterTaps rows = filterTaps(height, y);
+        std::fill(filtered.begin(), filtered.end(), 0.0f);
+        for (int r = 0; r < rows.count; r++) {
+            const unsigned char* row = src + (size_t)(rows.first + r) * width * 4;
+            for (int x = 0; x < w; x++) {
+                const FilterTaps& taps = columns[x];
+                for (int t = 0; t < taps.count; t++) {
+                    const unsigned char* p = row + (size_t)(taps.first + t) * 4;
+                    float weight = rows.weights[r] * taps.weights[t];
+                    for (int c = 0; c < 4; c++) {
+                        filtered[x * 4 + c] += weight * decode[c][p[c]];
+                    }
+                }
+            }
+        }
+        unsigned char* out = dst + (size_t)y * w * 4;
+        for (int i = 0; i < w * 4; i++) {
+            int value = (int)(filtered[i] + 0.5f);
+            if (tables != nullptr && i % 4 < 3) {
+                out[i] = tables->fromLinear[value < LINEAR_MAX ? value : LINEAR_MAX];
+            } else {
+                out[i] = (unsigned char)(value < 255 ? value : 255);
+            }
+        }
+    }
+}
+
+// ==================== 其它未压缩格式：解码到浮点后滤波 ====================
+
+// 逐行解码 / 编码：sRGB 颜色（tables 非空）为 14 位线性值，其余 8 位以内的通道为 0..255，半浮点为实际值
+struct PixelCodec {
+    int channels;
+    void (*decode)(const unsigned char* src, int count, const SrgbTables* tables, float* out);
+    void (*encode)(const float* src, int count, const SrgbTables* tables, unsigned char* out);
+};
+
+static int clampRound(float value, int maximum) {
+    int rounded = (int)(value + 0.5f);
+    return rounded < 0 ? 0 : (rounded > maximum ? maximum : rounded);
+}
+
+static void decodeRGB565Row(const unsigned char* src, int count, const SrgbTables* tables, float* out) {
+    for (int i = 0; i < count; i++) {
+        uint16_t pixel;
+        memcpy(&pixel, src + i * 2, 2);
+        int channels[3] = {((pixel >> 11) * 255 + 15) / 31, (((pixel >> 5) & 63) * 255 + 31) / 63,
+                           ((pixel & 31) * 255 + 15) / 31};
+        for (int c = 0; c < 3; c++) {
+            out[i * 3 + c] = tables != nullptr ? (float)tables->toLinear[channels[c]] : (float)channels[c];
+        }
+    }
+}
+
+static void encodeRGB565Row(const float* src, int count, const SrgbTables* tables, unsigned char* out) {
+    for (int i = 0; i < count; i++) {
+        int channels[3];
+        for (int c = 0; c < 3; c++) {
+            float value = src[i * 3 + c];
+            channels[c] = tables != nullptr ? tables->fromLinear[clampRound(value, LINEAR_MAX)] : clampRound(value, 255);
+        }
+        uint16_t pixel = (uint16_t)(((channels[0] * 31 + 127) / 255) << 11 | ((channels[1] * 63 + 127) / 255) << 5
+                                    | (channels[2] * 31 + 127) / 255);
+        memcpy(out + i * 2, &pixel, 2);
+    }
+}
+
+static void decodeR8Row(const unsigned char* src, int count, const SrgbTables*, float* out) {
+    for (int i = 0; i < count; i++) {
+        out[i] = (float)src[i];
+    }
+}
+
+static void encodeR8Row(const float* src, int count, const SrgbTables*, unsigned char* out) {
+    for (int i = 0; i < count; i++) {
+        out[i] = (unsigned char)clampRound(src[i], 255);
+    }
+}
+
+static void decodeRGBA16FRow(const unsigned char* src, int count, const SrgbTables*, float* out) {
+    for (int i = 0; i < count * 4; i++) {
+        uint16_t half;
+        memcpy(&half, src + i * 2, 2);
+        out[i] = halfToFloat(half);
+    }
+}
+
+static void encodeRGBA16FRow(const float* src, int count, const SrgbTables*, unsigned char* out) {
+    for (int i = 0; i < count * 4; i++) {
+        uint16_t half = floatToHalf(src[i]);
+        memcpy(out + i * 2, &half, 2);
+    }
+}
+
+static const PixelCodec* pixelCodec(GLenum internalFormat) {
+    static const PixelCodec RGB565 = {3, decodeRGB565Row, encodeRGB565Row};
+    static const PixelCodec R8 = {1, decodeR8Row, encodeR8Row};
+    static const PixelCodec RGBA16F = {4, decodeRGBA16FRow, encodeRGBA16FRow};
+    switch (internalFormat) {
+        case GL_RGB565: return &RGB565;
+        case GL_R8: return &R8;
+        case GL_RGBA16F: return &RGBA16F;
+        default: return nullptr;
+    }
+}
+
+// 与 downsampleGeneral 相同的抽头（偶数尺寸即 2x2 盒式滤波），源行解码一次后对整行滤波
+static void downsampleDecoded(const PixelCodec& codec, const SrgbTables* tables, const unsigned char* src,
+                              size_t srcRowSize, int width, int height, unsigned char* dst, size_t dstRowSize) {
+    int w = mipLevelDimension(width);
+    int h = mipLevelDimension(height);
+    int channels = codec.channels;
+    std::vector<FilterTaps> columns(w);
+    for (int x = 0; x < w; x++) {
+        columns[x] = filterTaps(width, x);
+    }
+    std::vector<float> decoded((size_t)width * channels);
+    std::vector<float> filtered((size_t)w * channels);
+    for (int y = 0; y < h; y++) {
+        FilterTaps rows = filterTaps(height, y);
+        std::fill(filtered.begin(), filtered.end(), 0.0f);
+        for (int r = 0; r < rows.count; r++) {
+            codec.decode(src + (size_t)(rows.first + r) * srcRowSize, width, tables, decoded.data());
+            for (int x = 0; x < w; x++) {
+                const FilterTaps& taps = columns[x];
+                for (int t = 0; t < taps.count; t++) {
+                    const float* p = &decoded[(size_t)(taps.first + t) * channels];
+                    float weight = rows.weights[r] * taps.weights[t];
+                    for (int c = 0; c < channels; c++) {
+                        filtered[x * channels + c] += weight * p[c];
+                    }
+                }
+            }
+        }
+        codec.encode(filtered.data(), w, tables, dst + (size_t)y * dstRowSize);
+    }
+}
+
+void downsampleRGBA8(const unsigned char* src, int width, int height, MipColorSpace colorSpace, unsigned char* dst) {
+    if (width % 2 == 0 && height % 2 == 0) {
+        downsampleEven(src, width, height, colorSpace, dst);
+    } else {
+        downsampleGeneral(src, width, height, colorSpace, dst);
+    }
+}
+
+void generateMipChain(std::vector<unsigned char>* pixels, GLenum internalFormat, int width, int height,
+                      MipColorSpace colorSpace, KTXImage* image) {
+    memset(image, 0, sizeof(*image));
+    image->internalFormat = internalFormat;
+    image->width = width;
+    image->height = height;
+    image->levelCount = mipLevelCount(width, height);
+    size_t total = 0;
+    for (int level = 0; level < image->levelCount; level++) {
+        KTXLevel& info = image->levels[level];
+        info.offset = (uint32_t)total;
+        info.size = (uint32_t)textureLevelSize(internalFormat, width, height);
+        info.width = width;
+        info.height = height;
+        total += info.size;
+        width = mipLevelDimension(width);
+        height = mipLevelDimension(height);
+    }
+    // 一次分配好全部级别，生成时上一级的指针不会失效
+    pixels->resize(total);
+    const PixelCodec* codec = pixelCodec(internalFormat);
+    // 只有 RGB565 的颜色按 colorSpace 处理，R8 / RGBA16F 始终是线性值
+    const SrgbTables* tables = internalFormat == GL_RGB565 && colorSpace == MIP_COLOR_SRGB ? &srgbTables() : nullptr;
+    for (int level = 1; level < image->levelCount; level++) {
+        const KTXLevel& source = image->levels[level - 1];
+        const KTXLevel& target = image->levels[level];
+        if (codec == nullptr) {
+            downsampleRGBA8(pixels->data() + source.offset, source.width, source.height, colorSpace,
+                            pixels->data() + target.offset);
+        } else {
+            downsampleDecoded(*codec, tables, pixels->data() + source.offset,
+                              textureRowSize(internalFormat, source.width), source.width, source.height,
+                              pixels->data() + target.offset, textureRowSize(internalFormat, target.width));
+        }
+    }
+}
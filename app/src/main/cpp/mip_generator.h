@@ -0,0 +1,40 @@
+//
+// Created by zhangx on 2026/10/16.
+// CPU mip 生成 - 在纹理加载线程或离线工具中生成完整 mip 链，逐级上传，不调用 glGenerateMipmap
+//
+// 偶数尺寸用 2x2 盒式滤波（NEON / SSE2），奇数尺寸的一边用 3 个抽头的多相盒式滤波，
+// 每个源像素的权重相同，非 2 的幂的纹理不会丢掉最后一行/列。
+// sRGB 颜色在线性空间平均后再编码回 sRGB，alpha 始终按线性值处理。
+// RGB565 / R8 / RGBA16F（Android Bitmap 可直接上传的格式）逐行解码到浮点后用同样的抽头滤波，再编码回原格式：
+// RGB565 的颜色按 colorSpace 处理，R8 是 A_8 的覆盖率、RGBA16F 本身是线性值，都直接平均
+//
+
+#ifndef NDKLEARN2_MIP_GENERATOR_H
+#define NDKLEARN2_MIP_GENERATOR_H
+
+#include "ktx_container.h"
+#include <vector>
+
+enum MipColorSpace {
+    MIP_COLOR_LINEAR = 0,  // 法线、遮罩等数据纹理，直接平均编码值
+    MIP_COLOR_SRGB         // Bitmap、PNG 等颜色图像
+};
+
+// 下一级的尺寸：每边减半，最小为 1
+inline int mipLevelDimension(int size) {
+    return size > 1 ? size / 2 : 1;
+}
+
+// 完整 mip 链的级数（直到 1x1）
+int mipLevelCount(int width, int height);
+
+// 把 RGBA8 图像（行紧密排列）缩小一级，dst 大小为 mipLevelDimension(width) * mipLevelDimension(height) * 4
+void downsampleRGBA8(const unsigned char* src, int width, int height, MipColorSpace colorSpace, unsigned char* dst);
+
+// 生成完整 mip 链：internalFormat 为 uncompressedFormatInfo（ktx_container.h）认识的未压缩格式，
+// pixels 开头是第 0 级，其余各级依次追加在后面，每级的行按 textureRowSize 补齐到 4 字节（RGBA8 即紧密排列）；
+// image 写出各级的偏移和尺寸，可直接交给 writeKTX 或逐级上传
+void generateMipChain(std::vector<unsigned char>* pixels, GLenum internalFormat, int width, int height,
+                      MipColorSpace colorSpace, KTXImage* image);
+
+#endif //NDKLEARN2_MIP_GENERATOR_H
@@ -1,7 +1,12 @@
-#include <jni.h>
 #include <GLES3/gl3.h>
 #include <android/log.h>
 #include <cmath>
+#include "opengl_renderer.h"
+#include "opengl_utils.h"
+#include "shader_compile_service.h"
+#include "shader_registry.h"
+#include "gl_trace.h"
+#include "frame_timing.h"
 
 #define LOG_TAG "OpenGLRenderer"
 #define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
@@ -69,93 +74,18 @@ precision mediump float;
 )";
 
 // ============================================================
-// 编译 GLSL 着色器代码
+// 编译 GLSL 着色器代码 / 创建着色器程序
 // ============================================================
-// 这个函数将 GLSL 字符串源码编译成 GPU 可执行的着色器对象
-// type: GL_VERTEX_SHADER 或 GL_FRAGMENT_SHADER
-// source: GLSL 源码字符串（就是上面定义的 vertexShaderSource 或 fragmentShaderSource）
-static GLuint compileShader(GLenum type, const char* source) {
-    GLuint shader = glCreateShader(type);
-    if (shader == 0) {
-        LOGE("Failed to create shader");
-        return 0;
-    }
-    
-    glShaderSource(shader, 1, &source, nullptr);
-    glCompileShader(shader);
-    
-    GLint compiled = 0;
-    glGetShaderiv(shader, GL_COMPILE_STATUS, &compiled);
-    if (!compiled) {
-        GLint infoLen = 0;
-        glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &infoLen);
-        if (infoLen > 0) {
-            char* infoLog = new char[infoLen];
-            glGetShaderInfoLog(shader, infoLen, nullptr, infoLog);
-            LOGE("Shader compilation error: %s", infoLog);
-            delete[] infoLog;
-        }
-        glDeleteShader(shader);
-        return 0;
-    }
-    
-    return shader;
-}
-
-// ============================================================
-// 创建着色器程序（Shader Program）
-// ============================================================
-// 将顶点着色器和片段着色器链接成一个完整的着色器程序
-// 这个程序会在 GPU 上执行，处理所有的渲染工作
-static GLuint createProgram() {
-    GLuint vertexShader = compileShader(GL_VERTEX_SHADER, vertexShaderSource);
-    if (vertexShader == 0) {
-        return 0;
-    }
-    
-    GLuint fragmentShader = compileShader(GL_FRAGMENT_SHADER, fragmentShaderSource);
-    if (fragmentShader == 0) {
-        glDeleteShader(vertexShader);
-        return 0;
-    }
-    
-    GLuint program = glCreateProgram();
-    if (program == 0) {
-        LOGE("Failed to create program");
-        glDeleteShader(vertexShader);
-        glDeleteShader(fragmentShader);
-        return 0;
-    }
-    
-    glAttachShader(program, vertexShader);
-    glAttachShader(program, fragmentShader);
-    glLinkProgram(program);
-    
-    GLint linked = 0;
-    glGetProgramiv(program, GL_LINK_STATUS, &linked);
-    if (!linked) {
-        GLint infoLen = 0;
-        glGetProgramiv(program, GL_INFO_LOG_LENGTH, &infoLen);
-        if (infoLen > 0) {
-            char* infoLog = new char[infoLen];
-            glGetProgramInfoLog(program, infoLen, nullptr, infoLog);
-            LOGE("Program linking error: %s", infoLog);
-            delete[] infoLog;
-        }
-        glDeleteProgram(program);
-        glDeleteShader(vertexShader);
-        glDeleteShader(fragmentShader);
-        return 0;
-    }
-    
-    glDeleteShader(vertexShader);
-    glDeleteShader(fragmentShader);
-    
-    return program;
-}
+// 编译和链接统一由 opengl_utils 中的 createProgram() 完成：
+// 它会先查找程序二进制缓存（program_cache.h），命中时直接加载，
+// 跳过 GLSL 编译；未命中时才把 GLSL 源码编译链接成 GPU 可执行的程序
+//
+// 这里通过 shader_compile_service 把 createProgram() 放到工作线程执行，
+// triangleRendererInit 不再等待编译完成，triangleRendererRender 每帧非阻塞地检查程序是否就绪
 
 // 全局变量
 static GLuint gProgram = 0;
+static ProgramFuture gProgramFuture;  // 异步编译中的程序
 static GLuint gVAO = 0;
 static GLuint gVBO = 0;
 static float gRotationAngle = 0.0f;
@@ -177,19 +107,21 @@ static float gBrightness = 1.0f;
 //   → 设置 OpenGLRenderer 
 //   → GLSurfaceView 创建 OpenGL 上下文
 //   → 调用 OpenGLRenderer.onSurfaceCreated()
-//   → onSurfaceCreated() 调用 nativeInit() (这里！)
-//   → nativeInit() 编译 GLSL 着色器并创建缓冲区
-extern "C" JNIEXPORT jboolean JNICALL
-Java_com_example_ndklearn2_OpenGLRenderer_nativeInit(JNIEnv* env, jobject thiz) {
+//   → onSurfaceCreated() 调用 nativeInit() (JNI，见 opengl_renderer_jni.cpp)
+//   → nativeInit() 调用 triangleRendererInit() (这里！)
+//   → 编译 GLSL 着色器并创建缓冲区
+bool triangleRendererInit() {
     LOGI("Initializing OpenGL ES 3.0");
+    glTraceContextCreated();
+    frameTimingContextCreated();
+    glCheckContextCreated();
     
-    // 【步骤 1】编译 GLSL 着色器代码，创建着色器程序
-    // 这里会编译上面定义的 vertexShaderSource 和 fragmentShaderSource
-    gProgram = createProgram();
-    if (gProgram == 0) {
-        LOGE("Failed to create shader program");
-        return JNI_FALSE;
-    }
+    // 【步骤 1】提交 GLSL 着色器编译请求
+    // 编译在共享上下文的工作线程上进行，这里立即返回，程序就绪前 triangleRendererRender 只画占位帧
+    startShaderCompileService();
+    gProgram = 0;
+    gProgramFuture = requestProgramAsync(vertexShaderSource, fragmentShaderSource,
+                                         nullptr, 0, GL_INTERLEAVED_ATTRIBS);
     
     // ============================================================
     // 【第一部分】定义顶点数据
@@ -392,22 +324,25 @@ Java_com_example_ndklearn2_OpenGLRenderer_nativeInit(JNIEnv* env, jobject thiz)
     glBindVertexArray(0);
     // 现在：不再绑定任何 VAO
     // 注意：VAO 中已经保存了所有配置，解绑不影响已保存的配置
-    
 
-    //setup uniform
-    gUniformBrightnessLoc = glGetUniformLocation(gProgram, "uBrightness");
+    // uniform 位置要等程序链接完成后才能查询，见 onProgramReady()
+
+    LOGI("OpenGL initialization successful");
+    return true;
+}
+
+// 程序在工作线程链接完成后，在渲染线程执行一次
+static void onProgramReady() {
+    //setup uniform（从注册表的反射结果中取，不再向驱动查询）
+    registerProgram(gProgram, LOG_TAG);
+    gUniformBrightnessLoc = programUniformLocation(gProgram, uniformHandle("uBrightness"));
     if (gUniformBrightnessLoc == -1) {
         LOGE("Failed to get uniform location for uBrightness");
-        return JNI_FALSE;
     }
-
-    LOGI("OpenGL initialization successful");
-    return JNI_TRUE;
 }
 
 // 改变视口大小
-extern "C" JNIEXPORT void JNICALL
-Java_com_example_ndklearn2_OpenGLRenderer_nativeResize(JNIEnv* env, jobject thiz, jint width, jint height) {
+void triangleRendererResize(int width, int height) {
     LOGI("Resizing viewport to %d x %d", width, height);
     glViewport(0, 0, width, height);
 }
@@ -420,25 +355,47 @@ Java_com_example_ndklearn2_OpenGLRenderer_nativeResize(JNIEnv* env, jobject thiz
 // 完整调用链：
 // GLSurfaceView 渲染循环（每帧）
 //   → 调用 OpenGLRenderer.onDrawFrame()
-//   → onDrawFrame() 调用 nativeRender() (这里！)
-//   → nativeRender() 使用编译好的 GLSL 着色器程序绘制
+//   → onDrawFrame() 调用 nativeRender() (JNI，见 opengl_renderer_jni.cpp)
+//   → nativeRender() 调用 triangleRendererRender() (这里！)
+//   → 使用编译好的 GLSL 着色器程序绘制
 //   → GPU 执行 GLSL 着色器代码
 //   → 渲染结果显示在屏幕上
-extern "C" JNIEXPORT void JNICALL
-Java_com_example_ndklearn2_OpenGLRenderer_nativeRender(JNIEnv* env, jobject thiz) {
+void triangleRendererRender() {
+    GLTraceFrameScope traceFrame;
+    FrameTimingFrameScope timingFrame;
+    GLCheckFrameScope checkFrame;
+
     // 清除颜色缓冲区（设置背景色）
-    glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
-    glClear(GL_COLOR_BUFFER_BIT);
+    {
+        FrameTimingStageScope timing(FRAME_STAGE_CLEAR);
+        glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT);
+    }
+
+    // 程序还在编译：只输出背景色作为占位帧，不阻塞渲染线程
+    if (gProgram == 0) {
+        if (!pollProgram(&gProgramFuture, &gProgram)) {
+            return;
+        }
+        if (gProgram == 0) {
+            LOGE("Failed to create shader program");
+            return;
+        }
+        onProgramReady();
+    }
     
     // 【关键步骤】激活着色器程序
     // 这会让 GPU 使用我们编译好的 GLSL 着色器代码！
     // 之后所有的绘制操作都会使用这个着色器程序
-    glUseProgram(gProgram);
-    //getuniform
-    if (gUniformBrightnessLoc != -1) {
-        float brightness = sin(gRotationAngle) * 0.5f + 0.5f;
-        glUniform1f(gUniformBrightnessLoc, brightness);
-        gRotationAngle += 0.01f;
+    {
+        FrameTimingStageScope timing(FRAME_STAGE_UNIFORMS);
+        glUseProgram(gProgram);
+        //getuniform
+        if (gUniformBrightnessLoc != -1) {
+            float brightness = sin(gRotationAngle) * 0.5f + 0.5f;
+            glUniform1f(gUniformBrightnessLoc, brightness);
+            gRotationAngle += 0.01f;
+        }
     }
 
 
@@ -456,14 +413,14 @@ Java_com_example_ndklearn2_OpenGLRenderer_nativeRender(JNIEnv* env, jobject thiz
     // 2. 然后进行光栅化（将三角形转换为像素）
     // 3. GPU 会执行片段着色器（fragmentShaderSource）处理每个像素
     // 4. 最终颜色写入帧缓冲区，显示在屏幕上
+    FrameTimingStageScope timing(FRAME_STAGE_DRAW);
     glBindVertexArray(gVAO);
     glDrawArrays(GL_TRIANGLES, 0, 3);  // 绘制 3 个顶点组成的三角形
     glBindVertexArray(0);
 }
 
 // 清理资源
-extern "C" JNIEXPORT void JNICALL
-Java_com_example_ndklearn2_OpenGLRenderer_nativeCleanup(JNIEnv* env, jobject thiz) {
+void triangleRendererCleanup() {
     LOGI("Cleaning up OpenGL resources");
     
     if (gVAO != 0) {
@@ -477,8 +434,10 @@ Java_com_example_ndklearn2_OpenGLRenderer_nativeCleanup(JNIEnv* env, jobject thi
     }
     
     if (gProgram != 0) {
+        unregisterProgram(gProgram);
         glDeleteProgram(gProgram);
         gProgram = 0;
     }
+    gProgramFuture = ProgramFuture();
 }
 
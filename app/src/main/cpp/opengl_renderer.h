@@ -0,0 +1,16 @@
+//
+// Created by zhangx on 2026/10/16.
+// Renderer1（渐变三角形）的渲染核心，不依赖 JNI，JNI 入口见 opengl_renderer_jni.cpp
+// 所有函数都在持有 GL 上下文的渲染线程调用
+//
+
+#ifndef NDKLEARN2_OPENGL_RENDERER_H
+#define NDKLEARN2_OPENGL_RENDERER_H
+
+// 提交着色器编译并创建三角形的 VAO/VBO，程序就绪前 render 只画清屏色
+bool triangleRendererInit();
+void triangleRendererResize(int width, int height);
+void triangleRendererRender();
+void triangleRendererCleanup();
+
+#endif //NDKLEARN2_OPENGL_RENDERER_H
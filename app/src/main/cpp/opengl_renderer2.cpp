@@ -2,26 +2,83 @@
 // Created by zhangx on 2026/1/3.
 //
 
-#include <jni.h>
 #include <GLES3/gl3.h>
 #include <android/log.h>
 #include <cmath>
-#include <android/bitmap.h>
+#include <chrono>
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "opengl_renderer2.h"
+#include "opengl_utils.h"
+#include "vertex_layout.h"
+#include "program_cache.h"
+#include "shader_compile_service.h"
+#include "texture_loader.h"
+#include "shader_variants.h"
+#include "shader_registry.h"
+#include "gl_trace.h"
+#include "frame_timing.h"
+#include "frustum_culling.h"
+#include "stream_buffer.h"
+#include "std140_layout.h"
 
 #define LOG_TAG "OpenGLRenderer2"
 #define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
 #define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
 
-static GLuint compileShader(GLenum type, const char* source);
-static GLuint createProgram();
-
 static GLuint gProgram = 0;
 static GLuint gLightingProgram = 0;  // 光照程序
-static GLuint gVAO = 0;
-static GLuint gVBO = 0;
-static GLuint gEBO = 0;
+static ProgramFuture gProgramFuture;  // 异步编译中的光照程序
+// 正方体顶点：半精度位置、2_10_10_10 法线、半精度 UV、整数面ID，每个顶点 20 字节（float 源数据为 36 字节）
+typedef VertexLayout<VertexHalf<3>, VertexPackedNormal, VertexHalf<2>, VertexUByteInt<1>> CubeVertexLayout;
+static MeshData gCubeMesh = {0, 0, 0, 0, GL_UNSIGNED_INT};
+// lightingRendererSetMeshArenaEnabled 打开时，init 创建本渲染器的网格池集合，之后加载的 .mesh 文件放进其中，
+// cleanup 时连同网格一起释放
+static bool gMeshArenaEnabled = false;
+static MeshArenaSet* gMeshArenas = nullptr;
+// .mesh 文件的网格在网格池中时：gCubeMesh 每帧从网格池刷新，索引范围加上 gMeshFirstIndex
+static MeshArena* gMeshArena = nullptr;
+static ArenaMeshHandle gArenaMesh = 0;
+static uint32_t gMeshFirstIndex = 0;
+static uint32_t gArenaGeneration = 0;  // 上次设置实例属性时网格池的重建次数
+// 网格各子网格的 LOD 索引范围和包围盒（内置正方体为一个子网格、一级 LOD）
+static int gMeshSubmeshCount = 0;
+static MeshSubmesh gMeshSubmeshes[MESH_MAX_SUBMESHES];
+// LOD 选择：与 TransformBlock 中上传的相同的矩阵、视口高度，以及允许的屏幕误差（像素）
+static float gModelMatrix[16] = {1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1};
+static float gViewMatrix[16] = {1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1};
+static float gProjMatrix[16] = {1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1};
+static float gNormalMatrix[12] = {1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0};
+static int gViewportHeight = 1;
+static float gLodThreshold = 1.0f;
+// 实例化绘制：每个实例的模型矩阵和法线矩阵在 CPU 上保留一份，render 时只上传改过的范围
+static const int INSTANCE_FLOATS = 16 + 9;  // mat4 + mat3
+static const GLuint INSTANCE_MODEL_LOCATION = 4;   // 占 location 4-7
+static const GLuint INSTANCE_NORMAL_LOCATION = 8;  // 占 location 8-10
+static std::vector<float> gInstanceData;
+static int gInstanceCount = 0;
+static int gDirtyFirst = 0;        // 待上传的实例范围 [gDirtyFirst, gDirtyEnd)
+static int gDirtyEnd = 0;
+static bool gInstancing = true;    // false 时逐个实例更新 TransformBlock 并绘制
+static GLuint gInstanceVBO = 0;
+static int gInstanceCapacity = 0;  // gInstanceVBO 能放下的实例数
+static bool gInstanceAttributesSet = false;  // gCubeMesh 当前的 VAO 中已经设置了实例属性
+static bool gCulling = true;
+static float gMeshBoundsMin[3] = {0.0f, 0.0f, 0.0f};  // 所有子网格合起来的包围盒
+static float gMeshBoundsMax[3] = {0.0f, 0.0f, 0.0f};
+static CullBounds gInstanceBounds;                   // 实例在 TransformBlock 模型空间中的包围盒
+static std::vector<uint32_t> gVisibleInstances;      // 本帧剔除后的实例，升序
+static std::vector<uint32_t> gUploadedInstances;     // gInstanceCompacted 时实例缓冲中依次存放的实例
+static bool gInstanceCompacted = false;              // 实例缓冲中只有部分实例（紧凑排列）
+static std::vector<float> gCompactData;
+static int gDrawnInstances = 0;
 static GLuint gTextureID1 = 0;
 static GLuint g_textureID = 0;  // 纹理ID
+static TextureFuture gTextureFuture;  // 上传中的纹理
+static int gFrameCount = 0;
 
 // Uniform Buffer Objects
 static GLuint gUBOTransform = 0;   // 变换矩阵UBO
@@ -33,6 +90,103 @@ const GLuint UBO_BINDING_TRANSFORM = 0;
 const GLuint UBO_BINDING_LIGHT = 1;
 const GLuint UBO_BINDING_MATERIAL = 2;
 
+// Uniform Block 的 std140 布局（std140_layout.h），成员顺序与着色器中的声明一致。
+// 程序异步编译时 UBO 需要在程序就绪前创建，块大小取自布局，不能再向程序查询；
+// 程序就绪后与反射的偏移核对（onLightingProgramReady）
+typedef Std140Block<Std140Mat4, Std140Mat4, Std140Mat4, Std140Mat3> TransformBlockLayout;
+enum { TRANSFORM_MODEL, TRANSFORM_VIEW, TRANSFORM_PROJECTION, TRANSFORM_NORMAL };
+
+typedef Std140Block<Std140Vec3, Std140Vec3, Std140Vec3, Std140Vec3, Std140Vec3, Std140Vec3,
+                    Std140Float, Std140Float, Std140Vec3, Std140Int, Std140Float> LightBlockLayout;
+enum {
+    LIGHT_AMBIENT, LIGHT_DIFFUSE, LIGHT_SPECULAR, LIGHT_DIRECTION, LIGHT_POSITION, LIGHT_ATTENUATION,
+    LIGHT_SPOT_EXPONENT, LIGHT_SPOT_CUTOFF_ANGLE, LIGHT_SPOT_DIRECTION, LIGHT_COMPUTE_ATTENUATION,
+    LIGHT_SPOT_COS_CUTOFF
+};
+
+typedef Std140Block<Std140Vec3, Std140Vec3, Std140Vec3, Std140Float> MaterialBlockLayout;
+enum { MATERIAL_AMBIENT, MATERIAL_DIFFUSE, MATERIAL_SPECULAR, MATERIAL_SHININESS };
+
+// 标量紧跟在 vec3 之后（uSpotExponent、uMaterialShininess），mat3 每列补齐到 vec4
+static_assert(TransformBlockLayout::Member<TRANSFORM_NORMAL>::OFFSET == 192, "TransformBlock layout");
+static_assert(TransformBlockLayout::SIZE == 240, "TransformBlock size");
+static_assert(LightBlockLayout::Member<LIGHT_SPOT_EXPONENT>::OFFSET == 92, "LightBlock layout");
+static_assert(LightBlockLayout::Member<LIGHT_SPOT_DIRECTION>::OFFSET == 112, "LightBlock layout");
+static_assert(LightBlockLayout::Member<LIGHT_COMPUTE_ATTENUATION>::OFFSET == 124, "LightBlock layout");
+static_assert(LightBlockLayout::Member<LIGHT_SPOT_COS_CUTOFF>::OFFSET == 128, "LightBlock layout");
+static_assert(LightBlockLayout::SIZE == 144, "LightBlock size");
+static_assert(MaterialBlockLayout::Member<MATERIAL_SHININESS>::OFFSET == 44, "MaterialBlock layout");
+static_assert(MaterialBlockLayout::SIZE == 48, "MaterialBlock size");
+
+const GLsizeiptr TRANSFORM_BLOCK_SIZE = TransformBlockLayout::SIZE;
+const GLsizeiptr LIGHT_BLOCK_SIZE = LightBlockLayout::SIZE;
+const GLsizeiptr MATERIAL_BLOCK_SIZE = MaterialBlockLayout::SIZE;
+
+// UBO 内容在 CPU 上的副本：lightingRendererUpdate* 只改副本并标记，render 时整块写进环形缓冲
+// （退回固定的 UBO 时只上传变化的块）
+// （TransformBlock 的副本在上传时由 gModelMatrix 等拼出）
+static unsigned char gTransformBlock[TRANSFORM_BLOCK_SIZE];
+static unsigned char gLightBlock[LIGHT_BLOCK_SIZE];
+static unsigned char gMaterialBlock[MATERIAL_BLOCK_SIZE];
+static bool gTransformDirty = false;
+static bool gLightDirty = false;
+static bool gMaterialDirty = false;
+static bool gUniformsInRing = false;  // 绑定点当前指向环形缓冲中的范围（而不是上面的固定 UBO）
+
+// 流式环形缓冲（stream_buffer.h）：uniform 块每帧写进这里并直接绑定；实例缓冲的更新写进这里再在 GPU 上复制过去。
+// 放不下时退回固定的 UBO / glBufferSubData
+static StreamBuffer* gStreamBuffer = nullptr;
+static const GLsizeiptr STREAM_FRAME_SIZE = 2 * 1024 * 1024;
+static const int STREAM_FRAMES_IN_FLIGHT = 3;
+
+// 注册表句柄：初始化时取一次，渲染时 O(1) 查位置，对通用程序和所有变体通用
+static const BlockHandle BLOCK_TRANSFORM = uniformBlockHandle("TransformBlock");
+static const BlockHandle BLOCK_LIGHT = uniformBlockHandle("LightBlock");
+static const BlockHandle BLOCK_MATERIAL = uniformBlockHandle("MaterialBlock");
+// 各块成员的句柄，顺序与上面的布局一致，用于链接后核对偏移
+static const UniformHandle TRANSFORM_MEMBERS[TransformBlockLayout::COUNT] = {
+    uniformHandle("uModelMatrix"), uniformHandle("uViewMatrix"), uniformHandle("uProjectionMatrix"),
+    uniformHandle("uNormalMatrix")
+};
+static const UniformHandle LIGHT_MEMBERS[LightBlockLayout::COUNT] = {
+    uniformHandle("uAmbientColor"), uniformHandle("uDiffuseColor"), uniformHandle("uSpecularColor"),
+    uniformHandle("uLightDirection"), uniformHandle("uLightPos"), uniformHandle("uAttenuationFactors"),
+    uniformHandle("uSpotExponent"), uniformHandle("uSpotCutoffAngle"), uniformHandle("uSpotDirection"),
+    uniformHandle("uComputeDistanceAttenuation"), uniformHandle("uSpotCosCutoff")
+};
+static const UniformHandle MATERIAL_MEMBERS[MaterialBlockLayout::COUNT] = {
+    uniformHandle("uMaterialAmbient"), uniformHandle("uMaterialDiffuse"), uniformHandle("uMaterialSpecular"),
+    uniformHandle("uMaterialShininess")
+};
+static const UniformHandle UNIFORM_CAMERA_POS = uniformHandle("uCameraPos");
+static const UniformHandle UNIFORM_TEXTURE = uniformHandle("uTexture");
+
+// 相机位置（程序就绪前先保存下来）
+static float gCameraPos[3] = {0.0f, 0.0f, 0.0f};
+// lightingRendererUpdateCameraPos 每次加一；gCameraPosUploaded 记录各程序已上传的版本，程序名字重建上下文后作废
+static uint32_t gCameraPosVersion = 1;
+static std::unordered_map<GLuint, uint32_t> gCameraPosUploaded;
+
+static const char* const LIGHT_VARIANT_DEFINES[LIGHT_VARIANT_COUNT] = {
+    "#define LIGHT_DIRECTIONAL\n",
+    "#define LIGHT_POINT\n",
+    "#define LIGHT_POINT\n#define USE_ATTENUATION\n",
+    "#define LIGHT_SPOT\n",
+    "#define LIGHT_SPOT\n#define USE_ATTENUATION\n",
+};
+
+static const char* const LIGHT_VARIANT_NAMES[LIGHT_VARIANT_COUNT] = {
+    "directional", "point", "point+attenuation", "spot", "spot+attenuation"
+};
+
+// 实例化的变体：光照变体加上 USE_INSTANCING，最后一个是实例化的通用程序（光照变体就绪前使用）
+static const int INSTANCED_VARIANT_OFFSET = LIGHT_VARIANT_COUNT;
+static const int INSTANCED_GENERIC_VARIANT = LIGHT_VARIANT_COUNT * 2;
+static const int SHADER_VARIANT_COUNT = LIGHT_VARIANT_COUNT * 2 + 1;
+
+static ShaderVariantSet gLightVariants;
+static int gLightVariant = -1;  // 当前 LightBlock 对应的变体，-1 表示光照参数还没设置
+
 
 
 //顶点着色器
@@ -50,18 +204,29 @@ layout(std140) uniform TransformBlock {
 layout(location = 0) in vec3 aPosition;
 layout(location = 1) in vec3 aNormal;//顶点法向量
 layout(location = 2) in vec2 aTexCoord;    // 纹理坐标（可选）
-
+#ifdef USE_INSTANCING
+// 每个实例的矩阵（glVertexAttribDivisor 为 1），UBO 中的模型矩阵和法线矩阵作为整组的变换
+layout(location = 4) in mat4 aInstanceModel;   // 占 location 4-7
+layout(location = 8) in mat3 aInstanceNormal;  // 占 location 8-10
+#endif
 
 out vec3 worldPos;//因为光照要通过世界坐标
 out vec3 vWorldSpaceNormal;
 out vec2 vTexCoord;      // 纹理坐标
 void main() {
+#ifdef USE_INSTANCING
+    mat4 modelMatrix = uModelMatrix * aInstanceModel;
+    mat3 normalMatrix = uNormalMatrix * aInstanceNormal;
+#else
+    mat4 modelMatrix = uModelMatrix;
+    mat3 normalMatrix = uNormalMatrix;
+#endif
 
-    worldPos = (uModelMatrix * vec4(aPosition, 1.0)).xyz;
+    worldPos = (modelMatrix * vec4(aPosition, 1.0)).xyz;
 
     vTexCoord = aTexCoord;
 
-    vWorldSpaceNormal = normalize(uNormalMatrix * aNormal);
+    vWorldSpaceNormal = normalize(normalMatrix * aNormal);
 
     // gl_Position 是内置变量，必须设置！
     // 这是顶点在裁剪空间中的最终位置
@@ -85,6 +250,7 @@ layout(std140) uniform LightBlock {
     float uSpotCutoffAngle;       // 聚光灯截止角度（度数）
     vec3 uSpotDirection;           // 聚光灯方向（归一化）
     int uComputeDistanceAttenuation;  // 是否计算距离衰减 (bool用int表示)
+    float uSpotCosCutoff;          // cos(radians(uSpotCutoffAngle))，由 CPU 预先计算
 };
 
 // 材质 Uniform Block
@@ -114,6 +280,24 @@ void main() {
     float distance = 0.0;
     float attenuation = 1.0;
 
+#if defined(LIGHT_DIRECTIONAL)
+    // 特化变体：光照类型和衰减开关在整个绘制内不变，由 CPU 选好变体，GPU 不再分支
+    L = normalize(-uLightDirection);
+#elif defined(LIGHT_POINT) || defined(LIGHT_SPOT)
+    vec3 lightDir = uLightPos - worldPos;
+    distance = length(lightDir);
+    L = normalize(lightDir);
+#ifdef USE_ATTENUATION
+    attenuation = 1.0 / (uAttenuationFactors.x + uAttenuationFactors.y * distance
+                         + uAttenuationFactors.z * distance * distance);
+#endif
+#ifdef LIGHT_SPOT
+    // 截止角的余弦和方向的归一化都已在 CPU 上完成
+    float cosAngle = dot(-L, uSpotDirection);
+    attenuation *= cosAngle > uSpotCosCutoff ? pow(cosAngle, uSpotExponent) : 0.0;
+#endif
+#else
+    // 通用程序（uber shader）：特化变体编译完成前使用
     //方向光是完整覆盖图形的平行光柱 与之相对的是点光源
     // 判断是方向光还是点光源/聚光灯
     if (uLightDirection.x == 0.0 && uLightDirection.y == 0.0 && uLightDirection.z == 0.0) {
@@ -154,6 +338,7 @@ void main() {
         L = normalize(-uLightDirection);
         attenuation = 1.0;  // 方向光无衰减
     }
+#endif
 
     // ========== Phong 光照模型 ==========
     vec3 N = normalize(vWorldSpaceNormal);
@@ -193,188 +378,711 @@ void main() {
 
 
 
-extern "C" JNIEXPORT jboolean JNICALL
-Java_com_example_ndklearn2_OpenGLRenderer2_nativeInit(JNIEnv* env, jobject thiz) {
+// 把程序的 Uniform Block 绑定到绑定点；块大小和成员偏移由 verifyStd140Layout 检查
+static void bindUniformBlock(GLuint program, BlockHandle block, const char* blockName, GLuint bindingPoint) {
+    if (!bindProgramUniformBlock(program, block, bindingPoint)) {
+        LOGE("%s not found in shader", blockName);
+        return;
+    }
+    GLint blockSize = programUniformBlockSize(program, block);
+    LOGI("%s bound to binding point %d (%d bytes)", blockName, bindingPoint, blockSize);
+}
+
+// 每个程序已上传的相机位置版本，不同时在使用这个程序绘制之前上传
+static void uploadCameraPos(GLuint program) {
+    uint32_t& uploaded = gCameraPosUploaded[program];
+    if (uploaded == gCameraPosVersion) {
+        return;
+    }
+    uploaded = gCameraPosVersion;
+    GLint cameraPosLoc = programUniformLocation(program, UNIFORM_CAMERA_POS);
+    if (cameraPosLoc == -1) {
+        return;
+    }
+    cachedUseProgram(program);
+    glUniform3fv(cameraPosLoc, 1, gCameraPos);
+}
+
+// 程序在工作线程链接完成后，在渲染线程执行一次：设置依赖程序对象的状态
+// 通用程序和每个特化变体都会走这里
+static void onLightingProgramReady(GLuint program) {
+    bindUniformBlock(program, BLOCK_TRANSFORM, "TransformBlock", UBO_BINDING_TRANSFORM);
+    bindUniformBlock(program, BLOCK_LIGHT, "LightBlock", UBO_BINDING_LIGHT);
+    bindUniformBlock(program, BLOCK_MATERIAL, "MaterialBlock", UBO_BINDING_MATERIAL);
+    // 布局与着色器不一致（或 UBO 小于块大小）时上传的数据会错位，只报告，不阻止绘制
+    verifyStd140Layout<TransformBlockLayout>(program, BLOCK_TRANSFORM, TRANSFORM_MEMBERS);
+    verifyStd140Layout<LightBlockLayout>(program, BLOCK_LIGHT, LIGHT_MEMBERS);
+    verifyStd140Layout<MaterialBlockLayout>(program, BLOCK_MATERIAL, MATERIAL_MEMBERS);
+    // 采样器固定用纹理单元 0，只在这里设置一次
+    GLint textureLoc = programUniformLocation(program, UNIFORM_TEXTURE);
+    if (textureLoc != -1) {
+        cachedUseProgram(program);
+        glUniform1i(textureLoc, 0);
+    }
+
+    logProgramCacheStats(LOG_TAG);
+}
+
+// 根据光照参数选择变体，判断条件与通用程序中的分支一致
+static int selectLightVariant(const LightParams& light) {
+    if (light.direction[0] != 0.0f || light.direction[1] != 0.0f || light.direction[2] != 0.0f) {
+        return LIGHT_VARIANT_DIRECTIONAL;
+    }
+    bool spot = light.spotCutoffAngle > 0.0f && light.spotCutoffAngle < 90.0f;
+    bool attenuation = light.computeDistanceAttenuation != 0;
+    if (spot) {
+        return attenuation ? LIGHT_VARIANT_SPOT_ATTENUATION : LIGHT_VARIANT_SPOT;
+    }
+    return attenuation ? LIGHT_VARIANT_POINT_ATTENUATION : LIGHT_VARIANT_POINT;
+}
+
+// 把光照参数按 std140 写进 block，整个绘制内不变的计算（截止角余弦、方向归一化）在这里一次完成
+static void packLightBlock(const LightParams& light, unsigned char* block) {
+    float spotCosCutoff = cosf(light.spotCutoffAngle * (float)M_PI / 180.0f);
+    float spotDirection[3] = {light.spotDirection[0], light.spotDirection[1], light.spotDirection[2]};
+    float length = sqrtf(spotDirection[0] * spotDirection[0] + spotDirection[1] * spotDirection[1]
+                         + spotDirection[2] * spotDirection[2]);
+    if (length > 0.0f) {
+        spotDirection[0] /= length;
+        spotDirection[1] /= length;
+        spotDirection[2] /= length;
+    }
+
+    LightBlockLayout::write<LIGHT_AMBIENT>(block, light.ambient);
+    LightBlockLayout::write<LIGHT_DIFFUSE>(block, light.diffuse);
+    LightBlockLayout::write<LIGHT_SPECULAR>(block, light.specular);
+    LightBlockLayout::write<LIGHT_DIRECTION>(block, light.direction);
+    LightBlockLayout::write<LIGHT_POSITION>(block, light.position);
+    LightBlockLayout::write<LIGHT_ATTENUATION>(block, light.attenuation);
+    LightBlockLayout::write<LIGHT_SPOT_EXPONENT>(block, &light.spotExponent);
+    LightBlockLayout::write<LIGHT_SPOT_CUTOFF_ANGLE>(block, &light.spotCutoffAngle);
+    LightBlockLayout::write<LIGHT_SPOT_DIRECTION>(block, spotDirection);
+    LightBlockLayout::write<LIGHT_COMPUTE_ATTENUATION>(block, &light.computeDistanceAttenuation);
+    LightBlockLayout::write<LIGHT_SPOT_COS_CUTOFF>(block, &spotCosCutoff);
+}
+
+// normal 为按 std140 展开的 mat3（每列 4 个 float）
+static void packTransformBlock(const float* model, const float* normal, unsigned char* block) {
+    TransformBlockLayout::write<TRANSFORM_MODEL>(block, model);
+    TransformBlockLayout::write<TRANSFORM_VIEW>(block, gViewMatrix);
+    TransformBlockLayout::write<TRANSFORM_PROJECTION>(block, gProjMatrix);
+    Std140Mat3::writeColumns(block + TransformBlockLayout::Member<TRANSFORM_NORMAL>::OFFSET, normal, 4);
+}
+
+// 每帧把三个块整块写进环形缓冲的一段（一次映射），各自用 glBindBufferRange 绑定到绑定点，着色器直接读环形缓冲，
+// 不再复制到固定的 UBO，也不会改写前几帧可能还在读的存储。环形缓冲中的范围只在 framesInFlight 帧内有效，
+// 没变的块也每帧重写（一共几百字节）。环形缓冲不可用时退回固定的 UBO，只上传变化的块
+static void uploadUniformBlocks() {
+    struct UniformBlock {
+        GLuint binding;
+        GLuint ubo;
+        const unsigned char* data;
+        GLsizeiptr size;
+        bool* dirty;
+    };
+    if (gUBOTransform == 0) {
+        return;
+    }
+    if (gTransformDirty) {
+        packTransformBlock(gModelMatrix, gNormalMatrix, gTransformBlock);
+    }
+    const UniformBlock blocks[] = {
+        {UBO_BINDING_TRANSFORM, gUBOTransform, gTransformBlock, TRANSFORM_BLOCK_SIZE, &gTransformDirty},
+        {UBO_BINDING_LIGHT, gUBOLight, gLightBlock, LIGHT_BLOCK_SIZE, &gLightDirty},
+        {UBO_BINDING_MATERIAL, gUBOMaterial, gMaterialBlock, MATERIAL_BLOCK_SIZE, &gMaterialDirty},
+    };
+    const int blockCount = sizeof(blocks) / sizeof(blocks[0]);
+    if (gStreamBuffer != nullptr) {
+        // 每块的起点对齐到 GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT
+        GLsizeiptr alignment = streamBufferUniformAlignment(gStreamBuffer);
+        GLsizeiptr offsets[blockCount];
+        GLsizeiptr total = 0;
+        for (int i = 0; i < blockCount; i++) {
+            offsets[i] = total;
+            total = (total + blocks[i].size + alignment - 1) / alignment * alignment;
+        }
+        StreamRange range;
+        unsigned char* mapped = (unsigned char*)streamBufferMap(gStreamBuffer, total, alignment, &range);
+        if (mapped != nullptr) {
+            for (int i = 0; i < blockCount; i++) {
+                memcpy(mapped + offsets[i], blocks[i].data, (size_t)blocks[i].size);
+            }
+            if (streamBufferUnmap(gStreamBuffer)) {
+                for (int i = 0; i < blockCount; i++) {
+                    cachedBindBufferRange(GL_UNIFORM_BUFFER, blocks[i].binding, range.buffer,
+                                          range.offset + offsets[i], blocks[i].size);
+                    *blocks[i].dirty = false;
+                }
+                gUniformsInRing = true;
+                return;
+            }
+        }
+    }
+    // 绑定点改回固定的 UBO；之前绑定的是环形缓冲时，固定 UBO 的内容已经过时，全部重新上传
+    if (gUniformsInRing) {
+        for (int i = 0; i < blockCount; i++) {
+            cachedBindBufferBase(GL_UNIFORM_BUFFER, blocks[i].binding, blocks[i].ubo);
+            *blocks[i].dirty = true;
+        }
+        gUniformsInRing = false;
+    }
+    for (int i = 0; i < blockCount; i++) {
+        if (*blocks[i].dirty) {
+            cachedBindBuffer(GL_UNIFORM_BUFFER, blocks[i].ubo);
+            glBufferSubData(GL_UNIFORM_BUFFER, 0, blocks[i].size, blocks[i].data);
+            *blocks[i].dirty = false;
+        }
+    }
+}
+
+bool lightingRendererInit() {
     LOGI("Initializing Lighting");
 
-    //编译着色器
-    gProgram = createProgram();
-    gLightingProgram = gProgram;  // 使用同一个程序
-    if (gProgram == 0) {
-        LOGE("Failed to create shader program");
-        return JNI_FALSE;
+    // 新的 EGL 上下文：之前缓存的绑定状态全部失效
+    invalidateGLStateCache();
+    glTraceContextCreated();
+    frameTimingContextCreated();
+    glCheckContextCreated();
+
+    //提交着色器编译请求，在工作线程上编译，程序就绪前 lightingRendererRender 只画占位帧
+    startShaderCompileService();
+    startTextureLoader();
+    gProgram = 0;
+    gLightingProgram = 0;
+    gProgramFuture = requestProgramAsync(vertexShaderSource, fragmentShaderSource,
+                                         nullptr, 0, GL_INTERLEAVED_ATTRIBS);
+
+    // 特化变体在光照参数确定后按需编译，编译完成前用通用程序绘制
+    initShaderVariantSet(&gLightVariants, vertexShaderSource, fragmentShaderSource,
+                         SHADER_VARIANT_COUNT, onLightingProgramReady);
+    for (int i = 0; i < LIGHT_VARIANT_COUNT; i++) {
+        setShaderVariantDefines(&gLightVariants, i, LIGHT_VARIANT_DEFINES[i]);
+        std::string instanced = std::string("#define USE_INSTANCING\n") + LIGHT_VARIANT_DEFINES[i];
+        setShaderVariantDefines(&gLightVariants, INSTANCED_VARIANT_OFFSET + i, instanced.c_str());
+    }
+    setShaderVariantDefines(&gLightVariants, INSTANCED_GENERIC_VARIANT, "#define USE_INSTANCING\n");
+    gLightVariant = -1;
+    gCameraPosUploaded.clear();
+    // 旧上下文中的实例缓冲已经失效，CPU 上的实例数据在第一帧全部重新上传
+    gInstanceVBO = 0;
+    gInstanceCapacity = 0;
+    gInstanceAttributesSet = false;
+    gDirtyFirst = 0;
+    gDirtyEnd = gInstanceCount;
+    gInstanceCompacted = false;
+    // 旧上下文中的环形缓冲和 fence 同样失效，只丢掉记录
+    abandonStreamBuffer(gStreamBuffer);
+    gStreamBuffer = createStreamBuffer(STREAM_FRAME_SIZE, STREAM_FRAMES_IN_FLIGHT);
+    // 网格池也一样，网格在资源加载时重新创建
+    if (meshArenaSet() == gMeshArenas) {
+        setMeshArenaSet(nullptr);
+    }
+    abandonMeshArenaSet(gMeshArenas);
+    gMeshArenas = gMeshArenaEnabled ? createMeshArenaSet() : nullptr;
+    if (gMeshArenas != nullptr) {
+        setMeshArenaSet(gMeshArenas);
     }
+    gMeshArena = nullptr;
+    gArenaMesh = 0;
+    gMeshFirstIndex = 0;
 
-    return JNI_TRUE;
+    return true;
 }
 
-extern "C" JNIEXPORT void JNICALL
-Java_com_example_ndklearn2_OpenGLRenderer2_loadTextureFromBitmap(JNIEnv *env, jobject thiz, jobject bitmap) {
-    AndroidBitmapInfo info;
-    void *pixels = nullptr;
+// 上传 RGBA8888 像素（JNI 层负责锁定 Bitmap）：像素复制后交给纹理加载线程，
+// 就绪前继续使用旧纹理，lightingRendererRender 每帧检查并替换
+void lightingRendererUploadTexture(const void* pixels, int width, int height) {
+    lightingRendererSetTexture(requestTextureAsync(pixels, width, height, true));
+}
+
+bool lightingRendererSetTexture(TextureFuture texture) {
+    if (!texture.valid()) {
+        return false;
+    }
+    discardTexture(&gTextureFuture);
+    gTextureFuture = texture;
+    return true;
+}
+
+void lightingRendererReleaseTexture() {
+    discardTexture(&gTextureFuture);
+    releaseDiscardedTextures();
+    releaseTexture(g_textureID);
+    g_textureID = 0;
+}
+
+void lightingRendererResize(int width, int height) {
+    LOGI("Resizing viewport to %d x %d", width, height);
+    cachedViewport(0, 0, width, height);
+    gViewportHeight = height > 0 ? height : 1;
+}
+
+void lightingRendererSetLodThreshold(float pixels) {
+    gLodThreshold = pixels;
+}
 
-    // 1. 获取Bitmap信息
-    if (AndroidBitmap_getInfo(env, bitmap, &info) < 0) {
+void lightingRendererSetMeshArenaEnabled(bool enabled) {
+    gMeshArenaEnabled = enabled;
+}
+
+// 子网格的简化误差投影到屏幕上的像素数不超过阈值的最粗一级：
+// 包围球在视图空间中离相机最近的距离为 d 时，模型空间中长度 e 的误差约占 e * scale * proj[5] * (H / 2) / d 个像素
+static int selectLod(const MeshSubmesh& submesh) {
+    if (submesh.lodCount <= 1 || gLodThreshold <= 0.0f) {
+        return 0;
+    }
+    float center[3];
+    float extent = 0.0f;
+    for (int i = 0; i < 3; i++) {
+        center[i] = (submesh.boundsMin[i] + submesh.boundsMax[i]) * 0.5f;
+        float half = (submesh.boundsMax[i] - submesh.boundsMin[i]) * 0.5f;
+        extent += half * half;
+    }
+    // 模型矩阵的最大缩放，视图矩阵假设为刚体变换
+    float scale = 0.0f;
+    for (int column = 0; column < 3; column++) {
+        const float* m = gModelMatrix + column * 4;
+        scale = fmaxf(scale, sqrtf(m[0] * m[0] + m[1] * m[1] + m[2] * m[2]));
+    }
+    float world[3];
+    for (int i = 0; i < 3; i++) {
+        world[i] = gModelMatrix[i] * center[0] + gModelMatrix[4 + i] * center[1] + gModelMatrix[8 + i] * center[2]
+                   + gModelMatrix[12 + i];
+    }
+    float viewZ = gViewMatrix[2] * world[0] + gViewMatrix[6] * world[1] + gViewMatrix[10] * world[2]
+                  + gViewMatrix[14];
+    float pixelsPerUnit = scale * gProjMatrix[5] * (float)gViewportHeight * 0.5f;
+    // 透视投影（proj[11] 为 -1）按最近距离缩小；正交投影与距离无关
+    if (gProjMatrix[11] != 0.0f) {
+        float distance = -viewZ - sqrtf(extent) * scale;
+        if (distance <= 0.0f) {
+            return 0;
+        }
+        pixelsPerUnit /= distance;
+    }
+    for (int lod = submesh.lodCount - 1; lod > 0; lod--) {
+        if (submesh.lods[lod].error * pixelsPerUnit <= gLodThreshold) {
+            return lod;
+        }
+    }
+    return 0;
+}
+
+// 网格池整理或扩容后 VAO 和索引位置都会变，绘制前重新获取
+static void refreshArenaMesh() {
+    if (gMeshArena == nullptr) {
         return;
     }
+    // 重建后的 VAO 是新对象（名字可能与旧的相同），实例属性要重新设置
+    uint32_t generation = meshArenaGeneration(gMeshArena);
+    if (generation != gArenaGeneration) {
+        gArenaGeneration = generation;
+        gInstanceAttributesSet = false;
+    }
+    if (!getArenaMeshRange(gMeshArena, gArenaMesh, &gCubeMesh, &gMeshFirstIndex)) {
+        LOGE("Mesh %u is no longer in the mesh arena", gArenaMesh);
+        gMeshArena = nullptr;
+        gCubeMesh.vao = 0;
+    }
+}
+
+static void drawIndexRange(uint32_t first, uint32_t count, GLsizei instanceCount) {
+    first += gMeshFirstIndex;
+    size_t indexSize = gCubeMesh.indexType == GL_UNSIGNED_SHORT ? sizeof(uint16_t) : sizeof(uint32_t);
+    const void* offset = (const void*)(uintptr_t)(first * indexSize);
+    if (instanceCount > 0) {
+        glDrawElementsInstanced(GL_TRIANGLES, count, gCubeMesh.indexType, offset, instanceCount);
+    } else {
+        glDrawElements(GL_TRIANGLES, count, gCubeMesh.indexType, offset);
+    }
+}
+
+// 按子网格绘制选中的 LOD（selectLods 为 false 时全部用 LOD 0），索引范围首尾相接的合并为一次绘制；
+// instanceCount 大于 0 时每次绘制都是实例化绘制
+static void drawMeshLods(bool selectLods, GLsizei instanceCount) {
+    uint32_t first = 0;
+    uint32_t count = 0;
+    for (int s = 0; s < gMeshSubmeshCount; s++) {
+        int lod = selectLods ? selectLod(gMeshSubmeshes[s]) : 0;
+        const MeshLod& range = gMeshSubmeshes[s].lods[lod];
+        if (count > 0 && first + count == range.firstIndex) {
+            count += range.indexCount;
+            continue;
+        }
+        if (count > 0) {
+            drawIndexRange(first, count, instanceCount);
+        }
+        first = range.firstIndex;
+        count = range.indexCount;
+    }
+    if (count > 0) {
+        drawIndexRange(first, count, instanceCount);
+    }
+}
 
-    // 仅处理RGBA_8888格式（其他格式需额外适配）
-    if (info.format != ANDROID_BITMAP_FORMAT_RGBA_8888) {
+// 经环形缓冲在 GPU 上复制到实例缓冲，环形缓冲放不下时直接 glBufferSubData
+static void uploadInstanceRange(GLintptr offset, GLsizeiptr size, const void* data) {
+    if (gStreamBuffer != nullptr && streamBufferUpload(gStreamBuffer, gInstanceVBO, offset, data, size)) {
         return;
     }
+    cachedBindBuffer(GL_ARRAY_BUFFER, gInstanceVBO);
+    glBufferSubData(GL_ARRAY_BUFFER, offset, size, data);
+}
+
+// 可见实例依次写到 dst
+static void gatherVisibleInstances(float* dst) {
+    for (size_t k = 0; k < gVisibleInstances.size(); k++) {
+        const float* instance = &gInstanceData[(size_t)gVisibleInstances[k] * INSTANCE_FLOATS];
+        memcpy(dst + k * INSTANCE_FLOATS, instance, INSTANCE_FLOATS * sizeof(float));
+    }
+}
 
-    // 2. 锁定像素内存
-    if (AndroidBitmap_lockPixels(env, bitmap, &pixels) < 0) {
+// 只有部分实例可见时：可见集合或实例数据变了，就把可见实例依次收集起来整体上传（先重新分配），
+// 绘制时实例缓冲的第 k 项就是第 k 个可见实例。可见实例直接收集到环形缓冲的映射里，省掉一次复制
+static void uploadVisibleInstances(GLsizei instanceSize) {
+    int visibleCount = (int)gVisibleInstances.size();
+    if (gInstanceCompacted && gDirtyEnd <= gDirtyFirst && gVisibleInstances == gUploadedInstances) {
         return;
     }
+    if (gInstanceCapacity < visibleCount) {
+        gInstanceCapacity = std::max(visibleCount, gInstanceCapacity * 2);
+    }
+    glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)gInstanceCapacity * instanceSize, nullptr, GL_DYNAMIC_DRAW);
+    if (visibleCount > 0) {
+        GLsizeiptr size = (GLsizeiptr)visibleCount * instanceSize;
+        StreamRange range;
+        float* mapped = nullptr;
+        if (gStreamBuffer != nullptr) {
+            mapped = (float*)streamBufferMap(gStreamBuffer, size, 4, &range);
+        }
+        if (mapped != nullptr) {
+            gatherVisibleInstances(mapped);
+        }
+        if (mapped != nullptr && streamBufferUnmap(gStreamBuffer)) {
+            streamBufferCopy(gStreamBuffer, range.offset, gInstanceVBO, 0, size);
+        } else {
+            gCompactData.resize((size_t)visibleCount * INSTANCE_FLOATS);
+            gatherVisibleInstances(gCompactData.data());
+            cachedBindBuffer(GL_ARRAY_BUFFER, gInstanceVBO);
+            glBufferSubData(GL_ARRAY_BUFFER, 0, size, gCompactData.data());
+        }
+    }
+    gUploadedInstances = gVisibleInstances;
+    gInstanceCompacted = true;
+    gDirtyFirst = 0;
+    gDirtyEnd = 0;
+}
 
-    // 3. 生成并绑定纹理对象（核心修复1）
-    if (g_textureID == 0) {
-        glGenTextures(1, &g_textureID); // 生成纹理ID
+// 把改过的实例上传到实例缓冲：容量不够时按两倍重新分配；整体更新时先重新分配（旧存储交给驱动回收），
+// 不等上一帧的绘制读完。当前 VAO 还没有实例属性时（第一次绘制、换了网格或网格池重建了 VAO）设置 location 4-10；
+// 网格池是本渲染器自己的集合，池中其他网格也只由这里绘制，共用 VAO 中的实例属性不影响它们
+static void prepareInstances() {
+    const GLsizei instanceSize = INSTANCE_FLOATS * sizeof(float);
+    if (gInstanceVBO == 0) {
+        glGenBuffers(1, &gInstanceVBO);
     }
-    glBindTexture(GL_TEXTURE_2D, g_textureID); // 绑定到当前纹理单元
+    cachedBindBuffer(GL_ARRAY_BUFFER, gInstanceVBO);
+    if ((int)gVisibleInstances.size() < gInstanceCount) {
+        uploadVisibleInstances(instanceSize);
+    } else {
+        if (gInstanceCompacted) {
+            // 缓冲中还是上次的部分实例，全部重新上传
+            gInstanceCompacted = false;
+            gDirtyFirst = 0;
+            gDirtyEnd = gInstanceCount;
+        }
+        if (gInstanceCapacity < gInstanceCount) {
+            gInstanceCapacity = std::max(gInstanceCount, gInstanceCapacity * 2);
+            glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)gInstanceCapacity * instanceSize, nullptr, GL_DYNAMIC_DRAW);
+            gDirtyFirst = 0;
+            gDirtyEnd = gInstanceCount;
+        } else if (gDirtyFirst == 0 && gDirtyEnd == gInstanceCount) {
+            glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)gInstanceCapacity * instanceSize, nullptr, GL_DYNAMIC_DRAW);
+        }
+        if (gDirtyEnd > gDirtyFirst) {
+            uploadInstanceRange((GLintptr)gDirtyFirst * instanceSize, (GLsizeiptr)(gDirtyEnd - gDirtyFirst) * instanceSize,
+                                &gInstanceData[(size_t)gDirtyFirst * INSTANCE_FLOATS]);
+            gDirtyFirst = 0;
+            gDirtyEnd = 0;
+        }
+    }
+    if (!gInstanceAttributesSet) {
+        cachedBindVertexArray(gCubeMesh.vao);
+        for (GLuint column = 0; column < 4; column++) {
+            GLuint location = INSTANCE_MODEL_LOCATION + column;
+            glVertexAttribPointer(location, 4, GL_FLOAT, GL_FALSE, instanceSize,
+                                  (const void*)(uintptr_t)(column * 4 * sizeof(float)));
+            glEnableVertexAttribArray(location);
+            glVertexAttribDivisor(location, 1);
+        }
+        for (GLuint column = 0; column < 3; column++) {
+            GLuint location = INSTANCE_NORMAL_LOCATION + column;
+            glVertexAttribPointer(location, 3, GL_FLOAT, GL_FALSE, instanceSize,
+                                  (const void*)(uintptr_t)((16 + column * 3) * sizeof(float)));
+            glEnableVertexAttribArray(location);
+            glVertexAttribDivisor(location, 1);
+        }
+        gInstanceAttributesSet = true;
+    }
+}
 
-    // 4. 处理像素数据并上传
-    int width = info.width;
-    int height = info.height;
-    uint8_t *srcPixels = static_cast<uint8_t*>(pixels);
-    
-    // Android Bitmap RGBA_8888格式在内存中通常是RGBA顺序，但需要验证
-    // 为了兼容性，我们直接使用像素数据（如果格式正确）
-    // 如果遇到颜色问题，可能需要根据实际格式调整
-    
-    // 上传像素数据到OpenGL
-    glTexImage2D(
-            GL_TEXTURE_2D,        // 2D纹理
-            0,                    // 基础mip层级
-            GL_RGBA,              // GPU内部格式
-            width,                // 宽度
-            height,               // 高度
-            0,                    // 无边框
-            GL_RGBA,              // 输入数据格式
-            GL_UNSIGNED_BYTE,     // 数据类型
-            srcPixels             // 像素数据
-    );
-
-    // 5. 解锁Bitmap像素
-    AndroidBitmap_unlockPixels(env, bitmap);
-
-    // 6. 设置完整的纹理参数（核心修复3）
-    // 过滤模式（解决黑屏/模糊问题）
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    // 环绕模式（适配非2次幂尺寸）
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    // 生成mipmap（提升缩放效果）
-    glGenerateMipmap(GL_TEXTURE_2D);
-}
-extern "C"
-JNIEXPORT void JNICALL
-Java_com_example_ndklearn2_OpenGLRenderer2_releaseTexture(JNIEnv *env, jobject thiz) {
-    if (g_textureID != 0) {
-    glDeleteTextures(1, &g_textureID);
-    g_textureID = 0;
+// 列主序 a * b
+static void multiplyMatrix4(const float* a, const float* b, float* result) {
+    for (int column = 0; column < 4; column++) {
+        for (int row = 0; row < 4; row++) {
+            result[column * 4 + row] = a[row] * b[column * 4] + a[4 + row] * b[column * 4 + 1]
+                                       + a[8 + row] * b[column * 4 + 2] + a[12 + row] * b[column * 4 + 3];
+        }
     }
 }
 
-extern "C"
-JNIEXPORT void JNICALL
-Java_com_example_ndklearn2_OpenGLRenderer2_nativeResize(JNIEnv *env, jobject thiz, jint width,
-                                                        jint height) {
-    LOGI("Resizing viewport to %d x %d", width, height);
-    glViewport(0, 0, width, height);
+// a 为 std140 的 mat3（每列 4 个 float），b 为紧密排列的 mat3，结果按 std140 写出
+static void multiplyNormalMatrix(const float* a, const float* b, float* result) {
+    for (int column = 0; column < 3; column++) {
+        for (int row = 0; row < 3; row++) {
+            result[column * 4 + row] = a[row] * b[column * 3] + a[4 + row] * b[column * 3 + 1]
+                                       + a[8 + row] * b[column * 3 + 2];
+        }
+        result[column * 4 + 3] = 0.0f;
+    }
+}
+
+// 第 k 个可见实例的 TransformBlock：组合后的模型矩阵和法线矩阵
+static void packInstanceTransform(size_t k, unsigned char* block) {
+    const float* instance = &gInstanceData[(size_t)gVisibleInstances[k] * INSTANCE_FLOATS];
+    float model[16];
+    float normal[12];
+    multiplyMatrix4(gModelMatrix, instance, model);
+    multiplyNormalMatrix(gNormalMatrix, instance + 16, normal);
+    packTransformBlock(model, normal, block);
+}
+
+// 对照用的逐个绘制：每个可见实例改写一次整个 TransformBlock 再绘制，下一帧再恢复整组的矩阵。
+// 每次绘制用 glBindBufferRange 指向环形缓冲中不同的块在 llvmpipe 上慢约 5 倍（每次换绑定都要重新验证常量），
+// 这里仍然逐个 glBufferSubData
+static void drawInstancesOneByOne() {
+    cachedBindBufferBase(GL_UNIFORM_BUFFER, UBO_BINDING_TRANSFORM, gUBOTransform);
+    cachedBindBuffer(GL_UNIFORM_BUFFER, gUBOTransform);
+    for (size_t k = 0; k < gVisibleInstances.size(); k++) {
+        packInstanceTransform(k, gTransformBlock);
+        glBufferSubData(GL_UNIFORM_BUFFER, 0, TRANSFORM_BLOCK_SIZE, gTransformBlock);
+        drawMeshLods(false, 0);
+    }
+    if (!gVisibleInstances.empty()) {
+        gTransformDirty = true;
+    }
+}
+
+// 实例 [first, first + count) 的包围盒：网格包围盒经实例矩阵变换
+static void updateInstanceBounds(int first, int count) {
+    resizeCullBounds(&gInstanceBounds, (size_t)gInstanceCount);
+    for (int i = first; i < first + count; i++) {
+        setCullBoundsTransformed(&gInstanceBounds, (size_t)i, gMeshBoundsMin, gMeshBoundsMax,
+                                 &gInstanceData[(size_t)i * INSTANCE_FLOATS]);
+    }
+}
+
+// 换了网格之后所有实例的包围盒都要重新计算
+static void updateMeshBounds() {
+    for (int i = 0; i < 3; i++) {
+        gMeshBoundsMin[i] = gMeshSubmeshes[0].boundsMin[i];
+        gMeshBoundsMax[i] = gMeshSubmeshes[0].boundsMax[i];
+        for (int s = 1; s < gMeshSubmeshCount; s++) {
+            gMeshBoundsMin[i] = std::min(gMeshBoundsMin[i], gMeshSubmeshes[s].boundsMin[i]);
+            gMeshBoundsMax[i] = std::max(gMeshBoundsMax[i], gMeshSubmeshes[s].boundsMax[i]);
+        }
+    }
+    updateInstanceBounds(0, gInstanceCount);
+}
+
+// 实例的包围盒在 TransformBlock 的模型空间中，视锥平面也从 proj * view * model 提取，每帧不用变换包围盒
+static void cullInstances() {
+    FrameTimingStageScope timing(FRAME_STAGE_CULL);
+    if (!gCulling) {
+        gVisibleInstances.resize((size_t)gInstanceCount);
+        for (int i = 0; i < gInstanceCount; i++) {
+            gVisibleInstances[i] = (uint32_t)i;
+        }
+        return;
+    }
+    float viewModel[16];
+    float viewProj[16];
+    multiplyMatrix4(gViewMatrix, gModelMatrix, viewModel);
+    multiplyMatrix4(gProjMatrix, viewModel, viewProj);
+    FrustumPlanes frustum;
+    extractFrustumPlanes(viewProj, &frustum);
+    cullBoxes(frustum, gInstanceBounds, &gVisibleInstances);
 }
-extern "C"
-JNIEXPORT void JNICALL
-Java_com_example_ndklearn2_OpenGLRenderer2_nativeRender(JNIEnv *env, jobject thiz) {
+
+void lightingRendererRender() {
+    GLTraceFrameScope traceFrame;
+    FrameTimingFrameScope timingFrame;
+    GLCheckFrameScope checkFrame;
+    StreamBufferFrameScope streamFrame(gStreamBuffer);
+
     // 清除颜色缓冲区和深度缓冲区
-    glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
-    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    {
+        FrameTimingStageScope timing(FRAME_STAGE_CLEAR);
+        glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    }
     
     // 启用深度测试（用于3D渲染）
-    glEnable(GL_DEPTH_TEST);
+    cachedEnable(GL_DEPTH_TEST);
     
     // 激活着色器程序
-    if (gLightingProgram == 0) {
-        LOGE("Shader program not initialized");
+    // 程序还在工作线程编译时，只输出清屏颜色作为占位帧，不阻塞渲染线程
+    if (gLightingProgram == 0 && pollProgram(&gProgramFuture, &gProgram)) {
+        if (gProgram == 0) {
+            LOGE("Failed to create shader program");
+        } else {
+            gLightingProgram = gProgram;  // 使用同一个程序
+            registerProgram(gLightingProgram, "lighting");
+            onLightingProgramReady(gLightingProgram);
+        }
+    }
+    // 纹理在加载线程上传完成后替换旧纹理
+    GLuint texture = 0;
+    if (pollTexture(&gTextureFuture, &texture)) {
+        if (texture == 0) {
+            LOGE("Texture upload failed, keeping the previous texture");
+        } else {
+            releaseTexture(g_textureID);
+            g_textureID = texture;
+            LOGI("Texture ready, texture=%d", g_textureID);
+        }
+    }
+    // 按每帧预算补上大纹理还没上传的 mip 级别
+    streamTextureLevels();
+    // 优先使用与当前光照参数匹配的特化变体，未就绪时退回通用程序；实例化绘制用各自的实例化版本
+    bool instanced = gInstanceCount > 0 && gInstancing;
+    GLuint program = 0;
+    if (instanced) {
+        program = acquireShaderVariant(&gLightVariants, gLightVariant >= 0 ? INSTANCED_VARIANT_OFFSET + gLightVariant
+                                                                           : INSTANCED_GENERIC_VARIANT);
+        if (program == 0) {
+            program = acquireShaderVariant(&gLightVariants, INSTANCED_GENERIC_VARIANT);
+        }
+    } else {
+        program = acquireShaderVariant(&gLightVariants, gLightVariant);
+        if (program == 0) {
+            program = gLightingProgram;
+        }
+    }
+    if (program == 0) {
         return;
     }
-    glUseProgram(gLightingProgram);
-    
-    // 绑定纹理到纹理单元0
-    if (g_textureID != 0) {
-        glActiveTexture(GL_TEXTURE0);  // 激活纹理单元0
-        glBindTexture(GL_TEXTURE_2D, g_textureID);
-        // 设置纹理采样器uniform（绑定到纹理单元0）
-        GLint textureLoc = glGetUniformLocation(gLightingProgram, "uTexture");
-        if (textureLoc != -1) {
-            glUniform1i(textureLoc, 0);  // 0 对应 GL_TEXTURE0
+    if (gInstanceCount > 0) {
+        cullInstances();
+    }
+    gDrawnInstances = (int)gVisibleInstances.size();
+    {
+        // 变换/光照/材质在 UBO 中；相机位置只在改过之后上传给这一帧用的程序，采样器在程序就绪时已经设置
+        FrameTimingStageScope timing(FRAME_STAGE_UNIFORMS);
+        uploadUniformBlocks();
+        uploadCameraPos(program);
+        cachedUseProgram(program);
+
+        // 绑定纹理到纹理单元0
+        if (g_textureID != 0) {
+            cachedActiveTexture(GL_TEXTURE0);  // 激活纹理单元0
+            cachedBindTexture(GL_TEXTURE_2D, g_textureID);
         }
     }
     
     // 绑定VAO（包含所有顶点属性配置和EBO）
-    if (gVAO == 0) {
+    refreshArenaMesh();
+    if (gCubeMesh.vao == 0) {
         LOGE("VAO not initialized");
         return;
     }
-    glBindVertexArray(gVAO);
-    
-    // 使用索引绘制（EBO）
-    // 正方体有6个面，每个面2个三角形，共36个索引（6面 * 2三角形 * 3顶点）
-    glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
-    
-    // 解绑VAO
-    glBindVertexArray(0);
-    
-    // 解绑着色器程序
-    glUseProgram(0);
+    {
+        FrameTimingStageScope timing(FRAME_STAGE_DRAW);
+        if (instanced) {
+            prepareInstances();
+        }
+        cachedBindVertexArray(gCubeMesh.vao);
+
+        // 使用索引绘制（EBO）
+        // 内置正方体有6个面，每个面2个三角形，共36个索引；.mesh 文件的网格按距离为每个子网格选择 LOD。
+        // 实例分散在场景各处，不按单个模型矩阵选 LOD，全部用 LOD 0；只画视锥内的实例
+        if (instanced) {
+            if (gDrawnInstances > 0) {
+                drawMeshLods(false, gDrawnInstances);
+            }
+        } else if (gInstanceCount > 0) {
+            drawInstancesOneByOne();
+        } else {
+            drawMeshLods(true, 0);
+        }
+    }
+
+    // 不再解绑 VAO 和程序：状态缓存会丢弃下一帧相同的绑定
+    gFrameCount++;
+    if (gFrameCount % 300 == 0) {
+        logGLStateCacheStats(LOG_TAG);
+    }
 }
-extern "C"
-JNIEXPORT void JNICALL
-Java_com_example_ndklearn2_OpenGLRenderer2_nativeCleanup(JNIEnv *env, jobject thiz) {
-    // 清理VAO, VBO, EBO
-    if (gVAO != 0) {
-        glDeleteVertexArrays(1, &gVAO);
-        gVAO = 0;
+
+void lightingRendererCleanup() {
+    // 清理VAO, VBO, EBO；网格池中的网格随网格池一起释放
+    if (gMeshArena != nullptr) {
+        gCubeMesh.vao = 0;
+        gMeshArena = nullptr;
+    } else {
+        releaseMesh(&gCubeMesh);
     }
-    if (gVBO != 0) {
-        glDeleteBuffers(1, &gVBO);
-        gVBO = 0;
+    gArenaMesh = 0;
+    gMeshFirstIndex = 0;
+    if (meshArenaSet() == gMeshArenas) {
+        setMeshArenaSet(nullptr);
     }
-    if (gEBO != 0) {
-        glDeleteBuffers(1, &gEBO);
-        gEBO = 0;
+    destroyMeshArenaSet(gMeshArenas);
+    gMeshArenas = nullptr;
+    // 实例缓冲；CPU 上的实例数据保留，重新初始化后再上传
+    if (gInstanceVBO != 0) {
+        cachedDeleteBuffers(1, &gInstanceVBO);
+        gInstanceVBO = 0;
     }
+    gInstanceCapacity = 0;
+    gInstanceAttributesSet = false;
+    gDirtyFirst = 0;
+    gDirtyEnd = gInstanceCount;
+    gInstanceCompacted = false;
+    destroyStreamBuffer(gStreamBuffer);
+    gStreamBuffer = nullptr;
     
     // 清理UBO
     if (gUBOTransform != 0) {
-        glDeleteBuffers(1, &gUBOTransform);
+        cachedDeleteBuffers(1, &gUBOTransform);
         gUBOTransform = 0;
     }
     if (gUBOLight != 0) {
-        glDeleteBuffers(1, &gUBOLight);
+        cachedDeleteBuffers(1, &gUBOLight);
         gUBOLight = 0;
     }
     if (gUBOMaterial != 0) {
-        glDeleteBuffers(1, &gUBOMaterial);
+        cachedDeleteBuffers(1, &gUBOMaterial);
         gUBOMaterial = 0;
     }
+    gUniformsInRing = false;
     
     // 清理着色器程序
     if (gProgram != 0) {
-        glDeleteProgram(gProgram);
+        unregisterProgram(gProgram);
+        cachedDeleteProgram(gProgram);
         gProgram = 0;
         gLightingProgram = 0;
     }
+    gProgramFuture = ProgramFuture();
+    releaseShaderVariantSet(&gLightVariants);
+    gCameraPosUploaded.clear();
+    gLightVariant = -1;
     
     // 清理纹理
-    if (g_textureID != 0) {
-        glDeleteTextures(1, &g_textureID);
-        g_textureID = 0;
-    }
+    lightingRendererReleaseTexture();
     if (gTextureID1 != 0) {
-        glDeleteTextures(1, &gTextureID1);
+        cachedDeleteTextures(1, &gTextureID1);
         gTextureID1 = 0;
     }
     
@@ -382,87 +1090,10 @@ Java_com_example_ndklearn2_OpenGLRenderer2_nativeCleanup(JNIEnv *env, jobject th
 }
 
 
-static GLuint createProgram() {
-    GLuint vertexShader = compileShader(GL_VERTEX_SHADER, vertexShaderSource);
-    if (vertexShader == 0) {
-        return 0;
-    }
-
-    GLuint fragmentShader = compileShader(GL_FRAGMENT_SHADER, fragmentShaderSource);
-    if (fragmentShader == 0) {
-        glDeleteShader(vertexShader);
-        return 0;
-    }
-
-    GLuint program = glCreateProgram();
-    if (program == 0) {
-        LOGE("Failed to create program");
-        glDeleteShader(vertexShader);
-        glDeleteShader(fragmentShader);
-        return 0;
-    }
-
-    glAttachShader(program, vertexShader);
-    glAttachShader(program, fragmentShader);
-    glLinkProgram(program);
-
-    GLint linked = 0;
-    glGetProgramiv(program, GL_LINK_STATUS, &linked);
-    if (!linked) {
-        GLint infoLen = 0;
-        glGetProgramiv(program, GL_INFO_LOG_LENGTH, &infoLen);
-        if (infoLen > 0) {
-            char* infoLog = new char[infoLen];
-            glGetProgramInfoLog(program, infoLen, nullptr, infoLog);
-            LOGE("Program linking error: %s", infoLog);
-            delete[] infoLog;
-        }
-        glDeleteProgram(program);
-        glDeleteShader(vertexShader);
-        glDeleteShader(fragmentShader);
-        return 0;
-    }
-
-    glDeleteShader(vertexShader);
-    glDeleteShader(fragmentShader);
-
-    return program;
-}
-static GLuint compileShader(GLenum type, const char* source) {
-    GLuint shader = glCreateShader(type);
-    if (shader == 0) {
-        LOGE("Failed to create shader");
-        return 0;
-    }
-
-    glShaderSource(shader, 1, &source, nullptr);
-    glCompileShader(shader);
-
-    GLint compiled = 0;
-    glGetShaderiv(shader, GL_COMPILE_STATUS, &compiled);
-    if (!compiled) {
-        GLint infoLen = 0;
-        glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &infoLen);
-        if (infoLen > 0) {
-            char* infoLog = new char[infoLen];
-            glGetShaderInfoLog(shader, infoLen, nullptr, infoLog);
-            LOGE("Shader compilation error: %s", infoLog);
-            delete[] infoLog;
-        }
-        glDeleteShader(shader);
-        return 0;
-    }
-
-    return shader;
-}
-
-
-extern "C"
-JNIEXPORT void JNICALL
-Java_com_example_ndklearn2_OpenGLRenderer2_loadVertice(JNIEnv *env, jobject thiz) {
-    // TODO: implement loadVertice()
+// 正方体网格：位置、法线、UV、面ID，24 个顶点 36 个索引
+void lightingRendererLoadMesh() {
     float vertices[] = {
-            // 位置              // 法线            // UV      // 面ID（float转int）
+            // 位置              // 法线            // UV      // 面ID（打包时转为整数）
             // 纹理布局：三行两列，每个矩形宽0.5，高1/3
             // 第1行(底部): [0.0-0.5, 0.0-1/3] [0.5-1.0, 0.0-1/3]
             // 第2行(中间): [0.0-0.5, 1/3-2/3] [0.5-1.0, 1/3-2/3]
@@ -515,257 +1146,361 @@ Java_com_example_ndklearn2_OpenGLRenderer2_loadVertice(JNIEnv *env, jobject thiz
     };
 
 
-    // 创建 VAO 和 VBO
-    glGenVertexArrays(1, &gVAO);
-    glGenBuffers(1, &gVBO);
-    glGenBuffers(1, &gEBO);
-    
-    glBindVertexArray(gVAO);
-    
-    // 绑定并上传顶点数据
-    glBindBuffer(GL_ARRAY_BUFFER, gVBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
-    
-    //location 0 vertice
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 9 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-    //location 1 normal
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 9 * sizeof(float), (void*)(3 * sizeof(float)));
-    glEnableVertexAttribArray(1);
-    //location 2 texCoord
-    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 9 * sizeof(float), (void*)(6 * sizeof(float)));
-    glEnableVertexAttribArray(2);
-    //location 3 faceID
-    glVertexAttribPointer(3, 1, GL_FLOAT, GL_FALSE, 9 * sizeof(float), (void*)(8 * sizeof(float)));
-    glEnableVertexAttribArray(3);
-    
-    // 绑定并上传索引数据（必须在VAO绑定时绑定EBO）
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, gEBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
-    
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
-    // 注意：不要解绑EBO，因为它已经存储在VAO中了
-}
-extern "C"
-JNIEXPORT void JNICALL
-Java_com_example_ndklearn2_OpenGLRenderer2_loadUniform(JNIEnv *env, jobject thiz) {
-    if (gLightingProgram == 0) {
-        LOGE("Shader program not initialized");
-        return;
-    }
-
-    glUseProgram(gLightingProgram);
-
-    // 获取 Uniform Block 索引
-    GLuint transformBlockIndex = glGetUniformBlockIndex(gLightingProgram, "TransformBlock");
-    GLuint lightBlockIndex = glGetUniformBlockIndex(gLightingProgram, "LightBlock");
-    GLuint materialBlockIndex = glGetUniformBlockIndex(gLightingProgram, "MaterialBlock");
+    // 量化成打包格式后创建 VAO：location 0 位置、1 法线、2 纹理坐标、3 面ID（整数属性）
+    static_assert(sizeof(vertices) / sizeof(float) % CubeVertexLayout::SOURCE_FLOATS == 0,
+                  "cube vertices do not match CubeVertexLayout");
+    const size_t vertexCount = sizeof(vertices) / sizeof(float) / CubeVertexLayout::SOURCE_FLOATS;
+    std::vector<unsigned char> packed;
+    packVertices<CubeVertexLayout>(vertices, vertexCount, &packed);
+    gCubeMesh = createMesh<CubeVertexLayout>(packed.data(), vertexCount, indices,
+                                             sizeof(indices) / sizeof(indices[0]));
+    gMeshArena = nullptr;
+    gMeshFirstIndex = 0;
+    gInstanceAttributesSet = false;
+    MeshSubmesh cube = {1, {{0, (uint32_t)gCubeMesh.indexCount, 0.0f}}, {-0.5f, -0.5f, -0.5f}, {0.5f, 0.5f, 0.5f},
+                        "cube"};
+    gMeshSubmeshCount = 1;
+    gMeshSubmeshes[0] = cube;
+    updateMeshBounds();
+}
 
-    // 绑定 Uniform Block 到绑定点
-    if (transformBlockIndex != GL_INVALID_INDEX) {
-        glUniformBlockBinding(gLightingProgram, transformBlockIndex, UBO_BINDING_TRANSFORM);
-        LOGI("TransformBlock bound to binding point %d", UBO_BINDING_TRANSFORM);
-    } else {
-        LOGE("TransformBlock not found in shader");
-    }
-
-    if (lightBlockIndex != GL_INVALID_INDEX) {
-        glUniformBlockBinding(gLightingProgram, lightBlockIndex, UBO_BINDING_LIGHT);
-        LOGI("LightBlock bound to binding point %d", UBO_BINDING_LIGHT);
-    } else {
-        LOGE("LightBlock not found in shader");
+void lightingRendererSetMesh(const MeshAsset& asset) {
+    // 与 lightingRendererLoadMesh 一样直接覆盖：上下文重建后旧句柄已经失效，删除会误删新上下文中的同名对象
+    gCubeMesh = asset.mesh;
+    gMeshArena = asset.arena;
+    gArenaMesh = asset.arenaMesh;
+    gArenaGeneration = asset.arena != nullptr ? meshArenaGeneration(asset.arena) : 0;
+    gInstanceAttributesSet = false;
+    gMeshFirstIndex = 0;
+    refreshArenaMesh();
+    gMeshSubmeshCount = asset.submeshCount;
+    memcpy(gMeshSubmeshes, asset.submeshes, sizeof(MeshSubmesh) * asset.submeshCount);
+    if (asset.submeshCount == 0) {
+        // 没有子网格表的文件整体作为一个子网格
+        MeshSubmesh whole = {1, {{0, (uint32_t)asset.mesh.indexCount, 0.0f}}, {0.0f}, {0.0f}, "mesh"};
+        memcpy(whole.boundsMin, asset.boundsMin, sizeof(whole.boundsMin));
+        memcpy(whole.boundsMax, asset.boundsMax, sizeof(whole.boundsMax));
+        gMeshSubmeshCount = 1;
+        gMeshSubmeshes[0] = whole;
     }
+    updateMeshBounds();
+}
 
-    if (materialBlockIndex != GL_INVALID_INDEX) {
-        glUniformBlockBinding(gLightingProgram, materialBlockIndex, UBO_BINDING_MATERIAL);
-        LOGI("MaterialBlock bound to binding point %d", UBO_BINDING_MATERIAL);
-    } else {
-        LOGE("MaterialBlock not found in shader");
-    }
+void lightingRendererCreateUniformBuffers() {
+    // UBO 不依赖程序对象：按 std140 大小直接创建，Block 到绑定点的映射在程序就绪后设置
+    // （见 onLightingProgramReady）
 
     // 创建 Uniform Buffer Objects
     glGenBuffers(1, &gUBOTransform);
     glGenBuffers(1, &gUBOLight);
     glGenBuffers(1, &gUBOMaterial);
 
-    // 获取 Uniform Block 大小
-    GLint transformBlockSize = 0;
-    GLint lightBlockSize = 0;
-    GLint materialBlockSize = 0;
-
-    if (transformBlockIndex != GL_INVALID_INDEX) {
-        glGetActiveUniformBlockiv(gLightingProgram, transformBlockIndex, GL_UNIFORM_BLOCK_DATA_SIZE, &transformBlockSize);
-        LOGI("TransformBlock size: %d bytes", transformBlockSize);
-    }
-
-    if (lightBlockIndex != GL_INVALID_INDEX) {
-        glGetActiveUniformBlockiv(gLightingProgram, lightBlockIndex, GL_UNIFORM_BLOCK_DATA_SIZE, &lightBlockSize);
-        LOGI("LightBlock size: %d bytes", lightBlockSize);
-    }
-
-    if (materialBlockIndex != GL_INVALID_INDEX) {
-        glGetActiveUniformBlockiv(gLightingProgram, materialBlockIndex, GL_UNIFORM_BLOCK_DATA_SIZE, &materialBlockSize);
-        LOGI("MaterialBlock size: %d bytes", materialBlockSize);
-    }
-
     // 分配并绑定缓冲区
-    if (gUBOTransform != 0 && transformBlockSize > 0) {
+    if (gUBOTransform != 0) {
         //指明操纵这个UBO
-        glBindBuffer(GL_UNIFORM_BUFFER, gUBOTransform);
+        cachedBindBuffer(GL_UNIFORM_BUFFER, gUBOTransform);
         //分配内存
-        glBufferData(GL_UNIFORM_BUFFER, transformBlockSize, nullptr, GL_DYNAMIC_DRAW);
+        glBufferData(GL_UNIFORM_BUFFER, TRANSFORM_BLOCK_SIZE, nullptr, GL_DYNAMIC_DRAW);
         //绑定到绑定点
-        glBindBufferBase(GL_UNIFORM_BUFFER, UBO_BINDING_TRANSFORM, gUBOTransform);
+        cachedBindBufferBase(GL_UNIFORM_BUFFER, UBO_BINDING_TRANSFORM, gUBOTransform);
         //解绑
-        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+        cachedBindBuffer(GL_UNIFORM_BUFFER, 0);
     }
 
-    if (gUBOLight != 0 && lightBlockSize > 0) {
-        glBindBuffer(GL_UNIFORM_BUFFER, gUBOLight);
-        glBufferData(GL_UNIFORM_BUFFER, lightBlockSize, nullptr, GL_DYNAMIC_DRAW);
-        glBindBufferBase(GL_UNIFORM_BUFFER, UBO_BINDING_LIGHT, gUBOLight);
-        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    if (gUBOLight != 0) {
+        cachedBindBuffer(GL_UNIFORM_BUFFER, gUBOLight);
+        glBufferData(GL_UNIFORM_BUFFER, LIGHT_BLOCK_SIZE, nullptr, GL_DYNAMIC_DRAW);
+        cachedBindBufferBase(GL_UNIFORM_BUFFER, UBO_BINDING_LIGHT, gUBOLight);
+        cachedBindBuffer(GL_UNIFORM_BUFFER, 0);
     }
 
-    if (gUBOMaterial != 0 && materialBlockSize > 0) {
-        glBindBuffer(GL_UNIFORM_BUFFER, gUBOMaterial);
-        glBufferData(GL_UNIFORM_BUFFER, materialBlockSize, nullptr, GL_DYNAMIC_DRAW);
-        glBindBufferBase(GL_UNIFORM_BUFFER, UBO_BINDING_MATERIAL, gUBOMaterial);
-        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    if (gUBOMaterial != 0) {
+        cachedBindBuffer(GL_UNIFORM_BUFFER, gUBOMaterial);
+        glBufferData(GL_UNIFORM_BUFFER, MATERIAL_BLOCK_SIZE, nullptr, GL_DYNAMIC_DRAW);
+        cachedBindBufferBase(GL_UNIFORM_BUFFER, UBO_BINDING_MATERIAL, gUBOMaterial);
+        cachedBindBuffer(GL_UNIFORM_BUFFER, 0);
     }
 
-    glUseProgram(0);
+    // 新的 UBO 内容未定义，下一帧用 CPU 上的副本整块上传
+    gUniformsInRing = false;
+    gTransformDirty = true;
+    gLightDirty = true;
+    gMaterialDirty = true;
+
+    // 程序已经就绪（例如重复调用）时直接完成绑定
+    if (gLightingProgram != 0) {
+        onLightingProgramReady(gLightingProgram);
+    }
     LOGI("Uniform blocks initialized successfully");
 }
 
 // 辅助函数：更新变换矩阵UBO
-extern "C"
-JNIEXPORT void JNICALL
-Java_com_example_ndklearn2_OpenGLRenderer2_updateTransformUBO(JNIEnv *env, jobject thiz,
-    jfloatArray modelMatrix, jfloatArray viewMatrix, jfloatArray projectionMatrix, jfloatArray normalMatrix) {
+void lightingRendererUpdateTransform(const float* model, const float* view, const float* proj,
+                                     const float* normal) {
     if (gUBOTransform == 0) {
         LOGE("Transform UBO not initialized");
         return;
     }
 
-    jfloat* model = env->GetFloatArrayElements(modelMatrix, nullptr);
-    jfloat* view = env->GetFloatArrayElements(viewMatrix, nullptr);
-    jfloat* proj = env->GetFloatArrayElements(projectionMatrix, nullptr);
-    jfloat* normal = env->GetFloatArrayElements(normalMatrix, nullptr);
+    // 这份副本同时用于 LOD 选择和剔除，下一帧由 uploadUniformBlocks 拼成 TransformBlock 上传
+    memcpy(gModelMatrix, model, sizeof(gModelMatrix));
+    memcpy(gViewMatrix, view, sizeof(gViewMatrix));
+    memcpy(gProjMatrix, proj, sizeof(gProjMatrix));
+    memcpy(gNormalMatrix, normal, sizeof(gNormalMatrix));
+    gTransformDirty = true;
+}
 
-    glBindBuffer(GL_UNIFORM_BUFFER, gUBOTransform);
-    
-    // std140布局：mat4占用16个float（4个vec4），每个vec4对齐到16字节
-    // 偏移量：modelMatrix(0), viewMatrix(64), projectionMatrix(128), normalMatrix(192)
-    glBufferSubData(GL_UNIFORM_BUFFER, 0, 16 * sizeof(float), model);
-    glBufferSubData(GL_UNIFORM_BUFFER, 64, 16 * sizeof(float), view);
-    glBufferSubData(GL_UNIFORM_BUFFER, 128, 16 * sizeof(float), proj);
-    glBufferSubData(GL_UNIFORM_BUFFER, 192, 12 * sizeof(float), normal);  // mat3占用12个float
-    
-    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+// 模型矩阵左上 3x3 的逆转置（伴随矩阵除以行列式），紧密排列的 mat3
+static void instanceNormalMatrix(const float* m, float* normal) {
+    float a = m[0], b = m[4], c = m[8];
+    float d = m[1], e = m[5], f = m[9];
+    float g = m[2], h = m[6], i = m[10];
+    float cofactors[9] = {
+        e * i - f * h, f * g - d * i, d * h - e * g,
+        c * h - b * i, a * i - c * g, b * g - a * h,
+        b * f - c * e, c * d - a * f, a * e - b * d
+    };
+    float det = a * cofactors[0] + b * cofactors[1] + c * cofactors[2];
+    float scale = det != 0.0f ? 1.0f / det : 0.0f;
+    // 逆转置的第 column 列为第 column 行的代数余子式
+    for (int column = 0; column < 3; column++) {
+        for (int row = 0; row < 3; row++) {
+            normal[column * 3 + row] = cofactors[row * 3 + column] * scale;
+        }
+    }
+}
 
-    env->ReleaseFloatArrayElements(modelMatrix, model, JNI_ABORT);
-    env->ReleaseFloatArrayElements(viewMatrix, view, JNI_ABORT);
-    env->ReleaseFloatArrayElements(projectionMatrix, proj, JNI_ABORT);
-    env->ReleaseFloatArrayElements(normalMatrix, normal, JNI_ABORT);
+void lightingRendererUpdateInstances(int first, int count, const float* models, const float* normals) {
+    if (first < 0 || count <= 0) {
+        return;
+    }
+    if (first + count > gInstanceCount) {
+        gInstanceCount = first + count;
+        gInstanceData.resize((size_t)gInstanceCount * INSTANCE_FLOATS, 0.0f);
+    }
+    for (int n = 0; n < count; n++) {
+        float* instance = &gInstanceData[(size_t)(first + n) * INSTANCE_FLOATS];
+        memcpy(instance, models + n * 16, 16 * sizeof(float));
+        if (normals != nullptr) {
+            memcpy(instance + 16, normals + n * 9, 9 * sizeof(float));
+        } else {
+            instanceNormalMatrix(instance, instance + 16);
+        }
+    }
+    updateInstanceBounds(first, count);
+    if (gDirtyEnd > gDirtyFirst) {
+        gDirtyFirst = std::min(gDirtyFirst, first);
+        gDirtyEnd = std::max(gDirtyEnd, first + count);
+    } else {
+        gDirtyFirst = first;
+        gDirtyEnd = first + count;
+    }
+}
+
+void lightingRendererSetInstanceCount(int count) {
+    count = std::max(count, 0);
+    if (count > gInstanceCount) {
+        // 新增的实例矩阵为 0，在 lightingRendererUpdateInstances 写入之前不可见
+        gDirtyFirst = gDirtyEnd > gDirtyFirst ? std::min(gDirtyFirst, gInstanceCount) : gInstanceCount;
+        gDirtyEnd = count;
+    }
+    int previous = gInstanceCount;
+    gInstanceCount = count;
+    gInstanceData.resize((size_t)count * INSTANCE_FLOATS, 0.0f);
+    gDirtyEnd = std::min(gDirtyEnd, count);
+    if (count > previous) {
+        updateInstanceBounds(previous, count - previous);
+    } else {
+        resizeCullBounds(&gInstanceBounds, (size_t)count);
+    }
+    if (count == 0) {
+        gVisibleInstances.clear();
+    }
+}
+
+void lightingRendererSetInstancing(bool enabled) {
+    gInstancing = enabled;
+}
+
+void lightingRendererSetCulling(bool enabled) {
+    gCulling = enabled;
+}
+
+int lightingRendererVisibleInstanceCount() {
+    return gDrawnInstances;
 }
 
 // 辅助函数：更新光照UBO
-extern "C"
-JNIEXPORT void JNICALL
-Java_com_example_ndklearn2_OpenGLRenderer2_updateLightUBO(JNIEnv *env, jobject thiz,
-    jfloatArray ambientColor, jfloatArray diffuseColor, jfloatArray specularColor,
-    jfloatArray lightDirection, jfloatArray lightPos, jfloatArray attenuationFactors,
-    jfloat spotExponent, jfloat spotCutoffAngle, jfloatArray spotDirection, jint computeDistanceAttenuation) {
+void lightingRendererUpdateLight(const LightParams& light) {
     if (gUBOLight == 0) {
         LOGE("Light UBO not initialized");
         return;
     }
 
-    jfloat* ambient = env->GetFloatArrayElements(ambientColor, nullptr);
-    jfloat* diffuse = env->GetFloatArrayElements(diffuseColor, nullptr);
-    jfloat* specular = env->GetFloatArrayElements(specularColor, nullptr);
-    jfloat* lightDir = env->GetFloatArrayElements(lightDirection, nullptr);
-    jfloat* lightP = env->GetFloatArrayElements(lightPos, nullptr);
-    jfloat* atten = env->GetFloatArrayElements(attenuationFactors, nullptr);
-    jfloat* spotDir = env->GetFloatArrayElements(spotDirection, nullptr);
+    packLightBlock(light, gLightBlock);
+    gLightDirty = true;
 
-    glBindBuffer(GL_UNIFORM_BUFFER, gUBOLight);
-    
-    // std140布局：vec3对齐到16字节（4个float），float对齐到4字节
-    // 偏移量计算（按std140规则）：
-    // ambientColor(0), diffuseColor(16), specularColor(32), lightDirection(48), lightPos(64)
-    // attenuationFactors(80), spotExponent(92), spotCutoffAngle(96), spotDirection(112), computeDistanceAttenuation(128)
-    glBufferSubData(GL_UNIFORM_BUFFER, 0, 3 * sizeof(float), ambient);
-    glBufferSubData(GL_UNIFORM_BUFFER, 16, 3 * sizeof(float), diffuse);
-    glBufferSubData(GL_UNIFORM_BUFFER, 32, 3 * sizeof(float), specular);
-    glBufferSubData(GL_UNIFORM_BUFFER, 48, 3 * sizeof(float), lightDir);
-    glBufferSubData(GL_UNIFORM_BUFFER, 64, 3 * sizeof(float), lightP);
-    glBufferSubData(GL_UNIFORM_BUFFER, 80, 3 * sizeof(float), atten);
-    glBufferSubData(GL_UNIFORM_BUFFER, 92, sizeof(float), &spotExponent);
-    glBufferSubData(GL_UNIFORM_BUFFER, 96, sizeof(float), &spotCutoffAngle);
-    glBufferSubData(GL_UNIFORM_BUFFER, 112, 3 * sizeof(float), spotDir);
-    glBufferSubData(GL_UNIFORM_BUFFER, 128, sizeof(int), &computeDistanceAttenuation);
-    
-    glBindBuffer(GL_UNIFORM_BUFFER, 0);
-
-    env->ReleaseFloatArrayElements(ambientColor, ambient, JNI_ABORT);
-    env->ReleaseFloatArrayElements(diffuseColor, diffuse, JNI_ABORT);
-    env->ReleaseFloatArrayElements(specularColor, specular, JNI_ABORT);
-    env->ReleaseFloatArrayElements(lightDirection, lightDir, JNI_ABORT);
-    env->ReleaseFloatArrayElements(lightPos, lightP, JNI_ABORT);
-    env->ReleaseFloatArrayElements(attenuationFactors, atten, JNI_ABORT);
-    env->ReleaseFloatArrayElements(spotDirection, spotDir, JNI_ABORT);
+    // 光照类型变化时切换变体，新变体在下一帧开始异步编译
+    int variant = selectLightVariant(light);
+    if (variant != gLightVariant) {
+        LOGI("Light variant: %s", LIGHT_VARIANT_NAMES[variant]);
+        gLightVariant = variant;
+    }
 }
 
 // 辅助函数：更新材质UBO
-extern "C"
-JNIEXPORT void JNICALL
-Java_com_example_ndklearn2_OpenGLRenderer2_updateMaterialUBO(JNIEnv *env, jobject thiz,
-    jfloatArray materialAmbient, jfloatArray materialDiffuse, jfloatArray materialSpecular, jfloat materialShininess) {
+void lightingRendererUpdateMaterial(const float* ambient, const float* diffuse, const float* specular,
+                                    float shininess) {
     if (gUBOMaterial == 0) {
         LOGE("Material UBO not initialized");
         return;
     }
 
-    jfloat* ambient = env->GetFloatArrayElements(materialAmbient, nullptr);
-    jfloat* diffuse = env->GetFloatArrayElements(materialDiffuse, nullptr);
-    jfloat* specular = env->GetFloatArrayElements(materialSpecular, nullptr);
+    MaterialBlockLayout::write<MATERIAL_AMBIENT>(gMaterialBlock, ambient);
+    MaterialBlockLayout::write<MATERIAL_DIFFUSE>(gMaterialBlock, diffuse);
+    MaterialBlockLayout::write<MATERIAL_SPECULAR>(gMaterialBlock, specular);
+    MaterialBlockLayout::write<MATERIAL_SHININESS>(gMaterialBlock, &shininess);
+    gMaterialDirty = true;
+}
 
-    glBindBuffer(GL_UNIFORM_BUFFER, gUBOMaterial);
-    
-    // std140布局：vec3对齐到16字节，float对齐到4字节
-    // 偏移量：materialAmbient(0), materialDiffuse(16), materialSpecular(32), materialShininess(44)
-    glBufferSubData(GL_UNIFORM_BUFFER, 0, 3 * sizeof(float), ambient);
-    glBufferSubData(GL_UNIFORM_BUFFER, 16, 3 * sizeof(float), diffuse);
-    glBufferSubData(GL_UNIFORM_BUFFER, 32, 3 * sizeof(float), specular);
-    glBufferSubData(GL_UNIFORM_BUFFER, 44, sizeof(float), &materialShininess);
-    
-    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+// 辅助函数：更新相机位置（单独的uniform）
+void lightingRendererUpdateCameraPos(const float* cameraPos) {
+    gCameraPos[0] = cameraPos[0];
+    gCameraPos[1] = cameraPos[1];
+    gCameraPos[2] = cameraPos[2];
 
-    env->ReleaseFloatArrayElements(materialAmbient, ambient, JNI_ABORT);
-    env->ReleaseFloatArrayElements(materialDiffuse, diffuse, JNI_ABORT);
-    env->ReleaseFloatArrayElements(materialSpecular, specular, JNI_ABORT);
+    // 只记下新版本，render 在绘制前上传给当前用的程序，其余变体用到时再上传
+    gCameraPosVersion++;
+}
+// 基准测试用的光照参数：光源正对着画面，保证每个变体的每个分支都真正执行
+static LightParams benchmarkLight(int variant) {
+    LightParams light = {
+            {0.2f, 0.2f, 0.2f}, {1.0f, 1.0f, 1.0f}, {1.0f, 1.0f, 1.0f},
+            {0.0f, 0.0f, 0.0f}, {0.0f, 0.0f, 2.0f}, {1.0f, 0.09f, 0.032f},
+            8.0f, 0.0f, {0.0f, 0.0f, -1.0f}, 0
+    };
+    if (variant == LIGHT_VARIANT_DIRECTIONAL) {
+        light.direction[2] = -1.0f;
+    }
+    if (variant == LIGHT_VARIANT_SPOT || variant == LIGHT_VARIANT_SPOT_ATTENUATION) {
+        light.spotCutoffAngle = 30.0f;
+    }
+    if (variant == LIGHT_VARIANT_POINT_ATTENUATION || variant == LIGHT_VARIANT_SPOT_ATTENUATION) {
+        light.computeDistanceAttenuation = 1;
+    }
+    return light;
 }
 
-// 辅助函数：更新相机位置（单独的uniform）
-extern "C"
-JNIEXPORT void JNICALL
-Java_com_example_ndklearn2_OpenGLRenderer2_updateCameraPos(JNIEnv *env, jobject thiz, jfloatArray cameraPos) {
-    if (gLightingProgram == 0) {
-        LOGE("Shader program not initialized");
-        return;
+// 绘制 drawCount 次并等待 GPU 完成，返回平均每次绘制的毫秒数
+static double timeDraws(GLuint program, int drawCount) {
+    uploadCameraPos(program);
+    cachedUseProgram(program);
+    // 预热一次，避免把驱动的延迟编译算进去
+    drawMeshLods(false, 0);
+    glFinish();
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (int i = 0; i < drawCount; i++) {
+        drawMeshLods(false, 0);
     }
+    glFinish();
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return ms / drawCount;
+}
 
-    jfloat* pos = env->GetFloatArrayElements(cameraPos, nullptr);
-    
-    glUseProgram(gLightingProgram);
-    GLint cameraPosLoc = glGetUniformLocation(gLightingProgram, "uCameraPos");
-    if (cameraPosLoc != -1) {
-        glUniform3fv(cameraPosLoc, 1, pos);
+// 比较通用程序和特化变体的片段着色开销
+// 在离屏 FBO 中用接近全屏的正方体（不开深度测试，前后两个面都着色）绘制，
+// 变换和光照使用临时 UBO，结束后恢复原来的绑定，不影响正常渲染
+// results 写入 [通用程序 ms, 特化变体 ms] * LIGHT_VARIANT_COUNT，程序未就绪时返回 false
+bool lightingRendererBenchmark(int drawCount, float* results) {
+    refreshArenaMesh();
+    if (gLightingProgram == 0 || gCubeMesh.vao == 0) {
+        LOGE("Lighting benchmark needs the program and mesh to be ready");
+        return false;
+    }
+    if (drawCount <= 0) {
+        drawCount = 100;
+    }
+
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    GLsizei width = viewport[2] > 0 ? viewport[2] : 1024;
+    GLsizei height = viewport[3] > 0 ? viewport[3] : 1024;
+
+    GLuint colorBuffer = 0;
+    GLuint framebuffer = 0;
+    glGenRenderbuffers(1, &colorBuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, colorBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+    glGenFramebuffers(1, &framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorBuffer);
+    cachedViewport(0, 0, width, height);
+
+    // 模型矩阵缩放 1.8 倍，视图、投影为单位矩阵：正对屏幕的两个面各覆盖 81% 的像素
+    float model[16] = {0};
+    float identity[16] = {0};
+    float normal[9] = {0};
+    for (int i = 0; i < 4; i++) {
+        model[i * 5] = i < 3 ? 1.8f : 1.0f;
+        identity[i * 5] = 1.0f;
+    }
+    for (int i = 0; i < 3; i++) {
+        normal[i * 4] = 1.0f;
+    }
+    unsigned char transform[TRANSFORM_BLOCK_SIZE] = {0};
+    TransformBlockLayout::write<TRANSFORM_MODEL>(transform, model);
+    TransformBlockLayout::write<TRANSFORM_VIEW>(transform, identity);
+    TransformBlockLayout::write<TRANSFORM_PROJECTION>(transform, identity);
+    TransformBlockLayout::write<TRANSFORM_NORMAL>(transform, normal);
+    GLuint transformUBO = 0;
+    GLuint lightUBO = 0;
+    glGenBuffers(1, &transformUBO);
+    cachedBindBuffer(GL_UNIFORM_BUFFER, transformUBO);
+    glBufferData(GL_UNIFORM_BUFFER, TRANSFORM_BLOCK_SIZE, transform, GL_STATIC_DRAW);
+    glGenBuffers(1, &lightUBO);
+    cachedBindBuffer(GL_UNIFORM_BUFFER, lightUBO);
+    glBufferData(GL_UNIFORM_BUFFER, LIGHT_BLOCK_SIZE, nullptr, GL_DYNAMIC_DRAW);
+    cachedBindBuffer(GL_UNIFORM_BUFFER, 0);
+    cachedBindBufferBase(GL_UNIFORM_BUFFER, UBO_BINDING_TRANSFORM, transformUBO);
+    cachedBindBufferBase(GL_UNIFORM_BUFFER, UBO_BINDING_LIGHT, lightUBO);
+
+    cachedDisable(GL_DEPTH_TEST);
+    cachedActiveTexture(GL_TEXTURE0);
+    cachedBindTexture(GL_TEXTURE_2D, g_textureID);
+    cachedBindVertexArray(gCubeMesh.vao);
+
+    for (int i = 0; i < LIGHT_VARIANT_COUNT * 2; i++) {
+        results[i] = 0.0f;
+    }
+    for (int i = 0; i < LIGHT_VARIANT_COUNT; i++) {
+        // 基准测试可以阻塞，直接等变体编译完成
+        GLuint variant = waitShaderVariant(&gLightVariants, i);
+        if (variant == 0) {
+            continue;
+        }
+        unsigned char lightBlock[LIGHT_BLOCK_SIZE] = {0};
+        packLightBlock(benchmarkLight(i), lightBlock);
+        cachedBindBuffer(GL_UNIFORM_BUFFER, lightUBO);
+        glBufferSubData(GL_UNIFORM_BUFFER, 0, LIGHT_BLOCK_SIZE, lightBlock);
+        double uberMs = timeDraws(gLightingProgram, drawCount);
+        double variantMs = timeDraws(variant, drawCount);
+        results[i * 2] = (float)uberMs;
+        results[i * 2 + 1] = (float)variantMs;
+        LOGI("Lighting benchmark %-18s uber %.3f ms/draw, variant %.3f ms/draw (%+.1f%%)",
+             LIGHT_VARIANT_NAMES[i], uberMs, variantMs,
+             uberMs > 0.0 ? (variantMs - uberMs) * 100.0 / uberMs : 0.0);
     }
-    glUseProgram(0);
 
-    env->ReleaseFloatArrayElements(cameraPos, pos, JNI_ABORT);
-}
\ No newline at end of file
+    cachedBindVertexArray(0);
+    cachedUseProgram(0);
+    cachedBindBufferBase(GL_UNIFORM_BUFFER, UBO_BINDING_TRANSFORM, gUBOTransform);
+    cachedBindBufferBase(GL_UNIFORM_BUFFER, UBO_BINDING_LIGHT, gUBOLight);
+    cachedDeleteBuffers(1, &transformUBO);
+    cachedDeleteBuffers(1, &lightUBO);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glDeleteFramebuffers(1, &framebuffer);
+    glDeleteRenderbuffers(1, &colorBuffer);
+    cachedViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+    return true;
+}
@@ -0,0 +1,87 @@
+//
+// Created by zhangx on 2026/10/16.
+// Renderer2（带光照和纹理的正方体）的渲染核心，不依赖 JNI，JNI 入口见 opengl_renderer2_jni.cpp
+// 所有函数都在持有 GL 上下文的渲染线程调用
+//
+
+#ifndef NDKLEARN2_OPENGL_RENDERER2_H
+#define NDKLEARN2_OPENGL_RENDERER2_H
+
+#include "texture_loader.h"
+#include "opengl_utils.h"
+
+// 光照参数（LightBlock 的 CPU 副本），用来选择特化变体
+typedef struct {
+    float ambient[3];
+    float diffuse[3];
+    float specular[3];
+    float direction[3];       // 全 0 表示点光源/聚光灯
+    float position[3];
+    float attenuation[3];     // K0, K1, K2
+    float spotExponent;
+    float spotCutoffAngle;    // 度数，(0, 90) 之外表示不是聚光灯
+    float spotDirection[3];
+    int computeDistanceAttenuation;
+} LightParams;
+
+// 光照模型的特化变体：光照类型 x 是否衰减（平行光没有衰减）
+enum {
+    LIGHT_VARIANT_DIRECTIONAL = 0,
+    LIGHT_VARIANT_POINT,
+    LIGHT_VARIANT_POINT_ATTENUATION,
+    LIGHT_VARIANT_SPOT,
+    LIGHT_VARIANT_SPOT_ATTENUATION,
+    LIGHT_VARIANT_COUNT
+};
+
+// 提交通用程序的编译请求并登记特化变体，程序就绪前 render 只画清屏色
+bool lightingRendererInit();
+// 内置的正方体网格
+void lightingRendererLoadMesh();
+// 改用 .mesh 文件的网格（loadMeshFile / loadMeshFromAsset 的结果，位置、法线、UV 在 location 0-2），
+// 接管 asset 中的 GL 对象（在网格池中时由 lightingRendererCleanup 连同网格池一起释放）；与 lightingRendererLoadMesh 二选一。
+// 每帧按 lightingRendererUpdateTransform 的矩阵为每个子网格选择 LOD，相邻的索引范围合并为一次绘制
+void lightingRendererSetMesh(const MeshAsset& asset);
+// UBO 按 std140 大小直接创建，不等程序就绪
+void lightingRendererCreateUniformBuffers();
+// pixels 为 RGBA8888，width * 4 字节一行
+void lightingRendererUploadTexture(const void* pixels, int width, int height);
+// 接管上传中的纹理（例如 loadKTXTextureAsync 的结果），就绪后在渲染时替换旧纹理；无效的 future 返回 false
+bool lightingRendererSetTexture(TextureFuture texture);
+void lightingRendererReleaseTexture();
+void lightingRendererResize(int width, int height);
+// LOD 选择允许的屏幕误差（像素，默认 1），不大于 0 时总是绘制完整网格
+void lightingRendererSetLodThreshold(float pixels);
+// 在 lightingRendererInit 之前调用：打开后渲染器创建自己的网格池集合（setMeshArenaSet），
+// 之后加载的 .mesh 文件放进其中按偏移绘制，lightingRendererCleanup 时一起释放。默认关闭
+void lightingRendererSetMeshArenaEnabled(bool enabled);
+void lightingRendererRender();
+void lightingRendererCleanup();
+
+// 矩阵均为列主序：model/view/proj 16 个 float，normal 为 mat3 按 std140 展开的 12 个 float
+void lightingRendererUpdateTransform(const float* model, const float* view, const float* proj,
+                                     const float* normal);
+void lightingRendererUpdateLight(const LightParams& light);
+void lightingRendererUpdateMaterial(const float* ambient, const float* diffuse, const float* specular,
+                                    float shininess);
+void lightingRendererUpdateCameraPos(const float* cameraPos);
+
+// 实例化绘制：models 为每个实例的模型矩阵（16 个 float），normals 为法线矩阵（mat3 的 9 个 float），均为列主序，
+// 与 TransformBlock 中的模型矩阵和法线矩阵相乘（后者作为整组的变换）；normals 为空时由模型矩阵计算。
+// 写入第 [first, first + count) 个实例，超出当前实例数时随之增长；render 时只上传改过的范围，
+// 所有实例用一次 glDrawElementsInstanced 绘制（每个子网格范围一次），不做 LOD 选择
+void lightingRendererUpdateInstances(int first, int count, const float* models, const float* normals);
+// 只保留前 count 个实例（增加的实例矩阵为 0，写入前不可见），0 表示回到单个模型的绘制（默认）
+void lightingRendererSetInstanceCount(int count);
+// false 时不用实例化，每个实例单独更新 TransformBlock 再绘制，用于对比；默认 true
+void lightingRendererSetInstancing(bool enabled);
+// 实例的视锥剔除，默认开启：每帧从 proj * view * model 提取视锥平面，实例的包围盒（网格包围盒经实例矩阵变换）
+// 在视锥外的不上传也不绘制。可见集合变化时把可见实例紧凑地重新上传，全部可见时按改过的范围上传
+void lightingRendererSetCulling(bool enabled);
+// 上一帧绘制的实例数（剔除之后）
+int lightingRendererVisibleInstanceCount();
+
+// 通用程序与各特化变体的片段着色开销对比，results 至少 LIGHT_VARIANT_COUNT * 2 个 float
+bool lightingRendererBenchmark(int drawCount, float* results);
+
+#endif //NDKLEARN2_OPENGL_RENDERER2_H
@@ -0,0 +1,183 @@
+//
+// Created by zhangx on 2026/10/16.
+// OpenGLRenderer2 的 JNI 入口：取出 Bitmap、字符串和 float[] 后转给 opengl_renderer2.cpp
+//
+
+#include <jni.h>
+#include "opengl_renderer2.h"
+#include "opengl_utils.h"
+
+extern "C" JNIEXPORT jboolean JNICALL
+Java_com_example_ndklearn2_OpenGLRenderer2_nativeInit(JNIEnv* env, jobject thiz) {
+    return lightingRendererInit() ? JNI_TRUE : JNI_FALSE;
+}
+
+// cachePath 可以为 null；非空时加载线程把生成的 mip 链写到该文件，下次启动用 loadTextureFile 直接加载
+extern "C" JNIEXPORT void JNICALL
+Java_com_example_ndklearn2_OpenGLRenderer2_loadTextureFromBitmap(JNIEnv *env, jobject thiz, jobject bitmap,
+                                                                 jstring cachePath) {
+    const char* path = cachePath != nullptr ? env->GetStringUTFChars(cachePath, nullptr) : nullptr;
+    lightingRendererSetTexture(loadTextureFromBitmapAsync(env, bitmap, path));
+    if (path != nullptr) {
+        env->ReleaseStringUTFChars(cachePath, path);
+    }
+}
+
+// 加载上次缓存的 mip 链，文件不存在或无效时返回 false，由 Java 层重新解码 Bitmap
+extern "C" JNIEXPORT jboolean JNICALL
+Java_com_example_ndklearn2_OpenGLRenderer2_loadTextureFile(JNIEnv *env, jobject thiz, jstring path) {
+    const char* filePath = env->GetStringUTFChars(path, nullptr);
+    TextureFuture texture = loadTextureFileAsync(filePath);
+    env->ReleaseStringUTFChars(path, filePath);
+    return lightingRendererSetTexture(texture) ? JNI_TRUE : JNI_FALSE;
+}
+
+// 从 assets 加载预先压缩的 KTX 纹理，文件不存在或设备不支持该格式时返回 false，由 Java 层退回 Bitmap
+extern "C" JNIEXPORT jboolean JNICALL
+Java_com_example_ndklearn2_OpenGLRenderer2_loadCompressedTexture(JNIEnv *env, jobject thiz, jobject assetManager,
+                                                                 jstring path) {
+    const char* assetPath = env->GetStringUTFChars(path, nullptr);
+    TextureFuture texture = loadCompressedTextureFromAsset(env, assetManager, assetPath);
+    env->ReleaseStringUTFChars(path, assetPath);
+    return lightingRendererSetTexture(texture) ? JNI_TRUE : JNI_FALSE;
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_example_ndklearn2_OpenGLRenderer2_releaseTexture(JNIEnv *env, jobject thiz) {
+    lightingRendererReleaseTexture();
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_example_ndklearn2_OpenGLRenderer2_nativeResize(JNIEnv *env, jobject thiz, jint width, jint height) {
+    lightingRendererResize(width, height);
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_example_ndklearn2_OpenGLRenderer2_nativeRender(JNIEnv *env, jobject thiz) {
+    lightingRendererRender();
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_example_ndklearn2_OpenGLRenderer2_nativeCleanup(JNIEnv *env, jobject thiz) {
+    lightingRendererCleanup();
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_example_ndklearn2_OpenGLRenderer2_loadVertice(JNIEnv *env, jobject thiz) {
+    lightingRendererLoadMesh();
+}
+
+// 从 assets 加载 mesh_assets 目标生成的 .mesh 文件，不存在或无效时返回 false，由 Java 层退回内置正方体
+extern "C" JNIEXPORT jboolean JNICALL
+Java_com_example_ndklearn2_OpenGLRenderer2_loadMeshAsset(JNIEnv *env, jobject thiz, jobject assetManager,
+                                                         jstring path) {
+    const char* assetPath = env->GetStringUTFChars(path, nullptr);
+    MeshAsset mesh;
+    bool loaded = loadMeshFromAsset(env, assetManager, assetPath, &mesh);
+    env->ReleaseStringUTFChars(path, assetPath);
+    if (!loaded) {
+        return JNI_FALSE;
+    }
+    lightingRendererSetMesh(mesh);
+    return JNI_TRUE;
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_example_ndklearn2_OpenGLRenderer2_loadUniform(JNIEnv *env, jobject thiz) {
+    lightingRendererCreateUniformBuffers();
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_example_ndklearn2_OpenGLRenderer2_updateTransformUBO(JNIEnv *env, jobject thiz,
+    jfloatArray modelMatrix, jfloatArray viewMatrix, jfloatArray projectionMatrix, jfloatArray normalMatrix) {
+    jfloat* model = env->GetFloatArrayElements(modelMatrix, nullptr);
+    jfloat* view = env->GetFloatArrayElements(viewMatrix, nullptr);
+    jfloat* proj = env->GetFloatArrayElements(projectionMatrix, nullptr);
+    jfloat* normal = env->GetFloatArrayElements(normalMatrix, nullptr);
+
+    lightingRendererUpdateTransform(model, view, proj, normal);
+
+    env->ReleaseFloatArrayElements(modelMatrix, model, JNI_ABORT);
+    env->ReleaseFloatArrayElements(viewMatrix, view, JNI_ABORT);
+    env->ReleaseFloatArrayElements(projectionMatrix, proj, JNI_ABORT);
+    env->ReleaseFloatArrayElements(normalMatrix, normal, JNI_ABORT);
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_example_ndklearn2_OpenGLRenderer2_updateLightUBO(JNIEnv *env, jobject thiz,
+    jfloatArray ambientColor, jfloatArray diffuseColor, jfloatArray specularColor,
+    jfloatArray lightDirection, jfloatArray lightPos, jfloatArray attenuationFactors,
+    jfloat spotExponent, jfloat spotCutoffAngle, jfloatArray spotDirection, jint computeDistanceAttenuation) {
+    LightParams light;
+    env->GetFloatArrayRegion(ambientColor, 0, 3, light.ambient);
+    env->GetFloatArrayRegion(diffuseColor, 0, 3, light.diffuse);
+    env->GetFloatArrayRegion(specularColor, 0, 3, light.specular);
+    env->GetFloatArrayRegion(lightDirection, 0, 3, light.direction);
+    env->GetFloatArrayRegion(lightPos, 0, 3, light.position);
+    env->GetFloatArrayRegion(attenuationFactors, 0, 3, light.attenuation);
+    env->GetFloatArrayRegion(spotDirection, 0, 3, light.spotDirection);
+    light.spotExponent = spotExponent;
+    light.spotCutoffAngle = spotCutoffAngle;
+    light.computeDistanceAttenuation = computeDistanceAttenuation;
+
+    lightingRendererUpdateLight(light);
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_example_ndklearn2_OpenGLRenderer2_updateMaterialUBO(JNIEnv *env, jobject thiz,
+    jfloatArray materialAmbient, jfloatArray materialDiffuse, jfloatArray materialSpecular, jfloat materialShininess) {
+    jfloat* ambient = env->GetFloatArrayElements(materialAmbient, nullptr);
+    jfloat* diffuse = env->GetFloatArrayElements(materialDiffuse, nullptr);
+    jfloat* specular = env->GetFloatArrayElements(materialSpecular, nullptr);
+
+    lightingRendererUpdateMaterial(ambient, diffuse, specular, materialShininess);
+
+    env->ReleaseFloatArrayElements(materialAmbient, ambient, JNI_ABORT);
+    env->ReleaseFloatArrayElements(materialDiffuse, diffuse, JNI_ABORT);
+    env->ReleaseFloatArrayElements(materialSpecular, specular, JNI_ABORT);
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_example_ndklearn2_OpenGLRenderer2_updateCameraPos(JNIEnv *env, jobject thiz, jfloatArray cameraPos) {
+    jfloat pos[3];
+    env->GetFloatArrayRegion(cameraPos, 0, 3, pos);
+    lightingRendererUpdateCameraPos(pos);
+}
+
+// modelMatrices 每 16 个 float 一个实例；normalMatrices 可以为 null（由模型矩阵计算），否则每 9 个 float 一个实例
+extern "C" JNIEXPORT void JNICALL
+Java_com_example_ndklearn2_OpenGLRenderer2_updateInstances(JNIEnv *env, jobject thiz, jint first,
+                                                           jfloatArray modelMatrices, jfloatArray normalMatrices) {
+    jsize count = env->GetArrayLength(modelMatrices) / 16;
+    if (normalMatrices != nullptr && env->GetArrayLength(normalMatrices) < count * 9) {
+        return;
+    }
+    // 实例数据可能很大，用 critical 访问避免复制整个数组
+    jfloat* models = (jfloat*)env->GetPrimitiveArrayCritical(modelMatrices, nullptr);
+    jfloat* normals = normalMatrices != nullptr ? (jfloat*)env->GetPrimitiveArrayCritical(normalMatrices, nullptr)
+                                                : nullptr;
+    lightingRendererUpdateInstances(first, count, models, normals);
+    if (normals != nullptr) {
+        env->ReleasePrimitiveArrayCritical(normalMatrices, normals, JNI_ABORT);
+    }
+    env->ReleasePrimitiveArrayCritical(modelMatrices, models, JNI_ABORT);
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_example_ndklearn2_OpenGLRenderer2_setInstanceCount(JNIEnv *env, jobject thiz, jint count) {
+    lightingRendererSetInstanceCount(count);
+}
+
+// 返回 [通用程序 ms, 特化变体 ms] * LIGHT_VARIANT_COUNT，程序未就绪时返回 null
+extern "C" JNIEXPORT jfloatArray JNICALL
+Java_com_example_ndklearn2_OpenGLRenderer2_nativeBenchmarkLighting(JNIEnv *env, jobject thiz, jint drawCount) {
+    float results[LIGHT_VARIANT_COUNT * 2];
+    if (!lightingRendererBenchmark(drawCount, results)) {
+        return nullptr;
+    }
+    jfloatArray result = env->NewFloatArray(LIGHT_VARIANT_COUNT * 2);
+    if (result != nullptr) {
+        env->SetFloatArrayRegion(result, 0, LIGHT_VARIANT_COUNT * 2, results);
+    }
+    return result;
+}
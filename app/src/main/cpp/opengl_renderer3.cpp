@@ -3,11 +3,21 @@
 // OpenGL Renderer 3 - 使用共享工具库的简化版本
 //
 
-#include <jni.h>
 #include <GLES3/gl3.h>
 #include <android/log.h>
+#include "opengl_renderer3.h"
 #include "opengl_utils.h"
+#include "program_cache.h"
+#include "shader_compile_service.h"
+#include "texture_loader.h"
+#include "shader_registry.h"
+#include "gl_trace.h"
+#include "frame_timing.h"
+#include "stream_buffer.h"
+#include "std140_layout.h"
 #include <sys/time.h>
+#include <algorithm>
+#include <cstring>
 
 #define LOG_TAG "OpenGLRenderer3"
 #define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
@@ -39,6 +49,40 @@ static struct {
     float currentTime;  // 累积时间
 } g_Particle_Uniforms;
 
+// 两个 uniform block 的 std140 布局（std140_layout.h），成员顺序与着色器中的声明一致，
+// 程序就绪后与反射的偏移核对（createParticleUBOs）
+typedef Std140Block<Std140Float, Std140Vec3> CameraUniformsLayout;
+enum { CAMERA_ASPECT_RATIO, CAMERA_POS };
+
+typedef Std140Block<Std140Float, Std140Vec3, Std140Vec3, Std140Float, Std140Float> ParticleUniformsLayout;
+enum { PARTICLE_DELTA_TIME, PARTICLE_SPOUT_POS, PARTICLE_GRAVITY, PARTICLE_MAX_LIFE_TIME, PARTICLE_CURRENT_TIME };
+
+// uMaxLifeTime 紧跟在 uGravity 的 12 字节之后，uCurrentTime 在 48
+static_assert(CameraUniformsLayout::Member<CAMERA_POS>::OFFSET == 16, "CameraUniforms layout");
+static_assert(ParticleUniformsLayout::Member<PARTICLE_MAX_LIFE_TIME>::OFFSET == 44, "ParticleUniforms layout");
+static_assert(ParticleUniformsLayout::Member<PARTICLE_CURRENT_TIME>::OFFSET == 48, "ParticleUniforms layout");
+static_assert(ParticleUniformsLayout::SIZE == 64, "ParticleUniforms size");
+
+static const BlockHandle BLOCK_CAMERA = uniformBlockHandle("CameraUniforms");
+static const BlockHandle BLOCK_PARTICLE = uniformBlockHandle("ParticleUniforms");
+static const UniformHandle CAMERA_MEMBERS[CameraUniformsLayout::COUNT] = {
+    uniformHandle("uAspectRatio"), uniformHandle("uCameraPos")
+};
+static const UniformHandle PARTICLE_MEMBERS[ParticleUniformsLayout::COUNT] = {
+    uniformHandle("uDeltaTime"), uniformHandle("uSpoutPos"), uniformHandle("uGravity"), uniformHandle("uMaxLifeTime"),
+    uniformHandle("uCurrentTime")
+};
+
+// ParticleUniforms 每帧都变（deltaTime、currentTime），整块写进流式环形缓冲后用 glBindBufferRange 绑定，
+// 不再每帧两次 glBufferSubData；环形缓冲不可用时退回 UBO
+static StreamBuffer* gStreamBuffer = nullptr;
+static const GLsizeiptr STREAM_FRAME_SIZE = 4096;
+static const int STREAM_FRAMES_IN_FLIGHT = 3;
+
+static ProgramFuture gProgramFuture;  // 异步编译中的粒子程序
+static TextureFuture gTextureFuture;  // 上传中的粒子纹理
+static const UniformHandle UNIFORM_TEXTURE = uniformHandle("uTexture");
+
 static const int BINDING_POINT_TFB =0;
 static const int BINDING_POINT_VAO =1;
 void updateParticlesWithTFB();
@@ -177,38 +221,38 @@ void main() {
 static float last_time = 0.0f;
 
 // 初始化渲染器
-extern "C" JNIEXPORT jboolean JNICALL
-Java_com_example_ndklearn2_OpenGLRenderer3_nativeInit(JNIEnv* env, jobject thiz) {
+bool particleRendererInit() {
     LOGI("Initializing Renderer3");
+    // 新的 EGL 上下文：之前缓存的绑定状态全部失效
+    invalidateGLStateCache();
+    glTraceContextCreated();
+    frameTimingContextCreated();
+    glCheckContextCreated();
     glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
     
     // 检查 OpenGL 上下文
-    GLenum err = glGetError();
-    if (err != GL_NO_ERROR) {
-        LOGE("OpenGL error before shader creation: 0x%x", err);
-    }
+    logGLError(LOG_TAG, "context setup before shader creation");
     
-    // 编译着色器程序
+    // 提交着色器编译请求
+    // TFB 捕获变量在链接前设置，只链接一次；整个程序（含 TFB 状态）可以从二进制缓存加载
+    // 编译在共享上下文的工作线程上进行，程序就绪前 particleRendererRender 只画占位帧
     gRenderer.particle_count = 200;
-    gRenderer.program = createProgram(vertexShaderSource, fragmentShaderSource);
-    
-    if (gRenderer.program == 0) {
-        LOGE("Failed to create shader program - check shader compilation errors above");
-        gRenderer.initialized = false;
-        return JNI_FALSE;
-    }
+    gRenderer.program = 0;
+    startShaderCompileService();
+    startTextureLoader();
+    gProgramFuture = requestProgramAsync(vertexShaderSource, fragmentShaderSource,
+                                         g_TransformFeedbackVaryings, 4, GL_INTERLEAVED_ATTRIBS);
     
+    // 旧上下文中的环形缓冲已经失效，只丢掉记录
+    abandonStreamBuffer(gStreamBuffer);
+    gStreamBuffer = createStreamBuffer(STREAM_FRAME_SIZE, STREAM_FRAMES_IN_FLIGHT);
+
     // 开启点精灵（渲染粒子为点）
-    glEnable(GL_PROGRAM_POINT_SIZE);
+    cachedEnable(GL_PROGRAM_POINT_SIZE);
     gRenderer.initialized = true;
-    LOGI("Renderer3 initialized successfully, program=%d", gRenderer.program);
-
-    //初始化统一变量ubo
-    g_Camera_Uniforms.ubo = createUniformBuffer(gRenderer.program, "CameraUniforms", 0);
-//    updateUniformBuffer(&g_Camera_Uniforms.ubo, &g_Camera_Uniforms.aspectRatio, 0, sizeof(g_Camera_Uniforms.aspectRatio));
+    LOGI("Renderer3 initialized, shader program compiling in background");
 
-
-    g_Particle_Uniforms.ubo = createUniformBuffer(gRenderer.program, "ParticleUniforms", 1);
+    //统一变量初始值，UBO 在程序就绪后创建（见 createParticleUBOs）
     g_Particle_Uniforms.deltaTime = 0.0f;
     g_Particle_Uniforms.currentTime = 0.0f;
     float spoutPosTemp[] = {0.0f, -0.8f, 0.0f};  // 屏幕下方
@@ -216,48 +260,102 @@ Java_com_example_ndklearn2_OpenGLRenderer3_nativeInit(JNIEnv* env, jobject thiz)
     memcpy(g_Particle_Uniforms.spoutPos, spoutPosTemp, sizeof(spoutPosTemp));
     memcpy(g_Particle_Uniforms.gravity, gravityTemp, sizeof(gravityTemp));
     g_Particle_Uniforms.maxLifeTime = MAX_LIFE_TIME;
-    updateUniformBuffer(&g_Particle_Uniforms.ubo, &g_Particle_Uniforms.deltaTime, 0, sizeof(g_Particle_Uniforms.deltaTime));
-    updateUniformBuffer(&g_Particle_Uniforms.ubo, &g_Particle_Uniforms.spoutPos, 16, sizeof(g_Particle_Uniforms.spoutPos));
-    updateUniformBuffer(&g_Particle_Uniforms.ubo, &g_Particle_Uniforms.gravity, 32, sizeof(g_Particle_Uniforms.gravity));
-    updateUniformBuffer(&g_Particle_Uniforms.ubo, &g_Particle_Uniforms.maxLifeTime, 44, sizeof(g_Particle_Uniforms.maxLifeTime));
-    updateUniformBuffer(&g_Particle_Uniforms.ubo, &g_Particle_Uniforms.currentTime, 48, sizeof(g_Particle_Uniforms.currentTime));
-    return JNI_TRUE;
+    return true;
 }
 
-// 从 Bitmap 加载纹理
-extern "C" JNIEXPORT void JNICALL
-Java_com_example_ndklearn2_OpenGLRenderer3_loadTextureFromBitmap(JNIEnv *env, jobject thiz, jobject bitmap) {
-    if (gRenderer.textureID != 0) {
-        releaseTexture(gRenderer.textureID);
-    }
-    gRenderer.textureID = loadTextureFromBitmap(env, bitmap);
-    if (gRenderer.textureID == 0) {
+// 替换粒子纹理（JNI 层从 Bitmap 提交上传），上传完成前继续使用旧纹理
+void particleRendererSetTexture(TextureFuture texture) {
+    discardTexture(&gTextureFuture);
+    gTextureFuture = texture;
+    if (!gTextureFuture.valid()) {
         LOGE("Failed to load texture from bitmap");
     }
 }
 
 // 释放纹理
-extern "C" JNIEXPORT void JNICALL
-Java_com_example_ndklearn2_OpenGLRenderer3_releaseTexture(JNIEnv *env, jobject thiz) {
+void particleRendererReleaseTexture() {
+    discardTexture(&gTextureFuture);
+    releaseDiscardedTextures();
     releaseTexture(gRenderer.textureID);
     gRenderer.textureID = 0;
 }
 
+// 按布局把整个块拼好，padding 清零
+static void packCameraUniforms(unsigned char* block) {
+    memset(block, 0, CameraUniformsLayout::SIZE);
+    CameraUniformsLayout::write<CAMERA_ASPECT_RATIO>(block, &g_Camera_Uniforms.aspectRatio);
+    CameraUniformsLayout::write<CAMERA_POS>(block, g_Camera_Uniforms.cameraPos);
+}
+
+static void packParticleUniforms(unsigned char* block) {
+    memset(block, 0, ParticleUniformsLayout::SIZE);
+    ParticleUniformsLayout::write<PARTICLE_DELTA_TIME>(block, &g_Particle_Uniforms.deltaTime);
+    ParticleUniformsLayout::write<PARTICLE_SPOUT_POS>(block, g_Particle_Uniforms.spoutPos);
+    ParticleUniformsLayout::write<PARTICLE_GRAVITY>(block, g_Particle_Uniforms.gravity);
+    ParticleUniformsLayout::write<PARTICLE_MAX_LIFE_TIME>(block, &g_Particle_Uniforms.maxLifeTime);
+    ParticleUniformsLayout::write<PARTICLE_CURRENT_TIME>(block, &g_Particle_Uniforms.currentTime);
+}
+
+// 整块一次上传；UBO 按反射的块大小分配，不超过布局大小（见 verifyStd140Layout）
+static void uploadUniformBlock(UniformBuffer* ubo, const unsigned char* block, size_t size) {
+    updateUniformBuffer(ubo, block, 0, std::min((size_t)ubo->size, size));
+}
+
+static void uploadCameraUniforms() {
+    unsigned char block[CameraUniformsLayout::SIZE];
+    packCameraUniforms(block);
+    uploadUniformBlock(&g_Camera_Uniforms.ubo, block, sizeof(block));
+}
+
+static void uploadParticleUniforms() {
+    unsigned char block[ParticleUniformsLayout::SIZE];
+    packParticleUniforms(block);
+    uploadUniformBlock(&g_Particle_Uniforms.ubo, block, sizeof(block));
+}
+
 // 改变视口大小
-extern "C" JNIEXPORT void JNICALL
-Java_com_example_ndklearn2_OpenGLRenderer3_nativeResize(JNIEnv *env, jobject thiz, jint width, jint height) {
+void particleRendererResize(int width, int height) {
     LOGI("Resizing viewport to %d x %d", width, height);
-    glViewport(0, 0, width, height);
+    cachedViewport(0, 0, width, height);
     g_Camera_Uniforms.aspectRatio = (float)width / (float)height;
-    updateUniformBuffer(&g_Camera_Uniforms.ubo, &g_Camera_Uniforms.aspectRatio, 0, sizeof(g_Camera_Uniforms.aspectRatio));
+    // 程序还在编译时 UBO 尚未创建，就绪后 createParticleUBOs 会上传最新的宽高比
+    if (g_Camera_Uniforms.ubo.ubo != 0) {
+        uploadCameraUniforms();
+    }
 }
 
+static void createParticleUBOs();
+
 static int frameCount = 0;
 
+// 把整个 ParticleUniforms 写进环形缓冲并绑定这一段，成功时返回 true
+static bool streamParticleUniforms() {
+    if (gStreamBuffer == nullptr) {
+        return false;
+    }
+    StreamRange range;
+    unsigned char* block = (unsigned char*)streamBufferMap(gStreamBuffer, ParticleUniformsLayout::SIZE,
+                                                           streamBufferUniformAlignment(gStreamBuffer), &range);
+    if (block == nullptr) {
+        return false;
+    }
+    packParticleUniforms(block);
+    if (!streamBufferUnmap(gStreamBuffer)) {
+        return false;
+    }
+    cachedBindBufferRange(GL_UNIFORM_BUFFER, g_Particle_Uniforms.ubo.bindingPoint, range.buffer, range.offset,
+                          range.size);
+    return true;
+}
+
 // 渲染一帧
-extern "C" JNIEXPORT void JNICALL
-Java_com_example_ndklearn2_OpenGLRenderer3_nativeRender(JNIEnv *env, jobject thiz) {
-    if (!gRenderer.initialized || gRenderer.program == 0) {
+void particleRendererRender() {
+    GLTraceFrameScope traceFrame;
+    FrameTimingFrameScope timingFrame;
+    GLCheckFrameScope checkFrame;
+    StreamBufferFrameScope streamFrame(gStreamBuffer);
+
+    if (!gRenderer.initialized) {
         LOGE("Renderer not initialized");
         return;
     }
@@ -271,15 +369,43 @@ Java_com_example_ndklearn2_OpenGLRenderer3_nativeRender(JNIEnv *env, jobject thi
     frameCount++;
     if (frameCount % 60 == 0) {  // 每60帧打印一次
         LOGI("Rendering frame %d", frameCount);
+        logGLStateCacheStats(LOG_TAG);
     }
 
-    glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
-    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-    glEnable(GL_DEPTH_TEST);
+    {
+        FrameTimingStageScope timing(FRAME_STAGE_CLEAR);
+        glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    }
+
+    // 程序还在工作线程编译：只输出清屏颜色作为占位帧，不阻塞渲染线程
+    if (gRenderer.program == 0) {
+        if (!pollProgram(&gProgramFuture, &gRenderer.program)) {
+            return;
+        }
+        if (gRenderer.program == 0) {
+            LOGE("Failed to create shader program - check shader compilation errors above");
+            gRenderer.initialized = false;
+            return;
+        }
+        LOGI("Shader program ready, program=%d", gRenderer.program);
+        logProgramCacheStats(LOG_TAG);
+        // 登记后 createUniformBuffer 使用反射结果，块绑定在重新链接后自动恢复
+        registerProgram(gRenderer.program, LOG_TAG);
+        createParticleUBOs();
+        // 采样器固定用纹理单元 0，只在程序就绪时设置一次
+        GLint textureLoc = programUniformLocation(gRenderer.program, UNIFORM_TEXTURE);
+        if (textureLoc != -1) {
+            cachedUseProgram(gRenderer.program);
+            glUniform1i(textureLoc, 0);
+        }
+    }
+
+    cachedEnable(GL_BLEND);
+    cachedBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    cachedEnable(GL_DEPTH_TEST);
 
-    glUseProgram(gRenderer.program);
+    cachedUseProgram(gRenderer.program);
 
     //设置统一变量
     //当前时间（使用毫秒精度）
@@ -316,9 +442,11 @@ Java_com_example_ndklearn2_OpenGLRenderer3_nativeRender(JNIEnv *env, jobject thi
     if (g_Particle_Uniforms.ubo.ubo == 0) {
         LOGE("Particle UBO is not initialized!");
     } else {
-        updateUniformBuffer(&g_Particle_Uniforms.ubo, &g_Particle_Uniforms.deltaTime, 0, sizeof(g_Particle_Uniforms.deltaTime));
-        // 注意：UBO 中 uCurrentTime 在 offset 48 之后（uMaxLifeTime 在 44-47）
-        updateUniformBuffer(&g_Particle_Uniforms.ubo, &g_Particle_Uniforms.currentTime, 48, sizeof(g_Particle_Uniforms.currentTime));
+        FrameTimingStageScope timing(FRAME_STAGE_UNIFORMS);
+        if (!streamParticleUniforms()) {
+            uploadParticleUniforms();
+            cachedBindBufferBase(GL_UNIFORM_BUFFER, g_Particle_Uniforms.ubo.bindingPoint, g_Particle_Uniforms.ubo.ubo);
+        }
     }
     
 //    if (frameCount <= 10 || frameCount % 60 == 0) {
@@ -327,22 +455,32 @@ Java_com_example_ndklearn2_OpenGLRenderer3_nativeRender(JNIEnv *env, jobject thi
 //    }
 
 
+    // 纹理在加载线程上传完成后替换旧纹理
+    GLuint texture = 0;
+    if (pollTexture(&gTextureFuture, &texture)) {
+        if (texture == 0) {
+            LOGE("Texture upload failed, keeping the previous texture");
+        } else {
+            releaseTexture(gRenderer.textureID);
+            gRenderer.textureID = texture;
+            LOGI("Texture ready, texture=%d", gRenderer.textureID);
+        }
+    }
+    // 按每帧预算补上大纹理还没上传的 mip 级别
+    streamTextureLevels();
+
     // 绑定纹理
     if (gRenderer.textureID != 0) {
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, gRenderer.textureID);
-        GLint textureLoc = glGetUniformLocation(gRenderer.program, "uTexture");
-        if (textureLoc != -1) {
-            glUniform1i(textureLoc, 0);
-        }
+        cachedActiveTexture(GL_TEXTURE0);
+        cachedBindTexture(GL_TEXTURE_2D, gRenderer.textureID);
     }
 
 
     // 绑定并绘制网格
     if (gRenderer.mesh.vao != 0) {
-        glBindVertexArray(gRenderer.mesh.vao);
+        cachedBindVertexArray(gRenderer.mesh.vao);
         if (gRenderer.mesh.indexCount > 0) {
-            glDrawElements(GL_TRIANGLES, gRenderer.mesh.indexCount, GL_UNSIGNED_INT, 0);
+            glDrawElements(GL_TRIANGLES, gRenderer.mesh.indexCount, gRenderer.mesh.indexType, 0);
         } else if (gRenderer.g_tfb[0] != 0 && gRenderer.g_tfb[1] != 0){
             //两次 glDrawArrays 看似重复，实则目的完全不同：
             //第一次是 "更新粒子数据"（只跑顶点着色器，不渲染），
@@ -351,53 +489,55 @@ Java_com_example_ndklearn2_OpenGLRenderer3_nativeRender(JNIEnv *env, jobject thi
                 LOGI("Drawing particles for first time, currentBuffer=%d", gRenderer.currentBuffer);
             }
             // 更新粒子（使用 Transform Feedback）
-            updateParticlesWithTFB();
+            {
+                FrameTimingStageScope timing(FRAME_STAGE_TFB_UPDATE);
+                updateParticlesWithTFB();
+            }
             // 渲染更新后的粒子
-            renderParticles();
-            
-            // 检查 OpenGL 错误
-            GLenum err = glGetError();
-            if (err != GL_NO_ERROR && frameCount <= 5) {
-                LOGE("OpenGL error after drawing: 0x%x", err);
+            {
+                FrameTimingStageScope timing(FRAME_STAGE_DRAW);
+                renderParticles();
             }
+            
+            // 检查 OpenGL 错误（抽样模式下不是每帧都查询）
+            logGLError(LOG_TAG, "particle update and draw");
         }
-        glBindVertexArray(0);
     }
-
-    glUseProgram(0);
+    // 不再解绑 VAO 和程序：状态缓存会丢弃下一帧相同的绑定
 }
 
 // 清理资源
-extern "C" JNIEXPORT void JNICALL
-Java_com_example_ndklearn2_OpenGLRenderer3_nativeCleanup(JNIEnv *env, jobject thiz) {
+void particleRendererCleanup() {
     releaseMesh(&gRenderer.mesh);
-    releaseTexture(gRenderer.textureID);
+    particleRendererReleaseTexture();
 
     // 释放双缓冲 TFB
     if (gRenderer.g_tfb[0] != 0) {
-        glDeleteBuffers(1, &gRenderer.g_tfb[0]);
+        cachedDeleteBuffers(1, &gRenderer.g_tfb[0]);
         gRenderer.g_tfb[0] = 0;
     }
     if (gRenderer.g_tfb[1] != 0) {
-        glDeleteBuffers(1, &gRenderer.g_tfb[1]);
+        cachedDeleteBuffers(1, &gRenderer.g_tfb[1]);
         gRenderer.g_tfb[1] = 0;
     }
 
     if (gRenderer.program != 0) {
-        glDeleteProgram(gRenderer.program);
+        unregisterProgram(gRenderer.program);
+        cachedDeleteProgram(gRenderer.program);
         gRenderer.program = 0;
     }
+    gProgramFuture = ProgramFuture();
+    destroyStreamBuffer(gStreamBuffer);
+    gStreamBuffer = nullptr;
 
     gRenderer.initialized = false;
     LOGI("Renderer3 resources cleaned up");
 }
 
 
-extern "C"
-JNIEXPORT void JNICALL
-Java_com_example_ndklearn2_OpenGLRenderer3_initTFBBuffer(JNIEnv *env, jobject thiz) {
-    if (gRenderer.program == 0) {
-        LOGE("Cannot initialize TFB buffer: program is not created");
+void particleRendererInitTFBBuffer() {
+    if (!gRenderer.initialized) {
+        LOGE("Cannot initialize TFB buffer: renderer is not initialized");
         return;
     }
     
@@ -435,48 +575,21 @@ Java_com_example_ndklearn2_OpenGLRenderer3_initTFBBuffer(JNIEnv *env, jobject th
 
     // 初始化两个缓冲区（内容相同）
     for (int i = 0; i < 2; i++) {
-        glBindBuffer(GL_TRANSFORM_FEEDBACK_BUFFER, gRenderer.g_tfb[i]);
+        cachedBindBuffer(GL_TRANSFORM_FEEDBACK_BUFFER, gRenderer.g_tfb[i]);
         glBufferData(GL_TRANSFORM_FEEDBACK_BUFFER, buffer_size, particles, GL_DYNAMIC_COPY);
     }
     delete[] particles;  // 释放临时数组
     
-    //指定TFB要捕获的变量
-    glTransformFeedbackVaryings(gRenderer.program, 4, g_TransformFeedbackVaryings, GL_INTERLEAVED_ATTRIBS);
-
-    // 重新链接着色器程序（使TFB变量设置生效）
-    glLinkProgram(gRenderer.program);
-
-    //检查链接状态
-    GLint status;
-    glGetProgramiv(gRenderer.program, GL_LINK_STATUS, &status);
-    if (status != GL_TRUE) {
-        //抛出错误
-        GLint infoLen = 0;
-        glGetProgramiv(gRenderer.program, GL_INFO_LOG_LENGTH, &infoLen);
-        if (infoLen > 0) {
-            char* infoLog = new char[infoLen];
-            glGetProgramInfoLog(gRenderer.program, infoLen, nullptr, infoLog);
-            LOGE("Program link failed after TFB setup: %s", infoLog);
-            delete[] infoLog;
-        } else {
-            LOGE("Program link failed after TFB setup (no error log)");
-        }
-        // 解绑并返回，不继续初始化
-        glBindBuffer(GL_TRANSFORM_FEEDBACK_BUFFER, 0);
-        gRenderer.initialized = false;
-        return;
-    } else {
-        LOGI("TFB buffer initialized successfully, program relinked");
-    }
+    // TFB 捕获变量已在 particleRendererInit 链接前设置（createCachedProgram），这里不再重新链接
+    LOGI("TFB buffer initialized successfully");
     //解绑
-    glBindBuffer(GL_TRANSFORM_FEEDBACK_BUFFER, 0);
+    cachedBindBuffer(GL_TRANSFORM_FEEDBACK_BUFFER, 0);
 
 }
-extern "C"
-JNIEXPORT void JNICALL
-Java_com_example_ndklearn2_OpenGLRenderer3_initVAO(JNIEnv *env, jobject thiz) {
-    if (gRenderer.program == 0) {
-        LOGE("Cannot initialize VAO: program is not created");
+
+void particleRendererInitVAO() {
+    if (!gRenderer.initialized) {
+        LOGE("Cannot initialize VAO: renderer is not initialized");
         return;
     }
     if (gRenderer.g_tfb[0] == 0 || gRenderer.g_tfb[1] == 0) {
@@ -487,10 +600,10 @@ Java_com_example_ndklearn2_OpenGLRenderer3_initVAO(JNIEnv *env, jobject thiz) {
     LOGI("Initializing VAO");
     
     glGenVertexArrays(1, &gRenderer.mesh.vao);
-    glBindVertexArray(gRenderer.mesh.vao);
+    cachedBindVertexArray(gRenderer.mesh.vao);
     //绑定TFB缓冲区作为顶点缓冲区（因为粒子数据存在这里）
     // 初始绑定到缓冲区0
-    glBindBuffer(GL_ARRAY_BUFFER, gRenderer.g_tfb[0]);
+    cachedBindBuffer(GL_ARRAY_BUFFER, gRenderer.g_tfb[0]);
 
     //绑定顶点属性（对应顶点着色器的in变量）
     glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Particle), (void*)offsetof(Particle, position));
@@ -502,22 +615,29 @@ Java_com_example_ndklearn2_OpenGLRenderer3_initVAO(JNIEnv *env, jobject thiz) {
     glVertexAttribPointer(3, 1, GL_FLOAT, GL_FALSE, sizeof(Particle), (void*)(offsetof(Particle, lifeTime)));
     glEnableVertexAttribArray(3);
     //解绑VAO和vbo
-    glBindVertexArray(0);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    cachedBindVertexArray(0);
+    cachedBindBuffer(GL_ARRAY_BUFFER, 0);
     
     LOGI("VAO initialized successfully");
 }
-extern "C"
-JNIEXPORT void JNICALL
-Java_com_example_ndklearn2_OpenGLRenderer3_initUBO(JNIEnv *env, jobject thiz) {
+
+void particleRendererInitUBO() {
+    if (!gRenderer.initialized) {
+        LOGE("Cannot initialize UBO: renderer is not initialized");
+        return;
+    }
+    // UBO 依赖程序对象的 Block 信息，程序还在编译时推迟到 particleRendererRender 中程序就绪后创建
     if (gRenderer.program == 0) {
-        LOGE("Cannot initialize UBO: program is not created");
+        LOGI("Shader program still compiling, UBO creation deferred");
         return;
     }
+    createParticleUBOs();
+}
+
+// 创建和绑定UBO，并上传初始值（程序就绪后调用）
+static void createParticleUBOs() {
+    LOGI("Initializing UBO");
     
-    LOGI("Initializing UBO (re-bind after program relink)");
-    
-    // 重新链接程序后，需要重新创建和绑定UBO
     // 释放旧的 UBO
     if (g_Camera_Uniforms.ubo.ubo != 0) {
         releaseUniformBuffer(&g_Camera_Uniforms.ubo);
@@ -526,22 +646,21 @@ Java_com_example_ndklearn2_OpenGLRenderer3_initUBO(JNIEnv *env, jobject thiz) {
         releaseUniformBuffer(&g_Particle_Uniforms.ubo);
     }
     
+    // 布局与着色器不一致时上传的数据会错位，只报告
+    verifyStd140Layout<CameraUniformsLayout>(gRenderer.program, BLOCK_CAMERA, CAMERA_MEMBERS);
+    verifyStd140Layout<ParticleUniformsLayout>(gRenderer.program, BLOCK_PARTICLE, PARTICLE_MEMBERS);
+
     // 重新创建 Camera UBO
     g_Camera_Uniforms.ubo = createUniformBuffer(gRenderer.program, "CameraUniforms", 0);
-    updateUniformBuffer(&g_Camera_Uniforms.ubo, &g_Camera_Uniforms.aspectRatio, 0, sizeof(g_Camera_Uniforms.aspectRatio));
     g_Camera_Uniforms.cameraPos[0] = 0.0f;
     g_Camera_Uniforms.cameraPos[1] = 0.0f;
     g_Camera_Uniforms.cameraPos[2] = 0.0f;
-    updateUniformBuffer(&g_Camera_Uniforms.ubo, &g_Camera_Uniforms.cameraPos, 16, sizeof(g_Camera_Uniforms.cameraPos));
+    uploadCameraUniforms();
 
     // 重新创建 Particle UBO（确保使用相同的初始值）
     g_Particle_Uniforms.ubo = createUniformBuffer(gRenderer.program, "ParticleUniforms", 1);
     g_Particle_Uniforms.currentTime = 0.0f;  // 初始化累积时间
-    updateUniformBuffer(&g_Particle_Uniforms.ubo, &g_Particle_Uniforms.deltaTime, 0, sizeof(g_Particle_Uniforms.deltaTime));
-    updateUniformBuffer(&g_Particle_Uniforms.ubo, &g_Particle_Uniforms.spoutPos, 16, sizeof(g_Particle_Uniforms.spoutPos));
-    updateUniformBuffer(&g_Particle_Uniforms.ubo, &g_Particle_Uniforms.gravity, 32, sizeof(g_Particle_Uniforms.gravity));
-    updateUniformBuffer(&g_Particle_Uniforms.ubo, &g_Particle_Uniforms.maxLifeTime, 44, sizeof(g_Particle_Uniforms.maxLifeTime));
-    updateUniformBuffer(&g_Particle_Uniforms.ubo, &g_Particle_Uniforms.currentTime, 48, sizeof(g_Particle_Uniforms.currentTime));
+    uploadParticleUniforms();
     
     LOGI("UBO initialized successfully - spoutPos=(%.2f,%.2f,%.2f), gravity=(%.2f,%.2f,%.2f)", 
          g_Particle_Uniforms.spoutPos[0], g_Particle_Uniforms.spoutPos[1], g_Particle_Uniforms.spoutPos[2],
@@ -549,15 +668,15 @@ Java_com_example_ndklearn2_OpenGLRenderer3_initUBO(JNIEnv *env, jobject thiz) {
 }
 void updateParticlesWithTFB() {
     //禁用光栅化（只更新粒子，不渲染，节省性能）
-    glEnable(GL_RASTERIZER_DISCARD);
+    cachedEnable(GL_RASTERIZER_DISCARD);
 
     // 双缓冲 ping-pong：从 currentBuffer 读取，写入到另一个缓冲区
     int readBuffer = gRenderer.currentBuffer;
     int writeBuffer = 1 - gRenderer.currentBuffer;
 
     // 绑定读取缓冲区到 VAO（作为输入）
-    // 注意：VAO 必须已经绑定（在 nativeRender 中）
-    glBindBuffer(GL_ARRAY_BUFFER, gRenderer.g_tfb[readBuffer]);
+    // 注意：VAO 必须已经绑定（在 particleRendererRender 中）
+    cachedBindBuffer(GL_ARRAY_BUFFER, gRenderer.g_tfb[readBuffer]);
     // 更新顶点属性指针指向读取缓冲区（这些设置会保存到当前绑定的 VAO）
     glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Particle), (void*)offsetof(Particle, position));
     glEnableVertexAttribArray(0);
@@ -569,7 +688,7 @@ void updateParticlesWithTFB() {
     glEnableVertexAttribArray(3);
 
     // 绑定写入缓冲区到 Transform Feedback（作为输出）
-    glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, BINDING_POINT_TFB, gRenderer.g_tfb[writeBuffer]);
+    cachedBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, BINDING_POINT_TFB, gRenderer.g_tfb[writeBuffer]);
 
     //开启TFB捕获模式（图元类型为点）
     glBeginTransformFeedback(GL_POINTS);
@@ -587,12 +706,12 @@ void updateParticlesWithTFB() {
     gRenderer.currentBuffer = writeBuffer;
 
     //启用光栅化（后续渲染需要）
-    glDisable(GL_RASTERIZER_DISCARD);
+    cachedDisable(GL_RASTERIZER_DISCARD);
 }
 void renderParticles() {
     // 绑定当前缓冲区（已更新的数据）到 VAO 用于渲染
-    // 注意：VAO 已经绑定（在 nativeRender 中），只需要更新 ARRAY_BUFFER 绑定
-    glBindBuffer(GL_ARRAY_BUFFER, gRenderer.g_tfb[gRenderer.currentBuffer]);
+    // 注意：VAO 已经绑定（在 particleRendererRender 中），只需要更新 ARRAY_BUFFER 绑定
+    cachedBindBuffer(GL_ARRAY_BUFFER, gRenderer.g_tfb[gRenderer.currentBuffer]);
     // 重新设置顶点属性指针（因为缓冲区改变了）
     // VAO 已经绑定，所以这些设置会更新 VAO 的状态
     glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Particle), (void*)offsetof(Particle, position));
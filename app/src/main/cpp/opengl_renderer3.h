@@ -0,0 +1,26 @@
+//
+// Created by zhangx on 2026/10/16.
+// Renderer3（Transform Feedback 粒子）的渲染核心，不依赖 JNI，JNI 入口见 opengl_renderer3_jni.cpp
+// 所有函数都在持有 GL 上下文的渲染线程调用
+//
+
+#ifndef NDKLEARN2_OPENGL_RENDERER3_H
+#define NDKLEARN2_OPENGL_RENDERER3_H
+
+#include <GLES3/gl3.h>
+#include "texture_loader.h"
+
+// 提交粒子程序的编译请求，之后依次调用 initTFBBuffer、initVAO、initUBO
+bool particleRendererInit();
+void particleRendererInitTFBBuffer();
+void particleRendererInitVAO();
+// 程序还在编译时推迟到程序就绪后创建
+void particleRendererInitUBO();
+// 接管上传中的纹理，就绪后在渲染时替换旧纹理（旧纹理被释放）
+void particleRendererSetTexture(TextureFuture texture);
+void particleRendererReleaseTexture();
+void particleRendererResize(int width, int height);
+void particleRendererRender();
+void particleRendererCleanup();
+
+#endif //NDKLEARN2_OPENGL_RENDERER3_H
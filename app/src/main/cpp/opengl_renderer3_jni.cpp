@@ -0,0 +1,53 @@
+//
+// Created by zhangx on 2026/10/16.
+// OpenGLRenderer3 的 JNI 入口，只做参数转换，渲染逻辑在 opengl_renderer3.cpp
+//
+
+#include <jni.h>
+#include "opengl_renderer3.h"
+#include "opengl_utils.h"
+
+extern "C" JNIEXPORT jboolean JNICALL
+Java_com_example_ndklearn2_OpenGLRenderer3_nativeInit(JNIEnv* env, jobject thiz) {
+    return particleRendererInit() ? JNI_TRUE : JNI_FALSE;
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_example_ndklearn2_OpenGLRenderer3_loadTextureFromBitmap(JNIEnv *env, jobject thiz, jobject bitmap) {
+    particleRendererSetTexture(loadTextureFromBitmapAsync(env, bitmap, nullptr));
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_example_ndklearn2_OpenGLRenderer3_releaseTexture(JNIEnv *env, jobject thiz) {
+    particleRendererReleaseTexture();
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_example_ndklearn2_OpenGLRenderer3_nativeResize(JNIEnv *env, jobject thiz, jint width, jint height) {
+    particleRendererResize(width, height);
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_example_ndklearn2_OpenGLRenderer3_nativeRender(JNIEnv *env, jobject thiz) {
+    particleRendererRender();
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_example_ndklearn2_OpenGLRenderer3_nativeCleanup(JNIEnv *env, jobject thiz) {
+    particleRendererCleanup();
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_example_ndklearn2_OpenGLRenderer3_initTFBBuffer(JNIEnv *env, jobject thiz) {
+    particleRendererInitTFBBuffer();
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_example_ndklearn2_OpenGLRenderer3_initVAO(JNIEnv *env, jobject thiz) {
+    particleRendererInitVAO();
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_example_ndklearn2_OpenGLRenderer3_initUBO(JNIEnv *env, jobject thiz) {
+    particleRendererInitUBO();
+}
@@ -0,0 +1,27 @@
+//
+// Created by zhangx on 2026/10/16.
+// OpenGLRenderer 的 JNI 入口，只做参数转换，渲染逻辑在 opengl_renderer.cpp
+//
+
+#include <jni.h>
+#include "opengl_renderer.h"
+
+extern "C" JNIEXPORT jboolean JNICALL
+Java_com_example_ndklearn2_OpenGLRenderer_nativeInit(JNIEnv* env, jobject thiz) {
+    return triangleRendererInit() ? JNI_TRUE : JNI_FALSE;
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_example_ndklearn2_OpenGLRenderer_nativeResize(JNIEnv* env, jobject thiz, jint width, jint height) {
+    triangleRendererResize(width, height);
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_example_ndklearn2_OpenGLRenderer_nativeRender(JNIEnv* env, jobject thiz) {
+    triangleRendererRender();
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_example_ndklearn2_OpenGLRenderer_nativeCleanup(JNIEnv* env, jobject thiz) {
+    triangleRendererCleanup();
+}
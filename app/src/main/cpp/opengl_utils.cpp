@@ -4,9 +4,25 @@
 //
 
 #include "opengl_utils.h"
+#include "program_cache.h"
+#include "shader_registry.h"
+#include "gl_trace.h"
 #include <android/log.h>
+#ifdef __ANDROID__
+#include <android/asset_manager_jni.h>
 #include <android/bitmap.h>
+#endif
+#include <GLES2/gl2ext.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
 #include <cstring>
+#include <unordered_map>
+#include <vector>
 
 #define LOG_TAG "OpenGLUtils"
 #define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
@@ -47,8 +63,15 @@ GLuint compileShader(GLenum type, const char* source) {
     return shader;
 }
 
-// 创建着色器程序
+// 创建着色器程序（优先从程序二进制缓存加载）
 GLuint createProgram(const char* vertexShaderSource, const char* fragmentShaderSource) {
+    return createCachedProgram(vertexShaderSource, fragmentShaderSource, nullptr, 0, GL_INTERLEAVED_ATTRIBS);
+}
+
+// 从源码编译并链接着色器程序
+GLuint compileAndLinkProgram(const char* vertexShaderSource, const char* fragmentShaderSource,
+                             const char* const* tfbVaryings, GLsizei tfbVaryingCount,
+                             GLenum tfbBufferMode, bool retrievable) {
     LOGI("Creating shader program...");
     
     GLuint vertexShader = compileShader(GL_VERTEX_SHADER, vertexShaderSource);
@@ -74,6 +97,17 @@ GLuint createProgram(const char* vertexShaderSource, const char* fragmentShaderS
 
     glAttachShader(program, vertexShader);
     glAttachShader(program, fragmentShader);
+
+    // TFB 捕获变量必须在链接前指定，这样只需链接一次
+    if (tfbVaryings != nullptr && tfbVaryingCount > 0) {
+        glTransformFeedbackVaryings(program, tfbVaryingCount, tfbVaryings, tfbBufferMode);
+    }
+    // 提示驱动保留程序二进制，供 glGetProgramBinary 读取
+    if (retrievable) {
+        glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
+    logGLError(LOG_TAG, "program setup before link");
+
     LOGI("Linking shader program...");
     glLinkProgram(program);
 
@@ -103,66 +137,120 @@ GLuint createProgram(const char* vertexShaderSource, const char* fragmentShaderS
     return program;
 }
 
-// 从 Bitmap 加载纹理
-GLuint loadTextureFromBitmap(JNIEnv* env, jobject bitmap) {
+#ifdef __ANDROID__
+// 从 Bitmap 异步加载纹理：渲染线程上只锁定和复制像素，上传和 mipmap 生成在纹理加载线程
+TextureFuture loadTextureFromBitmapAsync(JNIEnv* env, jobject bitmap, const char* cachePath) {
     AndroidBitmapInfo info;
     void *pixels = nullptr;
 
     // 获取Bitmap信息
     if (AndroidBitmap_getInfo(env, bitmap, &info) < 0) {
         LOGE("Failed to get bitmap info");
-        return 0;
+        return TextureFuture();
     }
 
-    // 仅处理RGBA_8888格式
-    if (info.format != ANDROID_BITMAP_FORMAT_RGBA_8888) {
-        LOGE("Unsupported bitmap format");
-        return 0;
+    // 每种 Bitmap 格式都有内存布局相同的 GL 格式，按原格式上传，不在 CPU 上展开成 RGBA8
+    GLenum internalFormat;
+    switch (info.format) {
+        case ANDROID_BITMAP_FORMAT_RGBA_8888: internalFormat = GL_RGBA8; break;
+        case ANDROID_BITMAP_FORMAT_RGB_565: internalFormat = GL_RGB565; break;
+        case ANDROID_BITMAP_FORMAT_A_8: internalFormat = GL_R8; break;
+        case ANDROID_BITMAP_FORMAT_RGBA_F16: internalFormat = GL_RGBA16F; break;
+        default:
+            LOGE("Unsupported bitmap format %d", info.format);
+            return TextureFuture();
     }
 
     // 锁定像素内存
     if (AndroidBitmap_lockPixels(env, bitmap, &pixels) < 0) {
         LOGE("Failed to lock bitmap pixels");
-        return 0;
+        return TextureFuture();
     }
 
-    // 生成纹理
-    GLuint textureID = 0;
-    glGenTextures(1, &textureID);
-    glBindTexture(GL_TEXTURE_2D, textureID);
-
-    // 上传像素数据
-    glTexImage2D(
-        GL_TEXTURE_2D,
-        0,
-        GL_RGBA,
-        info.width,
-        info.height,
-        0,
-        GL_RGBA,
-        GL_UNSIGNED_BYTE,
-        pixels
-    );
+    // stride 大于 width * 每像素字节数时，复制时按 4 字节对齐重新排列各行
+    TexturePixels source = {pixels, internalFormat, (int)info.width, (int)info.height, (int)info.stride};
+    TextureFuture texture = requestPixelsTextureAsync(source, true, cachePath);
 
     // 解锁Bitmap
     AndroidBitmap_unlockPixels(env, bitmap);
+    return texture;
+}
+
+TextureFuture loadCompressedTextureFromAsset(JNIEnv* env, jobject assetManager, const char* path) {
+    AAssetManager* manager = AAssetManager_fromJava(env, assetManager);
+    AAsset* asset = manager != nullptr ? AAssetManager_open(manager, path, AASSET_MODE_BUFFER) : nullptr;
+    if (asset == nullptr) {
+        // KTX 只由主机构建的 texture_assets 目标生成，只跑 Gradle 的构建不会打包，退回 Bitmap 上传会慢很多
+        LOGE("Missing compressed texture asset %s, build the host texture_assets target to generate it", path);
+        return TextureFuture();
+    }
+    // 未压缩存放的 asset 直接映射，不经过额外的复制
+    const void* data = AAsset_getBuffer(asset);
+    TextureFuture texture;
+    if (data != nullptr) {
+        texture = loadKTXTextureAsync(data, (size_t)AAsset_getLength(asset));
+    } else {
+        LOGE("Failed to read asset %s", path);
+    }
+    AAsset_close(asset);
+    return texture;
+}
+#endif // __ANDROID__
 
-    // 设置纹理参数
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    glGenerateMipmap(GL_TEXTURE_2D);
+bool isCompressedFormatSupported(GLenum internalFormat) {
+    int blockWidth, blockHeight, blockBytes;
+    if (!compressedBlockInfo(internalFormat, &blockWidth, &blockHeight, &blockBytes)) {
+        return false;
+    }
+    if (internalFormat >= GL_COMPRESSED_R11_EAC && internalFormat <= GL_COMPRESSED_SRGB8_ALPHA8_ETC2_EAC) {
+        return true;
+    }
+    const char* extensions = (const char*)glGetString(GL_EXTENSIONS);
+    return extensions != nullptr && strstr(extensions, "GL_KHR_texture_compression_astc_ldr") != nullptr;
+}
 
-    glBindTexture(GL_TEXTURE_2D, 0);
+TextureFuture loadKTXTextureAsync(const void* data, size_t size) {
+    KTXImage image;
+    if (!parseKTX(data, size, &image)) {
+        return TextureFuture();
+    }
+    bool compressed = compressedLevelSize(image.internalFormat, 1, 1) != 0;
+    if (compressed && !isCompressedFormatSupported(image.internalFormat)) {
+        LOGE("%s textures (0x%x) are not supported on this device", textureFormatName(image.internalFormat),
+             image.internalFormat);
+        return TextureFuture();
+    }
+    LOGI("Loading %dx%d %s texture with %d levels, %zu bytes", image.width, image.height,
+         textureFormatName(image.internalFormat), image.levelCount, size);
+    return requestKTXTextureAsync(data, size, image);
+}
 
-    return textureID;
+TextureFuture loadTextureFileAsync(const char* path) {
+    FILE* file = fopen(path, "rb");
+    if (file == nullptr) {
+        LOGI("No texture file %s", path);
+        return TextureFuture();
+    }
+    std::vector<unsigned char> data;
+    unsigned char buffer[65536];
+    size_t n;
+    while ((n = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        data.insert(data.end(), buffer, buffer + n);
+    }
+    bool failed = ferror(file) != 0;
+    fclose(file);
+    if (failed) {
+        LOGE("Failed to read texture file %s", path);
+        return TextureFuture();
+    }
+    return loadKTXTextureAsync(data.data(), data.size());
 }
 
 // 释放纹理
 void releaseTexture(GLuint textureID) {
     if (textureID != 0) {
-        glDeleteTextures(1, &textureID);
+        stopTextureStreaming(textureID);
+        cachedDeleteTextures(1, &textureID);
     }
 }
 
@@ -170,17 +258,8 @@ void releaseTexture(GLuint textureID) {
 MeshData createMesh(const float* vertices, size_t vertexCount, size_t vertexSize,
                     const unsigned int* indices, size_t indexCount,
                     const int* attribSizes, size_t attribCount) {
-    MeshData mesh = {0, 0, 0, 0};
-
-    glGenVertexArrays(1, &mesh.vao);
-    glGenBuffers(1, &mesh.vbo);
-    glGenBuffers(1, &mesh.ebo);
-
-    glBindVertexArray(mesh.vao);
-
-    // 上传顶点数据
-    glBindBuffer(GL_ARRAY_BUFFER, mesh.vbo);
-    glBufferData(GL_ARRAY_BUFFER, vertexCount * vertexSize * sizeof(float), vertices, GL_STATIC_DRAW);
+    MeshData mesh = createMeshBuffers(vertices, vertexCount * vertexSize * sizeof(float), indices, GL_UNSIGNED_INT,
+                                      indexCount);
 
     // 设置顶点属性
     size_t offset = 0;
@@ -190,63 +269,636 @@ MeshData createMesh(const float* vertices, size_t vertexCount, size_t vertexSize
         glEnableVertexAttribArray(i);
         offset += attribSizes[i];
     }
+    finishMeshBuffers();
+    return mesh;
+}
 
-    // 上传索引数据
+MeshData createMeshBuffers(const void* vertices, size_t vertexBytes, const void* indices, GLenum indexType,
+                           size_t indexCount) {
+    MeshData mesh = {0, 0, 0, 0, indexType};
+
+    glGenVertexArrays(1, &mesh.vao);
+    glGenBuffers(1, &mesh.vbo);
+    glGenBuffers(1, &mesh.ebo);
+
+    cachedBindVertexArray(mesh.vao);
+
+    // 上传顶点数据
+    cachedBindBuffer(GL_ARRAY_BUFFER, mesh.vbo);
+    glBufferData(GL_ARRAY_BUFFER, vertexBytes, vertices, GL_STATIC_DRAW);
+
+    // 上传索引数据（EBO 绑定记录在 VAO 中）
     if (indices != nullptr && indexCount > 0) {
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.ebo);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexCount * sizeof(unsigned int), indices, GL_STATIC_DRAW);
+        cachedBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.ebo);
+        std::vector<uint16_t> narrowed;
+        if (indexType == GL_UNSIGNED_INT) {
+            const uint32_t* wide = (const uint32_t*)indices;
+            if (*std::max_element(wide, wide + indexCount) <= 0xffffu) {
+                narrowed.assign(wide, wide + indexCount);
+                indices = narrowed.data();
+                mesh.indexType = GL_UNSIGNED_SHORT;
+            }
+        }
+        size_t indexSize = mesh.indexType == GL_UNSIGNED_SHORT ? sizeof(uint16_t) : sizeof(uint32_t);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexCount * indexSize, indices, GL_STATIC_DRAW);
         mesh.indexCount = indexCount;
     }
+    return mesh;
+}
 
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
+void finishMeshBuffers() {
+    cachedBindBuffer(GL_ARRAY_BUFFER, 0);
+    cachedBindVertexArray(0);
+    logGLError(LOG_TAG, "createMesh");
+}
 
-    return mesh;
+void setVertexAttributes(const MeshAttribute* attributes, int attributeCount, GLsizei stride) {
+    for (int i = 0; i < attributeCount; i++) {
+        const MeshAttribute& attribute = attributes[i];
+        const void* offset = (const void*)(uintptr_t)attribute.offset;
+        if ((attribute.flags & MESH_ATTRIBUTE_INTEGER) != 0) {
+            glVertexAttribIPointer(attribute.location, attribute.components, attribute.type, stride, offset);
+        } else {
+            GLboolean normalized = (attribute.flags & MESH_ATTRIBUTE_NORMALIZED) != 0 ? GL_TRUE : GL_FALSE;
+            glVertexAttribPointer(attribute.location, attribute.components, attribute.type, normalized, stride,
+                                  offset);
+        }
+        glEnableVertexAttribArray(attribute.location);
+    }
+}
+
+static MeshArenaSet* gMeshArenaTarget = nullptr;
+
+void setMeshArenaSet(MeshArenaSet* set) {
+    gMeshArenaTarget = set;
 }
 
+MeshArenaSet* meshArenaSet() {
+    return gMeshArenaTarget;
+}
+
+// 放进同一布局的网格池，失败（没有索引、索引越界）时返回 false，由调用方单独创建
+static bool addMeshFileToArena(const MeshFile& file, MeshAsset* asset) {
+    if (file.indexCount == 0) {
+        return false;
+    }
+    MeshArena* arena = meshArenaForLayout(gMeshArenaTarget, file.attributes, file.attributeCount,
+                                          (GLsizei)file.vertexStride);
+    if (arena == nullptr) {
+        return false;
+    }
+    // 网格池按 32 位索引保留原始索引
+    std::vector<uint32_t> indices;
+    if (file.indexType == GL_UNSIGNED_SHORT) {
+        const uint16_t* narrow = (const uint16_t*)file.indices;
+        indices.assign(narrow, narrow + file.indexCount);
+    } else {
+        const uint32_t* wide = (const uint32_t*)file.indices;
+        indices.assign(wide, wide + file.indexCount);
+    }
+    ArenaMeshHandle handle = arenaAddMesh(arena, file.vertices, file.vertexCount, indices.data(), file.indexCount);
+    uint32_t firstIndex;
+    if (handle == 0 || !getArenaMeshRange(arena, handle, &asset->mesh, &firstIndex)) {
+        return false;
+    }
+    asset->arena = arena;
+    asset->arenaMesh = handle;
+    return true;
+}
+
+void createMeshFromFile(const MeshFile& file, MeshAsset* asset) {
+    asset->arena = nullptr;
+    asset->arenaMesh = 0;
+    if (gMeshArenaTarget == nullptr || !addMeshFileToArena(file, asset)) {
+        asset->mesh = createMeshBuffers(file.vertices, (size_t)file.vertexCount * file.vertexStride, file.indices,
+                                        file.indexType, file.indexCount);
+        setVertexAttributes(file.attributes, file.attributeCount, (GLsizei)file.vertexStride);
+        finishMeshBuffers();
+    }
+    memcpy(asset->boundsMin, file.boundsMin, sizeof(asset->boundsMin));
+    memcpy(asset->boundsMax, file.boundsMax, sizeof(asset->boundsMax));
+    asset->submeshCount = file.submeshCount;
+    memcpy(asset->submeshes, file.submeshes, sizeof(MeshSubmesh) * file.submeshCount);
+}
+
+// 解析映射好的文件并上传，data 在返回前不能解除映射
+static bool createMeshFromMemory(const void* data, size_t size, const char* name, MeshAsset* asset) {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    MeshFile file;
+    if (!parseMeshFile(data, size, &file)) {
+        LOGE("Invalid mesh file %s", name);
+        return false;
+    }
+    createMeshFromFile(file, asset);
+    LOGI("Loaded mesh %s: %u vertices (%u bytes each), %u indices, %d submeshes in %.2f ms", name, file.vertexCount,
+         file.vertexStride, file.indexCount, file.submeshCount,
+         std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+    return true;
+}
+
+bool loadMeshFile(const char* path, MeshAsset* asset) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        LOGI("No mesh file %s", path);
+        return false;
+    }
+    struct stat info;
+    void* data = MAP_FAILED;
+    if (fstat(fd, &info) == 0 && info.st_size > 0) {
+        data = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    // 映射建立后文件描述符就不再需要
+    close(fd);
+    if (data == MAP_FAILED) {
+        LOGE("Failed to map mesh file %s", path);
+        return false;
+    }
+    bool loaded = createMeshFromMemory(data, (size_t)info.st_size, path, asset);
+    munmap(data, (size_t)info.st_size);
+    return loaded;
+}
+
+#ifdef __ANDROID__
+bool loadMeshFromAsset(JNIEnv* env, jobject assetManager, const char* path, MeshAsset* asset) {
+    AAssetManager* manager = AAssetManager_fromJava(env, assetManager);
+    AAsset* file = manager != nullptr ? AAssetManager_open(manager, path, AASSET_MODE_BUFFER) : nullptr;
+    if (file == nullptr) {
+        // .mesh 只由主机构建的 mesh_assets 目标生成，只跑 Gradle 的构建不会打包
+        LOGE("Missing mesh asset %s, build the host mesh_assets target to generate it", path);
+        return false;
+    }
+    const void* data = AAsset_getBuffer(file);
+    bool loaded = false;
+    if (data != nullptr) {
+        loaded = createMeshFromMemory(data, (size_t)AAsset_getLength(file), path, asset);
+    } else {
+        LOGE("Failed to read asset %s", path);
+    }
+    AAsset_close(file);
+    return loaded;
+}
+#endif
+
 // 释放网格数据
 void releaseMesh(MeshData* mesh) {
     if (mesh == nullptr) return;
 
     if (mesh->vao != 0) {
-        glDeleteVertexArrays(1, &mesh->vao);
+        cachedDeleteVertexArrays(1, &mesh->vao);
         mesh->vao = 0;
     }
     if (mesh->vbo != 0) {
-        glDeleteBuffers(1, &mesh->vbo);
+        cachedDeleteBuffers(1, &mesh->vbo);
         mesh->vbo = 0;
     }
     if (mesh->ebo != 0) {
-        glDeleteBuffers(1, &mesh->ebo);
+        cachedDeleteBuffers(1, &mesh->ebo);
         mesh->ebo = 0;
     }
     mesh->indexCount = 0;
 }
 
+// ==================== 网格池 ====================
+
+static const uint32_t MESH_ARENA_DEFAULT_VERTICES = 65536;
+static const uint32_t MESH_ARENA_DEFAULT_INDICES = 65536 * 3;
+
+struct ArenaRange {
+    uint32_t first;
+    uint32_t count;
+};
+
+struct ArenaMesh {
+    ArenaRange vertices;
+    ArenaRange indices;
+    std::vector<uint32_t> localIndices;  // 相对于网格第一个顶点的索引，重写 EBO 时使用
+};
+
+struct MeshArena {
+    std::vector<MeshAttribute> attributes;
+    GLsizei stride;
+    GLuint vao;
+    GLuint vbo;
+    GLuint ebo;
+    GLenum indexType;
+    uint32_t vertexCapacity;
+    uint32_t indexCapacity;
+    std::vector<ArenaRange> freeVertices;  // 按 first 升序，相邻的区间已合并
+    std::vector<ArenaRange> freeIndices;
+    std::unordered_map<ArenaMeshHandle, ArenaMesh> meshes;
+    ArenaMeshHandle nextHandle;
+    uint32_t compactions;
+    uint32_t grows;
+    uint32_t generation;  // VAO/VBO/EBO 重建的次数
+};
+
+struct MeshArenaSet {
+    std::vector<MeshArena*> arenas;
+};
+
+// 最佳适配：从能放下的最小空闲区间的开头切出 count 个
+static bool allocateRange(std::vector<ArenaRange>* freeList, uint32_t count, uint32_t* first) {
+    size_t best = freeList->size();
+    for (size_t i = 0; i < freeList->size(); i++) {
+        uint32_t available = (*freeList)[i].count;
+        if (available >= count && (best == freeList->size() || available < (*freeList)[best].count)) {
+            best = i;
+        }
+    }
+    if (best == freeList->size()) {
+        return false;
+    }
+    ArenaRange& range = (*freeList)[best];
+    *first = range.first;
+    range.first += count;
+    range.count -= count;
+    if (range.count == 0) {
+        freeList->erase(freeList->begin() + best);
+    }
+    return true;
+}
+
+// 按位置插回空闲表，并与前后相邻的区间合并
+static void freeRange(std::vector<ArenaRange>* freeList, ArenaRange range) {
+    std::vector<ArenaRange>::iterator it = freeList->begin();
+    while (it != freeList->end() && it->first < range.first) {
+        ++it;
+    }
+    it = freeList->insert(it, range);
+    if (it + 1 != freeList->end() && it->first + it->count == (it + 1)->first) {
+        it->count += (it + 1)->count;
+        freeList->erase(it + 1);
+    }
+    if (it != freeList->begin() && (it - 1)->first + (it - 1)->count == it->first) {
+        (it - 1)->count += it->count;
+        freeList->erase(it);
+    }
+}
+
+static uint32_t freeTotal(const std::vector<ArenaRange>& freeList, uint32_t* largest) {
+    uint32_t total = 0;
+    *largest = 0;
+    for (size_t i = 0; i < freeList.size(); i++) {
+        total += freeList[i].count;
+        *largest = std::max(*largest, freeList[i].count);
+    }
+    return total;
+}
+
+static size_t arenaIndexSize(const MeshArena* arena) {
+    return arena->indexType == GL_UNSIGNED_SHORT ? sizeof(uint16_t) : sizeof(uint32_t);
+}
+
+// 分配空的 VAO/VBO/EBO 并设置顶点属性，之后的上传都经过 GL_COPY_WRITE_BUFFER，不改变 VAO 状态
+static void createArenaBuffers(MeshArena* arena, uint32_t vertexCapacity, uint32_t indexCapacity) {
+    arena->vertexCapacity = vertexCapacity;
+    arena->indexCapacity = indexCapacity;
+    arena->indexType = vertexCapacity <= 65536 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+    glGenVertexArrays(1, &arena->vao);
+    glGenBuffers(1, &arena->vbo);
+    glGenBuffers(1, &arena->ebo);
+    cachedBindVertexArray(arena->vao);
+    cachedBindBuffer(GL_ARRAY_BUFFER, arena->vbo);
+    glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)vertexCapacity * arena->stride, nullptr, GL_STATIC_DRAW);
+    setVertexAttributes(arena->attributes.data(), (int)arena->attributes.size(), arena->stride);
+    cachedBindBuffer(GL_ELEMENT_ARRAY_BUFFER, arena->ebo);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, (GLsizeiptr)(indexCapacity * arenaIndexSize(arena)), nullptr,
+                 GL_STATIC_DRAW);
+    cachedBindBuffer(GL_ARRAY_BUFFER, 0);
+    cachedBindVertexArray(0);
+    logGLError(LOG_TAG, "createMeshArena");
+}
+
+static void deleteArenaBuffers(MeshArena* arena) {
+    cachedDeleteVertexArrays(1, &arena->vao);
+    cachedDeleteBuffers(1, &arena->vbo);
+    cachedDeleteBuffers(1, &arena->ebo);
+    arena->vao = 0;
+    arena->vbo = 0;
+    arena->ebo = 0;
+}
+
+// 索引加上网格的起始顶点后按 EBO 的类型追加到 data
+static void appendArenaIndices(const MeshArena* arena, const ArenaMesh& mesh, std::vector<unsigned char>* data) {
+    size_t indexSize = arenaIndexSize(arena);
+    size_t offset = data->size();
+    data->resize(offset + mesh.localIndices.size() * indexSize);
+    for (size_t i = 0; i < mesh.localIndices.size(); i++) {
+        uint32_t index = mesh.localIndices[i] + mesh.vertices.first;
+        if (indexSize == sizeof(uint16_t)) {
+            uint16_t narrow = (uint16_t)index;
+            memcpy(&(*data)[offset + i * indexSize], &narrow, indexSize);
+        } else {
+            memcpy(&(*data)[offset + i * indexSize], &index, indexSize);
+        }
+    }
+}
+
+// 按当前位置的顺序把网格紧密排到新缓冲的开头：顶点在 GPU 上复制（相邻的连续区间合并成一次复制），
+// 索引按新的起始顶点重写后一次上传
+static void rebuildMeshArena(MeshArena* arena, uint32_t vertexCapacity, uint32_t indexCapacity) {
+    std::vector<ArenaMesh*> order;
+    order.reserve(arena->meshes.size());
+    for (std::unordered_map<ArenaMeshHandle, ArenaMesh>::iterator it = arena->meshes.begin();
+         it != arena->meshes.end(); ++it) {
+        order.push_back(&it->second);
+    }
+    std::sort(order.begin(), order.end(), [](const ArenaMesh* a, const ArenaMesh* b) {
+        return a->vertices.first < b->vertices.first;
+    });
+
+    GLuint oldVao = arena->vao;
+    GLuint oldVbo = arena->vbo;
+    GLuint oldEbo = arena->ebo;
+    createArenaBuffers(arena, vertexCapacity, indexCapacity);
+    cachedBindBuffer(GL_COPY_READ_BUFFER, oldVbo);
+    cachedBindBuffer(GL_COPY_WRITE_BUFFER, arena->vbo);
+    uint32_t nextVertex = 0;
+    uint32_t nextIndex = 0;
+    uint32_t copyFrom = 0;
+    uint32_t copyTo = 0;
+    uint32_t copyCount = 0;
+    GLsizeiptr stride = arena->stride;
+    for (size_t i = 0; i < order.size(); i++) {
+        ArenaMesh* mesh = order[i];
+        if (copyCount > 0 && copyFrom + copyCount != mesh->vertices.first) {
+            glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, copyFrom * stride, copyTo * stride,
+                                copyCount * stride);
+            copyCount = 0;
+        }
+        if (copyCount == 0) {
+            copyFrom = mesh->vertices.first;
+            copyTo = nextVertex;
+        }
+        copyCount += mesh->vertices.count;
+        mesh->vertices.first = nextVertex;
+        mesh->indices.first = nextIndex;
+        nextVertex += mesh->vertices.count;
+        nextIndex += mesh->indices.count;
+    }
+    if (copyCount > 0) {
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, copyFrom * stride, copyTo * stride,
+                            copyCount * stride);
+    }
+
+    std::vector<unsigned char> indexData;
+    indexData.reserve(nextIndex * arenaIndexSize(arena));
+    for (size_t i = 0; i < order.size(); i++) {
+        appendArenaIndices(arena, *order[i], &indexData);
+    }
+    if (!indexData.empty()) {
+        cachedBindBuffer(GL_COPY_WRITE_BUFFER, arena->ebo);
+        glBufferSubData(GL_COPY_WRITE_BUFFER, 0, (GLsizeiptr)indexData.size(), indexData.data());
+    }
+    cachedDeleteVertexArrays(1, &oldVao);
+    cachedDeleteBuffers(1, &oldVbo);
+    cachedDeleteBuffers(1, &oldEbo);
+    arena->generation++;
+
+    arena->freeVertices.clear();
+    arena->freeIndices.clear();
+    if (nextVertex < vertexCapacity) {
+        ArenaRange range = {nextVertex, vertexCapacity - nextVertex};
+        arena->freeVertices.push_back(range);
+    }
+    if (nextIndex < indexCapacity) {
+        ArenaRange range = {nextIndex, indexCapacity - nextIndex};
+        arena->freeIndices.push_back(range);
+    }
+    logGLError(LOG_TAG, "rebuildMeshArena");
+}
+
+MeshArena* createMeshArena(const MeshAttribute* attributes, int attributeCount, GLsizei stride,
+                           uint32_t vertexCapacity, uint32_t indexCapacity) {
+    if (attributeCount <= 0 || stride <= 0 || vertexCapacity == 0 || indexCapacity == 0) {
+        LOGE("Invalid mesh arena layout or capacity");
+        return nullptr;
+    }
+    MeshArena* arena = new MeshArena();
+    arena->attributes.assign(attributes, attributes + attributeCount);
+    arena->stride = stride;
+    arena->nextHandle = 1;
+    arena->compactions = 0;
+    arena->grows = 0;
+    arena->generation = 0;
+    createArenaBuffers(arena, vertexCapacity, indexCapacity);
+    ArenaRange vertices = {0, vertexCapacity};
+    ArenaRange indices = {0, indexCapacity};
+    arena->freeVertices.push_back(vertices);
+    arena->freeIndices.push_back(indices);
+    LOGI("Created mesh arena: %u vertices of %d bytes, %u indices", vertexCapacity, stride, indexCapacity);
+    return arena;
+}
+
+void destroyMeshArena(MeshArena* arena) {
+    if (arena == nullptr) return;
+    deleteArenaBuffers(arena);
+    delete arena;
+}
+
+MeshArenaSet* createMeshArenaSet() {
+    return new MeshArenaSet();
+}
+
+void destroyMeshArenaSet(MeshArenaSet* set) {
+    if (set == nullptr) return;
+    for (size_t i = 0; i < set->arenas.size(); i++) {
+        destroyMeshArena(set->arenas[i]);
+    }
+    delete set;
+}
+
+void abandonMeshArenaSet(MeshArenaSet* set) {
+    if (set == nullptr) return;
+    for (size_t i = 0; i < set->arenas.size(); i++) {
+        delete set->arenas[i];
+    }
+    delete set;
+}
+
+MeshArena* meshArenaForLayout(MeshArenaSet* set, const MeshAttribute* attributes, int attributeCount, GLsizei stride) {
+    for (size_t i = 0; i < set->arenas.size(); i++) {
+        MeshArena* arena = set->arenas[i];
+        if (arena->stride == stride && (int)arena->attributes.size() == attributeCount &&
+            memcmp(arena->attributes.data(), attributes, sizeof(MeshAttribute) * attributeCount) == 0) {
+            return arena;
+        }
+    }
+    MeshArena* arena = createMeshArena(attributes, attributeCount, stride, MESH_ARENA_DEFAULT_VERTICES,
+                                       MESH_ARENA_DEFAULT_INDICES);
+    if (arena != nullptr) {
+        set->arenas.push_back(arena);
+    }
+    return arena;
+}
+
+// 先在空闲表中找；找不到时空闲总量够就整理，不够就翻倍扩容，重建后空闲空间连成一块，一定放得下
+static void reserveArenaSpace(MeshArena* arena, uint32_t vertexCount, uint32_t indexCount, uint32_t* firstVertex,
+                              uint32_t* firstIndex) {
+    if (allocateRange(&arena->freeVertices, vertexCount, firstVertex)) {
+        if (allocateRange(&arena->freeIndices, indexCount, firstIndex)) {
+            return;
+        }
+        ArenaRange range = {*firstVertex, vertexCount};
+        freeRange(&arena->freeVertices, range);
+    }
+    uint32_t largest;
+    uint32_t freeVertices = freeTotal(arena->freeVertices, &largest);
+    uint32_t freeIndices = freeTotal(arena->freeIndices, &largest);
+    if (freeVertices >= vertexCount && freeIndices >= indexCount) {
+        compactMeshArena(arena);
+    } else {
+        uint32_t usedVertices = arena->vertexCapacity - freeVertices;
+        uint32_t usedIndices = arena->indexCapacity - freeIndices;
+        uint32_t vertexCapacity = arena->vertexCapacity;
+        uint32_t indexCapacity = arena->indexCapacity;
+        while (vertexCapacity - usedVertices < vertexCount) {
+            vertexCapacity *= 2;
+        }
+        while (indexCapacity - usedIndices < indexCount) {
+            indexCapacity *= 2;
+        }
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        rebuildMeshArena(arena, vertexCapacity, indexCapacity);
+        arena->grows++;
+        LOGI("Grew mesh arena to %u vertices, %u indices in %.2f ms", vertexCapacity, indexCapacity,
+             std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+    }
+    allocateRange(&arena->freeVertices, vertexCount, firstVertex);
+    allocateRange(&arena->freeIndices, indexCount, firstIndex);
+}
+
+ArenaMeshHandle arenaAddMesh(MeshArena* arena, const void* vertices, uint32_t vertexCount, const uint32_t* indices,
+                             uint32_t indexCount) {
+    if (arena == nullptr || vertexCount == 0 || indexCount == 0) {
+        return 0;
+    }
+    if (*std::max_element(indices, indices + indexCount) >= vertexCount) {
+        LOGE("Mesh index out of range (%u vertices)", vertexCount);
+        return 0;
+    }
+    ArenaMesh mesh;
+    reserveArenaSpace(arena, vertexCount, indexCount, &mesh.vertices.first, &mesh.indices.first);
+    mesh.vertices.count = vertexCount;
+    mesh.indices.count = indexCount;
+    mesh.localIndices.assign(indices, indices + indexCount);
+
+    GLsizeiptr stride = arena->stride;
+    cachedBindBuffer(GL_COPY_WRITE_BUFFER, arena->vbo);
+    glBufferSubData(GL_COPY_WRITE_BUFFER, mesh.vertices.first * stride, vertexCount * stride, vertices);
+    std::vector<unsigned char> indexData;
+    appendArenaIndices(arena, mesh, &indexData);
+    cachedBindBuffer(GL_COPY_WRITE_BUFFER, arena->ebo);
+    glBufferSubData(GL_COPY_WRITE_BUFFER, (GLintptr)(mesh.indices.first * arenaIndexSize(arena)),
+                    (GLsizeiptr)indexData.size(), indexData.data());
+    logGLError(LOG_TAG, "arenaAddMesh");
+
+    ArenaMeshHandle handle = arena->nextHandle++;
+    if (arena->nextHandle == 0) {
+        arena->nextHandle = 1;
+    }
+    std::swap(arena->meshes[handle], mesh);
+    return handle;
+}
+
+void arenaRemoveMesh(MeshArena* arena, ArenaMeshHandle handle) {
+    std::unordered_map<ArenaMeshHandle, ArenaMesh>::iterator it = arena->meshes.find(handle);
+    if (it == arena->meshes.end()) {
+        return;
+    }
+    freeRange(&arena->freeVertices, it->second.vertices);
+    freeRange(&arena->freeIndices, it->second.indices);
+    arena->meshes.erase(it);
+}
+
+void bindMeshArena(const MeshArena* arena) {
+    cachedBindVertexArray(arena->vao);
+}
+
+void drawArenaMesh(const MeshArena* arena, ArenaMeshHandle handle) {
+    std::unordered_map<ArenaMeshHandle, ArenaMesh>::const_iterator it = arena->meshes.find(handle);
+    if (it == arena->meshes.end()) {
+        return;
+    }
+    const ArenaRange& indices = it->second.indices;
+    glDrawElements(GL_TRIANGLES, (GLsizei)indices.count, arena->indexType,
+                   (const void*)(uintptr_t)(indices.first * arenaIndexSize(arena)));
+}
+
+bool getArenaMeshRange(const MeshArena* arena, ArenaMeshHandle handle, MeshData* mesh, uint32_t* firstIndex) {
+    std::unordered_map<ArenaMeshHandle, ArenaMesh>::const_iterator it = arena->meshes.find(handle);
+    if (it == arena->meshes.end()) {
+        return false;
+    }
+    mesh->vao = arena->vao;
+    mesh->vbo = arena->vbo;
+    mesh->ebo = arena->ebo;
+    mesh->indexCount = (GLsizei)it->second.indices.count;
+    mesh->indexType = arena->indexType;
+    *firstIndex = it->second.indices.first;
+    return true;
+}
+
+uint32_t meshArenaGeneration(const MeshArena* arena) {
+    return arena->generation;
+}
+
+void compactMeshArena(MeshArena* arena) {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    MeshArenaStats before;
+    getMeshArenaStats(arena, &before);
+    rebuildMeshArena(arena, arena->vertexCapacity, arena->indexCapacity);
+    arena->compactions++;
+    LOGI("Compacted mesh arena: %u meshes, fragmentation %.2f/%.2f (vertices/indices) -> 0 in %.2f ms",
+         before.meshes, before.vertexFragmentation, before.indexFragmentation,
+         std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+}
+
+void getMeshArenaStats(const MeshArena* arena, MeshArenaStats* stats) {
+    uint32_t largestVertices;
+    uint32_t largestIndices;
+    uint32_t freeVertices = freeTotal(arena->freeVertices, &largestVertices);
+    uint32_t freeIndices = freeTotal(arena->freeIndices, &largestIndices);
+    stats->vertexCapacity = arena->vertexCapacity;
+    stats->vertexUsed = arena->vertexCapacity - freeVertices;
+    stats->indexCapacity = arena->indexCapacity;
+    stats->indexUsed = arena->indexCapacity - freeIndices;
+    stats->meshes = (uint32_t)arena->meshes.size();
+    stats->freeVertexBlocks = (uint32_t)arena->freeVertices.size();
+    stats->freeIndexBlocks = (uint32_t)arena->freeIndices.size();
+    stats->vertexFragmentation = freeVertices > 0 ? 1.0f - (float)largestVertices / freeVertices : 0.0f;
+    stats->indexFragmentation = freeIndices > 0 ? 1.0f - (float)largestIndices / freeIndices : 0.0f;
+    stats->compactions = arena->compactions;
+    stats->grows = arena->grows;
+}
+
 // 创建 Uniform Buffer Object
+// 程序已在注册表中登记时直接使用反射结果，绑定会被记录，重新链接后自动恢复
 UniformBuffer createUniformBuffer(GLuint program, const char* blockName, GLuint bindingPoint) {
     UniformBuffer ubo = {0, bindingPoint, 0};
 
-    GLuint blockIndex = glGetUniformBlockIndex(program, blockName);
-    if (blockIndex == GL_INVALID_INDEX) {
+    BlockHandle block = uniformBlockHandle(blockName);
+    // 绑定到绑定点
+    if (!bindProgramUniformBlock(program, block, bindingPoint)) {
         LOGE("Uniform block '%s' not found in shader", blockName);
         return ubo;
     }
 
-    // 绑定到绑定点
-    glUniformBlockBinding(program, blockIndex, bindingPoint);
-
     // 获取块大小
-    GLint blockSize = 0;
-    glGetActiveUniformBlockiv(program, blockIndex, GL_UNIFORM_BLOCK_DATA_SIZE, &blockSize);
+    GLint blockSize = programUniformBlockSize(program, block);
+    if (blockSize < 0) {
+        GLuint blockIndex = glGetUniformBlockIndex(program, blockName);
+        glGetActiveUniformBlockiv(program, blockIndex, GL_UNIFORM_BLOCK_DATA_SIZE, &blockSize);
+    }
 
     if (blockSize > 0) {
         glGenBuffers(1, &ubo.ubo);
-        glBindBuffer(GL_UNIFORM_BUFFER, ubo.ubo);
+        cachedBindBuffer(GL_UNIFORM_BUFFER, ubo.ubo);
         glBufferData(GL_UNIFORM_BUFFER, blockSize, nullptr, GL_DYNAMIC_DRAW);
-        glBindBufferBase(GL_UNIFORM_BUFFER, bindingPoint, ubo.ubo);
-        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+        cachedBindBufferBase(GL_UNIFORM_BUFFER, bindingPoint, ubo.ubo);
+        cachedBindBuffer(GL_UNIFORM_BUFFER, 0);
         ubo.size = blockSize;
+        logGLError(LOG_TAG, blockName);
     }
 
     return ubo;
@@ -259,9 +911,9 @@ void updateUniformBuffer(UniformBuffer* ubo, const void* data, size_t offset, si
         return;
     }
 
-    glBindBuffer(GL_UNIFORM_BUFFER, ubo->ubo);
+    // 不再解绑：连续更新同一个 UBO 时重复的绑定由状态缓存丢弃
+    cachedBindBuffer(GL_UNIFORM_BUFFER, ubo->ubo);
     glBufferSubData(GL_UNIFORM_BUFFER, offset, size, data);
-    glBindBuffer(GL_UNIFORM_BUFFER, 0);
 }
 
 // 释放 Uniform Buffer Object
@@ -269,17 +921,304 @@ void releaseUniformBuffer(UniformBuffer* ubo) {
     if (ubo == nullptr) return;
 
     if (ubo->ubo != 0) {
-        glDeleteBuffers(1, &ubo->ubo);
+        cachedDeleteBuffers(1, &ubo->ubo);
         ubo->ubo = 0;
     }
     ubo->size = 0;
 }
 
-// 记录 OpenGL 错误
-void logGLError(const char* tag, const char* operation) {
-    GLenum error = glGetError();
-    if (error != GL_NO_ERROR) {
-        LOGE("[%s] %s failed with error: 0x%x", tag, operation, error);
+
+// ==================== GL 状态缓存 ====================
+
+static const GLuint UNKNOWN_NAME = 0xFFFFFFFFu;  // 未知状态，下一次调用一定下发
+static const int MAX_CACHED_TEXTURE_UNITS = 16;
+
+// 缓存的缓冲区目标
+static const GLenum CACHED_BUFFER_TARGETS[] = {
+    GL_ARRAY_BUFFER, GL_ELEMENT_ARRAY_BUFFER, GL_UNIFORM_BUFFER, GL_TRANSFORM_FEEDBACK_BUFFER,
+    GL_PIXEL_PACK_BUFFER, GL_PIXEL_UNPACK_BUFFER, GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER
+};
+static const int BUFFER_TARGET_COUNT = sizeof(CACHED_BUFFER_TARGETS) / sizeof(CACHED_BUFFER_TARGETS[0]);
+
+static const GLenum CACHED_TEXTURE_TARGETS[] = {
+    GL_TEXTURE_2D, GL_TEXTURE_2D_ARRAY, GL_TEXTURE_3D, GL_TEXTURE_CUBE_MAP
+};
+static const int TEXTURE_TARGET_COUNT = sizeof(CACHED_TEXTURE_TARGETS) / sizeof(CACHED_TEXTURE_TARGETS[0]);
+
+static const GLenum CACHED_CAPS[] = {
+    GL_BLEND, GL_DEPTH_TEST, GL_CULL_FACE, GL_SCISSOR_TEST, GL_STENCIL_TEST, GL_RASTERIZER_DISCARD
+};
+static const int CAP_COUNT = sizeof(CACHED_CAPS) / sizeof(CACHED_CAPS[0]);
+
+enum { CAP_UNKNOWN = -1, CAP_DISABLED = 0, CAP_ENABLED = 1 };
+
+struct GLStateCache {
+    GLuint program;
+    GLuint vao;
+    GLuint buffers[BUFFER_TARGET_COUNT];
+    GLenum activeUnit;      // GL_TEXTURE0 + n，0 表示未知
+    GLuint textures[MAX_CACHED_TEXTURE_UNITS][TEXTURE_TARGET_COUNT];
+    int caps[CAP_COUNT];
+    GLenum blendSrc;
+    GLenum blendDst;
+    GLint viewport[4];
+    bool viewportValid;
+    GLStateCacheStats stats;
+};
+
+static thread_local GLStateCache gStateCache;
+static thread_local bool gStateCacheReady = false;
+
+static void resetStateCache(GLStateCache* cache) {
+    cache->program = UNKNOWN_NAME;
+    cache->vao = UNKNOWN_NAME;
+    for (int i = 0; i < BUFFER_TARGET_COUNT; i++) {
+        cache->buffers[i] = UNKNOWN_NAME;
+    }
+    cache->activeUnit = 0;
+    for (int unit = 0; unit < MAX_CACHED_TEXTURE_UNITS; unit++) {
+        for (int i = 0; i < TEXTURE_TARGET_COUNT; i++) {
+            cache->textures[unit][i] = UNKNOWN_NAME;
+        }
+    }
+    for (int i = 0; i < CAP_COUNT; i++) {
+        cache->caps[i] = CAP_UNKNOWN;
+    }
+    cache->blendSrc = 0;
+    cache->blendDst = 0;
+    cache->viewportValid = false;
+}
+
+static GLStateCache* stateCache() {
+    if (!gStateCacheReady) {
+        resetStateCache(&gStateCache);
+        gStateCache.stats.issued = 0;
+        gStateCache.stats.elided = 0;
+        gStateCacheReady = true;
+    }
+    return &gStateCache;
+}
+
+// 记一次调用，返回是否需要下发
+static bool countCall(GLStateCache* cache, bool changed) {
+    if (changed) {
+        cache->stats.issued++;
+    } else {
+        cache->stats.elided++;
+    }
+    return changed;
+}
+
+static int bufferTargetIndex(GLenum target) {
+    for (int i = 0; i < BUFFER_TARGET_COUNT; i++) {
+        if (CACHED_BUFFER_TARGETS[i] == target) return i;
+    }
+    return -1;
+}
+
+static int textureTargetIndex(GLenum target) {
+    for (int i = 0; i < TEXTURE_TARGET_COUNT; i++) {
+        if (CACHED_TEXTURE_TARGETS[i] == target) return i;
     }
+    return -1;
 }
 
+static int capIndex(GLenum cap) {
+    for (int i = 0; i < CAP_COUNT; i++) {
+        if (CACHED_CAPS[i] == cap) return i;
+    }
+    return -1;
+}
+
+void invalidateGLStateCache() {
+    resetStateCache(stateCache());
+}
+
+void cachedUseProgram(GLuint program) {
+    GLStateCache* cache = stateCache();
+    if (countCall(cache, cache->program != program)) {
+        glUseProgram(program);
+        cache->program = program;
+    }
+}
+
+void cachedBindVertexArray(GLuint vao) {
+    GLStateCache* cache = stateCache();
+    if (countCall(cache, cache->vao != vao)) {
+        glBindVertexArray(vao);
+        cache->vao = vao;
+        // EBO 绑定属于 VAO，切换后不再知道当前值
+        cache->buffers[bufferTargetIndex(GL_ELEMENT_ARRAY_BUFFER)] = UNKNOWN_NAME;
+    }
+}
+
+void cachedBindBuffer(GLenum target, GLuint buffer) {
+    GLStateCache* cache = stateCache();
+    int index = bufferTargetIndex(target);
+    if (index < 0) {
+        countCall(cache, true);
+        glBindBuffer(target, buffer);
+        return;
+    }
+    if (countCall(cache, cache->buffers[index] != buffer)) {
+        glBindBuffer(target, buffer);
+        cache->buffers[index] = buffer;
+    }
+}
+
+void cachedBindBufferBase(GLenum target, GLuint index, GLuint buffer) {
+    GLStateCache* cache = stateCache();
+    countCall(cache, true);
+    glBindBufferBase(target, index, buffer);
+    int targetIndex = bufferTargetIndex(target);
+    if (targetIndex >= 0) {
+        cache->buffers[targetIndex] = buffer;
+    }
+}
+
+void cachedBindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size) {
+    GLStateCache* cache = stateCache();
+    countCall(cache, true);
+    glBindBufferRange(target, index, buffer, offset, size);
+    int targetIndex = bufferTargetIndex(target);
+    if (targetIndex >= 0) {
+        cache->buffers[targetIndex] = buffer;
+    }
+}
+
+void cachedActiveTexture(GLenum unit) {
+    GLStateCache* cache = stateCache();
+    if (countCall(cache, cache->activeUnit != unit)) {
+        glActiveTexture(unit);
+        cache->activeUnit = unit;
+    }
+}
+
+void cachedBindTexture(GLenum target, GLuint texture) {
+    GLStateCache* cache = stateCache();
+    int targetIndex = textureTargetIndex(target);
+    int unit = cache->activeUnit == 0 ? -1 : (int)(cache->activeUnit - GL_TEXTURE0);
+    if (targetIndex < 0 || unit < 0 || unit >= MAX_CACHED_TEXTURE_UNITS) {
+        countCall(cache, true);
+        glBindTexture(target, texture);
+        return;
+    }
+    if (countCall(cache, cache->textures[unit][targetIndex] != texture)) {
+        glBindTexture(target, texture);
+        cache->textures[unit][targetIndex] = texture;
+    }
+}
+
+static void setCap(GLenum cap, bool enabled) {
+    GLStateCache* cache = stateCache();
+    int index = capIndex(cap);
+    int state = enabled ? CAP_ENABLED : CAP_DISABLED;
+    if (index >= 0 && !countCall(cache, cache->caps[index] != state)) {
+        return;
+    }
+    if (index < 0) {
+        countCall(cache, true);
+    } else {
+        cache->caps[index] = state;
+    }
+    if (enabled) {
+        glEnable(cap);
+    } else {
+        glDisable(cap);
+    }
+}
+
+void cachedEnable(GLenum cap) {
+    setCap(cap, true);
+}
+
+void cachedDisable(GLenum cap) {
+    setCap(cap, false);
+}
+
+void cachedBlendFunc(GLenum sfactor, GLenum dfactor) {
+    GLStateCache* cache = stateCache();
+    if (countCall(cache, cache->blendSrc != sfactor || cache->blendDst != dfactor)) {
+        glBlendFunc(sfactor, dfactor);
+        cache->blendSrc = sfactor;
+        cache->blendDst = dfactor;
+    }
+}
+
+void cachedViewport(GLint x, GLint y, GLsizei width, GLsizei height) {
+    GLStateCache* cache = stateCache();
+    bool changed = !cache->viewportValid || cache->viewport[0] != x || cache->viewport[1] != y
+                   || cache->viewport[2] != width || cache->viewport[3] != height;
+    if (countCall(cache, changed)) {
+        glViewport(x, y, width, height);
+        cache->viewport[0] = x;
+        cache->viewport[1] = y;
+        cache->viewport[2] = width;
+        cache->viewport[3] = height;
+        cache->viewportValid = true;
+    }
+}
+
+// 删除已绑定的对象时 GL 会把对应绑定重置为 0
+void cachedDeleteBuffers(GLsizei count, const GLuint* buffers) {
+    GLStateCache* cache = stateCache();
+    for (GLsizei n = 0; n < count; n++) {
+        for (int i = 0; i < BUFFER_TARGET_COUNT; i++) {
+            if (buffers[n] != 0 && cache->buffers[i] == buffers[n]) {
+                cache->buffers[i] = 0;
+            }
+        }
+    }
+    glDeleteBuffers(count, buffers);
+}
+
+void cachedDeleteVertexArrays(GLsizei count, const GLuint* vaos) {
+    GLStateCache* cache = stateCache();
+    for (GLsizei n = 0; n < count; n++) {
+        if (vaos[n] != 0 && cache->vao == vaos[n]) {
+            cache->vao = 0;
+            cache->buffers[bufferTargetIndex(GL_ELEMENT_ARRAY_BUFFER)] = UNKNOWN_NAME;
+        }
+    }
+    glDeleteVertexArrays(count, vaos);
+}
+
+void cachedDeleteTextures(GLsizei count, const GLuint* textures) {
+    GLStateCache* cache = stateCache();
+    for (GLsizei n = 0; n < count; n++) {
+        for (int unit = 0; unit < MAX_CACHED_TEXTURE_UNITS; unit++) {
+            for (int i = 0; i < TEXTURE_TARGET_COUNT; i++) {
+                if (textures[n] != 0 && cache->textures[unit][i] == textures[n]) {
+                    cache->textures[unit][i] = 0;
+                }
+            }
+        }
+    }
+    glDeleteTextures(count, textures);
+}
+
+// 正在使用的程序被删除时只是标记删除，名字不会被复用，但之后的 glUseProgram 需要真正下发
+void cachedDeleteProgram(GLuint program) {
+    GLStateCache* cache = stateCache();
+    if (program != 0 && cache->program == program) {
+        cache->program = UNKNOWN_NAME;
+    }
+    glDeleteProgram(program);
+}
+
+GLStateCacheStats getGLStateCacheStats() {
+    return stateCache()->stats;
+}
+
+void resetGLStateCacheStats() {
+    GLStateCache* cache = stateCache();
+    cache->stats.issued = 0;
+    cache->stats.elided = 0;
+}
+
+void logGLStateCacheStats(const char* tag) {
+    GLStateCacheStats stats = getGLStateCacheStats();
+    uint32_t total = stats.issued + stats.elided;
+    LOGI("[%s] GL state cache: %u issued, %u elided (%.1f%% of %u state calls)", tag,
+         stats.issued, stats.elided, total > 0 ? stats.elided * 100.0f / total : 0.0f, total);
+}
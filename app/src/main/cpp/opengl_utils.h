@@ -7,18 +7,32 @@
 #define NDKLEARN2_OPENGL_UTILS_H
 
 #include <GLES3/gl3.h>
+#include "gl_check.h"
+#include "texture_loader.h"
+#include "mesh_container.h"
+#ifdef __ANDROID__
 #include <jni.h>
+#endif
 #include <string>
+#include <stdint.h>
 #ifdef __cplusplus
 extern "C" {
 #endif
 
 // 着色器编译
 GLuint compileShader(GLenum type, const char* source);
+// 创建着色器程序（经过程序二进制缓存，见 program_cache.h）
 GLuint createProgram(const char* vertexShaderSource, const char* fragmentShaderSource);
+// 从源码完整编译并链接（不经过缓存）
+// tfbVaryings 非空时在链接前设置 Transform Feedback 捕获变量，避免链接后再重新链接
+// retrievable 为 true 时设置 GL_PROGRAM_BINARY_RETRIEVABLE_HINT，供缓存读取二进制
+GLuint compileAndLinkProgram(const char* vertexShaderSource, const char* fragmentShaderSource,
+                             const char* const* tfbVaryings, GLsizei tfbVaryingCount,
+                             GLenum tfbBufferMode, bool retrievable);
 
-// 纹理管理
-GLuint loadTextureFromBitmap(JNIEnv* env, jobject bitmap);
+// 纹理管理（返回 TextureFuture 的异步加载接口在文件末尾的 C++ 部分）
+// 当前上下文能否采样该压缩格式：ETC2/EAC 是 ES 3.0 核心格式，ASTC 需要 GL_KHR_texture_compression_astc_ldr
+bool isCompressedFormatSupported(GLenum internalFormat);
 void releaseTexture(GLuint textureID);
 
 // VAO/VBO/EBO 管理
@@ -27,13 +41,104 @@ typedef struct {
     GLuint vbo;
     GLuint ebo;
     GLsizei indexCount;
+    GLenum indexType;    // glDrawElements 的 type
 } MeshData;
 
+// 全部属性为 GL_FLOAT：每个顶点 vertexSize 个 float，attribSizes 依次为各属性的分量数。
+// 打包格式（半精度、2_10_10_10、整数属性）用 vertex_layout.h 的 createMesh<Layout>
 MeshData createMesh(const float* vertices, size_t vertexCount, size_t vertexSize,
                     const unsigned int* indices, size_t indexCount,
                     const int* attribSizes, size_t attribCount);
+// 创建 VAO 并上传顶点和索引（indices 可以为空，indexType 为 GL_UNSIGNED_SHORT / GL_UNSIGNED_INT），
+// 返回时 VAO 和 VBO 保持绑定，调用方设置顶点属性后调用 finishMeshBuffers 解绑。
+// 32 位索引的最大值不超过 65535 时缩窄为 16 位上传（索引缓冲减半），绘制时用 mesh.indexType
+MeshData createMeshBuffers(const void* vertices, size_t vertexBytes, const void* indices, GLenum indexType,
+                           size_t indexCount);
+void finishMeshBuffers();
+// 按属性表设置当前 VAO 的顶点属性（.mesh 文件中的布局）
+void setVertexAttributes(const MeshAttribute* attributes, int attributeCount, GLsizei stride);
+
+// .mesh 文件（mesh_container.h）创建的网格
+typedef struct {
+    MeshData mesh;
+    float boundsMin[3];
+    float boundsMax[3];
+    int submeshCount;
+    MeshSubmesh submeshes[MESH_MAX_SUBMESHES];
+    // 从网格池分配时非空：mesh 中的 GL 对象属于网格池，不能用 releaseMesh 释放，
+    // 绘制前用 getArenaMeshRange 取当前的 VAO 和索引位置
+    struct MeshArena* arena;
+    uint32_t arenaMesh;  // ArenaMeshHandle
+} MeshAsset;
+
+// createMeshFromFile 在文件末尾的 C++ 部分
+// 把文件映射到内存（mmap）后解析并上传，映射在返回前解除；文件不存在或无效时返回 false
+bool loadMeshFile(const char* path, MeshAsset* asset);
+#ifdef __ANDROID__
+// assets 中的 .mesh 文件：未压缩存放（build.gradle 的 noCompress）时 AAsset_getBuffer 直接映射 APK，同样不复制
+bool loadMeshFromAsset(JNIEnv* env, jobject assetManager, const char* path, MeshAsset* asset);
+#endif
 void releaseMesh(MeshData* mesh);
 
+// 网格池：同一顶点布局的网格共用一个 VAO/VBO/EBO，各自占用其中的一段顶点和一段索引，
+// 绑定一次 VAO 即可绘制池中的所有网格。ES 3.0 没有 glDrawElementsBaseVertex，
+// 上传时把索引加上网格的起始顶点；原始索引在 CPU 上保留一份，整理和扩容时据此重写 EBO。
+// 空间不够时先整理（网格移到缓冲开头，空闲空间合并成一块），空闲总量仍不够再把容量翻倍，
+// 两者都在新的 VAO/VBO/EBO 中重建（顶点用 glCopyBufferSubData 在 GPU 上复制），句柄保持有效
+struct MeshArena;
+
+// 0 为无效句柄
+typedef uint32_t ArenaMeshHandle;
+
+typedef struct {
+    uint32_t vertexCapacity;
+    uint32_t vertexUsed;
+    uint32_t indexCapacity;
+    uint32_t indexUsed;
+    uint32_t meshes;
+    uint32_t freeVertexBlocks;     // 空闲区间数，相邻的区间已合并
+    uint32_t freeIndexBlocks;
+    float vertexFragmentation;     // 1 - 最大空闲区间 / 空闲总量，0 表示空闲空间连成一块
+    float indexFragmentation;
+    uint32_t compactions;          // 累计整理次数（含手动调用）
+    uint32_t grows;                // 累计扩容次数
+} MeshArenaStats;
+
+// 属性表的 offset 相对于顶点开头（与 .mesh 文件相同）；顶点容量不超过 65536 时 EBO 用 16 位索引
+MeshArena* createMeshArena(const MeshAttribute* attributes, int attributeCount, GLsizei stride,
+                           uint32_t vertexCapacity, uint32_t indexCapacity);
+void destroyMeshArena(MeshArena* arena);
+// 按布局区分的一组网格池，GL 对象属于创建时的上下文：由使用它的渲染器创建，并在自己的 cleanup 中释放
+struct MeshArenaSet;
+MeshArenaSet* createMeshArenaSet();
+// 释放集合中的全部网格池和集合本身
+void destroyMeshArenaSet(MeshArenaSet* set);
+// 上下文已经销毁（GL 对象随之失效）时使用：只释放 CPU 上的记录，不调用 GL
+void abandonMeshArenaSet(MeshArenaSet* set);
+// 在集合中按布局查找网格池，没有时以默认容量创建；集合中的网格池只能由 destroyMeshArenaSet 释放
+MeshArena* meshArenaForLayout(MeshArenaSet* set, const MeshAttribute* attributes, int attributeCount, GLsizei stride);
+// createMeshFromFile（loadMeshFile / loadMeshFromAsset）把网格放进 set 中同一布局的网格池；
+// 默认为 nullptr，每个文件单独创建 VAO/VBO/EBO。释放 set 之前要先改回 nullptr
+void setMeshArenaSet(MeshArenaSet* set);
+MeshArenaSet* meshArenaSet();
+// 复制 vertexCount 个顶点（每个 stride 字节）和 indexCount 个索引（相对于这个网格的第一个顶点），
+// 索引越界时返回 0。可能触发整理或扩容，之后绘制前要重新调用 bindMeshArena
+ArenaMeshHandle arenaAddMesh(MeshArena* arena, const void* vertices, uint32_t vertexCount, const uint32_t* indices,
+                             uint32_t indexCount);
+void arenaRemoveMesh(MeshArena* arena, ArenaMeshHandle handle);
+// 绑定网格池的 VAO，之后用 drawArenaMesh 绘制其中的网格
+void bindMeshArena(const MeshArena* arena);
+void drawArenaMesh(const MeshArena* arena, ArenaMeshHandle handle);
+// 网格池当前的 VAO/VBO/EBO、索引类型和这个网格的索引数写入 mesh，网格第一个索引在 EBO 中的位置写入 firstIndex；
+// 整理或扩容后都会改变，每次绘制前重新获取。句柄无效时返回 false
+bool getArenaMeshRange(const MeshArena* arena, ArenaMeshHandle handle, MeshData* mesh, uint32_t* firstIndex);
+// 每次整理或扩容（重建 VAO/VBO/EBO）加一。新 VAO 可能复用旧 VAO 的名字，
+// 在 VAO 中额外设置了属性（例如实例属性）的调用方按这个计数判断是否需要重新设置
+uint32_t meshArenaGeneration(const MeshArena* arena);
+// 把网格依次移到缓冲开头，空闲空间合并到末尾
+void compactMeshArena(MeshArena* arena);
+void getMeshArenaStats(const MeshArena* arena, MeshArenaStats* stats);
+
 // UBO 管理
 typedef struct {
     GLuint ubo;
@@ -41,12 +146,48 @@ typedef struct {
     GLsizeiptr size;
 } UniformBuffer;
 
+// 程序已登记到注册表（shader_registry.h）时，块绑定会被记录，重新链接后自动恢复
 UniformBuffer createUniformBuffer(GLuint program, const char* blockName, GLuint bindingPoint);
 void updateUniformBuffer(UniformBuffer* ubo, const void* data, size_t offset, size_t size);
 void releaseUniformBuffer(UniformBuffer* ubo);
 
-// 辅助函数
-void logGLError(const char* tag, const char* operation);
+// 辅助函数：按 gl_check.h 的策略检查错误并归属到调用位置，release 构建中为空
+#define logGLError(tag, operation) GL_CHECK(tag, operation)
+
+// GL 状态缓存（影子状态）
+// 记录当前线程上下文中绑定的程序、VAO、各目标的缓冲区、纹理单元、开关状态和视口，
+// 与缓存相同的调用直接丢弃。状态按线程保存（每个线程只有一个当前上下文）。
+// 同一上下文中的状态修改都要经过这些函数；上下文重建或有代码直接调用 gl* 修改状态后
+// 必须调用 invalidateGLStateCache()
+typedef struct {
+    uint32_t issued;   // 实际发给驱动的调用
+    uint32_t elided;   // 与缓存相同而被丢弃的调用
+} GLStateCacheStats;
+
+void invalidateGLStateCache();
+void cachedUseProgram(GLuint program);
+// 切换 VAO 会同时改变 GL_ELEMENT_ARRAY_BUFFER 绑定（EBO 属于 VAO 状态）
+void cachedBindVertexArray(GLuint vao);
+void cachedBindBuffer(GLenum target, GLuint buffer);
+// 索引绑定总会下发，同时更新通用绑定点的缓存（glBindBufferBase 的副作用）
+void cachedBindBufferBase(GLenum target, GLuint index, GLuint buffer);
+// 同上，绑定缓冲区的一段（例如流式环形缓冲中的一段 uniform 数据）
+void cachedBindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size);
+void cachedActiveTexture(GLenum unit);
+void cachedBindTexture(GLenum target, GLuint texture);
+void cachedEnable(GLenum cap);
+void cachedDisable(GLenum cap);
+void cachedBlendFunc(GLenum sfactor, GLenum dfactor);
+void cachedViewport(GLint x, GLint y, GLsizei width, GLsizei height);
+// 删除对象时清掉缓存中的同名绑定，避免新对象复用名字后绑定被误丢弃
+void cachedDeleteBuffers(GLsizei count, const GLuint* buffers);
+void cachedDeleteVertexArrays(GLsizei count, const GLuint* vaos);
+void cachedDeleteTextures(GLsizei count, const GLuint* textures);
+void cachedDeleteProgram(GLuint program);
+
+GLStateCacheStats getGLStateCacheStats();
+void resetGLStateCacheStats();
+void logGLStateCacheStats(const char* tag);
 
 //其他数据结构
 typedef struct {
@@ -63,5 +204,25 @@ const float MAX_LIFE_TIME = 5.0f;
 }
 #endif
 
+// 以下接口的返回值或参数是 C++ 类型（TextureFuture 即 std::shared_future，MeshFile 以引用传入），
+// 不能声明为 C 链接
+
+#ifdef __ANDROID__
+// 复制 Bitmap 像素后交给纹理加载线程（texture_loader.h），失败时返回无效的 future。
+// RGBA_8888 / RGB_565 / A_8 / RGBA_F16 分别按 GL_RGBA8 / GL_RGB565 / GL_R8 / GL_RGBA16F 原样上传；
+// cachePath 非空时把生成的 mip 链写到该文件（见 requestCachedTextureAsync）
+TextureFuture loadTextureFromBitmapAsync(JNIEnv* env, jobject bitmap, const char* cachePath);
+// 读出 assets 中的 KTX/KTX2 文件后交给 loadKTXTextureAsync，文件不存在时返回无效的 future
+TextureFuture loadCompressedTextureFromAsset(JNIEnv* env, jobject assetManager, const char* path);
+#endif
+// 带 mip 链的 KTX/KTX2 文件（预先压缩，或加载器缓存的 RGBA8，见 ktx_container.h）：
+// 校验文件和设备支持后交给纹理加载线程，文件无效或格式不支持时返回无效的 future，调用方退回 Bitmap 上传
+TextureFuture loadKTXTextureAsync(const void* data, size_t size);
+// 从文件系统读出 KTX 文件（例如 requestCachedTextureAsync 写出的缓存）后同上，文件不存在时返回无效的 future
+TextureFuture loadTextureFileAsync(const char* path);
+
+// .mesh 文件已解析（mesh_container.h）时使用：顶点和索引直接从 file.vertices / file.indices 交给 glBufferData，不复制
+void createMeshFromFile(const MeshFile& file, MeshAsset* asset);
+
 #endif //NDKLEARN2_OPENGL_UTILS_H
 
@@ -0,0 +1,277 @@
+//
+// Created by zhangx on 2026/10/16.
+// 程序二进制缓存实现
+//
+
+#include "program_cache.h"
+#include "opengl_utils.h"
+#include "gl_trace.h"
+#ifdef __ANDROID__
+#include <jni.h>
+#endif
+#include <android/log.h>
+#include <sys/stat.h>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#define LOG_TAG "ProgramCache"
+#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
+#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
+
+// 缓存文件头，后面紧跟 binaryLength 字节的程序二进制
+struct ProgramBinaryHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t key;            // 与文件名相同的缓存键，防止文件被改名/碰撞
+    uint32_t binaryFormat;   // glGetProgramBinary 返回的格式
+    uint32_t binaryLength;
+    uint32_t checksum;       // 二进制数据的 FNV-1a 校验，检测截断或损坏
+    float compileMs;         // 未命中时完整编译+链接的耗时，命中时据此计算节省的时间
+};
+
+static const uint32_t PROGRAM_BINARY_MAGIC = 0x4E494250;  // "PBIN"
+static const uint32_t PROGRAM_BINARY_VERSION = 1;
+
+static std::mutex gCacheMutex;
+static std::string gCacheDir;
+static ProgramCacheStats gStats = {0, 0, 0, 0.0};
+
+// FNV-1a 64 位哈希
+static uint64_t fnv1a64(uint64_t hash, const void* data, size_t size) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+// 连同结尾的 '\0' 一起参与哈希，避免 "ab"+"c" 与 "a"+"bc" 得到相同的键
+static uint64_t hashString(uint64_t hash, const char* str) {
+    if (str == nullptr) {
+        str = "";
+    }
+    return fnv1a64(hash, str, strlen(str) + 1);
+}
+
+static double elapsedMs(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// 缓存键：着色器源码 + TFB 捕获变量 + 驱动信息（驱动升级后旧的二进制自然失效）
+static uint64_t computeProgramKey(const char* vertexShaderSource, const char* fragmentShaderSource,
+                                  const char* const* tfbVaryings, GLsizei tfbVaryingCount,
+                                  GLenum tfbBufferMode) {
+    uint64_t hash = 14695981039346656037ULL;
+    hash = hashString(hash, vertexShaderSource);
+    hash = hashString(hash, fragmentShaderSource);
+    for (GLsizei i = 0; i < tfbVaryingCount; i++) {
+        hash = hashString(hash, tfbVaryings[i]);
+    }
+    if (tfbVaryingCount > 0) {
+        hash = fnv1a64(hash, &tfbBufferMode, sizeof(tfbBufferMode));
+    }
+    hash = hashString(hash, (const char*)glGetString(GL_VENDOR));
+    hash = hashString(hash, (const char*)glGetString(GL_RENDERER));
+    hash = hashString(hash, (const char*)glGetString(GL_VERSION));
+    hash = hashString(hash, (const char*)glGetString(GL_SHADING_LANGUAGE_VERSION));
+    return hash;
+}
+
+static std::string entryPath(const std::string& dir, uint64_t key) {
+    char name[32];
+    snprintf(name, sizeof(name), "/%016llx.bin", (unsigned long long)key);
+    return dir + name;
+}
+
+// 读取缓存条目，任何不一致都视为未命中；文件存在但内容无效时 *exists 为 true
+static bool readEntry(const std::string& path, uint64_t key,
+                      ProgramBinaryHeader* header, std::vector<uint8_t>* binary, bool* exists) {
+    FILE* file = fopen(path.c_str(), "rb");
+    *exists = file != nullptr;
+    if (file == nullptr) {
+        return false;
+    }
+    bool ok = fread(header, sizeof(*header), 1, file) == 1
+              && header->magic == PROGRAM_BINARY_MAGIC
+              && header->version == PROGRAM_BINARY_VERSION
+              && header->key == key
+              && header->binaryLength > 0;
+    if (ok) {
+        binary->resize(header->binaryLength);
+        ok = fread(binary->data(), 1, binary->size(), file) == binary->size()
+             && (uint32_t)fnv1a64(14695981039346656037ULL, binary->data(), binary->size()) == header->checksum;
+    }
+    fclose(file);
+    return ok;
+}
+
+// 先写临时文件再 rename，保证进程被杀时不会留下半个条目
+static void writeEntry(const std::string& path, uint64_t key, GLuint program, float compileMs) {
+    GLint binaryLength = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &binaryLength);
+    if (binaryLength <= 0) {
+        LOGE("Driver returned empty program binary, not caching");
+        return;
+    }
+
+    std::vector<uint8_t> binary(binaryLength);
+    GLenum binaryFormat = 0;
+    GLsizei written = 0;
+    glGetProgramBinary(program, binaryLength, &written, &binaryFormat, binary.data());
+    if (written <= 0) {
+        LOGE("glGetProgramBinary failed, not caching");
+        return;
+    }
+
+    ProgramBinaryHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic = PROGRAM_BINARY_MAGIC;
+    header.version = PROGRAM_BINARY_VERSION;
+    header.key = key;
+    header.binaryFormat = binaryFormat;
+    header.binaryLength = (uint32_t)written;
+    header.checksum = (uint32_t)fnv1a64(14695981039346656037ULL, binary.data(), written);
+    header.compileMs = compileMs;
+
+    std::string tmpPath = path + ".tmp";
+    FILE* file = fopen(tmpPath.c_str(), "wb");
+    if (file == nullptr) {
+        LOGE("Failed to open %s for writing", tmpPath.c_str());
+        return;
+    }
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1
+              && fwrite(binary.data(), 1, written, file) == (size_t)written;
+    ok = (fclose(file) == 0) && ok;
+    if (!ok || rename(tmpPath.c_str(), path.c_str()) != 0) {
+        LOGE("Failed to write program cache entry %s", path.c_str());
+        remove(tmpPath.c_str());
+        return;
+    }
+    LOGI("Cached program binary (%d bytes, format 0x%x)", written, binaryFormat);
+}
+
+void setProgramCacheDir(const char* cacheDir) {
+    std::lock_guard<std::mutex> lock(gCacheMutex);
+    if (cacheDir == nullptr || cacheDir[0] == '\0') {
+        gCacheDir.clear();
+        return;
+    }
+    gCacheDir = cacheDir;
+    mkdir(gCacheDir.c_str(), 0700);
+    LOGI("Program cache dir: %s", gCacheDir.c_str());
+}
+
+GLuint createCachedProgram(const char* vertexShaderSource, const char* fragmentShaderSource,
+                           const char* const* tfbVaryings, GLsizei tfbVaryingCount,
+                           GLenum tfbBufferMode) {
+    std::string cacheDir;
+    {
+        std::lock_guard<std::mutex> lock(gCacheMutex);
+        cacheDir = gCacheDir;
+    }
+
+    // 驱动不支持任何二进制格式时缓存无意义；录制 GL 命令时必须走完整编译，回放端才能重建程序
+    GLint formatCount = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount);
+    if (cacheDir.empty() || formatCount <= 0 || glTraceCapturing()) {
+        return compileAndLinkProgram(vertexShaderSource, fragmentShaderSource,
+                                     tfbVaryings, tfbVaryingCount, tfbBufferMode, false);
+    }
+
+    uint64_t key = computeProgramKey(vertexShaderSource, fragmentShaderSource,
+                                     tfbVaryings, tfbVaryingCount, tfbBufferMode);
+    std::string path = entryPath(cacheDir, key);
+
+    ProgramBinaryHeader header;
+    std::vector<uint8_t> binary;
+    bool rejected = false;
+    if (readEntry(path, key, &header, &binary, &rejected)) {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        GLuint program = glCreateProgram();
+        // 二进制中已包含链接前设置的 TFB 捕获变量，无需再次指定
+        glProgramBinary(program, header.binaryFormat, binary.data(), (GLsizei)binary.size());
+        GLint linked = 0;
+        glGetProgramiv(program, GL_LINK_STATUS, &linked);
+        if (linked) {
+            double loadMs = elapsedMs(start);
+            std::lock_guard<std::mutex> lock(gCacheMutex);
+            gStats.hits++;
+            if (header.compileMs > loadMs) {
+                gStats.compileMsSaved += header.compileMs - loadMs;
+            }
+            LOGI("Program cache hit %016llx: loaded in %.2f ms (compile took %.2f ms)",
+                 (unsigned long long)key, loadMs, header.compileMs);
+            return program;
+        }
+        // 驱动拒绝了这个二进制（例如系统更新后格式变化），删掉后重新编译
+        LOGI("Program cache entry %016llx rejected by driver, recompiling", (unsigned long long)key);
+        glDeleteProgram(program);
+        remove(path.c_str());
+    } else if (rejected) {
+        LOGI("Program cache entry %016llx is corrupt, recompiling", (unsigned long long)key);
+    }
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    GLuint program = compileAndLinkProgram(vertexShaderSource, fragmentShaderSource,
+                                           tfbVaryings, tfbVaryingCount, tfbBufferMode, true);
+    double compileMs = elapsedMs(start);
+    {
+        std::lock_guard<std::mutex> lock(gCacheMutex);
+        gStats.misses++;
+        if (rejected) {
+            gStats.rejected++;
+        }
+    }
+    if (program != 0) {
+        writeEntry(path, key, program, (float)compileMs);
+    }
+    return program;
+}
+
+ProgramCacheStats getProgramCacheStats() {
+    std::lock_guard<std::mutex> lock(gCacheMutex);
+    return gStats;
+}
+
+void logProgramCacheStats(const char* tag) {
+    ProgramCacheStats stats = getProgramCacheStats();
+    LOGI("[%s] program cache: %u hits, %u misses (%u rejected), %.2f ms compile time saved",
+         tag, stats.hits, stats.misses, stats.rejected, stats.compileMsSaved);
+}
+
+#ifdef __ANDROID__
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_example_ndklearn2_ProgramCache_nativeSetCacheDir(JNIEnv* env, jclass clazz, jstring cacheDir) {
+    if (cacheDir == nullptr) {
+        setProgramCacheDir(nullptr);
+        return;
+    }
+    const char* dir = env->GetStringUTFChars(cacheDir, nullptr);
+    setProgramCacheDir(dir);
+    env->ReleaseStringUTFChars(cacheDir, dir);
+}
+
+// 返回 [hits, misses, rejected, 节省的微秒数]
+extern "C" JNIEXPORT jlongArray JNICALL
+Java_com_example_ndklearn2_ProgramCache_nativeGetStats(JNIEnv* env, jclass clazz) {
+    ProgramCacheStats stats = getProgramCacheStats();
+    jlong values[4] = {
+            (jlong)stats.hits,
+            (jlong)stats.misses,
+            (jlong)stats.rejected,
+            (jlong)(stats.compileMsSaved * 1000.0)
+    };
+    jlongArray result = env->NewLongArray(4);
+    if (result != nullptr) {
+        env->SetLongArrayRegion(result, 0, 4, values);
+    }
+    return result;
+}
+
+#endif // __ANDROID__
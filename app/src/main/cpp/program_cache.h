@@ -0,0 +1,40 @@
+//
+// Created by zhangx on 2026/10/16.
+// 程序二进制缓存 - 用 glGetProgramBinary/glProgramBinary 把链接好的程序存到磁盘，
+// 下次启动直接加载，跳过 GLSL 编译和链接
+//
+
+#ifndef NDKLEARN2_PROGRAM_CACHE_H
+#define NDKLEARN2_PROGRAM_CACHE_H
+
+#include <GLES3/gl3.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 缓存统计
+typedef struct {
+    unsigned int hits;        // 从缓存加载成功的次数
+    unsigned int misses;      // 需要完整编译的次数
+    unsigned int rejected;    // 缓存条目失效的次数（驱动升级、文件损坏等），也计入 misses
+    double compileMsSaved;    // 命中时节省的编译+链接时间（毫秒）
+} ProgramCacheStats;
+
+// 设置缓存目录（通常是 Context.getCacheDir() 下的子目录），传 nullptr 关闭缓存
+void setProgramCacheDir(const char* cacheDir);
+
+// 创建程序：缓存键由着色器源码、TFB 捕获变量和驱动字符串共同决定
+// 缓存未命中或条目失效时回退到 compileAndLinkProgram() 完整编译，并写回缓存
+GLuint createCachedProgram(const char* vertexShaderSource, const char* fragmentShaderSource,
+                           const char* const* tfbVaryings, GLsizei tfbVaryingCount,
+                           GLenum tfbBufferMode);
+
+ProgramCacheStats getProgramCacheStats();
+void logProgramCacheStats(const char* tag);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //NDKLEARN2_PROGRAM_CACHE_H
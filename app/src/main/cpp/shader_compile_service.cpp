@@ -0,0 +1,178 @@
+//
+// Created by zhangx on 2026/10/16.
+// 异步着色器编译服务实现
+//
+
+#include "shader_compile_service.h"
+#include "program_cache.h"
+#include "shared_context.h"
+#include "gl_trace.h"
+#include <android/log.h>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define LOG_TAG "ShaderCompileService"
+#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
+#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
+
+// 一个编译请求
+struct CompileJob {
+    std::string vertexSource;
+    std::string fragmentSource;
+    std::vector<std::string> tfbVaryings;
+    GLenum tfbBufferMode;
+    std::promise<GLuint> result;
+};
+
+static struct {
+    SharedContext shared;      // 工作线程的上下文，与渲染线程的上下文共享对象
+    std::thread worker;
+    std::mutex mutex;
+    std::condition_variable cond;
+    std::condition_variable idleCond;  // 队列清空且没有正在编译的请求时通知
+    std::deque<CompileJob*> jobs;
+    int compiling;                     // 工作线程已取出、还没完成的请求数
+    bool running;
+} gService = {{EGL_NO_DISPLAY, EGL_NO_CONTEXT, EGL_NO_CONTEXT, EGL_NO_SURFACE}};
+
+static GLuint compileJob(const CompileJob& job) {
+    std::vector<const char*> varyings;
+    for (size_t i = 0; i < job.tfbVaryings.size(); i++) {
+        varyings.push_back(job.tfbVaryings[i].c_str());
+    }
+    return createCachedProgram(job.vertexSource.c_str(), job.fragmentSource.c_str(),
+                               varyings.empty() ? nullptr : varyings.data(),
+                               (GLsizei)varyings.size(), job.tfbBufferMode);
+}
+
+static void workerLoop() {
+    makeSharedContextCurrent(gService.shared);
+
+    while (true) {
+        CompileJob* job = nullptr;
+        {
+            std::unique_lock<std::mutex> lock(gService.mutex);
+            gService.cond.wait(lock, [] { return !gService.running || !gService.jobs.empty(); });
+            if (!gService.running) {
+                break;
+            }
+            job = gService.jobs.front();
+            gService.jobs.pop_front();
+            gService.compiling++;
+        }
+
+        GLuint program = compileJob(*job);
+        // 共享对象的修改必须在本上下文中完成后，另一个上下文重新绑定（glUseProgram）才保证可见
+        GLsync fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+        glDeleteSync(fence);
+
+        job->result.set_value(program);
+        delete job;
+        {
+            std::lock_guard<std::mutex> lock(gService.mutex);
+            gService.compiling--;
+        }
+        gService.idleCond.notify_all();
+    }
+
+    releaseSharedContext(gService.shared);
+}
+
+bool startShaderCompileService() {
+    EGLDisplay display = eglGetCurrentDisplay();
+    EGLContext shareContext = eglGetCurrentContext();
+    if (display == EGL_NO_DISPLAY || shareContext == EGL_NO_CONTEXT) {
+        LOGE("No current EGL context, shaders will compile on the calling thread");
+        return false;
+    }
+    if (gService.running && gService.shared.shareContext == shareContext) {
+        return true;
+    }
+    // 渲染上下文被重建（例如 GLSurfaceView 暂停后恢复），旧工作线程的共享组已失效
+    stopShaderCompileService();
+
+    if (!createSharedContext(&gService.shared, "compile worker")) {
+        return false;
+    }
+    gService.compiling = 0;
+    gService.running = true;
+    gService.worker = std::thread(workerLoop);
+    LOGI("Shader compile service started");
+    return true;
+}
+
+void stopShaderCompileService() {
+    if (!gService.worker.joinable()) {
+        return;
+    }
+    std::deque<CompileJob*> pending;
+    {
+        std::lock_guard<std::mutex> lock(gService.mutex);
+        gService.running = false;
+        pending.swap(gService.jobs);
+    }
+    gService.cond.notify_all();
+    gService.idleCond.notify_all();
+    gService.worker.join();
+
+    for (size_t i = 0; i < pending.size(); i++) {
+        pending[i]->result.set_value(0);
+        delete pending[i];
+    }
+    destroySharedContext(&gService.shared);
+    LOGI("Shader compile service stopped");
+}
+
+ProgramFuture requestProgramAsync(const char* vertexShaderSource, const char* fragmentShaderSource,
+                                  const char* const* tfbVaryings, GLsizei tfbVaryingCount,
+                                  GLenum tfbBufferMode) {
+    CompileJob* job = new CompileJob();
+    job->vertexSource = vertexShaderSource;
+    job->fragmentSource = fragmentShaderSource;
+    for (GLsizei i = 0; i < tfbVaryingCount; i++) {
+        job->tfbVaryings.push_back(tfbVaryings[i]);
+    }
+    job->tfbBufferMode = tfbBufferMode;
+    ProgramFuture future = job->result.get_future().share();
+
+    {
+        std::lock_guard<std::mutex> lock(gService.mutex);
+        // 录制 GL 命令时在录制线程上同步编译，工作线程上的调用录不到
+        if (gService.running && !glTraceCapturing()) {
+            gService.jobs.push_back(job);
+            job = nullptr;
+        }
+    }
+    if (job == nullptr) {
+        gService.cond.notify_one();
+        return future;
+    }
+
+    // 服务未启动或正在录制：回退到同步编译
+    job->result.set_value(compileJob(*job));
+    delete job;
+    return future;
+}
+
+void waitShaderCompileServiceIdle() {
+    std::unique_lock<std::mutex> lock(gService.mutex);
+    gService.idleCond.wait(lock, [] {
+        return !gService.running || (gService.jobs.empty() && gService.compiling == 0);
+    });
+}
+
+bool pollProgram(ProgramFuture* future, GLuint* program) {
+    if (!future->valid()
+        || future->wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+        return false;
+    }
+    *program = future->get();
+    *future = ProgramFuture();
+    return true;
+}
@@ -0,0 +1,34 @@
+//
+// Created by zhangx on 2026/10/16.
+// 异步着色器编译服务 - 在共享上下文的工作线程上编译链接程序，渲染线程不再被编译阻塞
+//
+
+#ifndef NDKLEARN2_SHADER_COMPILE_SERVICE_H
+#define NDKLEARN2_SHADER_COMPILE_SERVICE_H
+
+#include <GLES3/gl3.h>
+#include <future>
+
+// 编译结果：就绪后为程序ID，失败为 0
+typedef std::shared_future<GLuint> ProgramFuture;
+
+// 在渲染线程调用（当前必须有 EGL 上下文）
+// 创建一个与当前上下文共享对象的工作线程上下文；当前上下文变化时会重建工作线程
+bool startShaderCompileService();
+
+// 停止工作线程并销毁它的上下文，未完成的请求返回 0
+void stopShaderCompileService();
+
+// 提交编译请求，源码会被复制，调用后即可释放
+// 服务未启动时在调用线程同步编译，返回已就绪的 future
+ProgramFuture requestProgramAsync(const char* vertexShaderSource, const char* fragmentShaderSource,
+                                  const char* const* tfbVaryings, GLsizei tfbVaryingCount,
+                                  GLenum tfbBufferMode);
+
+// 阻塞到已提交的请求全部编译完成（服务未启动时立即返回），基准测试预热用，渲染时不要调用
+void waitShaderCompileServiceIdle();
+
+// 渲染线程每帧调用，不阻塞：就绪时写出程序ID（失败为 0）、清空 future 并返回 true
+bool pollProgram(ProgramFuture* future, GLuint* program);
+
+#endif //NDKLEARN2_SHADER_COMPILE_SERVICE_H
@@ -0,0 +1,333 @@
+//
+// Created by zhangx on 2026/10/16.
+// 着色器程序注册表实现
+//
+
+#include "shader_registry.h"
+#include "gl_trace.h"
+#include <android/log.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#define LOG_TAG "ShaderRegistry"
+#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
+#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
+
+// 名字到全局编号的映射
+struct NameTable {
+    std::unordered_map<std::string, int> ids;
+    std::vector<std::string> names;
+
+    int intern(const std::string& name) {
+        std::unordered_map<std::string, int>::const_iterator it = ids.find(name);
+        if (it != ids.end()) {
+            return it->second;
+        }
+        int id = (int)names.size();
+        ids[name] = id;
+        names.push_back(name);
+        return id;
+    }
+};
+
+// 一个程序的反射结果，各数组按句柄索引（句柄超出数组范围表示该程序中不存在）
+struct ProgramEntry {
+    std::string label;
+    std::vector<GLint> uniformLocations;
+    std::vector<GLenum> uniformTypes;
+    std::vector<GLint> uniformOffsets;    // 块成员的偏移，默认块中的 uniform 为 -1
+    std::vector<GLuint> blockIndices;
+    std::vector<GLint> blockSizes;
+    std::vector<GLint> blockBindings;     // 记录的绑定点，-1 表示未设置
+    std::vector<GLint> attribLocations;
+};
+
+// 函数内静态变量，保证渲染器在静态初始化阶段获取句柄时注册表已经构造
+static NameTable& uniformNames() {
+    static NameTable table;
+    return table;
+}
+
+static NameTable& blockNames() {
+    static NameTable table;
+    return table;
+}
+
+static NameTable& attribNames() {
+    static NameTable table;
+    return table;
+}
+
+static std::unordered_map<GLuint, ProgramEntry>& programs() {
+    static std::unordered_map<GLuint, ProgramEntry> entries;
+    return entries;
+}
+
+static ProgramEntry* findEntry(GLuint program) {
+    std::unordered_map<GLuint, ProgramEntry>::iterator it = programs().find(program);
+    return it == programs().end() ? nullptr : &it->second;
+}
+
+UniformHandle uniformHandle(const char* name) {
+    return uniformNames().intern(name);
+}
+
+BlockHandle uniformBlockHandle(const char* name) {
+    return blockNames().intern(name);
+}
+
+AttribHandle attributeHandle(const char* name) {
+    return attribNames().intern(name);
+}
+
+// 数组 uniform 的名字带 "[0]" 后缀，去掉后按数组名登记（位置即首元素位置）
+static std::string baseName(const char* name) {
+    std::string result(name);
+    size_t bracket = result.find('[');
+    if (bracket != std::string::npos) {
+        result.erase(bracket);
+    }
+    return result;
+}
+
+template <typename T>
+static void setAt(std::vector<T>* values, int index, T value, T missing) {
+    if (index >= (int)values->size()) {
+        values->resize(index + 1, missing);
+    }
+    (*values)[index] = value;
+}
+
+static void reflectProgram(GLuint program, ProgramEntry* entry) {
+    entry->uniformLocations.clear();
+    entry->uniformTypes.clear();
+    entry->uniformOffsets.clear();
+    entry->blockIndices.clear();
+    entry->blockSizes.clear();
+    entry->attribLocations.clear();
+
+    GLint count = 0;
+    GLint maxLength = 0;
+    std::vector<char> name;
+
+    // 1. 默认块中的 uniform；Uniform Block 内的成员位置为 -1，只记录块内偏移
+    glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &count);
+    glGetProgramiv(program, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+    name.resize(maxLength > 0 ? maxLength : 1);
+    for (GLint i = 0; i < count; i++) {
+        GLint size = 0;
+        GLenum type = 0;
+        glGetActiveUniform(program, i, (GLsizei)name.size(), nullptr, &size, &type, name.data());
+        GLint location = glGetUniformLocation(program, name.data());
+        if (location == -1) {
+            GLuint index = (GLuint)i;
+            GLint offset = -1;
+            glGetActiveUniformsiv(program, 1, &index, GL_UNIFORM_OFFSET, &offset);
+            if (offset >= 0) {
+                setAt(&entry->uniformOffsets, uniformNames().intern(baseName(name.data())), offset, -1);
+            }
+            continue;
+        }
+        int handle = uniformNames().intern(baseName(name.data()));
+        setAt(&entry->uniformLocations, handle, location, -1);
+        setAt(&entry->uniformTypes, handle, type, (GLenum)0);
+    }
+
+    // 2. Uniform Block
+    glGetProgramiv(program, GL_ACTIVE_UNIFORM_BLOCKS, &count);
+    glGetProgramiv(program, GL_ACTIVE_UNIFORM_BLOCK_MAX_NAME_LENGTH, &maxLength);
+    name.resize(maxLength > 0 ? maxLength : 1);
+    for (GLint i = 0; i < count; i++) {
+        glGetActiveUniformBlockName(program, i, (GLsizei)name.size(), nullptr, name.data());
+        GLint dataSize = 0;
+        glGetActiveUniformBlockiv(program, i, GL_UNIFORM_BLOCK_DATA_SIZE, &dataSize);
+        int handle = blockNames().intern(name.data());
+        setAt(&entry->blockIndices, handle, (GLuint)i, GL_INVALID_INDEX);
+        setAt(&entry->blockSizes, handle, dataSize, -1);
+    }
+
+    // 3. 顶点属性
+    glGetProgramiv(program, GL_ACTIVE_ATTRIBUTES, &count);
+    glGetProgramiv(program, GL_ACTIVE_ATTRIBUTE_MAX_LENGTH, &maxLength);
+    name.resize(maxLength > 0 ? maxLength : 1);
+    for (GLint i = 0; i < count; i++) {
+        GLint size = 0;
+        GLenum type = 0;
+        glGetActiveAttrib(program, i, (GLsizei)name.size(), nullptr, &size, &type, name.data());
+        GLint location = glGetAttribLocation(program, name.data());
+        if (location == -1) {
+            continue;  // 内置变量（gl_VertexID 等）
+        }
+        setAt(&entry->attribLocations, attribNames().intern(name.data()), location, -1);
+    }
+
+    // 4. 恢复记录的块绑定（重新链接会把绑定重置为 0）
+    for (size_t i = 0; i < entry->blockBindings.size(); i++) {
+        if (entry->blockBindings[i] < 0) {
+            continue;
+        }
+        if (i < entry->blockIndices.size() && entry->blockIndices[i] != GL_INVALID_INDEX) {
+            glUniformBlockBinding(program, entry->blockIndices[i], (GLuint)entry->blockBindings[i]);
+        }
+    }
+}
+
+void registerProgram(GLuint program, const char* label) {
+    if (program == 0) {
+        return;
+    }
+    ProgramEntry& entry = programs()[program];
+    entry.label = label != nullptr ? label : "";
+    reflectProgram(program, &entry);
+
+    GLint uniforms = 0;
+    GLint blocks = 0;
+    GLint attributes = 0;
+    glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &uniforms);
+    glGetProgramiv(program, GL_ACTIVE_UNIFORM_BLOCKS, &blocks);
+    glGetProgramiv(program, GL_ACTIVE_ATTRIBUTES, &attributes);
+    LOGI("Registered program %d (%s): %d uniforms, %d blocks, %d attributes",
+         program, entry.label.c_str(), uniforms, blocks, attributes);
+}
+
+void unregisterProgram(GLuint program) {
+    programs().erase(program);
+}
+
+bool bindProgramUniformBlock(GLuint program, BlockHandle block, GLuint bindingPoint) {
+    ProgramEntry* entry = findEntry(program);
+    if (entry == nullptr) {
+        // 未登记的程序：直接查询
+        GLuint blockIndex = glGetUniformBlockIndex(program, blockNames().names[block].c_str());
+        if (blockIndex == GL_INVALID_INDEX) {
+            return false;
+        }
+        glUniformBlockBinding(program, blockIndex, bindingPoint);
+        return true;
+    }
+    setAt(&entry->blockBindings, block, (GLint)bindingPoint, -1);
+    GLuint blockIndex = programUniformBlockIndex(program, block);
+    if (blockIndex == GL_INVALID_INDEX) {
+        return false;
+    }
+    glUniformBlockBinding(program, blockIndex, bindingPoint);
+    return true;
+}
+
+bool relinkProgram(GLuint program) {
+    glLinkProgram(program);
+    GLint linked = 0;
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
+    if (!linked) {
+        GLint infoLen = 0;
+        glGetProgramiv(program, GL_INFO_LOG_LENGTH, &infoLen);
+        if (infoLen > 1) {
+            std::vector<char> infoLog(infoLen);
+            glGetProgramInfoLog(program, infoLen, nullptr, infoLog.data());
+            LOGE("Error relinking program %d: %s", program, infoLog.data());
+        }
+        return false;
+    }
+    ProgramEntry* entry = findEntry(program);
+    if (entry != nullptr) {
+        reflectProgram(program, entry);
+    }
+    return true;
+}
+
+GLint programUniformLocation(GLuint program, UniformHandle uniform) {
+    const ProgramEntry* entry = findEntry(program);
+    if (entry == nullptr || uniform < 0 || uniform >= (int)entry->uniformLocations.size()) {
+        return -1;
+    }
+    return entry->uniformLocations[uniform];
+}
+
+GLuint programUniformBlockIndex(GLuint program, BlockHandle block) {
+    const ProgramEntry* entry = findEntry(program);
+    if (entry == nullptr || block < 0 || block >= (int)entry->blockIndices.size()) {
+        return GL_INVALID_INDEX;
+    }
+    return entry->blockIndices[block];
+}
+
+GLint programUniformBlockSize(GLuint program, BlockHandle block) {
+    const ProgramEntry* entry = findEntry(program);
+    if (entry == nullptr || block < 0 || block >= (int)entry->blockSizes.size()) {
+        return -1;
+    }
+    return entry->blockSizes[block];
+}
+
+GLint programUniformOffset(GLuint program, UniformHandle uniform) {
+    const ProgramEntry* entry = findEntry(program);
+    if (entry == nullptr || uniform < 0 || uniform >= (int)entry->uniformOffsets.size()) {
+        return -1;
+    }
+    return entry->uniformOffsets[uniform];
+}
+
+GLint programAttributeLocation(GLuint program, AttribHandle attribute) {
+    const ProgramEntry* entry = findEntry(program);
+    if (entry == nullptr || attribute < 0 || attribute >= (int)entry->attribLocations.size()) {
+        return -1;
+    }
+    return entry->attribLocations[attribute];
+}
+
+bool verifyUniformBlockLayout(GLuint program, BlockHandle block, const UniformHandle* members, const size_t* offsets,
+                              int count, size_t cpuSize) {
+    const ProgramEntry* entry = findEntry(program);
+    if (entry == nullptr) {
+        LOGE("Program %d is not registered, cannot verify %s", program, blockNames().names[block].c_str());
+        return false;
+    }
+    const char* blockName = blockNames().names[block].c_str();
+    GLint blockSize = programUniformBlockSize(program, block);
+    if (blockSize < 0) {
+        return true;  // 这个程序不使用该块
+    }
+    bool matched = true;
+    if ((size_t)blockSize > cpuSize) {
+        LOGE("%s in program %d (%s) is %d bytes, CPU layout has %d", blockName, program, entry->label.c_str(),
+             blockSize, (int)cpuSize);
+        matched = false;
+    }
+    for (int i = 0; i < count; i++) {
+        GLint offset = programUniformOffset(program, members[i]);
+        if (offset >= 0 && (size_t)offset != offsets[i]) {
+            LOGE("%s.%s in program %d (%s) is at offset %d, CPU layout has %d", blockName,
+                 uniformNames().names[members[i]].c_str(), program, entry->label.c_str(), offset, (int)offsets[i]);
+            matched = false;
+        }
+    }
+    return matched;
+}
+
+void logProgramReflection(GLuint program) {
+    const ProgramEntry* entry = findEntry(program);
+    if (entry == nullptr) {
+        LOGE("Program %d is not registered", program);
+        return;
+    }
+    LOGI("Program %d (%s) reflection:", program, entry->label.c_str());
+    for (size_t i = 0; i < entry->uniformLocations.size(); i++) {
+        if (entry->uniformLocations[i] != -1) {
+            LOGI("  uniform %s: location %d, type 0x%x", uniformNames().names[i].c_str(),
+                 entry->uniformLocations[i], entry->uniformTypes[i]);
+        }
+    }
+    for (size_t i = 0; i < entry->blockIndices.size(); i++) {
+        if (entry->blockIndices[i] != GL_INVALID_INDEX) {
+            GLint binding = i < entry->blockBindings.size() ? entry->blockBindings[i] : -1;
+            LOGI("  block %s: index %d, %d bytes, binding %d", blockNames().names[i].c_str(),
+                 entry->blockIndices[i], entry->blockSizes[i], binding);
+        }
+    }
+    for (size_t i = 0; i < entry->attribLocations.size(); i++) {
+        if (entry->attribLocations[i] != -1) {
+            LOGI("  attribute %s: location %d", attribNames().names[i].c_str(), entry->attribLocations[i]);
+        }
+    }
+}
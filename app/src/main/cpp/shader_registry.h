@@ -0,0 +1,50 @@
+//
+// Created by zhangx on 2026/10/16.
+// 着色器程序注册表 - 链接后一次性反射 uniform / uniform block / 顶点属性，渲染时按句柄 O(1) 取位置
+//
+
+#ifndef NDKLEARN2_SHADER_REGISTRY_H
+#define NDKLEARN2_SHADER_REGISTRY_H
+
+#include <GLES3/gl3.h>
+#include <stddef.h>
+
+// 句柄是名字的全局编号，与具体程序无关：同一个句柄可以用在所有程序（例如各个着色器变体）上
+// 在初始化阶段获取一次并保存，渲染时不再做任何字符串查找
+typedef int UniformHandle;
+typedef int BlockHandle;
+typedef int AttribHandle;
+
+UniformHandle uniformHandle(const char* name);
+BlockHandle uniformBlockHandle(const char* name);
+AttribHandle attributeHandle(const char* name);
+
+// 登记已链接的程序并反射所有活动 uniform、uniform block 和顶点属性（渲染线程调用）
+// 重复登记同一个程序会重新反射，已记录的块绑定保持不变
+void registerProgram(GLuint program, const char* label);
+// 从注册表移除（不删除程序对象）
+void unregisterProgram(GLuint program);
+
+// 把程序的 uniform block 绑定到绑定点，并记录下来，重新链接后自动恢复
+// 程序未登记时直接向驱动查询，不做记录
+bool bindProgramUniformBlock(GLuint program, BlockHandle block, GLuint bindingPoint);
+
+// 重新链接程序（例如修改 Transform Feedback 捕获变量后），刷新反射结果并恢复块绑定
+bool relinkProgram(GLuint program);
+
+// 渲染路径使用的查询：只读注册表，不调用驱动；不活动或程序未登记时返回 -1 / GL_INVALID_INDEX
+GLint programUniformLocation(GLuint program, UniformHandle uniform);
+GLuint programUniformBlockIndex(GLuint program, BlockHandle block);
+GLint programUniformBlockSize(GLuint program, BlockHandle block);
+// uniform block 成员在块内的字节偏移（GL_UNIFORM_OFFSET）；默认块中的 uniform 返回 -1
+GLint programUniformOffset(GLuint program, UniformHandle uniform);
+GLint programAttributeLocation(GLuint program, AttribHandle attribute);
+
+// 核对块成员的反射偏移与 CPU 端的布局（见 std140_layout.h），以及块大小没有超过 cpuSize。
+// 程序中不活动的成员（被编译器优化掉）跳过；不一致的逐个报错并返回 false
+bool verifyUniformBlockLayout(GLuint program, BlockHandle block, const UniformHandle* members, const size_t* offsets,
+                              int count, size_t cpuSize);
+
+void logProgramReflection(GLuint program);
+
+#endif //NDKLEARN2_SHADER_REGISTRY_H
@@ -0,0 +1,115 @@
+//
+// Created by zhangx on 2026/10/16.
+// 着色器变体实现
+//
+
+#include "shader_variants.h"
+#include "shader_registry.h"
+#include "opengl_utils.h"
+#include <android/log.h>
+#include <cstring>
+
+#define LOG_TAG "ShaderVariants"
+#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
+#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
+
+std::string injectShaderDefines(const char* source, const char* defines) {
+    std::string result(source);
+    if (defines == nullptr || defines[0] == '\0') {
+        return result;
+    }
+    size_t version = result.find("#version");
+    if (version == std::string::npos) {
+        return std::string(defines) + result;
+    }
+    size_t lineEnd = result.find('\n', version);
+    if (lineEnd == std::string::npos) {
+        return result + "\n" + defines;
+    }
+    result.insert(lineEnd + 1, defines);
+    return result;
+}
+
+void initShaderVariantSet(ShaderVariantSet* set, const char* vertexSource, const char* fragmentSource,
+                          int variantCount, void (*onProgramReady)(GLuint program)) {
+    set->vertexSource = vertexSource;
+    set->fragmentSource = fragmentSource;
+    set->defines.assign(variantCount, std::string());
+    set->programs.assign(variantCount, 0);
+    set->futures.assign(variantCount, ProgramFuture());
+    set->requested.assign(variantCount, false);
+    set->onProgramReady = onProgramReady;
+}
+
+void setShaderVariantDefines(ShaderVariantSet* set, int key, const char* defines) {
+    set->defines[key] = defines;
+}
+
+static void requestVariant(ShaderVariantSet* set, int key) {
+    std::string vertexSource = injectShaderDefines(set->vertexSource.c_str(), set->defines[key].c_str());
+    std::string fragmentSource = injectShaderDefines(set->fragmentSource.c_str(), set->defines[key].c_str());
+    set->futures[key] = requestProgramAsync(vertexSource.c_str(), fragmentSource.c_str(),
+                                            nullptr, 0, GL_INTERLEAVED_ATTRIBS);
+    set->requested[key] = true;
+}
+
+static void finishVariant(ShaderVariantSet* set, int key, GLuint program) {
+    if (program == 0) {
+        LOGE("Shader variant %d failed to compile", key);
+        return;
+    }
+    set->programs[key] = program;
+    registerProgram(program, "variant");
+    if (set->onProgramReady != nullptr) {
+        set->onProgramReady(program);
+    }
+    LOGI("Shader variant %d ready, program=%d", key, program);
+}
+
+GLuint acquireShaderVariant(ShaderVariantSet* set, int key) {
+    if (key < 0 || key >= (int)set->programs.size()) {
+        return 0;
+    }
+    if (set->programs[key] != 0) {
+        return set->programs[key];
+    }
+    if (!set->requested[key]) {
+        requestVariant(set, key);
+    }
+    GLuint program = 0;
+    if (pollProgram(&set->futures[key], &program)) {
+        finishVariant(set, key, program);
+    }
+    return set->programs[key];
+}
+
+GLuint waitShaderVariant(ShaderVariantSet* set, int key) {
+    if (key < 0 || key >= (int)set->programs.size()) {
+        return 0;
+    }
+    if (set->programs[key] != 0) {
+        return set->programs[key];
+    }
+    if (!set->requested[key]) {
+        requestVariant(set, key);
+    }
+    if (set->futures[key].valid()) {
+        GLuint program = set->futures[key].get();
+        set->futures[key] = ProgramFuture();
+        finishVariant(set, key, program);
+    }
+    return set->programs[key];
+}
+
+void releaseShaderVariantSet(ShaderVariantSet* set) {
+    for (size_t i = 0; i < set->programs.size(); i++) {
+        if (set->programs[i] != 0) {
+            unregisterProgram(set->programs[i]);
+            cachedDeleteProgram(set->programs[i]);
+        }
+    }
+    set->defines.clear();
+    set->programs.clear();
+    set->futures.clear();
+    set->requested.clear();
+}
@@ -0,0 +1,40 @@
+//
+// Created by zhangx on 2026/10/16.
+// 着色器变体 - 用 #define 把整个绘制内一致的分支在编译期特化掉，每个变体只编译一次
+//
+
+#ifndef NDKLEARN2_SHADER_VARIANTS_H
+#define NDKLEARN2_SHADER_VARIANTS_H
+
+#include <GLES3/gl3.h>
+#include <string>
+#include <vector>
+#include "shader_compile_service.h"
+
+// 一组共享同一份源码、只在宏定义上不同的程序
+// 变体按整数 key 索引，第一次用到时异步编译，之后直接复用；就绪的变体会登记到 shader_registry
+typedef struct {
+    std::string vertexSource;
+    std::string fragmentSource;
+    std::vector<std::string> defines;      // 每个 key 的宏定义（多行 "#define XXX\n"）
+    std::vector<GLuint> programs;          // 就绪的程序，未就绪为 0
+    std::vector<ProgramFuture> futures;    // 编译中的程序
+    std::vector<bool> requested;
+    void (*onProgramReady)(GLuint program);  // 程序就绪时在渲染线程调用一次（绑定 Block 等）
+} ShaderVariantSet;
+
+// 在源码的 #version 行之后插入宏定义（#version 必须是第一条语句）
+std::string injectShaderDefines(const char* source, const char* defines);
+
+void initShaderVariantSet(ShaderVariantSet* set, const char* vertexSource, const char* fragmentSource,
+                          int variantCount, void (*onProgramReady)(GLuint program));
+void setShaderVariantDefines(ShaderVariantSet* set, int key, const char* defines);
+
+// 非阻塞：返回就绪的变体；还没编译时提交异步编译，未就绪返回 0（调用方使用通用程序兜底）
+GLuint acquireShaderVariant(ShaderVariantSet* set, int key);
+// 阻塞等待变体编译完成（只用于基准测试等离线场景）
+GLuint waitShaderVariant(ShaderVariantSet* set, int key);
+
+void releaseShaderVariantSet(ShaderVariantSet* set);
+
+#endif //NDKLEARN2_SHADER_VARIANTS_H
@@ -0,0 +1,93 @@
+//
+// Created by zhangx on 2026/10/16.
+// 共享 EGL 上下文实现
+//
+
+#include "shared_context.h"
+#include <android/log.h>
+#include <cstring>
+
+#define LOG_TAG "SharedContext"
+#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
+#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
+
+static bool hasEGLExtension(EGLDisplay display, const char* name) {
+    const char* extensions = eglQueryString(display, EGL_EXTENSIONS);
+    return extensions != nullptr && strstr(extensions, name) != nullptr;
+}
+
+bool createSharedContext(SharedContext* shared, const char* owner) {
+    EGLDisplay display = eglGetCurrentDisplay();
+    EGLContext shareContext = eglGetCurrentContext();
+    if (display == EGL_NO_DISPLAY || shareContext == EGL_NO_CONTEXT) {
+        LOGE("No current EGL context for the %s", owner);
+        return false;
+    }
+
+    const EGLint configAttribs[] = {
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_ES3_BIT,
+        EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+        EGL_NONE
+    };
+    EGLConfig config = nullptr;
+    EGLint numConfigs = 0;
+    if (!eglChooseConfig(display, configAttribs, &config, 1, &numConfigs) || numConfigs == 0) {
+        LOGE("No pbuffer-capable EGL config for the %s", owner);
+        return false;
+    }
+
+    // 参数3 share_context：与渲染上下文共享着色器、程序、纹理、缓冲区等对象
+    const EGLint contextAttribs[] = {
+        EGL_CONTEXT_CLIENT_VERSION, 3,
+        EGL_NONE
+    };
+    EGLContext context = eglCreateContext(display, config, shareContext, contextAttribs);
+    if (context == EGL_NO_CONTEXT) {
+        LOGE("Failed to create shared EGL context for the %s: 0x%x", owner, eglGetError());
+        return false;
+    }
+
+    // 工作线程不需要绘制，优先不创建表面
+    EGLSurface surface = EGL_NO_SURFACE;
+    if (!hasEGLExtension(display, "EGL_KHR_surfaceless_context")) {
+        const EGLint pbufferAttribs[] = {EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE};
+        surface = eglCreatePbufferSurface(display, config, pbufferAttribs);
+        if (surface == EGL_NO_SURFACE) {
+            LOGE("Failed to create pbuffer for the %s: 0x%x", owner, eglGetError());
+            eglDestroyContext(display, context);
+            return false;
+        }
+    }
+
+    shared->display = display;
+    shared->shareContext = shareContext;
+    shared->context = context;
+    shared->surface = surface;
+    return true;
+}
+
+void destroySharedContext(SharedContext* shared) {
+    if (shared->surface != EGL_NO_SURFACE) {
+        eglDestroySurface(shared->display, shared->surface);
+    }
+    if (shared->context != EGL_NO_CONTEXT) {
+        eglDestroyContext(shared->display, shared->context);
+    }
+    shared->display = EGL_NO_DISPLAY;
+    shared->shareContext = EGL_NO_CONTEXT;
+    shared->context = EGL_NO_CONTEXT;
+    shared->surface = EGL_NO_SURFACE;
+}
+
+bool makeSharedContextCurrent(const SharedContext& shared) {
+    if (!eglMakeCurrent(shared.display, shared.surface, shared.surface, shared.context)) {
+        LOGE("Worker failed to make context current: 0x%x", eglGetError());
+        return false;
+    }
+    return true;
+}
+
+void releaseSharedContext(const SharedContext& shared) {
+    eglMakeCurrent(shared.display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    eglReleaseThread();
+}
@@ -0,0 +1,26 @@
+//
+// Created by zhangx on 2026/10/16.
+// 共享 EGL 上下文 - 后台工作线程（着色器编译、纹理上传）与渲染线程共享 GL 对象
+//
+
+#ifndef NDKLEARN2_SHARED_CONTEXT_H
+#define NDKLEARN2_SHARED_CONTEXT_H
+
+#include <EGL/egl.h>
+
+struct SharedContext {
+    EGLDisplay display;
+    EGLContext shareContext;   // 创建时渲染线程的当前上下文
+    EGLContext context;        // 工作线程的上下文（与 shareContext 共享对象）
+    EGLSurface surface;        // 不支持 surfaceless 时用 1x1 pbuffer
+};
+
+// 渲染线程调用（当前必须有 EGL 上下文）；owner 只用于日志
+bool createSharedContext(SharedContext* shared, const char* owner);
+void destroySharedContext(SharedContext* shared);
+
+// 工作线程进入和退出时调用
+bool makeSharedContextCurrent(const SharedContext& shared);
+void releaseSharedContext(const SharedContext& shared);
+
+#endif //NDKLEARN2_SHARED_CONTEXT_H
@@ -0,0 +1,156 @@
+//
+// Created by zhangx on 2026/10/16.
+// std140 布局模板 - 在编译期按 std140 规则算出 uniform block 各成员的偏移和块大小
+//
+// 用成员类型的列表描述一个块，顺序与着色器中的声明一致：
+//   typedef Std140Block<Std140Vec3, Std140Float, Std140Mat3> ExampleLayout;
+//   ExampleLayout::Member<1>::OFFSET == 12，ExampleLayout::Member<2>::OFFSET == 16，ExampleLayout::SIZE == 64
+// 在 CPU 内存中按布局拼好整个块，再一次 glBufferSubData / 映射写入上传。
+// 偏移是常量表达式，渲染器用 static_assert 固定着色器声明的布局；链接后再用
+// verifyStd140Layout 与驱动反射的 GL_UNIFORM_OFFSET 逐个核对。
+// 规则（GLSL ES 3.00 §2.12.6.4）：
+//   float / int 对齐 4，vec2 对齐 8，vec3 / vec4 对齐 16（vec3 只占 12 字节，后面可以紧跟一个标量）；
+//   矩阵按列存放，每列按 vec4 对齐，mat3 每列末尾有 4 字节填充；
+//   数组每个元素的步长向上取整到 16 字节
+// 不支持嵌套结构体
+//
+
+#ifndef NDKLEARN2_STD140_LAYOUT_H
+#define NDKLEARN2_STD140_LAYOUT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include "shader_registry.h"
+
+namespace std140_detail {
+
+constexpr size_t alignUp(size_t value, size_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+// 成员从 Offset 开始依次排列时，第 I 个成员的类型和偏移
+template <size_t Offset, size_t I, typename... Members>
+struct MemberAt;
+
+template <size_t Offset, typename M, typename... Rest>
+struct MemberAt<Offset, 0, M, Rest...> {
+    typedef M Type;
+    static const size_t OFFSET = alignUp(Offset, M::ALIGN);
+};
+
+template <size_t Offset, size_t I, typename M, typename... Rest>
+struct MemberAt<Offset, I, M, Rest...> : MemberAt<alignUp(Offset, M::ALIGN) + M::SIZE, I - 1, Rest...> {
+};
+
+// 最后一个成员结束的位置
+template <size_t Offset, typename... Members>
+struct EndOf {
+    static const size_t VALUE = Offset;
+};
+
+template <size_t Offset, typename M, typename... Rest>
+struct EndOf<Offset, M, Rest...> : EndOf<alignUp(Offset, M::ALIGN) + M::SIZE, Rest...> {
+};
+
+}  // namespace std140_detail
+
+// 标量和向量：源数据为紧密排列的 Components 个分量
+template <typename T, int Components, size_t Alignment>
+struct Std140Vector {
+    typedef T Component;
+    static const size_t ALIGN = Alignment;
+    static const size_t SIZE = sizeof(T) * Components;
+    static const size_t COMPONENTS = Components;
+
+    static void write(unsigned char* dst, const T* src) {
+        memcpy(dst, src, SIZE);
+    }
+};
+
+typedef Std140Vector<float, 1, 4> Std140Float;
+typedef Std140Vector<int32_t, 1, 4> Std140Int;    // bool 也按 int 传
+typedef Std140Vector<float, 2, 8> Std140Vec2;
+typedef Std140Vector<float, 3, 16> Std140Vec3;
+typedef Std140Vector<float, 4, 16> Std140Vec4;
+
+// 列主序矩阵，每列占一个 vec4
+template <int Columns, int Rows>
+struct Std140Matrix {
+    typedef float Component;
+    static const size_t ALIGN = 16;
+    static const size_t SIZE = 16 * Columns;
+    static const size_t COMPONENTS = Columns * Rows;
+
+    // 源数据为紧密排列的 Columns * Rows 个 float
+    static void write(unsigned char* dst, const float* src) {
+        writeColumns(dst, src, Rows);
+    }
+
+    // 源数据每列 srcStride 个 float（例如已经按 std140 展开的 mat3 为 4），列尾的填充不写
+    static void writeColumns(unsigned char* dst, const float* src, int srcStride) {
+        for (int column = 0; column < Columns; column++) {
+            memcpy(dst + column * 16, src + column * srcStride, Rows * sizeof(float));
+        }
+    }
+};
+
+typedef Std140Matrix<3, 3> Std140Mat3;
+typedef Std140Matrix<4, 4> Std140Mat4;
+
+// 数组：元素步长向上取整到 16 字节，源数据为依次紧密排列的各元素
+template <typename Element, size_t Count>
+struct Std140Array {
+    typedef typename Element::Component Component;
+    static const size_t STRIDE = std140_detail::alignUp(Element::SIZE, 16);
+    static const size_t ALIGN = 16;
+    static const size_t SIZE = STRIDE * Count;
+    static const size_t COMPONENTS = Element::COMPONENTS * Count;
+
+    static void write(unsigned char* dst, const Component* src) {
+        for (size_t i = 0; i < Count; i++) {
+            Element::write(dst + i * STRIDE, src + i * Element::COMPONENTS);
+        }
+    }
+};
+
+template <typename... Members>
+struct Std140Block {
+    static const size_t COUNT = sizeof...(Members);
+    // 最后一个成员之后向上取整到 16 字节，驱动报告的 GL_UNIFORM_BLOCK_DATA_SIZE 不会超过它
+    static const size_t SIZE = std140_detail::alignUp(std140_detail::EndOf<0, Members...>::VALUE, 16);
+
+    // Member<I>::Type、Member<I>::OFFSET
+    template <size_t I>
+    struct Member : std140_detail::MemberAt<0, I, Members...> {
+    };
+
+    // 把第 I 个成员写进 block（至少 SIZE 字节）
+    template <size_t I>
+    static void write(unsigned char* block, const typename Member<I>::Type::Component* src) {
+        Member<I>::Type::write(block + Member<I>::OFFSET, src);
+    }
+
+    // 运行时按下标取偏移，供链接后的核对使用
+    static size_t offset(size_t index) {
+        static const size_t aligns[] = {Members::ALIGN...};
+        static const size_t sizes[] = {Members::SIZE...};
+        size_t result = 0;
+        for (size_t i = 0; i < index; i++) {
+            result = std140_detail::alignUp(result, aligns[i]) + sizes[i];
+        }
+        return std140_detail::alignUp(result, aligns[index]);
+    }
+};
+
+// 链接后核对：members 为各成员的 uniform 句柄（顺序与 Layout 一致），结果见 verifyUniformBlockLayout
+template <typename Layout>
+bool verifyStd140Layout(GLuint program, BlockHandle block, const UniformHandle (&members)[Layout::COUNT]) {
+    size_t offsets[Layout::COUNT];
+    for (size_t i = 0; i < Layout::COUNT; i++) {
+        offsets[i] = Layout::offset(i);
+    }
+    return verifyUniformBlockLayout(program, block, members, offsets, (int)Layout::COUNT, Layout::SIZE);
+}
+
+#endif //NDKLEARN2_STD140_LAYOUT_H
@@ -0,0 +1,244 @@
+//
+// Created by zhangx on 2026/10/16.
+// 流式环形缓冲 - 分配、映射和按帧的 fence 回收
+//
+
+#include "stream_buffer.h"
+#include "opengl_utils.h"
+#include "gl_trace.h"
+#include <android/log.h>
+#include <chrono>
+#include <cstring>
+#include <deque>
+
+#define LOG_TAG "StreamBuffer"
+#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
+#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
+
+// 环形缓冲固定绑定在 COPY_READ 上映射：它同时是 streamBufferUpload 的复制源，
+// COPY_WRITE 留给复制目标（网格池也用它上传）
+static const GLenum STREAM_TARGET = GL_COPY_READ_BUFFER;
+// 等待 fence 时每次的超时，超时后继续等，只在 GL_WAIT_FAILED 时放弃
+static const GLuint64 FENCE_WAIT_TIMEOUT_NS = 100000000;
+
+struct StreamFrame {
+    GLsync fence;
+    GLsizeiptr bytes;  // 这一帧占用的字节，fence 触发后归还
+};
+
+struct StreamBuffer {
+    GLuint buffer;
+    GLsizeiptr capacity;
+    GLsizeiptr uniformAlignment;
+    int framesInFlight;
+    GLsizeiptr head;        // 下一次分配的起点
+    GLsizeiptr used;        // 已结束但 GPU 可能还在读的帧 + 当前帧
+    GLsizeiptr frameBytes;  // 当前帧（还没有 fence）已占用的字节
+    std::deque<StreamFrame> frames;
+    bool mapped;
+    bool loggedFailure;     // 容量不够只报告一次，之后看 failures 统计
+    uint64_t allocations;
+    uint64_t bytes;
+    uint32_t wraps;
+    uint32_t stalls;
+    double stallMs;
+    uint32_t failures;
+};
+
+static GLsizeiptr alignUp(GLsizeiptr value, GLsizeiptr alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+// 等最老的一帧执行完并归还它的空间，fence 已经触发时不算停顿
+static void retireOldestFrame(StreamBuffer* stream) {
+    StreamFrame frame = stream->frames.front();
+    stream->frames.pop_front();
+    GLenum status = glClientWaitSync(frame.fence, 0, 0);
+    if (status == GL_TIMEOUT_EXPIRED) {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        do {
+            status = glClientWaitSync(frame.fence, GL_SYNC_FLUSH_COMMANDS_BIT, FENCE_WAIT_TIMEOUT_NS);
+        } while (status == GL_TIMEOUT_EXPIRED);
+        stream->stalls++;
+        stream->stallMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+    if (status == GL_WAIT_FAILED) {
+        LOGE("glClientWaitSync failed, reusing %d bytes without confirmation", (int)frame.bytes);
+    }
+    glDeleteSync(frame.fence);
+    stream->used -= frame.bytes;
+}
+
+StreamBuffer* createStreamBuffer(GLsizeiptr frameSize, int framesInFlight) {
+    if (frameSize <= 0 || framesInFlight <= 0) {
+        LOGE("Invalid stream buffer size %d x %d frames", (int)frameSize, framesInFlight);
+        return nullptr;
+    }
+    GLint alignment = 0;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+    StreamBuffer* stream = new StreamBuffer();
+    stream->uniformAlignment = alignment > 0 ? alignment : 256;
+    stream->capacity = alignUp(frameSize * framesInFlight, stream->uniformAlignment);
+    stream->framesInFlight = framesInFlight;
+    stream->head = 0;
+    stream->used = 0;
+    stream->frameBytes = 0;
+    stream->mapped = false;
+    stream->loggedFailure = false;
+    stream->allocations = 0;
+    stream->bytes = 0;
+    stream->wraps = 0;
+    stream->stalls = 0;
+    stream->stallMs = 0.0;
+    stream->failures = 0;
+    glGenBuffers(1, &stream->buffer);
+    cachedBindBuffer(STREAM_TARGET, stream->buffer);
+    glBufferData(STREAM_TARGET, stream->capacity, nullptr, GL_STREAM_DRAW);
+    LOGI("Stream buffer created: %d bytes, %d frames in flight, uniform alignment %d",
+         (int)stream->capacity, framesInFlight, (int)stream->uniformAlignment);
+    return stream;
+}
+
+void destroyStreamBuffer(StreamBuffer* stream) {
+    if (stream == nullptr) {
+        return;
+    }
+    if (stream->mapped) {
+        cachedBindBuffer(STREAM_TARGET, stream->buffer);
+        glUnmapBuffer(STREAM_TARGET);
+    }
+    for (size_t i = 0; i < stream->frames.size(); i++) {
+        glDeleteSync(stream->frames[i].fence);
+    }
+    cachedDeleteBuffers(1, &stream->buffer);
+    delete stream;
+}
+
+void abandonStreamBuffer(StreamBuffer* stream) {
+    delete stream;
+}
+
+GLsizeiptr streamBufferUniformAlignment(const StreamBuffer* stream) {
+    return stream->uniformAlignment;
+}
+
+void* streamBufferMap(StreamBuffer* stream, GLsizeiptr size, GLsizeiptr alignment, StreamRange* range) {
+    range->buffer = 0;
+    range->offset = 0;
+    range->size = 0;
+    if (stream->mapped) {
+        LOGE("Stream buffer is already mapped");
+        return nullptr;
+    }
+    if (alignment <= 0) {
+        alignment = 1;
+    }
+    // 放不下时跳过末尾剩下的部分，从开头分配；跳过的字节算在当前帧里，随这一帧的 fence 归还
+    GLsizeiptr offset = alignUp(stream->head, alignment);
+    bool wrap = offset + size > stream->capacity;
+    if (wrap) {
+        offset = 0;
+    }
+    GLsizeiptr needed = (wrap ? stream->capacity - stream->head : offset - stream->head) + size;
+    while (stream->used + needed > stream->capacity && !stream->frames.empty()) {
+        retireOldestFrame(stream);
+    }
+    if (size <= 0 || stream->used + needed > stream->capacity) {
+        stream->failures++;
+        if (!stream->loggedFailure) {
+            LOGE("Stream buffer exhausted: %d bytes requested, %d of %d used by the current frame",
+                 (int)size, (int)stream->frameBytes, (int)stream->capacity);
+            stream->loggedFailure = true;
+        }
+        return nullptr;
+    }
+    cachedBindBuffer(STREAM_TARGET, stream->buffer);
+    // 这段存储不在任何未完成的帧里，不需要驱动同步；INVALIDATE_RANGE 让驱动不必保留旧内容
+    void* data = glMapBufferRange(STREAM_TARGET, offset, size,
+                                  GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+    if (data == nullptr) {
+        stream->failures++;
+        LOGE("glMapBufferRange failed for %d bytes at %d", (int)size, (int)offset);
+        return nullptr;
+    }
+    if (wrap) {
+        stream->wraps++;
+    }
+    stream->head = offset + size;
+    stream->used += needed;
+    stream->frameBytes += needed;
+    stream->mapped = true;
+    stream->allocations++;
+    stream->bytes += (uint64_t)size;
+    range->buffer = stream->buffer;
+    range->offset = offset;
+    range->size = size;
+    return data;
+}
+
+bool streamBufferUnmap(StreamBuffer* stream) {
+    if (!stream->mapped) {
+        return false;
+    }
+    stream->mapped = false;
+    cachedBindBuffer(STREAM_TARGET, stream->buffer);
+    if (glUnmapBuffer(STREAM_TARGET) != GL_TRUE) {
+        LOGE("Stream buffer contents lost while mapped");
+        return false;
+    }
+    return true;
+}
+
+bool streamBufferWrite(StreamBuffer* stream, const void* data, GLsizeiptr size, GLsizeiptr alignment,
+                       StreamRange* range) {
+    void* mapped = streamBufferMap(stream, size, alignment, range);
+    if (mapped == nullptr) {
+        return false;
+    }
+    memcpy(mapped, data, (size_t)size);
+    if (!streamBufferUnmap(stream)) {
+        range->buffer = 0;
+        return false;
+    }
+    return true;
+}
+
+void streamBufferCopy(StreamBuffer* stream, GLintptr sourceOffset, GLuint buffer, GLintptr offset, GLsizeiptr size) {
+    cachedBindBuffer(STREAM_TARGET, stream->buffer);
+    cachedBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+    glCopyBufferSubData(STREAM_TARGET, GL_COPY_WRITE_BUFFER, sourceOffset, offset, size);
+}
+
+bool streamBufferUpload(StreamBuffer* stream, GLuint buffer, GLintptr offset, const void* data, GLsizeiptr size) {
+    StreamRange range;
+    // 复制没有对齐要求，按 4 字节对齐只为了让源地址整齐
+    if (!streamBufferWrite(stream, data, size, 4, &range)) {
+        return false;
+    }
+    streamBufferCopy(stream, range.offset, buffer, offset, size);
+    return true;
+}
+
+void streamBufferEndFrame(StreamBuffer* stream) {
+    if (stream->frameBytes > 0) {
+        StreamFrame frame = {glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0), stream->frameBytes};
+        stream->frames.push_back(frame);
+        stream->frameBytes = 0;
+    }
+    // 限制排队的 fence 数：GPU 落后超过 framesInFlight 帧时在这里等它
+    while ((int)stream->frames.size() > stream->framesInFlight) {
+        retireOldestFrame(stream);
+    }
+}
+
+void getStreamBufferStats(const StreamBuffer* stream, StreamBufferStats* stats) {
+    stats->capacity = (uint32_t)stream->capacity;
+    stats->used = (uint32_t)stream->used;
+    stats->pendingFrames = (uint32_t)stream->frames.size();
+    stats->allocations = stream->allocations;
+    stats->bytes = stream->bytes;
+    stats->wraps = stream->wraps;
+    stats->stalls = stream->stalls;
+    stats->stallMs = stream->stallMs;
+    stats->failures = stream->failures;
+}
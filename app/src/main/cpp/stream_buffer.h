@@ -0,0 +1,82 @@
+//
+// Created by zhangx on 2026/10/16.
+// 流式环形缓冲 - 每帧变化的数据（uniform、实例数据、动态顶点）从一个大 GL 缓冲中按环形顺序分配
+//
+// 写入用 glMapBufferRange(WRITE | INVALIDATE_RANGE | UNSYNCHRONIZED)：驱动不检查 GPU 是否还在读这段存储，
+// 映射不会等待，也没有 glBufferSubData 那样的额外复制。覆盖安全由缓冲自己保证：每帧结束时插入一个 fence，
+// 记下这一帧用掉的字节数，环形写指针追上还没执行完的帧时才等待最老的 fence（计为一次停顿）。
+// 排队的帧数超过 framesInFlight 时同样等待最老的一帧，fence 数量有上限。
+//
+// 分配出的范围可以直接作为 UBO（glBindBufferRange，对齐到 GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT）
+// 或顶点数据源使用，在 framesInFlight 帧之内有效；长期使用的数据用 streamBufferUpload 写入环形缓冲后
+// 再用 glCopyBufferSubData 在 GPU 上复制到目标缓冲，目标缓冲的更新同样不等待 GPU。
+// 只能在创建它的上下文所在线程使用，同一时间只能有一段处于映射状态。
+//
+
+#ifndef NDKLEARN2_STREAM_BUFFER_H
+#define NDKLEARN2_STREAM_BUFFER_H
+
+#include <GLES3/gl3.h>
+#include <stdint.h>
+
+struct StreamBuffer;
+
+// 环形缓冲中的一段；buffer 为 0 表示分配失败
+typedef struct {
+    GLuint buffer;
+    GLintptr offset;
+    GLsizeiptr size;
+} StreamRange;
+
+typedef struct {
+    uint32_t capacity;
+    uint32_t used;             // 还没确认 GPU 读完的字节（含对齐和回绕浪费的部分）
+    uint32_t pendingFrames;    // 还在排队的 fence
+    uint64_t allocations;      // 累计分配次数
+    uint64_t bytes;            // 累计分配的字节
+    uint32_t wraps;            // 写指针回到开头的次数
+    uint32_t stalls;           // fence 还没触发、CPU 阻塞等待的次数
+    double stallMs;            // 阻塞等待的总时间
+    uint32_t failures;         // 一帧的用量超过容量（或映射失败），调用方退回 glBufferSubData
+} StreamBufferStats;
+
+// 容量为 frameSize * framesInFlight，向上取整到 uniform 偏移对齐
+StreamBuffer* createStreamBuffer(GLsizeiptr frameSize, int framesInFlight);
+void destroyStreamBuffer(StreamBuffer* stream);
+// 上下文已经销毁（GL 对象随之失效）时使用：只释放 CPU 上的记录，不调用 GL
+void abandonStreamBuffer(StreamBuffer* stream);
+
+// GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT，创建时查询
+GLsizeiptr streamBufferUniformAlignment(const StreamBuffer* stream);
+
+// 分配 size 字节（起点对齐到 alignment）并映射，返回写指针，写完后调用 streamBufferUnmap。
+// 空间不够时等待最老的帧；当前帧自己已经占满容量或映射失败时返回 nullptr，range->buffer 为 0
+void* streamBufferMap(StreamBuffer* stream, GLsizeiptr size, GLsizeiptr alignment, StreamRange* range);
+// 映射期间存储内容丢失时返回 false，这一段的内容无效
+bool streamBufferUnmap(StreamBuffer* stream);
+// 分配并复制 data
+bool streamBufferWrite(StreamBuffer* stream, const void* data, GLsizeiptr size, GLsizeiptr alignment,
+                       StreamRange* range);
+// 把环形缓冲中 sourceOffset 处的 size 字节用 glCopyBufferSubData 复制到 buffer 的 offset 处
+// （环形缓冲绑定在 GL_COPY_READ_BUFFER，目标经过 GL_COPY_WRITE_BUFFER），sourceOffset 来自已解除映射的分配
+void streamBufferCopy(StreamBuffer* stream, GLintptr sourceOffset, GLuint buffer, GLintptr offset, GLsizeiptr size);
+// streamBufferWrite + streamBufferCopy
+bool streamBufferUpload(StreamBuffer* stream, GLuint buffer, GLintptr offset, const void* data, GLsizeiptr size);
+
+// 每帧的绘制提交完之后调用：为这一帧的分配插入 fence
+void streamBufferEndFrame(StreamBuffer* stream);
+
+void getStreamBufferStats(const StreamBuffer* stream, StreamBufferStats* stats);
+
+// 放在每帧入口函数开头，函数返回时（包括提前返回）结束这一帧；stream 为空时什么也不做
+struct StreamBufferFrameScope {
+    StreamBuffer* stream;
+    explicit StreamBufferFrameScope(StreamBuffer* frameStream) : stream(frameStream) {}
+    ~StreamBufferFrameScope() {
+        if (stream != nullptr) {
+            streamBufferEndFrame(stream);
+        }
+    }
+};
+
+#endif //NDKLEARN2_STREAM_BUFFER_H
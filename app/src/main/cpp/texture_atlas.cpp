@@ -0,0 +1,321 @@
+//
+// Created by zhangx on 2026/10/16.
+// 纹理数组图集实现
+//
+
+#include "texture_atlas.h"
+#include "opengl_utils.h"
+#include "mip_generator.h"
+#include "gl_trace.h"
+#include <android/log.h>
+#include <algorithm>
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+
+#define LOG_TAG "TextureAtlas"
+#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
+#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
+
+// 一行图块：高度在开辟时固定，x 为这一行已用到的位置
+struct AtlasShelf {
+    int y;
+    int height;
+    int x;
+};
+
+struct AtlasLayer {
+    std::vector<AtlasShelf> shelves;
+    int top;                           // 已开辟的行占用的高度
+    uint32_t lastUsedFrame;            // 0 表示从未使用
+    std::vector<AtlasHandle> handles;  // 这一层的有效句柄
+};
+
+struct AtlasEntry {
+    int layer;
+    int x, y;           // 第 0 级中图像（不含边框）的位置
+    int width, height;
+};
+
+struct TextureAtlas {
+    TextureAtlasConfig config;
+    GLuint texture;
+    int border;         // 边框宽度，也是图块位置和尺寸的对齐单位，保证每一级的图块都落在整像素上
+    uint32_t frame;
+    AtlasHandle nextHandle;
+    std::vector<AtlasLayer> layers;
+    std::unordered_map<AtlasHandle, AtlasEntry> entries;
+    uint32_t evictedLayers;
+    uint32_t evictedEntries;
+    std::vector<unsigned char> scratch;  // 加边框后的图块及其各级 mip
+};
+
+static size_t layerBytes(int size, int levels) {
+    size_t bytes = 0;
+    for (int level = 0; level < levels; level++) {
+        size_t side = (size_t)std::max(1, size >> level);
+        bytes += side * side * 4;
+    }
+    return bytes;
+}
+
+static void resetLayer(AtlasLayer* layer) {
+    layer->shelves.clear();
+    layer->top = 0;
+    layer->handles.clear();
+}
+
+// 在一层中找位置：先找高度够、浪费最少的已有行，返回行号；没有时返回行数（需要开新行），新行也放不下返回 -1
+static int findShelf(const AtlasLayer& layer, int layerSize, int width, int height) {
+    int best = -1;
+    for (size_t i = 0; i < layer.shelves.size(); i++) {
+        const AtlasShelf& shelf = layer.shelves[i];
+        if (shelf.height >= height && layerSize - shelf.x >= width &&
+            (best < 0 || shelf.height < layer.shelves[best].height)) {
+            best = (int)i;
+        }
+    }
+    if (best < 0 && layerSize - layer.top >= height) {
+        best = (int)layer.shelves.size();
+    }
+    return best;
+}
+
+static void placeInShelf(AtlasLayer* layer, int shelfIndex, int width, int height, int* x, int* y) {
+    if (shelfIndex == (int)layer->shelves.size()) {
+        AtlasShelf shelf = {layer->top, height, 0};
+        layer->shelves.push_back(shelf);
+        layer->top += height;
+    }
+    AtlasShelf& shelf = layer->shelves[shelfIndex];
+    *x = shelf.x;
+    *y = shelf.y;
+    shelf.x += width;
+}
+
+// 最久未使用、且本帧没用过的非空层；没有时返回 -1
+static int leastRecentlyUsedLayer(const TextureAtlas* atlas) {
+    int victim = -1;
+    for (size_t i = 0; i < atlas->layers.size(); i++) {
+        const AtlasLayer& layer = atlas->layers[i];
+        if (layer.handles.empty() || layer.lastUsedFrame == atlas->frame) {
+            continue;
+        }
+        if (victim < 0 || layer.lastUsedFrame < atlas->layers[victim].lastUsedFrame) {
+            victim = (int)i;
+        }
+    }
+    return victim;
+}
+
+static void evictLayer(TextureAtlas* atlas, int index) {
+    AtlasLayer& layer = atlas->layers[index];
+    for (size_t i = 0; i < layer.handles.size(); i++) {
+        atlas->entries.erase(layer.handles[i]);
+    }
+    atlas->evictedLayers++;
+    atlas->evictedEntries += (uint32_t)layer.handles.size();
+    resetLayer(&layer);
+}
+
+// 把图像复制到 slotWidth x slotHeight 的图块中间，四周重复边缘像素
+static void buildSlot(const unsigned char* src, int width, int height, int border, int slotWidth, int slotHeight,
+                      unsigned char* dst) {
+    for (int y = 0; y < slotHeight; y++) {
+        int sy = std::min(std::max(y - border, 0), height - 1);
+        const unsigned char* row = src + (size_t)sy * width * 4;
+        unsigned char* out = dst + (size_t)y * slotWidth * 4;
+        for (int x = 0; x < border; x++) {
+            memcpy(out + x * 4, row, 4);
+        }
+        memcpy(out + border * 4, row, (size_t)width * 4);
+        for (int x = border + width; x < slotWidth; x++) {
+            memcpy(out + x * 4, row + (size_t)(width - 1) * 4, 4);
+        }
+    }
+}
+
+// 生成图块的各级 mip 并上传到 (x, y, layer)；图块位置和尺寸都是 2^(levels-1) 的倍数，每一级都不用取整
+static void uploadSlot(TextureAtlas* atlas, const unsigned char* pixels, int width, int height, int slotWidth,
+                       int slotHeight, int x, int y, int layer) {
+    int levels = atlas->config.levels;
+    size_t total = 0;
+    for (int level = 0; level < levels; level++) {
+        total += (size_t)(slotWidth >> level) * (slotHeight >> level) * 4;
+    }
+    atlas->scratch.resize(total);
+    unsigned char* data = atlas->scratch.data();
+    buildSlot(pixels, width, height, atlas->border, slotWidth, slotHeight, data);
+
+    cachedBindTexture(GL_TEXTURE_2D_ARRAY, atlas->texture);
+    for (int level = 0; level < levels; level++) {
+        int levelWidth = slotWidth >> level;
+        int levelHeight = slotHeight >> level;
+        glTexSubImage3D(GL_TEXTURE_2D_ARRAY, level, x >> level, y >> level, layer, levelWidth, levelHeight, 1,
+                        GL_RGBA, GL_UNSIGNED_BYTE, data);
+        if (level + 1 < levels) {
+            unsigned char* next = data + (size_t)levelWidth * levelHeight * 4;
+            downsampleRGBA8(data, levelWidth, levelHeight, MIP_COLOR_SRGB, next);
+            data = next;
+        }
+    }
+    logGLError(LOG_TAG, "atlas upload");
+}
+
+TextureAtlas* createTextureAtlas(const TextureAtlasConfig& config) {
+    GLint maxSize = 0;
+    GLint maxLayers = 0;
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxSize);
+    glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &maxLayers);
+    if (config.layerSize <= 0 || config.layerSize > maxSize || config.levels < 1 ||
+        config.levels > mipLevelCount(config.layerSize, config.layerSize)) {
+        LOGE("Invalid atlas layer size %d with %d levels (max size %d)", config.layerSize, config.levels, maxSize);
+        return nullptr;
+    }
+    size_t bytesPerLayer = layerBytes(config.layerSize, config.levels);
+    int layerCount = (int)std::min(config.budgetBytes / bytesPerLayer, (size_t)maxLayers);
+    if (layerCount < 1) {
+        LOGE("Atlas budget of %zu bytes is smaller than one %dx%d layer (%zu bytes)",
+             config.budgetBytes, config.layerSize, config.layerSize, bytesPerLayer);
+        return nullptr;
+    }
+
+    TextureAtlas* atlas = new TextureAtlas();
+    atlas->config = config;
+    atlas->border = 1 << (config.levels - 1);
+    atlas->frame = 1;
+    atlas->nextHandle = 1;
+    atlas->layers.resize(layerCount);
+    for (int i = 0; i < layerCount; i++) {
+        resetLayer(&atlas->layers[i]);
+        atlas->layers[i].lastUsedFrame = 0;
+    }
+    atlas->evictedLayers = 0;
+    atlas->evictedEntries = 0;
+
+    glGenTextures(1, &atlas->texture);
+    cachedBindTexture(GL_TEXTURE_2D_ARRAY, atlas->texture);
+    glTexStorage3D(GL_TEXTURE_2D_ARRAY, config.levels, GL_RGBA8, config.layerSize, config.layerSize, layerCount);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER,
+                    config.levels > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    logGLError(LOG_TAG, "atlas storage");
+    LOGI("Texture atlas: %d layers of %dx%d, %d levels, %zu bytes", layerCount, config.layerSize,
+         config.layerSize, config.levels, bytesPerLayer * layerCount);
+    return atlas;
+}
+
+void destroyTextureAtlas(TextureAtlas* atlas) {
+    if (atlas == nullptr) {
+        return;
+    }
+    cachedDeleteTextures(1, &atlas->texture);
+    delete atlas;
+}
+
+void atlasBeginFrame(TextureAtlas* atlas) {
+    atlas->frame++;
+}
+
+AtlasHandle atlasAdd(TextureAtlas* atlas, const void* pixels, int width, int height) {
+    int align = atlas->border;
+    int slotWidth = (width + 2 * atlas->border + align - 1) / align * align;
+    int slotHeight = (height + 2 * atlas->border + align - 1) / align * align;
+    int layerSize = atlas->config.layerSize;
+    if (width <= 0 || height <= 0 || slotWidth > layerSize || slotHeight > layerSize) {
+        LOGE("Image %dx%d does not fit in a %dx%d atlas layer", width, height, layerSize, layerSize);
+        return 0;
+    }
+
+    // 先放进最近用过的非空层，新图和同一时期的图放在一起，之后一起被淘汰；都放不下再用空层，最后才淘汰
+    int layer = -1;
+    int shelf = -1;
+    int emptyLayer = -1;
+    for (size_t i = 0; i < atlas->layers.size(); i++) {
+        const AtlasLayer& candidate = atlas->layers[i];
+        if (candidate.handles.empty()) {
+            if (emptyLayer < 0) emptyLayer = (int)i;
+            continue;
+        }
+        if (layer >= 0 && candidate.lastUsedFrame <= atlas->layers[layer].lastUsedFrame) {
+            continue;
+        }
+        int index = findShelf(candidate, layerSize, slotWidth, slotHeight);
+        if (index >= 0) {
+            layer = (int)i;
+            shelf = index;
+        }
+    }
+    if (layer < 0) {
+        layer = emptyLayer >= 0 ? emptyLayer : leastRecentlyUsedLayer(atlas);
+        if (layer < 0) {
+            LOGE("Atlas is full with layers used in this frame, %dx%d image rejected", width, height);
+            return 0;
+        }
+        if (layer != emptyLayer) {
+            evictLayer(atlas, layer);
+        }
+        shelf = 0;
+    }
+    AtlasLayer& target = atlas->layers[layer];
+    int x = 0;
+    int y = 0;
+    placeInShelf(&target, shelf, slotWidth, slotHeight, &x, &y);
+    uploadSlot(atlas, (const unsigned char*)pixels, width, height, slotWidth, slotHeight, x, y, layer);
+
+    AtlasHandle handle = atlas->nextHandle++;
+    if (atlas->nextHandle == 0) {
+        atlas->nextHandle = 1;
+    }
+    AtlasEntry entry = {layer, x + atlas->border, y + atlas->border, width, height};
+    atlas->entries[handle] = entry;
+    target.handles.push_back(handle);
+    target.lastUsedFrame = atlas->frame;
+    return handle;
+}
+
+bool atlasLookup(TextureAtlas* atlas, AtlasHandle handle, AtlasRegion* region) {
+    std::unordered_map<AtlasHandle, AtlasEntry>::const_iterator it = atlas->entries.find(handle);
+    if (it == atlas->entries.end()) {
+        return false;
+    }
+    const AtlasEntry& entry = it->second;
+    atlas->layers[entry.layer].lastUsedFrame = atlas->frame;
+    float scale = 1.0f / (float)atlas->config.layerSize;
+    region->texture = atlas->texture;
+    region->layer = entry.layer;
+    region->uvRect[0] = entry.x * scale;
+    region->uvRect[1] = entry.y * scale;
+    region->uvRect[2] = (entry.x + entry.width) * scale;
+    region->uvRect[3] = (entry.y + entry.height) * scale;
+    return true;
+}
+
+void atlasRemove(TextureAtlas* atlas, AtlasHandle handle) {
+    std::unordered_map<AtlasHandle, AtlasEntry>::iterator it = atlas->entries.find(handle);
+    if (it == atlas->entries.end()) {
+        return;
+    }
+    AtlasLayer& layer = atlas->layers[it->second.layer];
+    atlas->entries.erase(it);
+    layer.handles.erase(std::find(layer.handles.begin(), layer.handles.end(), handle));
+    if (layer.handles.empty()) {
+        resetLayer(&layer);
+    }
+}
+
+void getTextureAtlasStats(const TextureAtlas* atlas, TextureAtlasStats* stats) {
+    stats->layers = (int)atlas->layers.size();
+    stats->usedLayers = 0;
+    for (size_t i = 0; i < atlas->layers.size(); i++) {
+        if (!atlas->layers[i].handles.empty()) {
+            stats->usedLayers++;
+        }
+    }
+    stats->entries = (int)atlas->entries.size();
+    stats->textureBytes = layerBytes(atlas->config.layerSize, atlas->config.levels) * atlas->layers.size();
+    stats->evictedLayers = atlas->evictedLayers;
+    stats->evictedEntries = atlas->evictedEntries;
+}
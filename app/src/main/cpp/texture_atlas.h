@@ -0,0 +1,67 @@
+//
+// Created by zhangx on 2026/10/16.
+// 纹理数组图集 - 把同格式（RGBA8）的小图打包进一个 GL_TEXTURE_2D_ARRAY 的各层，
+// 返回句柄，查询得到（层号，UV 矩形），多个物体绑定一次纹理即可绘制
+//
+// 显存预算在创建时换算成层数并一次分配好不可变存储，之后显存占用不再增长；
+// 放不下新图时淘汰最久未使用的一层（整层清空，层内的句柄全部失效），本帧用过的层不淘汰。
+// 每层用 shelf 算法排布，图块之间留出复制边缘像素的边框，低级 mip 不会混入相邻图块的颜色。
+// 着色器中的用法：
+//   uniform highp sampler2DArray uAtlas;
+//   texture(uAtlas, vec3(mix(region.uvRect.xy, region.uvRect.zw, uv), float(region.layer)))
+// 所有函数只在有 GL 上下文的渲染线程调用
+//
+
+#ifndef NDKLEARN2_TEXTURE_ATLAS_H
+#define NDKLEARN2_TEXTURE_ATLAS_H
+
+#include <GLES3/gl3.h>
+#include <stddef.h>
+#include <stdint.h>
+
+struct TextureAtlasConfig {
+    int layerSize;       // 每层的边长（像素）
+    int levels;          // mip 级数，1 表示不要 mip；级数越多图块之间的边框越宽（2^(levels-1) 像素）
+    size_t budgetBytes;  // 显存预算（含 mip），决定层数，至少要放得下一层
+};
+
+// 0 为无效句柄
+typedef uint32_t AtlasHandle;
+
+struct AtlasRegion {
+    GLuint texture;      // GL_TEXTURE_2D_ARRAY
+    int layer;
+    float uvRect[4];     // u0, v0, u1, v1，不含边框
+};
+
+struct TextureAtlasStats {
+    int layers;                // 分配的层数
+    int usedLayers;            // 有图块的层数
+    int entries;               // 有效句柄数
+    size_t textureBytes;       // 纹理数组的显存（含 mip）
+    uint32_t evictedLayers;    // 累计淘汰的层数
+    uint32_t evictedEntries;   // 累计因淘汰失效的句柄数
+};
+
+struct TextureAtlas;
+
+// 按预算分配纹理数组，层数受 GL_MAX_ARRAY_TEXTURE_LAYERS 限制；失败时返回 nullptr
+TextureAtlas* createTextureAtlas(const TextureAtlasConfig& config);
+void destroyTextureAtlas(TextureAtlas* atlas);
+
+// 帧开始时调用，之后的 atlasAdd / atlasLookup 记为这一帧的使用
+void atlasBeginFrame(TextureAtlas* atlas);
+
+// 复制 RGBA8 像素（行紧密排列，按 sRGB 颜色生成 mip）并同步上传，返回后即可释放 pixels。
+// 没有空间时淘汰最久未使用的层；图块（含边框）大于一层或本帧已用满全部层时返回 0
+AtlasHandle atlasAdd(TextureAtlas* atlas, const void* pixels, int width, int height);
+
+// 查询并标记使用：句柄已失效（被淘汰或移除）时返回 false，调用方重新 atlasAdd
+bool atlasLookup(TextureAtlas* atlas, AtlasHandle handle, AtlasRegion* region);
+
+// 移除图块；层内的图块全部移除后，这一层的空间重新可用
+void atlasRemove(TextureAtlas* atlas, AtlasHandle handle);
+
+void getTextureAtlasStats(const TextureAtlas* atlas, TextureAtlasStats* stats);
+
+#endif //NDKLEARN2_TEXTURE_ATLAS_H
@@ -0,0 +1,603 @@
+//
+// Created by zhangx on 2026/10/16.
+// 异步纹理加载实现
+//
+
+#include "texture_loader.h"
+#include "shared_context.h"
+#include "opengl_utils.h"
+#include "mip_generator.h"
+#include "gl_trace.h"
+#include <android/log.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <stdint.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define LOG_TAG "TextureLoader"
+#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
+#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
+
+// 一个上传请求
+struct UploadJob {
+    std::vector<unsigned char> pixels;  // image 描述的各级数据；像素请求提交时只有第 0 级，KTX 请求为整个文件
+    KTXImage image;                     // 各级的格式、尺寸和相对 pixels 开头的偏移
+    bool generateMips;                  // 上传前在 CPU 上生成 mip 链（按 sRGB 颜色处理）
+    int encodeQuality;                  // 上传前编码为 ETC2 的档位（ETC2Quality），-1 表示不编码
+    std::string cachePath;              // 非空时把最终的各级数据写成 KTX 文件，下次直接加载
+    size_t streamingBudget;             // 提交时的每帧流式上传预算，0 表示一次上传全部级别
+    std::promise<TextureUpload> result;
+};
+
+// 还没上传完全部级别的纹理：保留各级数据，渲染线程每帧从 baseLevel - 1 级开始按预算往上补
+struct TextureStream {
+    GLuint texture;
+    std::vector<unsigned char> pixels;
+    KTXImage image;
+    int baseLevel;   // 已上传的最大一级，即纹理的 GL_TEXTURE_BASE_LEVEL
+    int nextRow;     // baseLevel - 1 级已上传的像素行数
+    bool ready;      // pollTexture 已取回纹理（fence 已触发），渲染线程可以继续上传
+};
+
+static struct {
+    SharedContext shared;      // 工作线程的上下文，与渲染线程的上下文共享对象
+    std::thread worker;
+    std::mutex mutex;
+    std::condition_variable cond;
+    std::condition_variable idleCond;  // 队列清空且没有正在上传的请求时通知
+    std::deque<UploadJob*> jobs;
+    int uploading;                     // 工作线程已取出、还没完成的请求数
+    bool running;
+    GLuint pbo;                        // 只在工作线程访问
+} gLoader = {{EGL_NO_DISPLAY, EGL_NO_CONTEXT, EGL_NO_CONTEXT, EGL_NO_SURFACE}};
+
+static std::atomic<int> gCompressionQuality(-1);  // 运行时压缩档位，-1 表示关闭
+static std::atomic<size_t> gStreamingBudget(1024 * 1024);
+
+// 工作线程创建，渲染线程上传和删除
+static struct {
+    std::mutex mutex;
+    std::vector<TextureStream*> streams;
+} gStreams;
+
+// discardTexture 放弃时还没上传完的请求，只在渲染线程访问：上传完成后由 pollTexture 删除纹理和 fence
+static std::vector<TextureFuture> gDiscarded;
+
+// 把 pixels 从 begin 开始的数据写进 PIXEL_UNPACK_BUFFER，成功时缓冲区保持绑定，
+// glTexSubImage2D 的像素参数变成缓冲区偏移
+static bool stagePixels(const UploadJob& job, size_t begin) {
+    if (gLoader.pbo == 0) {
+        glGenBuffers(1, &gLoader.pbo);
+    }
+    cachedBindBuffer(GL_PIXEL_UNPACK_BUFFER, gLoader.pbo);
+    // 每次重新分配存储：上一次上传如果还在读旧存储，驱动换一块新的，不必等它
+    GLsizeiptr size = (GLsizeiptr)(job.pixels.size() - begin);
+    glBufferData(GL_PIXEL_UNPACK_BUFFER, size, nullptr, GL_STREAM_DRAW);
+    void* mapped = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size,
+                                    GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+    if (mapped != nullptr) {
+        memcpy(mapped, job.pixels.data() + begin, (size_t)size);
+        // 映射期间存储内容丢失（例如显存被回收）时返回 GL_FALSE
+        if (glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER) == GL_TRUE) {
+            return true;
+        }
+    }
+    LOGE("Failed to stage %dx%d texture (%zu bytes) in the unpack buffer, uploading from client memory",
+         job.image.width, job.image.height, (size_t)size);
+    cachedBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    return false;
+}
+
+// 把各级 RGBA8 数据编码为 ETC2，替换 pixels 和 image，之后按压缩纹理上传
+static void encodeJob(UploadJob* job) {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    const KTXImage& source = job->image;
+    bool alpha = etc2NeedsAlpha(job->pixels.data() + source.levels[0].offset, source.width, source.height);
+    std::vector<unsigned char> encoded;
+    KTXImage image;
+    encodeETC2Levels(job->pixels.data(), source, alpha, (ETC2Quality)job->encodeQuality, &encoded, &image);
+    LOGI("Encoded %dx%d texture to %s (%d levels, %zu bytes) in %.1f ms", image.width, image.height,
+         textureFormatName(image.internalFormat), image.levelCount, encoded.size(),
+         std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+    job->pixels.swap(encoded);
+    job->image = image;
+}
+
+// 先写临时文件再改名，进程中途被杀也不会留下半个缓存
+static void writeTextureCache(const UploadJob& job) {
+    std::vector<unsigned char> file;
+    if (!writeKTX(job.image, job.pixels.data(), &file)) {
+        return;
+    }
+    std::string temporary = job.cachePath + ".tmp";
+    FILE* out = fopen(temporary.c_str(), "wb");
+    bool written = out != nullptr && fwrite(file.data(), 1, file.size(), out) == file.size();
+    written = out != nullptr && fclose(out) == 0 && written;
+    if (!written || rename(temporary.c_str(), job.cachePath.c_str()) != 0) {
+        LOGE("Failed to write texture cache %s", job.cachePath.c_str());
+        remove(temporary.c_str());
+        return;
+    }
+    LOGI("Cached %dx%d %s texture with %d levels in %s (%zu bytes)", job.image.width, job.image.height,
+         textureFormatName(job.image.internalFormat), job.image.levelCount, job.cachePath.c_str(), file.size());
+}
+
+// 上传前的 CPU 处理（工作线程上，或同步上传时的调用线程上）：生成 mip 链、编码、写缓存
+static void prepareJob(UploadJob* job) {
+    if (job->generateMips) {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        generateMipChain(&job->pixels, job->image.internalFormat, job->image.width, job->image.height, MIP_COLOR_SRGB,
+                         &job->image);
+        LOGI("Generated %d mip levels for %dx%d texture in %.1f ms", job->image.levelCount, job->image.width,
+             job->image.height,
+             std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+    }
+    if (job->encodeQuality >= 0) {
+        encodeJob(job);
+    }
+    if (!job->cachePath.empty()) {
+        writeTextureCache(*job);
+    }
+}
+
+// 流式上传时加载阶段先上传的第一级：从最小一级往上累加，总量不超过预算（至少上传最小一级）
+static int firstStreamedLevel(const KTXImage& image, size_t budget) {
+    if (budget == 0) {
+        return 0;
+    }
+    int level = image.levelCount - 1;
+    size_t total = image.levels[level].size;
+    while (level > 0 && total + image.levels[level - 1].size <= budget) {
+        level--;
+        total += image.levels[level].size;
+    }
+    return level;
+}
+
+// 在当前上下文中创建不可变存储的纹理，上传 firstLevel 及更小的级别，staged 为 true 时经 PBO 上传
+static GLuint uploadTexture(const UploadJob& job, int firstLevel, bool staged) {
+    GLuint texture = 0;
+    glGenTextures(1, &texture);
+    cachedBindTexture(GL_TEXTURE_2D, texture);
+
+    const KTXImage& image = job.image;
+    // PBO 从偏移 0 开始存放 pixels 中 firstLevel 及之后的内容，这时像素参数是缓冲区内偏移
+    size_t begin = image.levels[firstLevel].offset;
+    const unsigned char* base = job.pixels.data();
+    if (staged && stagePixels(job, begin)) {
+        base = nullptr;
+    }
+    GLenum format = 0;
+    GLenum type = 0;
+    int bytesPerPixel = 0;
+    bool compressed = !uncompressedFormatInfo(image.internalFormat, &format, &type, &bytesPerPixel);
+    if (!compressed) {
+        // 各级的行都补齐到 4 字节（textureRowSize），RGB565 / R8 的奇数宽度依赖这个对齐
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    }
+    glTexStorage2D(GL_TEXTURE_2D, image.levelCount, image.internalFormat, image.width, image.height);
+    for (int level = firstLevel; level < image.levelCount; level++) {
+        const KTXLevel& info = image.levels[level];
+        const void* data = base != nullptr ? (const void*)(base + info.offset) : (const void*)(info.offset - begin);
+        if (compressed) {
+            glCompressedTexSubImage2D(GL_TEXTURE_2D, level, 0, 0, info.width, info.height, image.internalFormat,
+                                      (GLsizei)info.size, data);
+        } else {
+            glTexSubImage2D(GL_TEXTURE_2D, level, 0, 0, info.width, info.height, format, type, data);
+        }
+    }
+    if (base == nullptr) {
+        cachedBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    }
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, image.levelCount > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    if (firstLevel > 0) {
+        // 采样只用已上传的级别，纹理是完整的，可以立即绘制
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, firstLevel);
+    }
+    if (image.internalFormat == GL_R8) {
+        // alpha 遮罩：四个通道都取覆盖率，与预乘 alpha 的 RGBA 纹理一样使用
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_G, GL_RED);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_B, GL_RED);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_A, GL_RED);
+    }
+    cachedBindTexture(GL_TEXTURE_2D, 0);
+    logGLError(LOG_TAG, compressed ? "compressed texture upload" : "texture upload");
+    return texture;
+}
+
+// 上传后调用：还有没上传的级别时把数据交给流式上传，渲染线程取回纹理后继续
+static void beginTextureStream(UploadJob* job, GLuint texture, int firstLevel) {
+    if (firstLevel == 0 || texture == 0) {
+        return;
+    }
+    TextureStream* stream = new TextureStream();
+    stream->texture = texture;
+    stream->pixels.swap(job->pixels);
+    stream->image = job->image;
+    stream->baseLevel = firstLevel;
+    stream->nextRow = 0;
+    stream->ready = false;
+    LOGI("Streaming %dx%d texture %u from level %d (%dx%d)", job->image.width, job->image.height, texture,
+         firstLevel, job->image.levels[firstLevel].width, job->image.levels[firstLevel].height);
+    std::lock_guard<std::mutex> lock(gStreams.mutex);
+    gStreams.streams.push_back(stream);
+}
+
+// 渲染上下文重建时调用：旧纹理已失效，丢掉全部流式上传记录
+static void clearTextureStreams() {
+    std::lock_guard<std::mutex> lock(gStreams.mutex);
+    for (size_t i = 0; i < gStreams.streams.size(); i++) {
+        delete gStreams.streams[i];
+    }
+    gStreams.streams.clear();
+}
+
+static void workerLoop() {
+    makeSharedContextCurrent(gLoader.shared);
+    gLoader.pbo = 0;
+
+    while (true) {
+        UploadJob* job = nullptr;
+        {
+            std::unique_lock<std::mutex> lock(gLoader.mutex);
+            gLoader.cond.wait(lock, [] { return !gLoader.running || !gLoader.jobs.empty(); });
+            if (!gLoader.running) {
+                break;
+            }
+            job = gLoader.jobs.front();
+            gLoader.jobs.pop_front();
+            gLoader.uploading++;
+        }
+
+        prepareJob(job);
+        int firstLevel = firstStreamedLevel(job->image, job->streamingBudget);
+        TextureUpload upload;
+        upload.texture = uploadTexture(*job, firstLevel, true);
+        beginTextureStream(job, upload.texture, firstLevel);
+        // 不在这里等待：渲染线程每帧非阻塞地检查 fence，触发后重新绑定纹理即可看到完整内容
+        upload.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        glFlush();
+
+        job->result.set_value(upload);
+        delete job;
+        {
+            std::lock_guard<std::mutex> lock(gLoader.mutex);
+            gLoader.uploading--;
+        }
+        gLoader.idleCond.notify_all();
+    }
+
+    if (gLoader.pbo != 0) {
+        glDeleteBuffers(1, &gLoader.pbo);
+        gLoader.pbo = 0;
+    }
+    releaseSharedContext(gLoader.shared);
+}
+
+bool startTextureLoader() {
+    EGLContext shareContext = eglGetCurrentContext();
+    if (shareContext == EGL_NO_CONTEXT) {
+        LOGE("No current EGL context, textures will upload on the calling thread");
+        return false;
+    }
+    if (gLoader.running && gLoader.shared.shareContext == shareContext) {
+        return true;
+    }
+    // 渲染上下文被重建，旧工作线程的共享组已失效，旧纹理也不再继续流式上传
+    stopTextureLoader();
+    clearTextureStreams();
+    gDiscarded.clear();
+
+    if (!createSharedContext(&gLoader.shared, "texture loader")) {
+        return false;
+    }
+    gLoader.uploading = 0;
+    gLoader.running = true;
+    gLoader.worker = std::thread(workerLoop);
+    LOGI("Texture loader started");
+    return true;
+}
+
+void stopTextureLoader() {
+    if (!gLoader.worker.joinable()) {
+        return;
+    }
+    std::deque<UploadJob*> pending;
+    {
+        std::lock_guard<std::mutex> lock(gLoader.mutex);
+        gLoader.running = false;
+        pending.swap(gLoader.jobs);
+    }
+    gLoader.cond.notify_all();
+    gLoader.idleCond.notify_all();
+    gLoader.worker.join();
+
+    for (size_t i = 0; i < pending.size(); i++) {
+        TextureUpload failed = {0, 0};
+        pending[i]->result.set_value(failed);
+        delete pending[i];
+    }
+    destroySharedContext(&gLoader.shared);
+    LOGI("Texture loader stopped");
+}
+
+// 交给工作线程，加载器未启动或正在录制 GL 命令时在当前上下文同步上传
+static TextureFuture submitJob(UploadJob* job) {
+    job->streamingBudget = gStreamingBudget.load(std::memory_order_relaxed);
+    TextureFuture future = job->result.get_future().share();
+    {
+        std::lock_guard<std::mutex> lock(gLoader.mutex);
+        // 录制 GL 命令时在录制线程上同步上传，工作线程上的调用录不到
+        if (gLoader.running && !glTraceCapturing()) {
+            gLoader.jobs.push_back(job);
+            job = nullptr;
+        }
+    }
+    if (job == nullptr) {
+        gLoader.cond.notify_one();
+        return future;
+    }
+
+    // 同步上传不经过 PBO，不需要 fence
+    prepareJob(job);
+    int firstLevel = firstStreamedLevel(job->image, job->streamingBudget);
+    TextureUpload upload = {uploadTexture(*job, firstLevel, false), 0};
+    beginTextureStream(job, upload.texture, firstLevel);
+    job->result.set_value(upload);
+    delete job;
+    return future;
+}
+
+// 第 0 级为复制的像素（各行补齐到 4 字节，不转换格式），mip 链和编码留给 prepareJob
+static UploadJob* newPixelJob(const TexturePixels& pixels, int bytesPerPixel, bool mipmaps) {
+    UploadJob* job = new UploadJob();
+    size_t rowSize = textureRowSize(pixels.internalFormat, pixels.width);
+    const unsigned char* src = (const unsigned char*)pixels.data;
+    if ((size_t)pixels.stride == rowSize) {
+        job->pixels.assign(src, src + rowSize * pixels.height);
+    } else {
+        job->pixels.resize(rowSize * pixels.height);
+        for (int y = 0; y < pixels.height; y++) {
+            memcpy(&job->pixels[rowSize * y], src + (size_t)pixels.stride * y, (size_t)pixels.width * bytesPerPixel);
+        }
+    }
+    memset(&job->image, 0, sizeof(job->image));
+    job->image.internalFormat = pixels.internalFormat;
+    job->image.width = pixels.width;
+    job->image.height = pixels.height;
+    job->image.levelCount = 1;
+    KTXLevel level = {0, (uint32_t)job->pixels.size(), pixels.width, pixels.height};
+    job->image.levels[0] = level;
+    job->generateMips = mipmaps && (pixels.width > 1 || pixels.height > 1);
+    // ETC2 编码器的输入是 RGBA8，其它格式按原格式上传
+    job->encodeQuality = pixels.internalFormat == GL_RGBA8 ? gCompressionQuality.load(std::memory_order_relaxed) : -1;
+    return job;
+}
+
+TextureFuture requestPixelsTextureAsync(const TexturePixels& pixels, bool mipmaps, const char* cachePath) {
+    GLenum format, type;
+    int bytesPerPixel = 0;
+    if (!uncompressedFormatInfo(pixels.internalFormat, &format, &type, &bytesPerPixel) || pixels.width <= 0
+        || pixels.height <= 0 || pixels.stride < pixels.width * bytesPerPixel) {
+        LOGE("Unsupported %dx%d texture (format 0x%x, stride %d)", pixels.width, pixels.height,
+             pixels.internalFormat, pixels.stride);
+        return TextureFuture();
+    }
+    UploadJob* job = newPixelJob(pixels, bytesPerPixel, mipmaps || cachePath != nullptr);
+    if (cachePath != nullptr) {
+        job->cachePath = cachePath;
+    }
+    return submitJob(job);
+}
+
+TextureFuture requestTextureAsync(const void* pixels, int width, int height, bool mipmaps) {
+    TexturePixels rgba = {pixels, GL_RGBA8, width, height, width * 4};
+    return requestPixelsTextureAsync(rgba, mipmaps, nullptr);
+}
+
+TextureFuture requestCachedTextureAsync(const void* pixels, int width, int height, const char* cachePath) {
+    TexturePixels rgba = {pixels, GL_RGBA8, width, height, width * 4};
+    return requestPixelsTextureAsync(rgba, true, cachePath);
+}
+
+TextureFuture requestKTXTextureAsync(const void* data, size_t size, const KTXImage& image) {
+    UploadJob* job = new UploadJob();
+    job->pixels.assign((const unsigned char*)data, (const unsigned char*)data + size);
+    job->image = image;
+    job->generateMips = false;
+    job->encodeQuality = -1;
+    return submitJob(job);
+}
+
+// 删除已经就绪的上传结果
+static void deleteUpload(const TextureUpload& upload) {
+    if (upload.fence != 0) {
+        glDeleteSync(upload.fence);
+    }
+    if (upload.texture != 0) {
+        GLuint texture = upload.texture;
+        stopTextureStreaming(texture);
+        cachedDeleteTextures(1, &texture);
+    }
+}
+
+// 删除放弃的请求中已经上传完的；wait 为 true 时等待其余的上传结束
+static void collectDiscardedTextures(bool wait) {
+    size_t kept = 0;
+    for (size_t i = 0; i < gDiscarded.size(); i++) {
+        if (!wait && gDiscarded[i].wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+            gDiscarded[kept++] = gDiscarded[i];
+            continue;
+        }
+        deleteUpload(gDiscarded[i].get());
+    }
+    gDiscarded.resize(kept);
+}
+
+bool pollTexture(TextureFuture* future, GLuint* texture) {
+    if (!gDiscarded.empty()) {
+        collectDiscardedTextures(false);
+    }
+    if (!future->valid()
+        || future->wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+        return false;
+    }
+    const TextureUpload& upload = future->get();
+    if (upload.fence != 0) {
+        // 超时为 0：只查询状态，GPU 还没执行完上传就下一帧再看
+        if (glClientWaitSync(upload.fence, 0, 0) == GL_TIMEOUT_EXPIRED) {
+            return false;
+        }
+        glDeleteSync(upload.fence);
+    }
+    *texture = upload.texture;
+    *future = TextureFuture();
+    if (upload.texture != 0) {
+        std::lock_guard<std::mutex> lock(gStreams.mutex);
+        for (size_t i = 0; i < gStreams.streams.size(); i++) {
+            if (gStreams.streams[i]->texture == upload.texture) {
+                gStreams.streams[i]->ready = true;
+                break;
+            }
+        }
+    }
+    return true;
+}
+
+// 上传 baseLevel - 1 级接下来的若干行（压缩格式按块行），字节数不超过 budget（至少一行），
+// 返回上传的字节数；这一级传完时把 GL_TEXTURE_BASE_LEVEL 降到这一级
+static size_t uploadStreamRows(TextureStream* stream, size_t budget) {
+    const KTXImage& image = stream->image;
+    int level = stream->baseLevel - 1;
+    const KTXLevel& info = image.levels[level];
+    GLenum format = 0;
+    GLenum type = 0;
+    int bytesPerPixel = 0;
+    int blockWidth = 1;
+    int blockHeight = 1;
+    size_t rowSize;  // 一行像素（压缩格式为一行块）的字节数
+    bool compressed = !uncompressedFormatInfo(image.internalFormat, &format, &type, &bytesPerPixel);
+    if (compressed) {
+        int blockBytes = 0;
+        compressedBlockInfo(image.internalFormat, &blockWidth, &blockHeight, &blockBytes);
+        rowSize = (size_t)((info.width + blockWidth - 1) / blockWidth) * blockBytes;
+    } else {
+        rowSize = textureRowSize(image.internalFormat, info.width);
+    }
+    int rowsLeft = (info.height - stream->nextRow + blockHeight - 1) / blockHeight;
+    int rows = (int)std::min((size_t)rowsLeft, std::max(budget / rowSize, (size_t)1));
+    int y = stream->nextRow;
+    // 压缩格式的子区域高度要是块高的倍数，最后一段到这一级的底边为止
+    int height = std::min(rows * blockHeight, info.height - y);
+    const unsigned char* data = stream->pixels.data() + info.offset + rowSize * (y / blockHeight);
+    size_t size = rowSize * rows;
+
+    cachedBindTexture(GL_TEXTURE_2D, stream->texture);
+    if (compressed) {
+        glCompressedTexSubImage2D(GL_TEXTURE_2D, level, 0, y, info.width, height, image.internalFormat,
+                                  (GLsizei)size, data);
+    } else {
+        glTexSubImage2D(GL_TEXTURE_2D, level, 0, y, info.width, height, format, type, data);
+    }
+    stream->nextRow = y + height;
+    if (stream->nextRow == info.height) {
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, level);
+        stream->baseLevel = level;
+        stream->nextRow = 0;
+    }
+    return size;
+}
+
+void streamTextureLevels() {
+    std::lock_guard<std::mutex> lock(gStreams.mutex);
+    if (gStreams.streams.empty()) {
+        return;
+    }
+    // 预算改成 0（关闭）后把剩下的级别一次补完
+    size_t budget = gStreamingBudget.load(std::memory_order_relaxed);
+    if (budget == 0) {
+        budget = SIZE_MAX;
+    }
+    size_t uploaded = 0;
+    size_t i = 0;
+    while (i < gStreams.streams.size() && uploaded < budget) {
+        TextureStream* stream = gStreams.streams[i];
+        if (!stream->ready) {
+            i++;
+            continue;
+        }
+        if (uploaded == 0) {
+            // 从客户端内存上传，各级的行补齐到 4 字节（textureRowSize）
+            cachedBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        }
+        while (stream->baseLevel > 0 && uploaded < budget) {
+            uploaded += uploadStreamRows(stream, budget - uploaded);
+        }
+        if (stream->baseLevel == 0) {
+            LOGI("Texture %u fully resident (%d levels)", stream->texture, stream->image.levelCount);
+            delete stream;
+            gStreams.streams.erase(gStreams.streams.begin() + i);
+        } else {
+            i++;
+        }
+    }
+    if (uploaded > 0) {
+        cachedBindTexture(GL_TEXTURE_2D, 0);
+        logGLError(LOG_TAG, "texture streaming");
+    }
+}
+
+void stopTextureStreaming(GLuint texture) {
+    std::lock_guard<std::mutex> lock(gStreams.mutex);
+    for (size_t i = 0; i < gStreams.streams.size(); i++) {
+        if (gStreams.streams[i]->texture == texture) {
+            delete gStreams.streams[i];
+            gStreams.streams.erase(gStreams.streams.begin() + i);
+            return;
+        }
+    }
+}
+
+void setTextureStreamingBudget(size_t bytesPerFrame) {
+    gStreamingBudget.store(bytesPerFrame, std::memory_order_relaxed);
+}
+
+void discardTexture(TextureFuture* future) {
+    if (!future->valid()) {
+        return;
+    }
+    if (future->wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+        deleteUpload(future->get());
+    } else {
+        gDiscarded.push_back(*future);
+    }
+    *future = TextureFuture();
+}
+
+void releaseDiscardedTextures() {
+    collectDiscardedTextures(true);
+}
+
+void setTextureLoaderCompression(bool enabled, ETC2Quality quality) {
+    gCompressionQuality.store(enabled ? (int)quality : -1, std::memory_order_relaxed);
+}
+
+void waitTextureLoaderIdle() {
+    std::unique_lock<std::mutex> lock(gLoader.mutex);
+    gLoader.idleCond.wait(lock, [] {
+        return !gLoader.running || (gLoader.jobs.empty() && gLoader.uploading == 0);
+    });
+}
@@ -0,0 +1,84 @@
+//
+// Created by zhangx on 2026/10/16.
+// 异步纹理加载 - 在共享上下文的工作线程上经 PBO 上传到不可变存储（RGBA8 / RGB565 / R8 / RGBA16F 像素，或 KTX 中的格式），用 fence 把纹理交给渲染线程。
+// mip 链在工作线程的 CPU 上生成（mip_generator.h）后逐级上传，不调用 glGenerateMipmap。
+// 开启流式上传时先只上传放得进每帧预算的最小几级（GL_TEXTURE_BASE_LEVEL 指向已上传的最大一级），
+// 纹理立即可用，更大的级别由 streamTextureLevels 在之后的帧里按预算逐步补上
+//
+
+#ifndef NDKLEARN2_TEXTURE_LOADER_H
+#define NDKLEARN2_TEXTURE_LOADER_H
+
+#include <GLES3/gl3.h>
+#include "ktx_container.h"
+#include "etc2_encoder.h"
+#include <future>
+
+// 工作线程的上传结果：texture 为 0 表示失败；fence 在上传命令执行完后触发（同步上传时为空）
+struct TextureUpload {
+    GLuint texture;
+    GLsync fence;
+};
+
+typedef std::shared_future<TextureUpload> TextureFuture;
+
+// 在渲染线程调用（当前必须有 EGL 上下文）；当前上下文变化时会重建工作线程
+bool startTextureLoader();
+
+// 停止工作线程并销毁它的上下文，未开始的请求返回 0
+void stopTextureLoader();
+
+// 未压缩的第 0 级：internalFormat 为 GL_RGBA8 / GL_RGB565 / GL_R8 / GL_RGBA16F（uncompressedFormatInfo），
+// stride 为源图一行的字节数，可以大于 width * 每像素字节数（例如 Bitmap 的行填充）
+struct TexturePixels {
+    const void* data;
+    GLenum internalFormat;
+    int width;
+    int height;
+    int stride;
+};
+
+// 渲染线程调用：复制像素后立即返回，复制时各行重新按 4 字节对齐（GL_UNPACK_ALIGNMENT），不转换格式；
+// 按原格式生成 mip 并上传（mip_generator.h），cachePath 非空时同 requestCachedTextureAsync。
+// GL_R8 按 alpha 遮罩（Android A_8）处理，采样结果为 (a, a, a, a)，与预乘 alpha 的 RGBA 纹理用法相同；
+// 运行时压缩只作用于 GL_RGBA8。格式或 stride 不支持时返回无效的 future
+TextureFuture requestPixelsTextureAsync(const TexturePixels& pixels, bool mipmaps, const char* cachePath);
+// 紧密排列的 RGBA8：复制像素后立即返回，调用后即可释放 pixels。像素按 sRGB 颜色处理（Bitmap、PNG），
+// mip 在线性空间平均。加载器未启动或正在录制 GL 命令时在调用线程同步处理和上传，返回已就绪的 future
+TextureFuture requestTextureAsync(const void* pixels, int width, int height, bool mipmaps);
+// 同上（带 mip），并在工作线程上把最终的各级数据（运行时压缩开启时为 ETC2）写到 cachePath，
+// 之后用 loadTextureFileAsync（opengl_utils.h）直接加载，跳过 mip 生成和编码
+TextureFuture requestCachedTextureAsync(const void* pixels, int width, int height, const char* cachePath);
+// KTX 纹理：复制整个 KTX/KTX2 文件（image 为 parseKTX 的结果）后立即返回，
+// 按文件中的级数分配不可变存储并逐级上传（压缩格式或 RGBA8）
+TextureFuture requestKTXTextureAsync(const void* data, size_t size, const KTXImage& image);
+
+// 渲染线程每帧调用，不阻塞：上传完成且 fence 已触发时写出纹理ID（失败为 0）、清空 future 并返回 true；
+// 同时删除 discardTexture 放弃的、已经上传完的纹理
+bool pollTexture(TextureFuture* future, GLuint* texture);
+
+// 运行时压缩（默认关闭）：开启后之后提交的 RGBA8 请求先在工作线程上编码为 ETC2 再上传，
+// 不透明图像为 RGB8 ETC2（显存为 RGBA8 的 1/8），否则为 RGBA8 ETC2 EAC（1/4）；
+// 需要 mip 时先生成 RGBA8 的 mip 链再逐级编码。任意线程可调用
+void setTextureLoaderCompression(bool enabled, ETC2Quality quality);
+
+// 每帧的流式上传预算（字节，默认 1MB），0 表示关闭：所有级别在加载时一次上传。任意线程可调用，
+// 只影响之后提交的请求；预算小于最小一级时仍上传最小一级
+void setTextureStreamingBudget(size_t bytesPerFrame);
+
+// 渲染线程每帧调用一次：给 pollTexture 已取回的纹理按预算补上更大的级别（大的级别分成若干行分帧上传），
+// 一级补全后把 GL_TEXTURE_BASE_LEVEL 降到这一级；会改变当前纹理单元的 GL_TEXTURE_2D 绑定
+void streamTextureLevels();
+
+// 停止纹理的流式上传并释放保留的像素，删除纹理前调用（releaseTexture、discardTexture 已调用）
+void stopTextureStreaming(GLuint texture);
+
+// 放弃还没取回的纹理，不阻塞：已经上传完的立即删除；还在上传的记下来，上传结束后由 pollTexture 删除纹理和 fence
+void discardTexture(TextureFuture* future);
+// 等待 discardTexture 放弃的上传全部结束并删除，会阻塞，只在渲染器清理时调用
+void releaseDiscardedTextures();
+
+// 阻塞到已提交的请求全部上传完成（加载器未启动时立即返回），基准测试预热用
+void waitTextureLoaderIdle();
+
+#endif //NDKLEARN2_TEXTURE_LOADER_H
@@ -0,0 +1,194 @@
+//
+// Created by zhangx on 2026/10/16.
+// 顶点布局描述 - 用模板参数列出各属性的存储格式，编译期算出偏移和步长，
+// 展开成 glVertexAttribPointer / glVertexAttribIPointer 调用；附带把 float 源数据量化成打包格式的转换
+//
+// 属性按模板参数的顺序占用 location 0, 1, 2...，每个属性补齐到 4 字节（顶点读取按 4 字节对齐）。
+// 例：半精度位置 + 2_10_10_10 法线 + 半精度 UV + 整数面ID，每个顶点 20 字节（全部用 float 时为 36 字节）
+//   typedef VertexLayout<VertexHalf<3>, VertexPackedNormal, VertexHalf<2>, VertexUByteInt<1>> CubeLayout;
+//   std::vector<unsigned char> packed;
+//   packVertices<CubeLayout>(floats, vertexCount, &packed);  // floats 每个顶点 CubeLayout::SOURCE_FLOATS 个
+//   MeshData mesh = createMesh<CubeLayout>(packed.data(), vertexCount, indices, indexCount);
+// 着色器中的声明不变（vec3 / vec2），整数属性声明为 in uint 或 in int
+//
+
+#ifndef NDKLEARN2_VERTEX_LAYOUT_H
+#define NDKLEARN2_VERTEX_LAYOUT_H
+
+#include <GLES3/gl3.h>
+#include "opengl_utils.h"
+#include "mesh_container.h"
+#include "half_float.h"
+#include "gl_trace.h"
+#include <cmath>
+#include <cstring>
+#include <stdint.h>
+#include <vector>
+
+// 每种属性格式提供：COMPONENTS（GL 的 size）、TYPE、NORMALIZED、INTEGER（用 glVertexAttribIPointer）、
+// SOURCE_COMPONENTS（消耗的源 float 个数）、BYTES（补齐到 4 字节后的大小），
+// 以及 pack：把 SOURCE_COMPONENTS 个 float 量化写到 dst（BYTES 字节，补齐部分写 0）
+
+template <int N>
+struct VertexFloat {
+    static const GLint COMPONENTS = N;
+    static const GLenum TYPE = GL_FLOAT;
+    static const GLboolean NORMALIZED = GL_FALSE;
+    static const bool INTEGER = false;
+    static const int SOURCE_COMPONENTS = N;
+    static const size_t BYTES = N * 4;
+
+    static void pack(const float* src, unsigned char* dst) {
+        memcpy(dst, src, N * 4);
+    }
+};
+
+// 半精度：3 个分量时补第 4 个分量 1.0（位置的 w），凑齐 8 字节；精度约 3 位有效数字，适合模型空间坐标和 UV
+template <int N>
+struct VertexHalf {
+    static const GLint COMPONENTS = N == 3 ? 4 : N;
+    static const GLenum TYPE = GL_HALF_FLOAT;
+    static const GLboolean NORMALIZED = GL_FALSE;
+    static const bool INTEGER = false;
+    static const int SOURCE_COMPONENTS = N;
+    static const size_t BYTES = (COMPONENTS * 2 + 3) / 4 * 4;
+
+    static void pack(const float* src, unsigned char* dst) {
+        uint16_t halves[BYTES / 2] = {};
+        for (int i = 0; i < N; i++) {
+            halves[i] = floatToHalf(src[i]);
+        }
+        if (N == 3) {
+            halves[3] = 0x3c00;  // 1.0
+        }
+        memcpy(dst, halves, BYTES);
+    }
+};
+
+// 单位法线、切线：GL_INT_2_10_10_10_REV，xyz 各 10 位有符号归一化，w 为 0，共 4 字节
+struct VertexPackedNormal {
+    static const GLint COMPONENTS = 4;
+    static const GLenum TYPE = GL_INT_2_10_10_10_REV;
+    static const GLboolean NORMALIZED = GL_TRUE;
+    static const bool INTEGER = false;
+    static const int SOURCE_COMPONENTS = 3;
+    static const size_t BYTES = 4;
+
+    static void pack(const float* src, unsigned char* dst) {
+        uint32_t packed = 0;
+        for (int i = 0; i < 3; i++) {
+            // ES 3.0 的有符号归一化：f = max(c / 511, -1)
+            float value = src[i] < -1.0f ? -1.0f : (src[i] > 1.0f ? 1.0f : src[i]);
+            int32_t component = (int32_t)lrintf(value * 511.0f);
+            packed |= ((uint32_t)component & 0x3ffu) << (i * 10);
+        }
+        memcpy(dst, &packed, 4);
+    }
+};
+
+// 小整数（面ID、材质索引等）：GL_UNSIGNED_BYTE 整数属性，源值四舍五入并限制在 0..255
+template <int N>
+struct VertexUByteInt {
+    static const GLint COMPONENTS = N;
+    static const GLenum TYPE = GL_UNSIGNED_BYTE;
+    static const GLboolean NORMALIZED = GL_FALSE;
+    static const bool INTEGER = true;
+    static const int SOURCE_COMPONENTS = N;
+    static const size_t BYTES = (N + 3) / 4 * 4;
+
+    static void pack(const float* src, unsigned char* dst) {
+        memset(dst, 0, BYTES);
+        for (int i = 0; i < N; i++) {
+            long value = lrintf(src[i]);
+            dst[i] = (unsigned char)(value < 0 ? 0 : (value > 255 ? 255 : value));
+        }
+    }
+};
+
+template <typename... Attributes>
+struct VertexLayout;
+
+template <>
+struct VertexLayout<> {
+    static const size_t SIZE = 0;
+    static const int SOURCE_FLOATS = 0;
+    static const GLuint COUNT = 0;
+
+    template <GLuint LOCATION, size_t OFFSET, GLsizei STRIDE>
+    static void setAttributes() {}
+
+    template <GLuint LOCATION, size_t OFFSET>
+    static void describe(MeshAttribute*) {}
+
+    static void packVertex(const float*, unsigned char*) {}
+};
+
+template <typename First, typename... Rest>
+struct VertexLayout<First, Rest...> {
+    typedef VertexLayout<Rest...> Tail;
+    static const size_t SIZE = First::BYTES + Tail::SIZE;                       // 每个顶点的字节数（步长）
+    static const int SOURCE_FLOATS = First::SOURCE_COMPONENTS + Tail::SOURCE_FLOATS;  // 每个源顶点的 float 数
+    static const GLuint COUNT = 1 + Tail::COUNT;
+
+    static_assert(First::BYTES % 4 == 0, "vertex attributes must be padded to 4 bytes");
+    static_assert(COUNT <= 16, "ES 3.0 guarantees only 16 vertex attributes");
+
+    // 在当前绑定的 VAO 上设置全部属性，顶点数据在当前 GL_ARRAY_BUFFER 中从偏移 0 开始
+    static void enableAttributes() {
+        setAttributes<0, 0, (GLsizei)SIZE>();
+    }
+
+    template <GLuint LOCATION, size_t OFFSET, GLsizei STRIDE>
+    static void setAttributes() {
+        if (First::INTEGER) {
+            glVertexAttribIPointer(LOCATION, First::COMPONENTS, First::TYPE, STRIDE, (const void*)OFFSET);
+        } else {
+            glVertexAttribPointer(LOCATION, First::COMPONENTS, First::TYPE, First::NORMALIZED, STRIDE,
+                                  (const void*)OFFSET);
+        }
+        glEnableVertexAttribArray(LOCATION);
+        Tail::template setAttributes<LOCATION + 1, OFFSET + First::BYTES, STRIDE>();
+    }
+
+    // 写出运行时的属性表（COUNT 项），供 mesh_container.h 的 .mesh 文件记录布局
+    static void describeAttributes(MeshAttribute* attributes) {
+        describe<0, 0>(attributes);
+    }
+
+    template <GLuint LOCATION, size_t OFFSET>
+    static void describe(MeshAttribute* attribute) {
+        attribute->location = LOCATION;
+        attribute->components = First::COMPONENTS;
+        attribute->type = First::TYPE;
+        attribute->flags = (First::NORMALIZED ? MESH_ATTRIBUTE_NORMALIZED : 0)
+                           | (First::INTEGER ? MESH_ATTRIBUTE_INTEGER : 0);
+        attribute->offset = (uint32_t)OFFSET;
+        Tail::template describe<LOCATION + 1, OFFSET + First::BYTES>(attribute + 1);
+    }
+
+    static void packVertex(const float* src, unsigned char* dst) {
+        First::pack(src, dst);
+        Tail::packVertex(src + First::SOURCE_COMPONENTS, dst + First::BYTES);
+    }
+};
+
+// 量化转换：source 为紧密排列的 float 顶点（每个顶点 Layout::SOURCE_FLOATS 个，属性顺序与 Layout 相同），
+// 输出 vertexCount * Layout::SIZE 字节
+template <typename Layout>
+void packVertices(const float* source, size_t vertexCount, std::vector<unsigned char>* packed) {
+    packed->resize(vertexCount * Layout::SIZE);
+    for (size_t i = 0; i < vertexCount; i++) {
+        Layout::packVertex(source + i * Layout::SOURCE_FLOATS, packed->data() + i * Layout::SIZE);
+    }
+}
+
+// 上传 packVertices 打包好的顶点和索引（可以为空），按 Layout 设置属性
+template <typename Layout>
+MeshData createMesh(const void* vertices, size_t vertexCount, const unsigned int* indices, size_t indexCount) {
+    MeshData mesh = createMeshBuffers(vertices, vertexCount * Layout::SIZE, indices, GL_UNSIGNED_INT, indexCount);
+    Layout::enableAttributes();
+    finishMeshBuffers();
+    return mesh;
+}
+
+#endif //NDKLEARN2_VERTEX_LAYOUT_H
@@ -25,6 +25,9 @@ public class EGLTestActivity extends AppCompatActivity {
     protected void onCreate(Bundle savedInstanceState) {
         super.onCreate(savedInstanceState);
         
+        // 启用程序二进制缓存
+        ProgramCache.init(this);
+        
         // 创建 SurfaceView（用于显示 OpenGL 内容）
         surfaceView = new SurfaceView(this);
         
@@ -0,0 +1,109 @@
+package com.example.ndklearn2;
+
+import android.util.Log;
+
+import java.util.Locale;
+
+/**
+ * 分阶段帧耗时统计
+ *
+ * native 渲染器在每帧的清屏、统一变量更新、TFB 更新、绘制、视锥剔除和交换前后打点，
+ * CPU 耗时来自单调时钟，GPU 耗时来自 GL_EXT_disjoint_timer_query（驱动不支持时只有 CPU 耗时）。
+ * 样本先写入 native 层的无锁环形缓冲区，drain() 一次取出并按阶段汇总，可以在任意线程定期调用。
+ * 环形缓冲区约能容纳 10 秒的样本，调用间隔过长时多出的样本会被丢弃（见 Snapshot.dropped）。
+ */
+public class FrameTiming {
+
+    static {
+        System.loadLibrary("ndklearn2");
+    }
+
+    /** 阶段名，顺序与 native 层 FrameStage 一致 */
+    public static final String[] STAGES = {"clear", "uniforms", "tfbUpdate", "draw", "cull", "swap", "frame"};
+
+    private static final int FLOATS_PER_STAGE = 10;
+
+    /** 一个阶段的汇总，单位毫秒；gpuSamples 为 0 时 GPU 各项为 -1 */
+    public static class StageStats {
+        public String stage;
+        public int samples;
+        public float cpuMin, cpuAvg, cpuP95, cpuP99;
+        public int gpuSamples;
+        public float gpuMin, gpuAvg, gpuP95, gpuP99;
+
+        @Override
+        public String toString() {
+            String text = String.format(Locale.US, "%s n=%d cpu min %.3f avg %.3f p95 %.3f p99 %.3f ms",
+                    stage, samples, cpuMin, cpuAvg, cpuP95, cpuP99);
+            if (gpuSamples > 0) {
+                text += String.format(Locale.US, ", gpu min %.3f avg %.3f p95 %.3f p99 %.3f ms",
+                        gpuMin, gpuAvg, gpuP95, gpuP99);
+            }
+            return text;
+        }
+    }
+
+    public static class Snapshot {
+        /** 按 STAGES 顺序，没有样本的阶段 samples 为 0 */
+        public StageStats[] stages;
+        /** 上次取出以来因缓冲区满而丢弃的样本数 */
+        public int dropped;
+    }
+
+    /**
+     * 取出上次调用以来的全部样本并汇总
+     */
+    public static Snapshot drain() {
+        float[] values = nativeDrain();
+        Snapshot snapshot = new Snapshot();
+        snapshot.stages = new StageStats[STAGES.length];
+        for (int i = 0; i < STAGES.length; i++) {
+            int base = i * FLOATS_PER_STAGE;
+            StageStats stats = new StageStats();
+            stats.stage = STAGES[i];
+            stats.samples = (int) values[base];
+            stats.cpuMin = values[base + 1];
+            stats.cpuAvg = values[base + 2];
+            stats.cpuP95 = values[base + 3];
+            stats.cpuP99 = values[base + 4];
+            stats.gpuSamples = (int) values[base + 5];
+            stats.gpuMin = values[base + 6];
+            stats.gpuAvg = values[base + 7];
+            stats.gpuP95 = values[base + 8];
+            stats.gpuP99 = values[base + 9];
+            snapshot.stages[i] = stats;
+        }
+        snapshot.dropped = (int) values[STAGES.length * FLOATS_PER_STAGE];
+        return snapshot;
+    }
+
+    /**
+     * 取出并打印到 logcat
+     */
+    public static void drainToLog(String tag) {
+        Snapshot snapshot = drain();
+        for (StageStats stats : snapshot.stages) {
+            if (stats.samples > 0) {
+                Log.i(tag, stats.toString());
+            }
+        }
+        if (snapshot.dropped > 0) {
+            Log.w(tag, "Frame timing dropped " + snapshot.dropped + " samples");
+        }
+    }
+
+    /**
+     * 开关统计，下一帧生效，默认开启
+     */
+    public static void setEnabled(boolean enabled) {
+        nativeSetEnabled(enabled);
+    }
+
+    public static boolean isGpuTimingSupported() {
+        return nativeIsGpuSupported();
+    }
+
+    private static native float[] nativeDrain();
+    private static native void nativeSetEnabled(boolean enabled);
+    private static native boolean nativeIsGpuSupported();
+}
@@ -0,0 +1,47 @@
+package com.example.ndklearn2;
+
+import android.content.Context;
+
+import java.io.File;
+
+/**
+ * GL 命令录制
+ *
+ * 请求后，下一次创建 GL 上下文的渲染器（OpenGLRenderer / 2 / 3、EGLRenderer）会从初始化开始录制
+ * 渲染线程上的全部 GL 调用（含缓冲区和纹理数据），录满指定帧数后写入文件。
+ * 录制文件可以拷到 Linux 机器上用 gl_trace_replay 在无窗口的 EGL 上下文中回放，测量 CPU 提交耗时。
+ *
+ * 例如：adb shell am start -n com.example.ndklearn2/.MainActivity --ei gl_trace_frames 300
+ *      adb pull /sdcard/Android/data/com.example.ndklearn2/files/renderer.gltrace
+ *
+ * native 库以 NDKLEARN2_GL_TRACE=OFF 编译时请求会被忽略。
+ */
+public class GLTrace {
+
+    static {
+        System.loadLibrary("ndklearn2");
+    }
+
+    public static final String EXTRA_FRAMES = "gl_trace_frames";
+    private static final String TRACE_FILE_NAME = "renderer.gltrace";
+
+    /**
+     * 请求录制到应用外部文件目录下的 renderer.gltrace，必须在 GLSurfaceView 创建上下文之前调用
+     */
+    public static File request(Context context, int frameCount) {
+        File file = new File(context.getExternalFilesDir(null), TRACE_FILE_NAME);
+        request(file.getAbsolutePath(), frameCount);
+        return file;
+    }
+
+    public static void request(String path, int frameCount) {
+        nativeRequest(path, frameCount);
+    }
+
+    public static boolean isRecording() {
+        return nativeIsRecording();
+    }
+
+    private static native void nativeRequest(String path, int frameCount);
+    private static native boolean nativeIsRecording();
+}
@@ -21,6 +21,15 @@ public class MainActivity extends AppCompatActivity {
     protected void onCreate(Bundle savedInstanceState) {
         super.onCreate(savedInstanceState);
 
+        // 启用程序二进制缓存（必须在渲染器编译着色器之前）
+        ProgramCache.init(this);
+
+        // 启动参数带 gl_trace_frames 时录制渲染器的 GL 命令（必须在上下文创建之前请求）
+        int traceFrames = getIntent().getIntExtra(GLTrace.EXTRA_FRAMES, 0);
+        if (traceFrames > 0) {
+            GLTrace.request(this, traceFrames);
+        }
+
         // 创建 GLSurfaceView
         glSurfaceView = new GLSurfaceView(this);
         
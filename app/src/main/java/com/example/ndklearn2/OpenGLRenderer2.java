@@ -1,12 +1,16 @@
 package com.example.ndklearn2;
 
 import android.content.Context;
+import android.content.res.AssetManager;
 import android.opengl.GLSurfaceView;
 import javax.microedition.khronos.egl.EGLConfig;
 import javax.microedition.khronos.opengles.GL10;
 import android.graphics.Bitmap;
 import android.graphics.BitmapFactory;
 import android.opengl.Matrix;
+import android.util.Log;
+
+import java.io.File;
 /**
  * OpenGL ES 渲染器
  *
@@ -29,7 +33,12 @@ import android.opengl.Matrix;
  */
 public class OpenGLRenderer2 implements GLSurfaceView.Renderer {
 
+    private static final String TAG = "OpenGLRenderer2";
+
     private Context mContext;
+
+    // 光照基准测试请求（任意线程设置，在渲染线程下一帧执行）
+    private volatile boolean mLightingBenchmarkRequested = false;
     
     // 变换矩阵
     private float[] modelMatrix = new float[16];
@@ -142,7 +151,10 @@ public class OpenGLRenderer2 implements GLSurfaceView.Renderer {
         nativeInit();
         loadTexture(R.drawable.texture);
         loadUniform();
-        loadVertice();
+        // 优先使用构建时转换好的网格（assets/meshes，见 CMakeLists.txt 的 mesh_assets），没有时用内置正方体
+        if (!loadMeshAsset(mContext.getAssets(), "meshes/cube.mesh")) {
+            loadVertice();
+        }
 
         
 
@@ -159,23 +171,80 @@ public class OpenGLRenderer2 implements GLSurfaceView.Renderer {
     private native void updateMaterialUBO(float[] materialAmbient, float[] materialDiffuse, float[] materialSpecular, float materialShininess);
     private native void updateCameraPos(float[] cameraPos);
 
+    /**
+     * 比较通用光照程序和各特化变体的片段着色开销
+     * @return [通用程序 ms, 特化变体 ms] * 变体数，程序未就绪时返回 null
+     */
+    private native float[] nativeBenchmarkLighting(int drawCount);
+
+    /**
+     * 请求在下一帧运行光照基准测试，结果输出到 logcat
+     */
+    public void requestLightingBenchmark() {
+        mLightingBenchmarkRequested = true;
+    }
+
 
     private native void loadUniform();
 
 
     private native void loadVertice();
 
+    private native boolean loadMeshAsset(AssetManager assets, String path);
+
+    /**
+     * 实例化绘制：从第 first 个实例开始写入，每 16 个 float 一个列主序模型矩阵；
+     * normalMatrices 为 null 时由模型矩阵计算，否则每 9 个 float 一个 mat3。需要在 GL 线程调用（queueEvent）
+     */
+    public native void updateInstances(int first, float[] modelMatrices, float[] normalMatrices);
+
+    /**
+     * 只保留前 count 个实例，0 表示回到单个正方体的绘制。需要在 GL 线程调用
+     */
+    public native void setInstanceCount(int count);
+
     public void loadTexture(int resourceID){
-        // 1. 从资源中解码 Bitmap (设置为不缩放，确保原始大小)
+        String name = mContext.getResources().getResourceEntryName(resourceID);
+        // 0. 优先使用构建时编码好的压缩纹理（assets/textures/<资源名>.ktx，见 CMakeLists.txt 的 texture_assets）
+        String compressedPath = "textures/" + name + ".ktx";
+        if (loadCompressedTexture(mContext.getAssets(), compressedPath)) {
+            return;
+        }
+        // 1. 其次是上次启动时缓存的 mip 链；文件名带 APK 的修改时间，应用更新后资源可能变化，旧缓存不再匹配
+        File cacheDir = new File(mContext.getCacheDir(), "textures");
+        String stamp = Long.toString(new File(mContext.getApplicationInfo().sourceDir).lastModified());
+        File cacheFile = new File(cacheDir, name + "-" + stamp + ".ktx");
+        if (cacheFile.isFile() && loadTextureFile(cacheFile.getAbsolutePath())) {
+            return;
+        }
+        removeStaleTextureCaches(cacheDir, name, cacheFile);
+        // 2. 从资源中解码 Bitmap (设置为不缩放，确保原始大小)
         BitmapFactory.Options options = new BitmapFactory.Options();
         options.inScaled = false;
         Bitmap bitmap = BitmapFactory.decodeResource(mContext.getResources(), resourceID, options);
-        // 2. 绑定这个 Bitmap 到 OpenGL (假设你已经绑定了 texture ID)
-        loadTextureFromBitmap(bitmap);
-        // 3. 及时回收 Bitmap (可选，但这还是由 Java GC 管理)
+        // 3. 交给纹理加载线程：生成 mip 链后上传，并写出缓存供下次启动使用
+        String cachePath = cacheDir.isDirectory() || cacheDir.mkdirs() ? cacheFile.getAbsolutePath() : null;
+        loadTextureFromBitmap(bitmap, cachePath);
+        // 4. 像素已复制到 native，及时回收 Bitmap
         bitmap.recycle();
     }
-    public native void loadTextureFromBitmap(Bitmap bitmap);
+
+    // 删除同一资源在旧版本 APK 下生成的缓存
+    private static void removeStaleTextureCaches(File cacheDir, String name, File current) {
+        File[] files = cacheDir.listFiles();
+        if (files == null) {
+            return;
+        }
+        for (File file : files) {
+            if (file.getName().startsWith(name + "-") && !file.equals(current) && !file.delete()) {
+                Log.w(TAG, "Failed to delete stale texture cache " + file);
+            }
+        }
+    }
+
+    public native void loadTextureFromBitmap(Bitmap bitmap, String cachePath);
+    private native boolean loadCompressedTexture(AssetManager assets, String path);
+    private native boolean loadTextureFile(String path);
     /**
      * 【步骤 2】表面大小改变时调用
      * 时机：GLSurfaceView 大小改变时（如旋转屏幕）
@@ -211,6 +280,14 @@ public class OpenGLRenderer2 implements GLSurfaceView.Renderer {
     public void onDrawFrame(GL10 gl) {
         // 调用 C++ 函数，使用 GLSL 着色器绘制
         nativeRender();
+
+        if (mLightingBenchmarkRequested) {
+            mLightingBenchmarkRequested = false;
+            float[] results = nativeBenchmarkLighting(200);
+            if (results == null) {
+                Log.w(TAG, "Lighting benchmark skipped, program not ready");
+            }
+        }
     }
 
     /**
@@ -0,0 +1,40 @@
+package com.example.ndklearn2;
+
+import android.content.Context;
+
+import java.io.File;
+
+/**
+ * 程序二进制缓存
+ *
+ * 着色器程序第一次链接后，native 层会用 glGetProgramBinary 把二进制写到缓存目录，
+ * 之后的启动直接 glProgramBinary 加载，跳过 GLSL 编译和链接。
+ * 驱动升级或缓存文件损坏时会自动回退到完整编译。
+ */
+public class ProgramCache {
+
+    static {
+        System.loadLibrary("ndklearn2");
+    }
+
+    private static final String CACHE_DIR_NAME = "program_binaries";
+
+    /**
+     * 在创建任何渲染器之前调用
+     */
+    public static void init(Context context) {
+        File dir = new File(context.getCacheDir(), CACHE_DIR_NAME);
+        dir.mkdirs();
+        nativeSetCacheDir(dir.getAbsolutePath());
+    }
+
+    /**
+     * @return [命中次数, 未命中次数, 失效条目数, 节省的编译时间（微秒）]
+     */
+    public static long[] getStats() {
+        return nativeGetStats();
+    }
+
+    private static native void nativeSetCacheDir(String cacheDir);
+    private static native long[] nativeGetStats();
+}